@@ -1,7 +1,8 @@
-import { rm, mkdir, cp } from 'node:fs/promises';
+import { rm, mkdir, cp, readdir, readFile, writeFile } from 'node:fs/promises';
 import { existsSync } from 'node:fs';
-import { dirname, resolve } from 'node:path';
+import { dirname, extname, join, relative, resolve } from 'node:path';
 import { fileURLToPath } from 'node:url';
+import { constants, gzipSync } from 'node:zlib';
 
 const thisFile = fileURLToPath(import.meta.url);
 const scriptsDir = dirname(thisFile);
@@ -9,6 +10,12 @@ const root = resolve(scriptsDir, '..', '..');
 const distDir = resolve(root, 'frontend', 'dist');
 const firmwareDir = resolve(root, 'main', 'webui');
 
+// Text assets are stored gzip-only; the firmware serves `<name>.gz` with
+// Content-Encoding: gzip. Images are already compressed and stay as they are.
+const COMPRESSIBLE_EXTENSIONS = new Set(['.html', '.js', '.css', '.json', '.svg', '.ico', '.txt', '.map']);
+// SPIFFS object names, including the leading slash, are limited to 31 bytes.
+const SPIFFS_MAX_NAME_BYTES = 31;
+
 if (!existsSync(distDir)) {
   throw new Error(`Build output not found: ${distDir}`);
 }
@@ -17,4 +24,35 @@ await rm(firmwareDir, { recursive: true, force: true });
 await mkdir(firmwareDir, { recursive: true });
 await cp(distDir, firmwareDir, { recursive: true });
 
-console.log(`Copied frontend dist to ${firmwareDir}`);
+async function listFiles(dir) {
+  const entries = await readdir(dir, { withFileTypes: true });
+  const nested = await Promise.all(entries.map((entry) => {
+    const path = join(dir, entry.name);
+    return entry.isDirectory() ? listFiles(path) : [path];
+  }));
+  return nested.flat();
+}
+
+let rawBytes = 0;
+let storedBytes = 0;
+for (const file of await listFiles(firmwareDir)) {
+  const data = await readFile(file);
+  rawBytes += data.length;
+
+  let storedName = `/${relative(firmwareDir, file).split('\\').join('/')}`;
+  if (COMPRESSIBLE_EXTENSIONS.has(extname(file).toLowerCase())) {
+    const compressed = gzipSync(data, { level: constants.Z_BEST_COMPRESSION });
+    await writeFile(`${file}.gz`, compressed);
+    await rm(file);
+    storedName += '.gz';
+    storedBytes += compressed.length;
+  } else {
+    storedBytes += data.length;
+  }
+
+  if (Buffer.byteLength(storedName) > SPIFFS_MAX_NAME_BYTES) {
+    throw new Error(`${storedName} exceeds the ${SPIFFS_MAX_NAME_BYTES}-byte SPIFFS name limit`);
+  }
+}
+
+console.log(`Copied frontend dist to ${firmwareDir} (${rawBytes} bytes, ${storedBytes} stored after gzip)`);
@@ -35,10 +35,30 @@ const state = {
   pidDerivativeFilterS: 0,
   pidSetpointWeight: 0.5,
   inputFilterMs: 1000,
+  processRate: 0,
+  pvPipeline: {
+    filter: 'low_pass',
+    outlier_rejection: true,
+    derivative_from_rate: false,
+    input_weights: [1, 1, 1, 1],
+    rejected_readings: [0, 0, 0, 0]
+  },
+  tickMs: 0,
+  tickResetAt: Date.now(),
   inputs: [0],
   pwmRelays: [0, 1],
   pwmRelayWeights: { 0: 1, 1: 0.5 },
+  relayDriveMode: 'window',
+  mainsHz: 50,
   runningRelays: [2],
+  zones: [], // Explicit layout for 2-4 zones; empty = single zone over inputs/pwmRelays
+  feedforward: {
+    enabled: false,
+    lookahead_s: 30,
+    gain: 1,
+    model: { gain_c_per_pct: 0, time_constant_s: 0, ambient_c: 24 }
+  },
+  nextSeq: 0,
   points: []
 };
 
@@ -55,7 +75,8 @@ const profileState = {
 };
 
 let uploadedProfile = null;
-const profileSlots = new Array(5).fill(null);
+const MAX_PROFILE_SLOTS = 16;
+const profileSlots = new Array(MAX_PROFILE_SLOTS).fill(null);
 
 function json(res, code, payload) {
   res.writeHead(code, {
@@ -66,7 +87,161 @@ function json(res, code, payload) {
   res.end(JSON.stringify(payload));
 }
 
+function encodeHistoryBinary(points, oldestSeq, nextSeq) {
+  const headerSize = 32;
+  const zoneCount = Math.max(1, ...points.map((p) => p.zones?.length ?? 1));
+  const recordSize = 26 + (zoneCount > 1 ? zoneCount * 4 : 0);
+  const buffer = Buffer.alloc(headerSize + points.length * recordSize);
+  const clamp16 = (value) => Math.max(-32768, Math.min(32767, Math.round(value ?? 0)));
+
+  buffer.write('RFH1', 0, 'latin1');
+  buffer.writeUInt8(3, 4);
+  buffer.writeUInt8(recordSize, 5);
+  buffer.writeUInt8(zoneCount, 6);
+  let previous = points.length > 0 ? Math.floor(points[0].timestamp / 1000) : 0;
+  let previousSeq = points.length > 0 ? points[0].seq : nextSeq;
+  buffer.writeBigUInt64LE(BigInt(previous), 8);
+  buffer.writeUInt32LE(previousSeq, 16);
+  buffer.writeUInt32LE(oldestSeq, 20);
+  buffer.writeUInt32LE(nextSeq, 24);
+
+  points.forEach((p, idx) => {
+    const offset = headerSize + idx * recordSize;
+    const seconds = Math.floor(p.timestamp / 1000);
+    buffer.writeUInt16LE(Math.max(0, Math.min(65535, seconds - previous)), offset);
+    previous = seconds;
+    buffer.writeInt16LE(clamp16(p.setpoint * 4), offset + 2);
+    buffer.writeInt16LE(clamp16(p.process_value * 4), offset + 4);
+    buffer.writeInt16LE(clamp16(p.pid_output * 100), offset + 6);
+    buffer.writeUInt16LE(p.seq - previousSeq, offset + 24);
+    previousSeq = p.seq;
+    if (zoneCount > 1) {
+      (p.zones ?? []).forEach((zone, z) => {
+        buffer.writeInt16LE(clamp16(zone.process_value * 4), offset + 26 + z * 4);
+        buffer.writeInt16LE(clamp16(zone.pid_output * 100), offset + 28 + z * 4);
+      });
+    }
+  });
+
+  return buffer;
+}
+
+function makeRollups(points, resolutionS) {
+  const buckets = new Map();
+  for (const p of points) {
+    const bucket = Math.floor(p.timestamp / 1000 / resolutionS);
+    const entry = buckets.get(bucket) ?? { seq: bucket, timestamp: bucket * resolutionS, samples: 0, values: { setpoint: [], process_value: [], pid_output: [] } };
+    entry.samples += 1;
+    entry.values.setpoint.push(p.setpoint);
+    entry.values.process_value.push(p.process_value);
+    entry.values.pid_output.push(p.pid_output);
+    buckets.set(bucket, entry);
+  }
+  const stats = (values) => ({
+    min: Math.min(...values),
+    max: Math.max(...values),
+    mean: values.reduce((sum, v) => sum + v, 0) / values.length
+  });
+  // Like the firmware, only closed buckets are reported.
+  return [...buckets.values()].slice(0, -1).map((b) => ({
+    seq: b.seq,
+    timestamp: b.timestamp,
+    samples: b.samples,
+    setpoint: stats(b.values.setpoint),
+    process_value: stats(b.values.process_value),
+    pid_output: stats(b.values.pid_output)
+  }));
+}
+
+// Simulated relay autotune; every mock cycle takes 20 s.
+const MOCK_AUTOTUNE_CYCLE_MS = 20000;
+const autotuneState = {
+  state: 'idle',
+  startedMs: 0,
+  cycles: 0,
+  config: { setpoint_c: 150, heat_output_pct: 100, cool_output_pct: 100, hysteresis_c: 0.5, max_duration_s: 1800 }
+};
+
+function updateMockAutotune() {
+  if (autotuneState.state !== 'running') {
+    return;
+  }
+  const cycle = Math.floor((Date.now() - autotuneState.startedMs) / MOCK_AUTOTUNE_CYCLE_MS);
+  state.state = `Autotune ${Math.min(cycle + 1, autotuneState.cycles)}/${autotuneState.cycles}`;
+  if (cycle >= autotuneState.cycles) {
+    autotuneState.state = 'complete';
+    state.running = false;
+    state.state = 'Autotune Complete';
+  }
+}
+
+function mockAutotuneCycle() {
+  if (autotuneState.state === 'complete') {
+    return autotuneState.cycles;
+  }
+  if (autotuneState.state !== 'running') {
+    return 0;
+  }
+  return Math.min(autotuneState.cycles, Math.floor((Date.now() - autotuneState.startedMs) / MOCK_AUTOTUNE_CYCLE_MS));
+}
+
+// Simulated profile preview: the setpoint path through a first-order lag,
+// finishing after a short delay like the board's background task.
+const MOCK_SIMULATION_MS = 1500;
+const simulationState = { state: 'idle', startedMs: 0, profileName: '', result: null };
+
+function simulateMockProfile(profile, initialPv) {
+  const tauS = 180;
+  const points = [];
+  let t = 0;
+  let sp = initialPv;
+  let pv = initialPv;
+  const advance = (seconds, stepNumber, targetAt) => {
+    for (let s = 0; s < seconds; s += 5) {
+      sp = targetAt(s);
+      pv += (sp - pv) * (1 - Math.exp(-5 / tauS));
+      points.push({ time_s: t, setpoint: sp, process_value: pv, pid_output: Math.max(-100, Math.min(100, (sp - pv) * 5)), step_number: stepNumber });
+      t += 5;
+    }
+  };
+  (profile.steps ?? []).forEach((step, idx) => {
+    const n = idx + 1;
+    const start = sp;
+    switch (step.type) {
+      case 'direct':
+        advance(5, n, () => step.setpoint_c);
+        break;
+      case 'wait':
+        advance(step.wait_time_s ?? 60, n, () => start);
+        break;
+      case 'soak':
+        advance(step.soak_time_s, n, () => step.setpoint_c);
+        break;
+      case 'ramp_time':
+        advance(step.ramp_time_s, n, (s) => start + ((step.setpoint_c - start) * s) / step.ramp_time_s);
+        break;
+      case 'ramp_rate': {
+        const duration = Math.abs(step.setpoint_c - start) / step.ramp_rate_c_per_s;
+        advance(duration, n, (s) => start + Math.sign(step.setpoint_c - start) * Math.min(s * step.ramp_rate_c_per_s, Math.abs(step.setpoint_c - start)));
+        break;
+      }
+      default:
+        break;
+    }
+  });
+  const stride = Math.max(1, Math.ceil(points.length / 500));
+  return {
+    outcome: 'completed',
+    duration_s: t,
+    max_overshoot_c: 0,
+    ticks: Math.round(t / 0.22),
+    step_s: 0.22,
+    points: points.filter((_, idx) => idx % stride === 0)
+  };
+}
+
 function makeStatusData() {
+  updateMockAutotune();
   return {
     controller: {
       running: state.running,
@@ -75,10 +250,18 @@ function makeStatusData() {
       state: state.state,
       setpoint_c: state.setpoint,
       process_value_c: state.process,
+      process_rate_c_per_s: state.processRate,
       pid_output: state.pid,
       p_term: state.p,
       i_term: state.i,
-      d_term: state.d
+      d_term: state.d,
+      ff_term: 0,
+      autotune: {
+        state: autotuneState.state,
+        cycle: mockAutotuneCycle(),
+        cycles: autotuneState.cycles
+      },
+      zones: mockZoneStatus()
     },
     profile: {
       ...profileState
@@ -117,6 +300,38 @@ function envelope(data) {
   return { ok: true, data };
 }
 
+// A few seconds of controller ticks and thermocouple reads in Chrome trace form.
+function mockBootTimeline() {
+  const stages = [
+    ['tracer', 0.1], ['settings', 14.2], ['hardware', 38.5], ['controller', 2.1], ['profile_engine', 6.4],
+    ['data_manager', 1.2], ['control_benchmark', null], ['controller_task', 0.3],
+    ['wifi_init', 96.0], ['web_server', 182.4], ['run_log', 21.7], ['wifi_connect', 2840.5], ['time_sync', 0.4]
+  ];
+  const appStart = 412.6;
+  let at = appStart;
+  const out = stages.map(([name, duration]) => {
+    if (duration === null) {
+      return { name, state: 'skipped', start_ms: null, duration_ms: null, result: null };
+    }
+    const stage = { name, state: 'done', start_ms: at, duration_ms: duration, result: 'ESP_OK' };
+    at += duration;
+    return stage;
+  });
+  return { app_start_ms: appStart, control_ready_ms: appStart + 62.8, network_ready_ms: at, stages: out };
+}
+
+function mockTraceEvents() {
+  const events = [];
+  const baseUs = Date.now() * 1000 - 5_000_000;
+  for (let i = 0; i < 22; i += 1) {
+    const tickUs = baseUs + i * 220_000;
+    events.push({ name: 'HardwareManager::readThermocouples', ph: 'X', ts: tickUs, dur: 180 + Math.random() * 40, pid: 1, tid: 2 });
+    events.push({ name: 'Controller::RunTick', ph: 'X', ts: tickUs + 300, dur: 350 + Math.random() * 80, pid: 1, tid: 1 });
+    events.push({ name: 'TelemetryPublisher::Publish', ph: 'X', ts: tickUs + 700, dur: 25, pid: 1, tid: 1 });
+  }
+  return events;
+}
+
 function errEnvelope(code, message) {
   return { ok: false, error: { code, message } };
 }
@@ -148,6 +363,79 @@ const server = http.createServer(async (req, res) => {
     return;
   }
 
+  if (req.method === 'GET' && path === '/api/v1/controller/autotune') {
+    updateMockAutotune();
+    const data = {
+      state: autotuneState.state,
+      cycle: mockAutotuneCycle(),
+      cycles: autotuneState.cycles,
+      elapsed_s: autotuneState.state === 'idle' ? 0 : Math.round((Date.now() - autotuneState.startedMs) / 1000),
+      failure_reason: autotuneState.state === 'failed' ? 'cancelled' : '',
+      config: autotuneState.config
+    };
+    if (autotuneState.state === 'complete') {
+      data.result = {
+        ultimate_gain: 38.2,
+        ultimate_period_s: 96,
+        amplitude_c: 3.3,
+        heating: { kp: 17.4, ki: 0.082, kd: 265 },
+        cooling: { kp: 11.9, ki: 0.056, kd: 181 }
+      };
+    }
+    json(res, 200, envelope(data));
+    return;
+  }
+
+  if (req.method === 'POST' && path === '/api/v1/controller/autotune/start') {
+    const body = JSON.parse(await readBody(req));
+    if (!Number.isFinite(Number(body.setpoint_c))) {
+      json(res, 400, errEnvelope('BAD_AUTOTUNE_ARGS', 'setpoint_c must be numeric'));
+      return;
+    }
+    if (state.running || profileState.running) {
+      json(res, 409, errEnvelope('AUTOTUNE_START_FAILED', 'ESP_ERR_INVALID_STATE'));
+      return;
+    }
+    autotuneState.config = {
+      setpoint_c: Number(body.setpoint_c),
+      heat_output_pct: Number(body.heat_output_pct ?? 100),
+      cool_output_pct: Number(body.cool_output_pct ?? 100),
+      hysteresis_c: Number(body.hysteresis_c ?? 0.5),
+      max_duration_s: Number(body.max_duration_s ?? 1800)
+    };
+    autotuneState.cycles = Number(body.cycles ?? 4) + 1;
+    autotuneState.state = 'running';
+    autotuneState.startedMs = Date.now();
+    state.setpoint = autotuneState.config.setpoint_c;
+    state.running = true;
+    json(res, 200, envelope({}));
+    return;
+  }
+
+  if (req.method === 'POST' && path === '/api/v1/controller/autotune/cancel') {
+    if (autotuneState.state !== 'running') {
+      json(res, 409, errEnvelope('AUTOTUNE_NOT_RUNNING', 'ESP_ERR_INVALID_STATE'));
+      return;
+    }
+    autotuneState.state = 'failed';
+    state.running = false;
+    state.state = 'Idle';
+    json(res, 200, envelope({}));
+    return;
+  }
+
+  if (req.method === 'POST' && path === '/api/v1/controller/autotune/accept') {
+    if (autotuneState.state !== 'complete') {
+      json(res, 409, errEnvelope('AUTOTUNE_NOT_COMPLETE', 'No completed autotune result to accept'));
+      return;
+    }
+    state.pidKp = 17.4;
+    state.pidKi = 0.082;
+    state.pidKd = 265;
+    json(res, 200, envelope({}));
+    return;
+  }
+
   if (req.method === 'POST' && path === '/api/v1/control/start') {
     state.running = true;
     state.doorPreviewActive = false;
@@ -296,20 +584,75 @@ const server = http.createServer(async (req, res) => {
         setpoint_weight: state.pidSetpointWeight
       },
       input_filter_ms: state.inputFilterMs,
+      tick_ms: state.tickMs,
       inputs: state.inputs,
+      zones: state.zones.length > 1
+        ? state.zones
+        : [{ inputs: state.inputs.filter((ch) => ch <= 3), relays: state.pwmRelays }],
       relays: {
         pwm_relays: state.pwmRelays,
         pwm_relay_weights: state.pwmRelays.map((relay) => ({
           relay,
           weight: Number(state.pwmRelayWeights[relay] ?? 1)
         })),
-        running_relays: state.runningRelays
+        running_relays: state.runningRelays,
+        drive_mode: state.relayDriveMode,
+        mains_hz: state.mainsHz
       },
       door: {
         closed_angle_deg: state.doorClosedAngle,
         open_angle_deg: state.doorOpenAngle,
         max_speed_deg_per_s: state.doorMaxSpeedDegPerSec
-      }
+      },
+      feedforward: {
+        enabled: state.feedforward.enabled,
+        lookahead_s: state.feedforward.lookahead_s,
+        gain: state.feedforward.gain,
+        model: {
+          valid: state.feedforward.model.gain_c_per_pct > 0 && state.feedforward.model.time_constant_s > 0,
+          ...state.feedforward.model
+        }
+      },
+      pv_pipeline: state.pvPipeline
+    }));
+    return;
+  }
+
+  if (req.method === 'PUT' && path === '/api/v1/controller/config/feedforward') {
+    const body = JSON.parse(await readBody(req));
+    const ff = state.feedforward;
+    const lookahead = Number(body.lookahead_s ?? ff.lookahead_s);
+    const gain = Number(body.gain ?? ff.gain);
+    if (!Number.isFinite(lookahead) || lookahead < 0 || lookahead > 600 || !Number.isFinite(gain) || gain < 0 || gain > 2) {
+      json(res, 400, errEnvelope('FEEDFORWARD_UPDATE_FAILED', 'ESP_ERR_INVALID_ARG'));
+      return;
+    }
+    if (typeof body.enabled === 'boolean') {
+      ff.enabled = body.enabled;
+    }
+    ff.lookahead_s = lookahead;
+    ff.gain = gain;
+    if (body.model && typeof body.model === 'object') {
+      ff.model = { ...ff.model, ...body.model };
+    }
+    json(res, 200, envelope({}));
+    return;
+  }
+
+  if (req.method === 'POST' && path === '/api/v1/controller/feedforward/fit') {
+    const raw = await readBody(req);
+    const apply = raw ? JSON.parse(raw).apply === true : false;
+    const model = { gain_c_per_pct: 2.05, time_constant_s: 640, ambient_c: 23.8 };
+    if (apply) {
+      state.feedforward.model = model;
+      state.feedforward.lookahead_s = 22;
+    }
+    json(res, 200, envelope({
+      model: { valid: true, ...model },
+      dead_time_s: 22,
+      rmse_c_per_s: 0.0081,
+      samples: 1740,
+      applied: apply
     }));
     return;
   }
@@ -332,6 +675,41 @@ const server = http.createServer(async (req, res) => {
     return;
   }
 
+  if (req.method === 'PUT' && path === '/api/v1/controller/config/pv_pipeline') {
+    const body = JSON.parse(await readBody(req));
+    const pipeline = state.pvPipeline;
+    const weights = body.input_weights ?? pipeline.input_weights;
+    const valid = (body.filter === undefined || body.filter === 'low_pass' || body.filter === 'alpha_beta')
+      && Array.isArray(weights) && weights.length === 4
+      && weights.every((weight) => typeof weight === 'number' && weight >= 0 && weight <= 1);
+    if (!valid) {
+      json(res, 400, errEnvelope('BAD_PV_PIPELINE_ARGS', 'filter must be low_pass or alpha_beta, input_weights 4 numbers in 0..1'));
+      return;
+    }
+    state.pvPipeline = {
+      ...pipeline,
+      filter: body.filter ?? pipeline.filter,
+      outlier_rejection: body.outlier_rejection ?? pipeline.outlier_rejection,
+      derivative_from_rate: body.derivative_from_rate ?? pipeline.derivative_from_rate,
+      input_weights: weights
+    };
+    json(res, 200, envelope({}));
+    return;
+  }
+
+  if (req.method === 'PUT' && path === '/api/v1/controller/config/tick') {
+    const body = JSON.parse(await readBody(req));
+    const tickMs = Number(body.tick_ms);
+    if (!Number.isFinite(tickMs) || (tickMs !== 0 && (tickMs < 50 || tickMs > 1000))) {
+      json(res, 400, errEnvelope('TICK_UPDATE_FAILED', 'ESP_ERR_INVALID_ARG'));
+      return;
+    }
+    state.tickMs = tickMs;
+    state.tickResetAt = Date.now();
+    json(res, 200, envelope({}));
+    return;
+  }
+
   if (req.method === 'PUT' && path === '/api/v1/controller/config/inputs') {
     const body = JSON.parse(await readBody(req));
     state.inputs = Array.isArray(body.channels) ? body.channels.map((v) => Number(v)) : state.inputs;
@@ -339,6 +717,36 @@ const server = http.createServer(async (req, res) => {
     return;
   }
 
+  if (req.method === 'PUT' && path === '/api/v1/controller/config/zones') {
+    const body = JSON.parse(await readBody(req));
+    const zones = Array.isArray(body.zones) ? body.zones : [];
+    if (zones.length < 1 || zones.length > 4) {
+      json(res, 400, errEnvelope('BAD_ZONES_ARGS', 'zones must be an array of 1 to 4 {inputs, relays} entries'));
+      return;
+    }
+    if (state.running) {
+      json(res, 409, errEnvelope('CONTROLLER_RUNNING', 'stop the controller before changing zones'));
+      return;
+    }
+    const parsed = zones.map((zone) => ({
+      inputs: (Array.isArray(zone?.inputs) ? zone.inputs : []).map(Number).filter((ch) => ch >= 0 && ch <= 3),
+      relays: (Array.isArray(zone?.relays) ? zone.relays : []).map(Number).filter((relay) => relay >= 0 && relay <= 7)
+    }));
+    const claimed = new Set();
+    for (const zone of parsed.length > 1 ? parsed : []) {
+      const valid = zone.inputs.length > 0 && zone.relays.length > 0
+        && zone.relays.every((relay) => state.pwmRelays.includes(relay) && !claimed.has(relay));
+      if (!valid) {
+        json(res, 400, errEnvelope('ZONES_UPDATE_FAILED', 'every zone needs inputs and its own PWM relays'));
+        return;
+      }
+      zone.relays.forEach((relay) => claimed.add(relay));
+    }
+    state.zones = parsed.length > 1 ? parsed : [];
+    json(res, 200, envelope({}));
+    return;
+  }
+
   if (req.method === 'PUT' && path === '/api/v1/controller/config/relays') {
     const body = JSON.parse(await readBody(req));
     state.pwmRelays = Array.isArray(body.pwm_relays) ? body.pwm_relays.map((v) => Number(v)) : state.pwmRelays;
@@ -354,6 +762,12 @@ const server = http.createServer(async (req, res) => {
       state.pwmRelayWeights = nextWeights;
     }
     state.runningRelays = Array.isArray(body.running_relays) ? body.running_relays.map((v) => Number(v)) : state.runningRelays;
+    if (body.drive_mode === 'window' || body.drive_mode === 'burst') {
+      state.relayDriveMode = body.drive_mode;
+    }
+    if (body.mains_hz === 50 || body.mains_hz === 60) {
+      state.mainsHz = body.mains_hz;
+    }
     json(res, 200, envelope({}));
     return;
   }
@@ -379,7 +793,67 @@ const server = http.createServer(async (req, res) => {
   }
 
   if (req.method === 'GET' && path === '/api/v1/data/history') {
-    json(res, 200, envelope({ points: state.points.slice(-200) }));
+    const oldestSeq = state.points.length > 0 ? state.points[0].seq : state.nextSeq;
+    const since = parsed.query.since !== undefined ? Number(parsed.query.since) : null;
+    const resolution = parsed.query.resolution;
+    if (resolution === '10s' || resolution === '60s') {
+      const resolutionS = resolution === '10s' ? 10 : 60;
+      const rollups = makeRollups(state.points, resolutionS);
+      json(res, 200, envelope({
+        resolution_s: resolutionS,
+        oldest_seq: rollups.length > 0 ? rollups[0].seq : 0,
+        next_seq: rollups.length > 0 ? rollups[rollups.length - 1].seq + 1 : 0,
+        points: since === null ? rollups : rollups.filter((r) => r.seq > since)
+      }));
+      return;
+    }
+    const points = since === null
+      ? state.points.slice(-200)
+      : state.points.filter((p) => p.seq > since);
+    if (parsed.query.format === 'bin') {
+      res.writeHead(200, {
+        'Content-Type': 'application/octet-stream',
+        'Access-Control-Allow-Origin': '*'
+      });
+      res.end(encodeHistoryBinary(points, oldestSeq, state.nextSeq));
+      return;
+    }
+    json(res, 200, envelope({ oldest_seq: oldestSeq, next_seq: state.nextSeq, points }));
+    return;
+  }
+
+  // The mock keeps a single run made from the in-memory history.
+  if (req.method === 'GET' && path === '/api/v1/runs') {
+    const runs = state.points.length === 0 ? [] : [{
+      id: 1,
+      size_bytes: 32 + state.points.length * 26,
+      start_unix_s: Math.floor(Date.now() / 1000) - state.points.length,
+      first_timestamp: Math.floor(state.points[0].timestamp / 1000),
+      active: state.running
+    }];
+    json(res, 200, envelope({ runs, dropped_records: 0 }));
+    return;
+  }
+
+  if (path === '/api/v1/runs/1' && (req.method === 'GET' || req.method === 'DELETE')) {
+    if (state.points.length === 0) {
+      json(res, 404, errEnvelope('RUN_NOT_FOUND', 'Run not found'));
+      return;
+    }
+    if (req.method === 'DELETE') {
+      if (state.running) {
+        json(res, 409, errEnvelope('RUN_ACTIVE', 'Cannot delete the run currently being recorded'));
+        return;
+      }
+      state.points = [];
+      json(res, 200, envelope({}));
+      return;
+    }
+    res.writeHead(200, {
+      'Content-Type': 'application/octet-stream',
+      'Access-Control-Allow-Origin': '*'
+    });
+    res.end(encodeHistoryBinary(state.points, state.points[0].seq, state.nextSeq));
     return;
   }
 
@@ -409,6 +883,79 @@ const server = http.createServer(async (req, res) => {
     return;
   }
 
+  if (req.method === 'GET' && path === '/api/v1/diagnostics') {
+    const periodMs = state.tickMs === 0 ? 220 : state.tickMs;
+    const ticks = Math.floor((Date.now() - state.tickResetAt) / periodMs);
+    const limits = [500, 1000, 2000, 5000, 10000, 20000, 50000, null];
+    const heap = (total, free) => ({ total_bytes: total, free_bytes: free, min_free_bytes: Math.floor(free * 0.8), largest_free_block: Math.floor(free * 0.6) });
+    json(res, 200, envelope({
+      runtime_stats: true,
+      window_us: 1000000,
+      tasks: [
+        { name: 'IDLE0', priority: 0, core: 0, cpu_pct: 78 + Math.random() * 4, stack_free_min_bytes: 600 },
+        { name: 'IDLE1', priority: 0, core: 1, cpu_pct: 90 + Math.random() * 3, stack_free_min_bytes: 600 },
+        { name: 'ControllerTask', priority: 2, core: 1, cpu_pct: 0.4 + Math.random() * 0.2, stack_free_min_bytes: 1650 },
+        { name: 'ThermocoupleRea', priority: 3, core: 1, cpu_pct: 0.3, stack_free_min_bytes: 2200 },
+        { name: 'DataLogTask', priority: 1, core: 0, cpu_pct: 0.2, stack_free_min_bytes: 2900 },
+        { name: 'WsTelemetryTask', priority: 2, core: 1, cpu_pct: 2.5 + Math.random(), stack_free_min_bytes: 3100 },
+        { name: 'httpd', priority: 5, core: null, cpu_pct: 4 + Math.random() * 2, stack_free_min_bytes: 4200 },
+        { name: 'TimeSyncTask', priority: 1, core: 0, cpu_pct: 0, stack_free_min_bytes: 1800 },
+        { name: 'wifi', priority: 23, core: 0, cpu_pct: 6 + Math.random() * 3, stack_free_min_bytes: 2400 }
+      ],
+      tasks_omitted: 0,
+      heap: { internal: heap(330000, 142000), psram: heap(2097152, 560000) },
+      httpd: { busy_pct: 3 + Math.random() * 2, requests: 9, worst_us: 18500, open_sockets: 2, max_open_sockets: 7 },
+      websocket: { clients: wss.clients.size, dropped_frames: 0, slow_client_closes: 0 },
+      history: { points: 2400, max_points: 3600, storage_bytes: 3600 * 40 },
+      settings_nvs: { pending_keys: 0, commits: 4, keys_written: 11, keys_unchanged: 6, failed_writes: 0, failed_commits: 0, last_error: null },
+      boot: mockBootTimeline(),
+      trace: { available: true, frozen: false, events: mockTraceEvents().length, capacity: 8192 },
+      control_tick: {
+        mode: state.tickMs === 0 ? 'sample' : 'fixed',
+        tick_ms: state.tickMs,
+        period_ms: periodMs,
+        ticks,
+        overruns: 0,
+        missed_deadlines: 0,
+        last_exec_us: 410,
+        worst_exec_us: 1250,
+        mean_exec_us: 430,
+        worst_jitter_us: 8400,
+        jitter_histogram: limits.map((le_us, idx) => ({ le_us, count: idx === 0 ? Math.floor(ticks * 0.9) : idx === 3 ? ticks - Math.floor(ticks * 0.9) : 0 })),
+        since_us: state.tickResetAt * 1000
+      }
+    }));
+    return;
+  }
+
+  if (req.method === 'GET' && path === '/api/v1/diagnostics/trace') {
+    res.writeHead(200, {
+      'Content-Type': 'application/json',
+      'Content-Disposition': 'attachment; filename=trace.json',
+      'Access-Control-Allow-Origin': '*'
+    });
+    res.end(JSON.stringify({
+      displayTimeUnit: 'ms',
+      traceEvents: [
+        ...mockTraceEvents(),
+        { name: 'thread_name', ph: 'M', pid: 1, tid: 1, args: { name: 'ControllerTask' } },
+        { name: 'thread_name', ph: 'M', pid: 1, tid: 2, args: { name: 'ThermocoupleRea' } }
+      ]
+    }));
+    return;
+  }
+
+  if (req.method === 'POST' && path === '/api/v1/diagnostics/trace/clear') {
+    json(res, 200, envelope({}));
+    return;
+  }
+
+  if (req.method === 'POST' && path === '/api/v1/diagnostics/reset') {
+    state.tickResetAt = Date.now();
+    json(res, 200, envelope({}));
+    return;
+  }
+
   if (req.method === 'GET' && path === '/api/v1/system/info') {
     json(res, 200, envelope({
       project_name: 'reflow_oven_firmware',
@@ -423,7 +970,7 @@ const server = http.createServer(async (req, res) => {
   if (req.method === 'GET' && path === '/api/v1/profiles') {
     json(res, 200, envelope({
       supports_execution: true,
-      limits: { max_slots: 5, max_steps: 40 },
+      limits: { max_slots: MAX_PROFILE_SLOTS, max_steps: 40, max_name_bytes: 63, max_description_bytes: 255 },
       uploaded: uploadedProfile ? { present: true, name: uploadedProfile.name, step_count: uploadedProfile.steps?.length ?? 0 } : { present: false },
       slots: profileSlots.map((slot, idx) => ({
         slot_index: idx,
@@ -459,7 +1006,7 @@ const server = http.createServer(async (req, res) => {
 
   if (path.startsWith('/api/v1/profiles/slots/')) {
     const slot = Number(path.substring('/api/v1/profiles/slots/'.length));
-    if (!Number.isInteger(slot) || slot < 0 || slot >= 5) {
+    if (!Number.isInteger(slot) || slot < 0 || slot >= MAX_PROFILE_SLOTS) {
       json(res, 400, errEnvelope('PROFILE_SLOT_INVALID', 'Invalid slot index'));
       return;
     }
@@ -492,6 +1039,51 @@ const server = http.createServer(async (req, res) => {
     }
   }
 
+  if (req.method === 'GET' && path === '/api/v1/profiles/simulate') {
+    if (simulationState.state === 'running' && Date.now() - simulationState.startedMs >= MOCK_SIMULATION_MS) {
+      simulationState.state = 'complete';
+    }
+    const complete = simulationState.state === 'complete';
+    json(res, 200, envelope({
+      state: simulationState.state,
+      profile_name: simulationState.profileName,
+      simulated_s: complete ? simulationState.result.duration_s : 0,
+      wall_time_ms: simulationState.state === 'idle' ? 0 : Math.min(Date.now() - simulationState.startedMs, MOCK_SIMULATION_MS),
+      ...(complete ? { result: simulationState.result } : {})
+    }));
+    return;
+  }
+
+  if (req.method === 'POST' && path === '/api/v1/profiles/simulate/start') {
+    const body = JSON.parse(await readBody(req));
+    const selected = body.profile ?? (body.source === 'uploaded' ? uploadedProfile : profileSlots[Number(body.slot_index)]);
+    if (!selected) {
+      json(res, 404, errEnvelope('PROFILE_NOT_FOUND', 'Requested profile source was not found'));
+      return;
+    }
+    if (simulationState.state === 'running') {
+      json(res, 409, errEnvelope('SIMULATION_RUNNING', 'A simulation is already running'));
+      return;
+    }
+    simulationState.state = 'running';
+    simulationState.startedMs = Date.now();
+    simulationState.profileName = selected.name ?? '';
+    simulationState.result = simulateMockProfile(selected, Number(body.initial_pv_c ?? state.process ?? 25));
+    json(res, 200, envelope({}));
+    return;
+  }
+
+  if (req.method === 'POST' && path === '/api/v1/profiles/simulate/cancel') {
+    if (simulationState.state !== 'running') {
+      json(res, 409, errEnvelope('SIMULATION_NOT_RUNNING', 'ESP_ERR_INVALID_STATE'));
+      return;
+    }
+    simulationState.state = 'complete';
+    simulationState.result = { ...simulationState.result, outcome: 'cancelled' };
+    json(res, 200, envelope({}));
+    return;
+  }
+
   if (req.method === 'POST' && path === '/api/v1/profiles/run') {
     const body = JSON.parse(await readBody(req));
     if (profileState.running) {
@@ -546,14 +1138,95 @@ server.on('upgrade', (request, socket, head) => {
   });
 });
 
+// Mirrors the firmware: keyframes on connect and every 10 s, deltas in between.
+const WS_KEYFRAME_PERIOD_MS = 10000;
+let wsSentStatus = null;
+let wsLastKeyframeMs = 0;
+let wsTick = 0;
+
+function diffStatus(current, sent) {
+  if (Array.isArray(current) || typeof current !== 'object' || current === null) {
+    return JSON.stringify(current) === JSON.stringify(sent) ? undefined : current;
+  }
+  const out = {};
+  for (const [key, value] of Object.entries(current)) {
+    const changed = diffStatus(value, sent?.[key]);
+    if (changed !== undefined) {
+      out[key] = changed;
+    }
+  }
+  return Object.keys(out).length > 0 ? out : undefined;
+}
+
+// Zone PVs follow the mock thermocouples so each zone reads a little differently.
+function mockZoneStatus() {
+  if (state.zones.length <= 1) {
+    return [{ process_value_c: state.process, pid_output: state.pid }];
+  }
+  const offsets = [0.3, -0.4, 0.7, -0.1];
+  return state.zones.map((zone) => {
+    const pv = state.process + zone.inputs.reduce((sum, ch) => sum + offsets[ch], 0) / zone.inputs.length;
+    return { process_value_c: pv, pid_output: state.pid + (state.setpoint - pv) * state.pidKp * 0.1 };
+  });
+}
+
+// Per-socket subscription: { format: 'json' | 'bin', intervalMs, lastSentMs, needsKeyframe, missed }
+const wsSubscriptions = new WeakMap();
+
+function encodeTelemetryBinary(status, tick) {
+  const buffer = Buffer.alloc(120);
+  const c = status.controller;
+  const h = status.hardware;
+  const p = status.profile;
+  buffer.writeUInt8(2, 0);
+  buffer.writeUInt8((c.running ? 1 : 0) | (c.door_open ? 2 : 0) | (c.alarming ? 4 : 0) | (p.running ? 8 : 0), 1);
+  buffer.writeUInt8(h.relay_states.reduce((bits, on, i) => (on ? bits | (1 << i) : bits), 0), 2);
+  buffer.writeUInt32LE(tick >>> 0, 4);
+  [c.setpoint_c, c.process_value_c, c.pid_output, c.p_term, c.i_term, c.d_term, ...h.temperatures_c.slice(0, 4), h.servo_angle, p.step_elapsed_s, p.profile_elapsed_s]
+    .forEach((value, idx) => buffer.writeFloatLE(Number(value) || 0, 8 + idx * 4));
+  buffer.writeUInt16LE(Math.max(0, Math.min(0xffff, p.current_step_number | 0)), 60);
+  buffer.write(String(c.state).slice(0, 23), 64, 'utf8');
+  const zones = c.zones ?? [];
+  buffer.writeUInt8(zones.length, 3);
+  zones.slice(0, 4).forEach((zone, idx) => {
+    buffer.writeFloatLE(Number(zone.process_value_c) || 0, 88 + idx * 4);
+    buffer.writeFloatLE(Number(zone.pid_output) || 0, 104 + idx * 4);
+  });
+  return buffer;
+}
+
 wss.on('connection', (ws) => {
+  wsSubscriptions.set(ws, { format: 'json', intervalMs: 0, lastSentMs: 0, needsKeyframe: true, missed: false });
   ws.send(JSON.stringify({ type: 'hello', data: makeStatusData() }));
+  ws.on('message', (raw, isBinary) => {
+    if (isBinary) return;
+    try {
+      const msg = JSON.parse(String(raw));
+      if (msg.type !== 'subscribe') return;
+      const sub = wsSubscriptions.get(ws);
+      if (msg.format === 'bin' || msg.format === 'json') {
+        sub.format = msg.format;
+      }
+      if (typeof msg.rate_hz === 'number') {
+        const rate = Math.max(0, Math.min(20, msg.rate_hz));
+        sub.intervalMs = rate > 0 ? 1000 / rate : 0;
+      }
+      sub.needsKeyframe = true;
+    } catch {
+      // ignore malformed messages
+    }
+  });
 });
 
 setInterval(() => {
   const drift = (Math.random() - 0.5) * 1.2;
   const target = state.running ? state.setpoint : 28;
+  const previousProcess = state.process;
   state.process += (target - state.process) * 0.08 + drift;
+  state.processRate = (state.process - previousProcess) / 0.25;
+  if (state.pvPipeline.outlier_rejection && Math.random() < 0.01) {
+    state.pvPipeline.rejected_readings[Math.floor(Math.random() * 4)] += 1;
+  }
   state.pid = Math.max(-100, Math.min(100, (state.setpoint - state.process) * 1.5));
   state.p = state.pid * 0.7;
   state.i = state.pid * 0.2;
@@ -582,11 +1255,15 @@ setInterval(() => {
   }
 
   const sample = {
+    seq: state.nextSeq++,
     timestamp: Date.now(),
     setpoint: state.setpoint,
     process_value: state.process,
     pid_output: state.pid
   };
+  if (state.zones.length > 1) {
+    sample.zones = mockZoneStatus().map((zone) => ({ process_value: zone.process_value_c, pid_output: zone.pid_output }));
+  }
 
   state.points.push(sample);
   if (state.points.length > 5000) {
@@ -611,11 +1288,48 @@ setInterval(() => {
     }
   }
 
-  const payload = JSON.stringify({ type: 'telemetry', data: makeStatusData() });
+  const status = makeStatusData();
+  delete status.time; // unix_time_ms changes every tick; keyframes carry it
+  const now = Date.now();
+  const keyframeForAll = now - wsLastKeyframeMs >= WS_KEYFRAME_PERIOD_MS;
+  let deltaPayload = null;
+  if (keyframeForAll) {
+    wsLastKeyframeMs = now;
+  } else {
+    const delta = diffStatus(status, wsSentStatus);
+    if (delta !== undefined) {
+      deltaPayload = JSON.stringify({ type: 'delta', data: delta });
+    }
+  }
+  wsSentStatus = status;
+  wsTick += 1;
+
+  let keyframePayload = null;
+  let binaryPayload = null;
   for (const client of wss.clients) {
-    if (client.readyState === 1) {
-      client.send(payload);
+    const sub = wsSubscriptions.get(client);
+    if (client.readyState !== 1 || !sub) {
+      continue;
+    }
+    const due = now - sub.lastSentMs >= sub.intervalMs;
+    if (!keyframeForAll && !sub.needsKeyframe && (!due || (deltaPayload === null && !sub.missed))) {
+      sub.missed = sub.missed || deltaPayload !== null;
+      continue;
+    }
+    let payload;
+    if (keyframeForAll || sub.needsKeyframe || (sub.format === 'json' && sub.missed)) {
+      keyframePayload = keyframePayload ?? JSON.stringify({ type: 'telemetry', data: makeStatusData() });
+      payload = keyframePayload;
+      sub.needsKeyframe = false;
+    } else if (sub.format === 'bin') {
+      binaryPayload = binaryPayload ?? encodeTelemetryBinary(status, wsTick);
+      payload = binaryPayload;
+    } else {
+      payload = deltaPayload;
     }
+    sub.missed = false;
+    sub.lastSentMs = now;
+    client.send(payload);
   }
 }, 250);
 
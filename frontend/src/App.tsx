@@ -11,6 +11,7 @@ import { WifiSettingsPage } from './pages/settings/WifiSettingsPage';
 import { DataSettingsPage } from './pages/settings/DataSettingsPage';
 import { ControllerSettingsPage } from './pages/settings/ControllerSettingsPage';
 import { DoorCalibrationSettingsPage } from './pages/settings/DoorCalibrationSettingsPage';
+import { DiagnosticsSettingsPage } from './pages/settings/DiagnosticsSettingsPage';
 
 type Route =
   | 'dashboard'
@@ -21,7 +22,8 @@ type Route =
   | 'settings-wifi'
   | 'settings-data'
   | 'settings-controller'
-  | 'settings-door';
+  | 'settings-door'
+  | 'settings-diagnostics';
 
 const nav = [
   { id: 'dashboard' as const, label: 'Dashboard', icon: LayoutDashboard },
@@ -89,6 +91,8 @@ export default function App() {
         return <ControllerSettingsPage onBack={() => setRoute('settings')} />;
       case 'settings-door':
         return <DoorCalibrationSettingsPage onBack={() => setRoute('settings')} chamberRunning={!!status?.controller.running} />;
+      case 'settings-diagnostics':
+        return <DiagnosticsSettingsPage onBack={() => setRoute('settings')} />;
       default:
         return <DashboardPage status={status} onSetpoint={onSetpoint} onToggleDoor={onToggleDoor} />;
     }
@@ -1,10 +1,23 @@
 import {
   ApiEnvelope,
+  AutotuneStatus,
   ControllerConfig,
+  ControlZoneConfig,
+  Diagnostics,
+  FeedforwardConfig,
   HistoryPoint,
+  HistoryResolution,
+  HistoryResponse,
+  HistoryRollupResponse,
+  ProcessValuePipelineConfig,
   ProfileDefinition,
   ProfileSlotSummary,
-  StatusData
+  RelayDriveMode,
+  RunLogListResponse,
+  SimulationStatus,
+  StatusData,
+  ThermalModel,
+  ThermalModelFitResult
 } from './types';
 
 const API_BASE = (import.meta.env.VITE_API_BASE as string | undefined) ?? '';
@@ -43,6 +56,95 @@ async function request<T>(path: string, init?: RequestInit): Promise<T> {
   return json.data;
 }
 
+async function requestBinary(path: string): Promise<ArrayBuffer> {
+  const response = await fetch(`${API_BASE}${path}`);
+  if (!response.ok) {
+    let message = `HTTP ${response.status}`;
+    try {
+      const json = (await response.json()) as ApiEnvelope<unknown>;
+      message = json.error?.message ?? message;
+    } catch {
+      // Keep the status-only message.
+    }
+    throw new Error(message);
+  }
+  return response.arrayBuffer();
+}
+
+// Mirrors the ?format=bin layout written by WebServerManager::SendHistoryBinary.
+const HISTORY_BIN_MAGIC = 'RFH1';
+const HISTORY_BIN_VERSION = 3; // Version 2 (no zone fields) is still read
+const HISTORY_BIN_HEADER_SIZE = 32;
+const HISTORY_BIN_BASE_RECORD_SIZE = 26;
+const HISTORY_BIN_ZONE_FIELDS_SIZE = 4;
+
+export function decodeHistoryBinary(buffer: ArrayBuffer): HistoryResponse {
+  const view = new DataView(buffer);
+  if (buffer.byteLength < HISTORY_BIN_HEADER_SIZE) {
+    throw new Error('History payload too short');
+  }
+
+  const magic = String.fromCharCode(view.getUint8(0), view.getUint8(1), view.getUint8(2), view.getUint8(3));
+  const version = view.getUint8(4);
+  if (magic !== HISTORY_BIN_MAGIC || (version !== 2 && version !== HISTORY_BIN_VERSION)) {
+    throw new Error('Unsupported history format');
+  }
+
+  const recordSize = view.getUint8(5);
+  // Zone fields are only written for more than one zone.
+  const zoneCount = version >= 3 ? view.getUint8(6) : 0;
+  const zoneFields = zoneCount > 1 ? zoneCount : 0;
+  if (recordSize < HISTORY_BIN_BASE_RECORD_SIZE + zoneFields * HISTORY_BIN_ZONE_FIELDS_SIZE) {
+    throw new Error('Unsupported history record size');
+  }
+
+  let timestamp = Number(view.getBigUint64(8, true));
+  let seq = view.getUint32(16, true);
+  const oldestSeq = view.getUint32(20, true);
+  const nextSeq = view.getUint32(24, true);
+  const count = Math.floor((buffer.byteLength - HISTORY_BIN_HEADER_SIZE) / recordSize);
+  const points: HistoryPoint[] = new Array(count);
+
+  for (let idx = 0; idx < count; idx += 1) {
+    const offset = HISTORY_BIN_HEADER_SIZE + idx * recordSize;
+    timestamp += view.getUint16(offset, true);
+    seq += view.getUint16(offset + 24, true);
+    const flags = view.getUint8(offset + 22);
+    points[idx] = {
+      seq,
+      timestamp,
+      setpoint: view.getInt16(offset + 2, true) / 4,
+      process_value: view.getInt16(offset + 4, true) / 4,
+      pid_output: view.getInt16(offset + 6, true) / 100,
+      p: view.getInt16(offset + 8, true) / 100,
+      i: view.getInt16(offset + 10, true) / 100,
+      d: view.getInt16(offset + 12, true) / 100,
+      temperatures: [
+        view.getInt16(offset + 14, true) / 4,
+        view.getInt16(offset + 16, true) / 4,
+        view.getInt16(offset + 18, true) / 4,
+        view.getInt16(offset + 20, true) / 4
+      ],
+      relay_states: flags & 0x3f,
+      servo_angle: view.getUint8(offset + 23),
+      running: (flags & 0x80) !== 0
+    };
+    if (zoneFields > 0) {
+      const zones: Array<{ process_value: number; pid_output: number }> = new Array(zoneFields);
+      for (let zone = 0; zone < zoneFields; zone += 1) {
+        const field = offset + HISTORY_BIN_BASE_RECORD_SIZE + zone * HISTORY_BIN_ZONE_FIELDS_SIZE;
+        zones[zone] = {
+          process_value: view.getInt16(field, true) / 4,
+          pid_output: view.getInt16(field + 2, true) / 100
+        };
+      }
+      points[idx].zones = zones;
+    }
+  }
+
+  return { points, oldest_seq: oldestSeq, next_seq: nextSeq };
+}
+
 export const api = {
   getStatus: () => request<StatusData>('/api/v1/status'),
   startOven: () => request<{}>('/api/v1/control/start', { method: 'POST' }),
@@ -58,11 +160,28 @@ export const api = {
     method: 'POST',
     body: JSON.stringify({ setpoint_c })
   }),
-  getHistory: (limit?: number) => request<{ points: HistoryPoint[] }>(
-    typeof limit === 'number' ? `/api/v1/data/history?limit=${limit}` : '/api/v1/data/history'
-  ),
+  getHistory: async (options: { limit?: number; since?: number } = {}): Promise<HistoryResponse> => {
+    const params = new URLSearchParams({ format: 'bin' });
+    if (typeof options.limit === 'number') {
+      params.set('limit', String(options.limit));
+    }
+    if (typeof options.since === 'number') {
+      params.set('since', String(options.since));
+    }
+    return decodeHistoryBinary(await requestBinary(`/api/v1/data/history?${params.toString()}`));
+  },
+  getHistoryRollups: (resolution: Exclude<HistoryResolution, 'raw'>, since?: number) => {
+    const params = new URLSearchParams({ resolution });
+    if (typeof since === 'number') {
+      params.set('since', String(since));
+    }
+    return request<HistoryRollupResponse>(`/api/v1/data/history?${params.toString()}`);
+  },
   clearHistory: () => request<{}>('/api/v1/data/history', { method: 'DELETE' }),
   exportCsv: () => request<string>('/api/v1/data/export.csv'),
+  listRuns: () => request<RunLogListResponse>('/api/v1/runs'),
+  getRun: async (id: number): Promise<HistoryResponse> => decodeHistoryBinary(await requestBinary(`/api/v1/runs/${id}`)),
+  deleteRun: (id: number) => request<{}>(`/api/v1/runs/${id}`, { method: 'DELETE' }),
   getTimeSettings: () => request<{ timezone: string; synced: boolean; unix_time_ms: number }>('/api/v1/settings/time'),
   setTimeSettings: (timezone: string) => request<{}>('/api/v1/settings/time', {
     method: 'PUT',
@@ -75,7 +194,7 @@ export const api = {
     body: JSON.stringify({ ssid, password })
   }),
   disconnectWifi: () => request<{}>('/api/v1/settings/wifi/disconnect', { method: 'POST' }),
-  getDataSettings: () => request<{ logging_enabled: boolean; log_interval_ms: number; max_time_ms: number; points: number; bytes_used: number; max_points: number }>('/api/v1/settings/data'),
+  getDataSettings: () => request<{ logging_enabled: boolean; log_interval_ms: number; max_time_ms: number; points: number; bytes_used: number; max_points: number; rollup_tiers?: Array<{ resolution_s: number; points: number; max_points: number }> }>('/api/v1/settings/data'),
   setDataSettings: (payload: { logging_enabled: boolean; log_interval_ms: number; max_time_ms: number }) => request<{}>('/api/v1/settings/data', {
     method: 'PUT',
     body: JSON.stringify(payload)
@@ -103,29 +222,68 @@ export const api = {
     method: 'PUT',
     body: JSON.stringify(payload)
   }),
+  updateFeedforwardConfig: (payload: Partial<Omit<FeedforwardConfig, 'model'>> & { model?: Partial<ThermalModel> }) => request<{}>('/api/v1/controller/config/feedforward', {
+    method: 'PUT',
+    body: JSON.stringify(payload)
+  }),
+  fitThermalModel: (apply: boolean) => request<ThermalModelFitResult>('/api/v1/controller/feedforward/fit', {
+    method: 'POST',
+    body: JSON.stringify({ apply })
+  }),
+  updateTickConfig: (tick_ms: number) => request<{}>('/api/v1/controller/config/tick', {
+    method: 'PUT',
+    body: JSON.stringify({ tick_ms })
+  }),
+  getDiagnostics: () => request<Diagnostics>('/api/v1/diagnostics'),
+  resetDiagnostics: () => request<{}>('/api/v1/diagnostics/reset', { method: 'POST' }),
+  exportTrace: () => requestBinary('/api/v1/diagnostics/trace'), // Chrome trace JSON
+  clearTrace: () => request<{}>('/api/v1/diagnostics/trace/clear', { method: 'POST' }),
   updateInputFilter: (input_filter_ms: number) => request<{}>('/api/v1/controller/config/filter', {
     method: 'PUT',
     body: JSON.stringify({ input_filter_ms })
   }),
+  updateProcessValuePipeline: (payload: Partial<Omit<ProcessValuePipelineConfig, 'rejected_readings'>>) => request<{}>('/api/v1/controller/config/pv_pipeline', {
+    method: 'PUT',
+    body: JSON.stringify(payload)
+  }),
   updateInputs: (channels: number[]) => request<{}>('/api/v1/controller/config/inputs', {
     method: 'PUT',
     body: JSON.stringify({ channels })
   }),
+  updateZones: (zones: ControlZoneConfig[]) => request<{}>('/api/v1/controller/config/zones', {
+    method: 'PUT',
+    body: JSON.stringify({ zones })
+  }),
   updateRelays: (
     pwm_relays: number[],
     running_relays: number[],
-    pwm_relay_weights: Array<{ relay: number; weight: number }>
+    pwm_relay_weights: Array<{ relay: number; weight: number }>,
+    drive?: { drive_mode: RelayDriveMode; mains_hz: number }
   ) => request<{}>('/api/v1/controller/config/relays', {
     method: 'PUT',
-    body: JSON.stringify({ pwm_relays, running_relays, pwm_relay_weights })
+    body: JSON.stringify({ pwm_relays, running_relays, pwm_relay_weights, ...drive })
   }),
+  getAutotune: () => request<AutotuneStatus>('/api/v1/controller/autotune'),
+  startAutotune: (payload: {
+    setpoint_c: number;
+    heat_output_pct?: number;
+    cool_output_pct?: number;
+    hysteresis_c?: number;
+    cycles?: number;
+    max_duration_s?: number;
+  }) => request<{}>('/api/v1/controller/autotune/start', {
+    method: 'POST',
+    body: JSON.stringify(payload)
+  }),
+  cancelAutotune: () => request<{}>('/api/v1/controller/autotune/cancel', { method: 'POST' }),
+  acceptAutotune: () => request<{}>('/api/v1/controller/autotune/accept', { method: 'POST' }),
   updateDoorCalibration: (payload: { closed_angle_deg: number; open_angle_deg: number; max_speed_deg_per_s: number }) => request<{}>('/api/v1/controller/config/door', {
     method: 'PUT',
     body: JSON.stringify(payload)
   }),
   getProfilesIndex: () => request<{
     supports_execution: boolean;
-    limits: { max_slots: number; max_steps: number };
+    limits: { max_slots: number; max_steps: number; max_name_bytes?: number; max_description_bytes?: number };
     uploaded: { present: boolean; name?: string; step_count?: number };
     slots: ProfileSlotSummary[];
   }>('/api/v1/profiles'),
@@ -145,9 +303,21 @@ export const api = {
     method: 'POST',
     body: JSON.stringify(payload)
   }),
+  getSimulation: () => request<SimulationStatus>('/api/v1/profiles/simulate'),
+  startSimulation: (payload: ({ profile: ProfileDefinition } | { source: 'uploaded' } | { source: 'slot'; slot_index: number }) & {
+    initial_pv_c?: number;
+    dead_time_s?: number;
+    step_s?: number;
+    max_duration_s?: number;
+    model?: Partial<ThermalModel>;
+  }) => request<{}>('/api/v1/profiles/simulate/start', {
+    method: 'POST',
+    body: JSON.stringify(payload)
+  }),
+  cancelSimulation: () => request<{}>('/api/v1/profiles/simulate/cancel', { method: 'POST' }),
   getProfiles: () => request<{
     supports_execution: boolean;
-    limits: { max_slots: number; max_steps: number };
+    limits: { max_slots: number; max_steps: number; max_name_bytes?: number; max_description_bytes?: number };
     uploaded: { present: boolean; name?: string; step_count?: number };
     slots: ProfileSlotSummary[];
   }>('/api/v1/profiles')
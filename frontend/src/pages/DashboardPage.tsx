@@ -16,6 +16,7 @@ export function DashboardPage({ status, onSetpoint, onToggleDoor }: Props) {
   const controller = status?.controller;
   const hardware = status?.hardware;
   const profileRunning = !!status?.profile?.running;
+  const zones = controller?.zones ?? [];
 
   const pidDirection = useMemo(() => {
     if (!controller) return 'idle';
@@ -54,7 +55,10 @@ export function DashboardPage({ status, onSetpoint, onToggleDoor }: Props) {
         <section className="card" style={{ background: 'linear-gradient(135deg,#ef4444,#b91c1c)', color: 'white' }}>
           <h3 className="section-title" style={{ color: 'white' }}>Current Temperature</h3>
           <div className="kpi">{controller ? controller.process_value_c.toFixed(1) : '--'}{degC}</div>
-          <p style={{ opacity: 0.9 }}>Average chamber process value</p>
+          <p style={{ opacity: 0.9 }}>
+            Average chamber process value
+            {controller?.process_rate_c_per_s !== undefined && `, ${controller.process_rate_c_per_s >= 0 ? '+' : ''}${controller.process_rate_c_per_s.toFixed(2)}${degC}/s`}
+          </p>
         </section>
 
         <section className="card">
@@ -76,6 +80,21 @@ export function DashboardPage({ status, onSetpoint, onToggleDoor }: Props) {
         </section>
       </div>
 
+      {zones.length > 1 && (
+        <section className="card">
+          <h3 className="section-title">Zones</h3>
+          <div className="grid two">
+            {zones.map((zone, index) => (
+              <div key={index} className="row" style={{ justifyContent: 'space-between' }}>
+                <strong>Zone {index}</strong>
+                <span>{zone.process_value_c.toFixed(1)}{degC}</span>
+                <span className="muted">{zone.pid_output.toFixed(1)}%</span>
+              </div>
+            ))}
+          </div>
+        </section>
+      )}
+
       <section className="card">
         <h3 className="section-title">PID Output</h3>
         <div className="row" style={{ marginBottom: '0.5rem' }}>
@@ -1,7 +1,7 @@
 import { useCallback, useEffect, useMemo, useRef, useState } from 'react';
 import { Line, LineChart, ResponsiveContainer, Tooltip, XAxis, YAxis, CartesianGrid, Legend } from 'recharts';
 import { api } from '../api';
-import { HistoryPoint, StatusData } from '../types';
+import { HistoryPoint, HistoryResolution, HistoryRollupPoint, StatusData } from '../types';
 
 interface Props {
   status: StatusData | null;
@@ -83,12 +83,20 @@ function loadInitialVisibility(): Record<string, boolean> {
   return next;
 }
 
-function downsample(points: HistoryPoint[], maxPoints: number): HistoryPoint[] {
+// Appends an incremental fetch to what we already hold, dropping anything the
+// device no longer retains so the local window matches the device ring.
+function mergeIncremental<T extends { seq: number }>(current: T[], points: T[], oldestSeq: number): T[] {
+  const firstKept = current.findIndex((p) => p.seq >= oldestSeq);
+  const kept = firstKept < 0 ? [] : (firstKept === 0 ? current : current.slice(firstKept));
+  return points.length > 0 ? kept.concat(points) : kept;
+}
+
+function downsample<T>(points: T[], maxPoints: number): T[] {
   if (points.length <= maxPoints || maxPoints <= 2) {
     return points;
   }
 
-  const sampled: HistoryPoint[] = [];
+  const sampled: T[] = [];
   sampled.push(points[0]);
 
   const interiorCount = maxPoints - 2;
@@ -104,10 +112,14 @@ function downsample(points: HistoryPoint[], maxPoints: number): HistoryPoint[] {
 
 export function DataPage({ status }: Props) {
   const [history, setHistory] = useState<HistoryPoint[]>([]);
+  const [rollups, setRollups] = useState<HistoryRollupPoint[]>([]);
+  const [resolution, setResolution] = useState<HistoryResolution>('raw');
   const [loading, setLoading] = useState(false);
   const [error, setError] = useState<string | null>(null);
   const inFlightRef = useRef(false);
   const pendingReloadRef = useRef(false);
+  const nextSeqRef = useRef<number | null>(null);
+  const resolutionRef = useRef<HistoryResolution>('raw');
 
   const [visible, setVisible] = useState<Record<string, boolean>>(() => loadInitialVisibility());
 
@@ -122,10 +134,38 @@ export function DataPage({ status }: Props) {
     setError(null);
 
     try {
-      const data = await api.getHistory();
-      setHistory(Array.isArray(data.points) ? data.points : []);
+      // After the first load only fetch points newer than the last one we hold.
+      const nextSeq = nextSeqRef.current;
+      const incremental = nextSeq !== null && nextSeq > 0;
+      const since = incremental ? nextSeq - 1 : undefined;
+      const activeResolution = resolutionRef.current;
+
+      const data = activeResolution === 'raw'
+        ? await api.getHistory(since === undefined ? {} : { since })
+        : await api.getHistoryRollups(activeResolution, since);
+
+      if (activeResolution !== resolutionRef.current) {
+        // Resolution changed while the request was in flight; fetch again for the new one.
+        pendingReloadRef.current = true;
+      } else if (incremental && data.next_seq < nextSeq) {
+        // Sequence went backwards: the device rebooted, so start over.
+        nextSeqRef.current = null;
+        pendingReloadRef.current = true;
+      } else {
+        const points = Array.isArray(data.points) ? data.points : [];
+        if (activeResolution === 'raw') {
+          const raw = points as HistoryPoint[];
+          setHistory((current) => (incremental ? mergeIncremental(current, raw, data.oldest_seq) : raw));
+        } else {
+          const buckets = points as HistoryRollupPoint[];
+          setRollups((current) => (incremental ? mergeIncremental(current, buckets, data.oldest_seq) : buckets));
+        }
+        nextSeqRef.current = data.next_seq;
+      }
     } catch {
+      nextSeqRef.current = null;
       setHistory([]);
+      setRollups([]);
       setError('Failed to load data history.');
     } finally {
       setLoading(false);
@@ -155,9 +195,19 @@ export function DataPage({ status }: Props) {
     }
   }, [visible]);
 
+  const changeResolution = (next: HistoryResolution) => {
+    resolutionRef.current = next;
+    nextSeqRef.current = null;
+    setResolution(next);
+    setHistory([]);
+    setRollups([]);
+    void loadHistory();
+  };
+
   const sampledHistory = useMemo(() => downsample(history, MAX_RENDER_POINTS), [history]);
+  const sampledRollups = useMemo(() => downsample(rollups, MAX_RENDER_POINTS), [rollups]);
 
-  const chartData = useMemo(() => sampledHistory.map((p) => ({
+  const rawChartData = useMemo(() => sampledHistory.map((p) => ({
     t: p.timestamp,
     processValue: p.process_value,
     setpoint: p.setpoint,
@@ -179,6 +229,16 @@ export function DataPage({ status }: Props) {
     running: p.running ? 1 : 0
   })), [sampledHistory]);
 
+  // Rollup buckets only carry PV, setpoint and output; other series stay empty.
+  const rollupChartData = useMemo(() => sampledRollups.map((p) => ({
+    t: p.timestamp,
+    processValue: p.process_value.mean,
+    setpoint: p.setpoint.mean,
+    pidOutput: p.pid_output.mean
+  })), [sampledRollups]);
+
+  const chartData = resolution === 'raw' ? rawChartData : rollupChartData;
+
   const visibleAnalogSeries = useMemo(
     () => ANALOG_SERIES.filter((series) => visible[series.key]),
     [visible]
@@ -208,6 +268,7 @@ export function DataPage({ status }: Props) {
   const clearData = async () => {
     await api.clearHistory();
     setHistory([]);
+    setRollups([]);
   };
 
   return (
@@ -215,6 +276,14 @@ export function DataPage({ status }: Props) {
       <div className="toolbar">
         <h2 className="section-title" style={{ margin: 0 }}>Historical Data</h2>
         <div className="row" style={{ flexWrap: 'wrap' }}>
+          <label>
+            Resolution{' '}
+            <select className="select" value={resolution} onChange={(e) => changeResolution(e.target.value as HistoryResolution)}>
+              <option value="raw">Full rate</option>
+              <option value="10s">10 s average</option>
+              <option value="60s">60 s average</option>
+            </select>
+          </label>
           <button onClick={exportCsv}>Export CSV</button>
           <button onClick={clearData} className="secondary">Clear</button>
         </div>
@@ -304,8 +373,8 @@ export function DataPage({ status }: Props) {
       </section>
 
       <div className="grid three">
-        <section className="card"><div className="muted">Points Loaded</div><div className="kpi">{history.length}</div></section>
-        <section className="card"><div className="muted">Points Graphed</div><div className="kpi">{sampledHistory.length}</div></section>
+        <section className="card"><div className="muted">Points Loaded</div><div className="kpi">{resolution === 'raw' ? history.length : rollups.length}</div></section>
+        <section className="card"><div className="muted">Points Graphed</div><div className="kpi">{chartData.length}</div></section>
         <section className="card"><div className="muted">Max Points</div><div className="kpi">{status?.data.max_points ?? 0}</div></section>
       </div>
     </div>
@@ -11,7 +11,7 @@ import {
   YAxis
 } from 'recharts';
 import { api } from '../api';
-import { ProfileDefinition, ProfileSlotSummary, ProfileStep, StatusData } from '../types';
+import { ProfileDefinition, ProfileSlotSummary, ProfileStep, SimulationStatus, StatusData } from '../types';
 
 interface Props {
   status: StatusData | null;
@@ -59,6 +59,16 @@ function newStep(type: ProfileStep['type']): ProfileStep {
   }
 }
 
+const SIMULATION_POLL_MS = 500;
+
+const SIMULATION_OUTCOME_LABELS: Record<NonNullable<SimulationStatus['result']>['outcome'], string> = {
+  completed: 'Completed',
+  transition_guard_abort: 'Aborted by transition guard',
+  invalid_profile: 'Invalid profile',
+  timed_out: 'Timed out (a PV wait never finished)',
+  cancelled: 'Cancelled'
+};
+
 function formatSeconds(value: number) {
   if (!Number.isFinite(value) || value < 0) return '0.0s';
   if (value < 60) return `${value.toFixed(1)}s`;
@@ -71,6 +81,8 @@ function validateProfile(profile: ProfileDefinition) {
   const issues: string[] = [];
 
   if (!profile.name.trim()) issues.push('Profile name is required.');
+  if (new TextEncoder().encode(profile.name).length > 63) issues.push('Profile name must be at most 63 bytes.');
+  if (new TextEncoder().encode(profile.description ?? '').length > 255) issues.push('Description must be at most 255 bytes.');
   if (!Array.isArray(profile.steps) || profile.steps.length === 0) issues.push('At least one step is required.');
   if (profile.steps.length > 40) issues.push('Profiles support up to 40 steps.');
 
@@ -265,7 +277,7 @@ function interpolateTargetAtTime(points: PreviewPoint[], timeS: number) {
 export function ProfilesPage({ status }: Props) {
   const [profile, setProfile] = useState<ProfileDefinition>(DEFAULT_PROFILE);
   const [slots, setSlots] = useState<ProfileSlotSummary[]>([]);
-  const [limits, setLimits] = useState({ max_slots: 5, max_steps: 40 });
+  const [limits, setLimits] = useState({ max_slots: 16, max_steps: 40 });
   const [uploadedSummary, setUploadedSummary] = useState<{ present: boolean; name?: string; step_count?: number }>({ present: false });
   const [loading, setLoading] = useState(false);
   const [busy, setBusy] = useState(false);
@@ -274,6 +286,7 @@ export function ProfilesPage({ status }: Props) {
   const [runSource, setRunSource] = useState<'uploaded' | 'slot'>('uploaded');
   const [runSlotIndex, setRunSlotIndex] = useState(0);
   const [saveMode, setSaveMode] = useState<'editor' | 'uploaded'>('editor');
+  const [simulation, setSimulation] = useState<SimulationStatus | null>(null);
 
   const importInputRef = useRef<HTMLInputElement | null>(null);
   const [pvOverlay, setPvOverlay] = useState<PvOverlayPoint[]>([]);
@@ -293,7 +306,7 @@ export function ProfilesPage({ status }: Props) {
       const data = await api.getProfilesIndex();
       setSlots(Array.isArray(data.slots) ? data.slots : []);
       setUploadedSummary(data.uploaded ?? { present: false });
-      setLimits(data.limits ?? { max_slots: 5, max_steps: 40 });
+      setLimits(data.limits ?? { max_slots: 16, max_steps: 40 });
       if (data.slots?.length && runSlotIndex >= data.slots.length) {
         setRunSlotIndex(0);
       }
@@ -381,6 +394,7 @@ export function ProfilesPage({ status }: Props) {
 
     const buckets = new Set<number>();
     const pvByBucket = new Map<number, number>();
+    const simByBucket = new Map<number, number>();
 
     for (const point of preview.points) {
       buckets.add(toBucket(point.t));
@@ -392,16 +406,23 @@ export function ProfilesPage({ status }: Props) {
       pvByBucket.set(bucket, point.pv);
     }
 
+    for (const point of simulation?.result?.points ?? []) {
+      const bucket = toBucket(point.time_s);
+      buckets.add(bucket);
+      simByBucket.set(bucket, point.process_value);
+    }
+
     const sortedBuckets = Array.from(buckets).sort((a, b) => a - b);
     return sortedBuckets.map((bucket) => {
       const t = fromBucket(bucket);
       return {
         t,
         target: interpolateTargetAtTime(preview.points, t),
-        pv: pvByBucket.get(bucket)
+        pv: pvByBucket.get(bucket),
+        simPv: simByBucket.get(bucket)
       };
     });
-  }, [preview.points, pvOverlay]);
+  }, [preview.points, pvOverlay, simulation?.result?.points]);
 
   const updateStep = (index: number, updater: (prev: ProfileStep) => ProfileStep) => {
     setProfile((prev) => ({
@@ -585,6 +606,34 @@ export function ProfilesPage({ status }: Props) {
     }
   };
 
+  // The board runs the simulation in the background; poll until it finishes.
+  const simulateProfile = async () => {
+    setBusy(true);
+    try {
+      await api.startSimulation({ profile });
+      let next = await api.getSimulation();
+      setSimulation(next);
+      while (next.state === 'running') {
+        await new Promise((resolve) => setTimeout(resolve, SIMULATION_POLL_MS));
+        next = await api.getSimulation();
+        setSimulation(next);
+      }
+      setError(null);
+    } catch (e) {
+      setError((e as Error).message);
+    } finally {
+      setBusy(false);
+    }
+  };
+
+  const cancelSimulation = async () => {
+    try {
+      await api.cancelSimulation();
+    } catch (e) {
+      setError((e as Error).message);
+    }
+  };
+
   return (
     <div className="grid" style={{ gap: '1rem' }}>
       <div className="toolbar">
@@ -893,7 +942,22 @@ export function ProfilesPage({ status }: Props) {
       </div>
 
       <section className="card">
-        <h3 className="section-title">Preview + Live PV Overlay</h3>
+        <div className="toolbar">
+          <h3 className="section-title" style={{ margin: 0 }}>Preview + Live PV Overlay</h3>
+          <div className="row">
+            <button onClick={() => void simulateProfile()} disabled={busy || issues.length > 0}>Simulate on Board</button>
+            {simulation?.state === 'running' && <button onClick={() => void cancelSimulation()}>Cancel Simulation</button>}
+          </div>
+        </div>
+        {simulation?.state === 'running' && (
+          <div className="muted">Simulating... {formatSeconds(simulation.simulated_s)} of profile time</div>
+        )}
+        {simulation?.result && (
+          <div className="muted">
+            {SIMULATION_OUTCOME_LABELS[simulation.result.outcome]}: predicted runtime {formatSeconds(simulation.result.duration_s)},
+            max overshoot {simulation.result.max_overshoot_c.toFixed(1)} C (thermal model, {simulation.wall_time_ms} ms on the board)
+          </div>
+        )}
         <div style={{ height: 360 }}>
           <ResponsiveContainer width="100%" height="100%">
             <LineChart data={chartData}>
@@ -927,6 +991,16 @@ export function ProfilesPage({ status }: Props) {
                 isAnimationActive={false}
                 connectNulls
               />
+              <Line
+                type="monotone"
+                dataKey="simPv"
+                stroke="#16a34a"
+                strokeWidth={2}
+                dot={false}
+                name="Simulated PV"
+                isAnimationActive={false}
+                connectNulls
+              />
             </LineChart>
           </ResponsiveContainer>
         </div>
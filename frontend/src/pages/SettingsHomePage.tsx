@@ -1,7 +1,7 @@
-import { Clock3, Wifi, Database, SlidersHorizontal, DoorOpen } from 'lucide-react';
+import { Clock3, Wifi, Database, SlidersHorizontal, DoorOpen, Activity } from 'lucide-react';
 
 interface Props {
-  onOpen: (page: 'settings-time' | 'settings-wifi' | 'settings-data' | 'settings-controller' | 'settings-door') => void;
+  onOpen: (page: 'settings-time' | 'settings-wifi' | 'settings-data' | 'settings-controller' | 'settings-door' | 'settings-diagnostics') => void;
 }
 
 export function SettingsHomePage({ onOpen }: Props) {
@@ -10,7 +10,8 @@ export function SettingsHomePage({ onOpen }: Props) {
     { id: 'settings-wifi' as const, label: 'WiFi', icon: Wifi },
     { id: 'settings-data' as const, label: 'Data', icon: Database },
     { id: 'settings-controller' as const, label: 'Controller', icon: SlidersHorizontal },
-    { id: 'settings-door' as const, label: 'Door', icon: DoorOpen }
+    { id: 'settings-door' as const, label: 'Door', icon: DoorOpen },
+    { id: 'settings-diagnostics' as const, label: 'Diagnostics', icon: Activity }
   ];
 
   return (
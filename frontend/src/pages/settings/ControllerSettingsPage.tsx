@@ -1,6 +1,15 @@
 import { useEffect, useState } from 'react';
 import { api } from '../../api';
-import { ControllerConfig } from '../../types';
+import {
+  AutotuneStatus,
+  ControllerConfig,
+  ControlTickDiagnostics,
+  FeedforwardConfig,
+  ProcessValueFilterName,
+  ProcessValuePipelineConfig,
+  RelayDriveMode,
+  ThermalModelFitResult
+} from '../../types';
 
 interface Props {
   onBack: () => void;
@@ -30,6 +39,22 @@ export function ControllerSettingsPage({ onBack }: Props) {
   const [pwmRelaysCsv, setPwmRelaysCsv] = useState('0,1');
   const [runningRelaysCsv, setRunningRelaysCsv] = useState('2');
   const [relayWeights, setRelayWeights] = useState<Record<number, number>>({});
+  const [driveMode, setDriveMode] = useState<RelayDriveMode>('window');
+  const [mainsHz, setMainsHz] = useState(50);
+  const [autotune, setAutotune] = useState<AutotuneStatus | null>(null);
+  const [autotuneSetpoint, setAutotuneSetpoint] = useState(150);
+  const [autotuneHysteresis, setAutotuneHysteresis] = useState(0.5);
+  const [autotuneCycles, setAutotuneCycles] = useState(4);
+  const [feedforward, setFeedforward] = useState<FeedforwardConfig | null>(null);
+  const [pvPipeline, setPvPipeline] = useState<ProcessValuePipelineConfig | null>(null);
+  const [modelFit, setModelFit] = useState<ThermalModelFitResult | null>(null);
+  const [modelFitError, setModelFitError] = useState('');
+  const [tickMs, setTickMs] = useState(0);
+  const [tickDiagnostics, setTickDiagnostics] = useState<ControlTickDiagnostics | null>(null);
+  const [zoneCount, setZoneCount] = useState(1);
+  const [zoneInputsCsv, setZoneInputsCsv] = useState<string[]>(['0', '1', '2', '3']);
+  const [zoneRelaysCsv, setZoneRelaysCsv] = useState<string[]>(['0', '1', '', '']);
+  const [zonesError, setZonesError] = useState('');
 
   const refresh = async () => {
     const value = await api.getControllerConfig();
@@ -93,12 +118,51 @@ export function ControllerSettingsPage({ onBack }: Props) {
       }
     }
     setRelayWeights(nextWeights);
+    setDriveMode(value.relays.drive_mode === 'burst' ? 'burst' : 'window');
+    setMainsHz(value.relays.mains_hz === 60 ? 60 : 50);
+    setFeedforward(value.feedforward ?? null);
+    setPvPipeline(value.pv_pipeline ?? null);
+    setTickMs(Number.isFinite(value.tick_ms) ? Number(value.tick_ms) : 0);
+    const zones = value.zones ?? [];
+    if (zones.length > 1) {
+      setZoneCount(zones.length);
+      setZoneInputsCsv(Array.from({ length: 4 }, (_, zone) => zones[zone]?.inputs.join(',') ?? ''));
+      setZoneRelaysCsv(Array.from({ length: 4 }, (_, zone) => zones[zone]?.relays.join(',') ?? ''));
+    } else {
+      setZoneCount(1);
+    }
   };
 
   useEffect(() => {
     refresh().catch(() => undefined);
   }, []);
 
+  useEffect(() => {
+    const poll = () => api.getAutotune().then(setAutotune).catch(() => undefined);
+    poll();
+    const timer = window.setInterval(poll, 2000);
+    return () => window.clearInterval(timer);
+  }, []);
+
+  const startAutotune = async () => {
+    await api.startAutotune({
+      setpoint_c: autotuneSetpoint,
+      hysteresis_c: autotuneHysteresis,
+      cycles: autotuneCycles
+    });
+    setAutotune(await api.getAutotune());
+  };
+
+  const cancelAutotune = async () => {
+    await api.cancelAutotune();
+    setAutotune(await api.getAutotune());
+  };
+
+  const acceptAutotune = async () => {
+    await api.acceptAutotune();
+    await refresh();
+  };
+
   const savePid = async () => {
     if (!config) return;
     await api.updatePid(config.pid);
@@ -117,9 +181,60 @@ export function ControllerSettingsPage({ onBack }: Props) {
     await refresh();
   };
 
+  const saveFeedforward = async () => {
+    if (!feedforward) return;
+    await api.updateFeedforwardConfig({
+      enabled: feedforward.enabled,
+      lookahead_s: feedforward.lookahead_s,
+      gain: feedforward.gain
+    });
+    await refresh();
+  };
+
+  const fitModel = async (apply: boolean) => {
+    setModelFitError('');
+    try {
+      setModelFit(await api.fitThermalModel(apply));
+      if (apply) {
+        await refresh();
+      }
+    } catch (error) {
+      setModelFit(null);
+      setModelFitError(error instanceof Error ? error.message : String(error));
+    }
+  };
+
+  const refreshTickDiagnostics = async () => {
+    const value = await api.getDiagnostics();
+    setTickDiagnostics(value.control_tick);
+  };
+
+  useEffect(() => {
+    refreshTickDiagnostics().catch(() => undefined);
+  }, []);
+
+  const saveTick = async () => {
+    await api.updateTickConfig(tickMs);
+    await refresh();
+    await refreshTickDiagnostics();
+  };
+
+  const resetTickDiagnostics = async () => {
+    await api.resetDiagnostics();
+    await refreshTickDiagnostics();
+  };
+
   const saveFilter = async () => {
     if (!config) return;
     await api.updateInputFilter(config.input_filter_ms);
+    if (pvPipeline) {
+      await api.updateProcessValuePipeline({
+        filter: pvPipeline.filter,
+        outlier_rejection: pvPipeline.outlier_rejection,
+        derivative_from_rate: pvPipeline.derivative_from_rate,
+        input_weights: pvPipeline.input_weights.map(clampWeight)
+      });
+    }
     await refresh();
   };
 
@@ -135,10 +250,26 @@ export function ControllerSettingsPage({ onBack }: Props) {
       relay,
       weight: clampWeight(relayWeights[relay] ?? 1)
     }));
-    await api.updateRelays(pwmRelays, runningRelays, pwmRelayWeights);
+    await api.updateRelays(pwmRelays, runningRelays, pwmRelayWeights, { drive_mode: driveMode, mains_hz: mainsHz });
     await refresh();
   };
 
+  const saveZones = async () => {
+    setZonesError('');
+    const zones = Array.from({ length: zoneCount }, (_, zone) => ({
+      inputs: sanitizeRelays(zoneInputsCsv[zone] ?? '').filter((channel) => channel <= 3),
+      relays: sanitizeRelays(zoneRelaysCsv[zone] ?? '')
+    }));
+    try {
+      await api.updateZones(zones);
+      await refresh();
+    } catch (err) {
+      setZonesError(err instanceof Error ? err.message : String(err));
+    }
+  };
+
+  const setZoneCsv = (values: string[], zone: number, value: string) => values.map((entry, index) => (index === zone ? value : entry));
+
   if (!config) {
     return <div className="card">Loading controller config...</div>;
   }
@@ -341,10 +472,190 @@ export function ControllerSettingsPage({ onBack }: Props) {
         <button className="primary" style={{ marginTop: '0.75rem' }} onClick={saveHeater}>Save Heater Settings</button>
       </section>
 
+      {feedforward && (
+        <section className="card">
+          <h3 className="section-title">Profile Feedforward</h3>
+          <div className="grid two">
+            <div>
+              <label className="label">Mode</label>
+              <select
+                className="input"
+                value={feedforward.enabled ? 'on' : 'off'}
+                onChange={(e) => setFeedforward({ ...feedforward, enabled: e.target.value === 'on' })}
+              >
+                <option value="off">PID only</option>
+                <option value="on">PID + model feedforward</option>
+              </select>
+            </div>
+            <div>
+              <label className="label">Lookahead (s)</label>
+              <input
+                className="input"
+                type="number"
+                min="0"
+                max="600"
+                step="1"
+                value={feedforward.lookahead_s}
+                onChange={(e) => setFeedforward({ ...feedforward, lookahead_s: Number(e.target.value) })}
+              />
+            </div>
+            <div>
+              <label className="label">Feedforward Gain (0-2)</label>
+              <input
+                className="input"
+                type="number"
+                min="0"
+                max="2"
+                step="0.05"
+                value={feedforward.gain}
+                onChange={(e) => setFeedforward({ ...feedforward, gain: Number(e.target.value) })}
+              />
+            </div>
+          </div>
+          <div className="muted" style={{ marginTop: '0.5rem' }}>
+            {feedforward.model.valid
+              ? `Model: ${feedforward.model.gain_c_per_pct.toFixed(3)} C/%, tau ${feedforward.model.time_constant_s.toFixed(0)} s, ambient ${feedforward.model.ambient_c.toFixed(1)} C. `
+              : 'No thermal model fitted yet; feedforward stays at 0 until one is. '}
+            While a profile runs, adds the heater output the model needs to follow the profile setpoint Lookahead seconds ahead.
+          </div>
+          {modelFit && (
+            <div className="muted" style={{ marginTop: '0.5rem' }}>
+              {`Fit from ${modelFit.samples} samples: ${modelFit.model.gain_c_per_pct.toFixed(3)} C/%, tau ${modelFit.model.time_constant_s.toFixed(0)} s, ` +
+                `ambient ${modelFit.model.ambient_c.toFixed(1)} C, dead time ${modelFit.dead_time_s.toFixed(0)} s, ` +
+                `residual ${modelFit.rmse_c_per_s.toFixed(4)} C/s${modelFit.applied ? ' (applied)' : ''}`}
+            </div>
+          )}
+          {modelFitError && <div className="muted" style={{ marginTop: '0.5rem' }}>{`Fit failed: ${modelFitError}`}</div>}
+          <div className="toolbar" style={{ marginTop: '0.75rem' }}>
+            <button className="primary" onClick={saveFeedforward}>Save Feedforward</button>
+            <button onClick={() => fitModel(false)}>Fit Model From History</button>
+            <button onClick={() => fitModel(true)} disabled={!modelFit}>Apply Fitted Model</button>
+          </div>
+        </section>
+      )}
+
+      <section className="card">
+        <h3 className="section-title">Autotune</h3>
+        <div className="grid two">
+          <div>
+            <label className="label">Setpoint (C)</label>
+            <input className="input" type="number" value={autotuneSetpoint} onChange={(e) => setAutotuneSetpoint(Number(e.target.value))} />
+          </div>
+          <div>
+            <label className="label">Hysteresis (C)</label>
+            <input className="input" type="number" min="0" step="0.1" value={autotuneHysteresis} onChange={(e) => setAutotuneHysteresis(Number(e.target.value))} />
+          </div>
+          <div>
+            <label className="label">Measured Cycles</label>
+            <input className="input" type="number" min="1" max="10" value={autotuneCycles} onChange={(e) => setAutotuneCycles(Math.trunc(Number(e.target.value)))} />
+          </div>
+        </div>
+        <div className="muted" style={{ marginTop: '0.5rem' }}>
+          {autotune?.state === 'running' && `Running: cycle ${autotune.cycle + 1} of ${autotune.cycles}, ${Math.round(autotune.elapsed_s)} s elapsed`}
+          {autotune?.state === 'failed' && `Last autotune failed: ${autotune.failure_reason}`}
+          {autotune?.state === 'complete' && autotune.result && (
+            `Ku ${autotune.result.ultimate_gain.toFixed(2)}, Tu ${autotune.result.ultimate_period_s.toFixed(1)} s. ` +
+            `Heat Kp/Ki/Kd ${autotune.result.heating.kp.toFixed(3)} / ${autotune.result.heating.ki.toFixed(4)} / ${autotune.result.heating.kd.toFixed(2)}, ` +
+            `Cool ${autotune.result.cooling.kp.toFixed(3)} / ${autotune.result.cooling.ki.toFixed(4)} / ${autotune.result.cooling.kd.toFixed(2)}`
+          )}
+          {(!autotune || autotune.state === 'idle') && 'Oscillates the oven around the setpoint to measure ultimate gain and period. The first cycle is discarded.'}
+        </div>
+        <div className="toolbar" style={{ marginTop: '0.75rem' }}>
+          <button className="primary" onClick={startAutotune} disabled={autotune?.state === 'running'}>Start Autotune</button>
+          <button onClick={cancelAutotune} disabled={autotune?.state !== 'running'}>Cancel</button>
+          <button onClick={acceptAutotune} disabled={autotune?.state !== 'complete'}>Apply Proposed Gains</button>
+        </div>
+      </section>
+
+      <section className="card">
+        <h3 className="section-title">Control Loop</h3>
+        <label className="label">Tick Interval (ms, 0 = every thermocouple pass, else 50-1000)</label>
+        <input className="input" type="number" min={0} max={1000} step={10} value={tickMs} onChange={(e) => setTickMs(Number(e.target.value))} />
+        <div className="muted" style={{ marginTop: '0.5rem' }}>
+          The thermocouples update every 220 ms; faster ticks refresh duty, feedforward and the door ramp, while the PID only runs on new samples.
+        </div>
+        {tickDiagnostics && (
+          <div className="muted" style={{ marginTop: '0.5rem' }}>
+            {`${tickDiagnostics.ticks} ticks at ${tickDiagnostics.period_ms.toFixed(0)} ms: exec mean ${tickDiagnostics.mean_exec_us} us, worst ${tickDiagnostics.worst_exec_us} us; `}
+            {`worst jitter ${tickDiagnostics.worst_jitter_us} us, ${tickDiagnostics.overruns} overruns, ${tickDiagnostics.missed_deadlines} missed deadlines.`}
+          </div>
+        )}
+        <div className="toolbar" style={{ marginTop: '0.75rem' }}>
+          <button className="primary" onClick={saveTick}>Save Tick</button>
+          <button onClick={() => refreshTickDiagnostics().catch(() => undefined)}>Refresh Stats</button>
+          <button onClick={resetTickDiagnostics}>Reset Stats</button>
+        </div>
+      </section>
+
       <section className="card">
         <h3 className="section-title">Input Filtering</h3>
         <label className="label">Input Filter (ms)</label>
         <input className="input" type="number" value={config.input_filter_ms} onChange={(e) => setConfig({ ...config, input_filter_ms: Number(e.target.value) })} />
+        {pvPipeline && (
+          <>
+            <div className="grid two" style={{ marginTop: '0.75rem' }}>
+              <div>
+                <label className="label">Filter</label>
+                <select
+                  className="input"
+                  value={pvPipeline.filter}
+                  onChange={(e) => setPvPipeline({ ...pvPipeline, filter: e.target.value as ProcessValueFilterName })}
+                >
+                  <option value="low_pass">Low-pass</option>
+                  <option value="alpha_beta">Alpha-beta (tracks rate, no ramp lag)</option>
+                </select>
+              </div>
+              <div>
+                <label className="label">Outlier Rejection</label>
+                <select
+                  className="input"
+                  value={pvPipeline.outlier_rejection ? 'on' : 'off'}
+                  onChange={(e) => setPvPipeline({ ...pvPipeline, outlier_rejection: e.target.value === 'on' })}
+                >
+                  <option value="on">Median/MAD per channel</option>
+                  <option value="off">Off</option>
+                </select>
+              </div>
+              <div>
+                <label className="label">PID Derivative</label>
+                <select
+                  className="input"
+                  value={pvPipeline.derivative_from_rate ? 'rate' : 'difference'}
+                  onChange={(e) => setPvPipeline({ ...pvPipeline, derivative_from_rate: e.target.value === 'rate' })}
+                >
+                  <option value="difference">Difference of filtered PV</option>
+                  <option value="rate">Filter rate estimate</option>
+                </select>
+              </div>
+            </div>
+            <label className="label" style={{ marginTop: '0.75rem' }}>Channel Weights (0-1)</label>
+            <div className="grid two">
+              {pvPipeline.input_weights.map((weight, channel) => (
+                <div key={channel}>
+                  <label className="label">{`TC ${channel}`}</label>
+                  <input
+                    className="input"
+                    type="number"
+                    min="0"
+                    max="1"
+                    step="0.05"
+                    value={weight}
+                    onChange={(e) =>
+                      setPvPipeline({
+                        ...pvPipeline,
+                        input_weights: pvPipeline.input_weights.map((entry, index) => (index === channel ? Number(e.target.value) : entry))
+                      })
+                    }
+                  />
+                </div>
+              ))}
+            </div>
+            <div className="muted" style={{ marginTop: '0.5rem' }}>
+              {`Rejected readings since boot: ${pvPipeline.rejected_readings.map((count, channel) => `TC ${channel}: ${count}`).join(', ')}. `}
+              Each zone's PV is the weighted mean of its channels; a channel with weight 0 only counts when no other channel in the zone reads.
+            </div>
+          </>
+        )}
         <button className="primary" style={{ marginTop: '0.75rem' }} onClick={saveFilter}>Save Filter</button>
       </section>
 
@@ -378,10 +689,65 @@ export function ControllerSettingsPage({ onBack }: Props) {
         <div className="muted" style={{ marginTop: '0.5rem' }}>
           Relay weights are only applied to relays listed in PWM Relays CSV. A weight of 0 keeps that selected relay always off.
         </div>
+        <div className="grid two" style={{ marginTop: '0.75rem' }}>
+          <div>
+            <label className="label">PWM Drive Mode</label>
+            <select className="input" value={driveMode} onChange={(e) => setDriveMode(e.target.value === 'burst' ? 'burst' : 'window')}>
+              <option value="window">Window (1 s period)</option>
+              <option value="burst">Burst fire (mains cycles)</option>
+            </select>
+          </div>
+          <div>
+            <label className="label">Mains Frequency (Hz)</label>
+            <select className="input" value={mainsHz} onChange={(e) => setMainsHz(Number(e.target.value) === 60 ? 60 : 50)}>
+              <option value={50}>50</option>
+              <option value={60}>60</option>
+            </select>
+          </div>
+        </div>
+        <div className="muted" style={{ marginTop: '0.5rem' }}>
+          Burst fire switches relays in whole mains cycles. Only use it with zero-crossing SSRs, never with mechanical relays.
+        </div>
         <label className="label" style={{ marginTop: '0.5rem' }}>Running Relays CSV (0-7)</label>
         <input className="input" value={runningRelaysCsv} onChange={(e) => setRunningRelaysCsv(e.target.value)} />
         <button className="primary" style={{ marginTop: '0.75rem' }} onClick={saveRelays}>Save Relays</button>
       </section>
+
+      <section className="card">
+        <h3 className="section-title">Control Zones</h3>
+        <label className="label">Zones</label>
+        <select className="input" value={zoneCount} onChange={(e) => setZoneCount(Number(e.target.value))}>
+          <option value={1}>1 (single loop over Input Channels and PWM Relays)</option>
+          <option value={2}>2</option>
+          <option value={3}>3</option>
+          <option value={4}>4</option>
+        </select>
+        {zoneCount > 1 && (
+          <div className="grid two" style={{ marginTop: '0.75rem' }}>
+            {Array.from({ length: zoneCount }, (_, zone) => (
+              <div key={zone}>
+                <label className="label">Zone {zone} Thermocouples CSV (0-3)</label>
+                <input
+                  className="input"
+                  value={zoneInputsCsv[zone] ?? ''}
+                  onChange={(e) => setZoneInputsCsv(setZoneCsv(zoneInputsCsv, zone, e.target.value))}
+                />
+                <label className="label" style={{ marginTop: '0.5rem' }}>Zone {zone} Heater Relays CSV (0-7)</label>
+                <input
+                  className="input"
+                  value={zoneRelaysCsv[zone] ?? ''}
+                  onChange={(e) => setZoneRelaysCsv(setZoneCsv(zoneRelaysCsv, zone, e.target.value))}
+                />
+              </div>
+            ))}
+          </div>
+        )}
+        <div className="muted" style={{ marginTop: '0.5rem' }}>
+          Each zone runs its own PID (shared gains) on the mean of its thermocouples and drives its relays, which must be PWM relays not used by another zone. The door follows the chamber average. Stop the controller before changing zones; history picks up a new zone layout after a reboot.
+        </div>
+        {zonesError && <div className="muted" style={{ marginTop: '0.5rem' }}>{zonesError}</div>}
+        <button className="primary" style={{ marginTop: '0.75rem' }} onClick={saveZones}>Save Zones</button>
+      </section>
     </div>
   );
 }
@@ -0,0 +1,194 @@
+import { useEffect, useState } from 'react';
+import { api } from '../../api';
+import { BootDiagnostics, Diagnostics, HeapDiagnostics } from '../../types';
+
+interface Props {
+  onBack: () => void;
+}
+
+const POLL_MS = 2000;
+
+function formatKiB(bytes: number): string {
+  return `${(bytes / 1024).toFixed(1)} KiB`;
+}
+
+function HeapCard({ title, heap }: { title: string; heap: HeapDiagnostics }) {
+  return (
+    <section className="card">
+      <h3 className="section-title">{title}</h3>
+      {heap.total_bytes === 0 ? (
+        <div className="muted">Not present</div>
+      ) : (
+        <div className="muted">
+          {`Free ${formatKiB(heap.free_bytes)} of ${formatKiB(heap.total_bytes)}, largest block ${formatKiB(heap.largest_free_block)}, `}
+          {`lowest free since boot ${formatKiB(heap.min_free_bytes)}`}
+        </div>
+      )}
+    </section>
+  );
+}
+
+function formatMs(ms: number | null): string {
+  return ms === null ? '--' : `${ms.toFixed(1)} ms`;
+}
+
+function BootCard({ boot }: { boot: BootDiagnostics }) {
+  const sinceStart = (ms: number | null) => (ms === null || boot.app_start_ms === null ? null : ms - boot.app_start_ms);
+  return (
+    <section className="card">
+      <h3 className="section-title">Startup</h3>
+      <div className="muted">
+        {`Control ready ${formatMs(sinceStart(boot.control_ready_ms))} after app start; `}
+        {boot.network_ready_ms === null ? 'network bring-up still running' : `network ready after ${formatMs(sinceStart(boot.network_ready_ms))}`}
+      </div>
+      <table style={{ width: '100%', borderCollapse: 'collapse', marginTop: '0.5rem' }}>
+        <thead>
+          <tr>
+            <th style={{ textAlign: 'left' }}>Stage</th>
+            <th style={{ textAlign: 'right' }}>Start</th>
+            <th style={{ textAlign: 'right' }}>Duration</th>
+            <th style={{ textAlign: 'right' }}>Result</th>
+          </tr>
+        </thead>
+        <tbody>
+          {boot.stages.map((stage) => (
+            <tr key={stage.name}>
+              <td>{stage.name}</td>
+              <td style={{ textAlign: 'right' }}>{formatMs(sinceStart(stage.start_ms))}</td>
+              <td style={{ textAlign: 'right' }}>{formatMs(stage.duration_ms)}</td>
+              <td style={{ textAlign: 'right' }}>{stage.state === 'done' ? stage.result : stage.state}</td>
+            </tr>
+          ))}
+        </tbody>
+      </table>
+    </section>
+  );
+}
+
+export function DiagnosticsSettingsPage({ onBack }: Props) {
+  const [diagnostics, setDiagnostics] = useState<Diagnostics | null>(null);
+  const [traceError, setTraceError] = useState('');
+
+  useEffect(() => {
+    const poll = () => api.getDiagnostics().then(setDiagnostics).catch(() => undefined);
+    poll();
+    const timer = window.setInterval(poll, POLL_MS);
+    return () => window.clearInterval(timer);
+  }, []);
+
+  const downloadTrace = async () => {
+    try {
+      const trace = await api.exportTrace();
+      const blob = new Blob([trace], { type: 'application/json' });
+      const url = URL.createObjectURL(blob);
+      const a = document.createElement('a');
+      a.href = url;
+      a.download = 'reflow-trace.json';
+      a.click();
+      URL.revokeObjectURL(url);
+      setTraceError('');
+    } catch (error) {
+      setTraceError(error instanceof Error ? error.message : String(error));
+    }
+  };
+
+  const clearTrace = async () => {
+    await api.clearTrace();
+    setDiagnostics(await api.getDiagnostics());
+  };
+
+  const tasks = [...(diagnostics?.tasks ?? [])].sort((a, b) => b.cpu_pct - a.cpu_pct);
+
+  return (
+    <div className="grid" style={{ gap: '1rem' }}>
+      <div className="toolbar">
+        <h2 className="section-title" style={{ margin: 0 }}>Diagnostics</h2>
+        <button onClick={onBack}>Back</button>
+      </div>
+
+      <section className="card">
+        <h3 className="section-title">Tasks</h3>
+        {diagnostics && !diagnostics.runtime_stats && (
+          <div className="muted">Run-time stats are disabled in this firmware build; CPU% is unavailable.</div>
+        )}
+        <table style={{ width: '100%', borderCollapse: 'collapse' }}>
+          <thead>
+            <tr>
+              <th style={{ textAlign: 'left' }}>Task</th>
+              <th style={{ textAlign: 'right' }}>Core</th>
+              <th style={{ textAlign: 'right' }}>Priority</th>
+              <th style={{ textAlign: 'right' }}>CPU %</th>
+              <th style={{ textAlign: 'right' }}>Min Free Stack</th>
+            </tr>
+          </thead>
+          <tbody>
+            {tasks.map((task) => (
+              <tr key={task.name}>
+                <td>{task.name}</td>
+                <td style={{ textAlign: 'right' }}>{task.core ?? 'any'}</td>
+                <td style={{ textAlign: 'right' }}>{task.priority}</td>
+                <td style={{ textAlign: 'right' }}>{task.cpu_pct.toFixed(1)}</td>
+                <td style={{ textAlign: 'right' }}>{`${task.stack_free_min_bytes} B`}</td>
+              </tr>
+            ))}
+          </tbody>
+        </table>
+        <div className="muted" style={{ marginTop: '0.5rem' }}>
+          CPU % is the share of one core over the last {diagnostics ? (diagnostics.window_us / 1e6).toFixed(1) : '--'} s; the IDLE tasks hold what is left.
+          {diagnostics && diagnostics.tasks_omitted > 0 && ` ${diagnostics.tasks_omitted} more tasks are running but not listed.`}
+        </div>
+      </section>
+
+      {diagnostics && (
+        <div className="grid two">
+          <HeapCard title="Internal Heap" heap={diagnostics.heap.internal} />
+          <HeapCard title="PSRAM Heap" heap={diagnostics.heap.psram} />
+          <section className="card">
+            <h3 className="section-title">Web Server</h3>
+            <div className="muted">
+              {`Worker busy ${diagnostics.httpd.busy_pct.toFixed(1)}%, ${diagnostics.httpd.requests} requests, worst ${diagnostics.httpd.worst_us} us; `}
+              {`${diagnostics.httpd.open_sockets} of ${diagnostics.httpd.max_open_sockets} sockets open`}
+            </div>
+            <div className="muted">
+              {`${diagnostics.websocket.clients} live clients, ${diagnostics.websocket.dropped_frames} frames dropped, `}
+              {`${diagnostics.websocket.slow_client_closes} slow clients closed`}
+            </div>
+          </section>
+          <section className="card">
+            <h3 className="section-title">Settings Storage</h3>
+            <div className="muted">
+              {`${diagnostics.settings_nvs.commits} NVS commits, ${diagnostics.settings_nvs.keys_written} keys written, `}
+              {`${diagnostics.settings_nvs.keys_unchanged} unchanged skipped, ${diagnostics.settings_nvs.failed_writes} failed`}
+              {diagnostics.settings_nvs.pending_keys > 0 && `; ${diagnostics.settings_nvs.pending_keys} waiting to be written`}
+            </div>
+            {diagnostics.settings_nvs.last_error && (
+              <div className="muted" style={{ marginTop: '0.5rem' }}>
+                {`Last save failed (${diagnostics.settings_nvs.last_error}, ${diagnostics.settings_nvs.failed_commits} failed commits); recent changes may not survive a restart.`}
+              </div>
+            )}
+          </section>
+          <section className="card">
+            <h3 className="section-title">Trace</h3>
+            <div className="muted">
+              {diagnostics.trace.available
+                ? `${diagnostics.trace.events} of ${diagnostics.trace.capacity} events${diagnostics.trace.frozen ? ', frozen by a tick overrun' : ''}. Open the download in Perfetto.`
+                : 'Tracing is not built into this firmware (CONFIG_TRACE_ENABLED).'}
+            </div>
+            {traceError && <div className="muted" style={{ marginTop: '0.5rem' }}>{`Download failed: ${traceError}`}</div>}
+            <div className="toolbar" style={{ marginTop: '0.75rem' }}>
+              <button className="primary" onClick={downloadTrace} disabled={!diagnostics.trace.available}>Download Trace</button>
+              <button onClick={clearTrace} disabled={!diagnostics.trace.available}>Clear</button>
+            </div>
+          </section>
+          <BootCard boot={diagnostics.boot} />
+          <section className="card">
+            <h3 className="section-title">History Buffer</h3>
+            <div className="muted">
+              {`${diagnostics.history.points} of ${diagnostics.history.max_points} points, ${formatKiB(diagnostics.history.storage_bytes)}`}
+            </div>
+          </section>
+        </div>
+      )}
+    </div>
+  );
+}
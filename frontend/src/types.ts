@@ -5,10 +5,179 @@ export interface ControllerStatus {
   state: string;
   setpoint_c: number;
   process_value_c: number;
+  process_rate_c_per_s?: number; // From the input filter; with alpha_beta it also feeds the PID derivative
   pid_output: number;
   p_term: number;
   i_term: number;
   d_term: number;
+  ff_term?: number; // Model feedforward included in pid_output
+  autotune?: AutotuneProgress;
+  zones?: ZoneStatus[]; // One entry per control zone; a single zone mirrors the fields above
+}
+
+export interface ZoneStatus {
+  process_value_c: number;
+  pid_output: number;
+}
+
+export type AutotuneStateName = 'idle' | 'running' | 'complete' | 'failed';
+
+export interface AutotuneProgress {
+  state: AutotuneStateName;
+  cycle: number; // Completed cycles, including the discarded first one
+  cycles: number;
+}
+
+export interface AutotuneGains {
+  kp: number;
+  ki: number;
+  kd: number;
+}
+
+export interface AutotuneStatus extends AutotuneProgress {
+  elapsed_s: number;
+  failure_reason: string;
+  config: {
+    setpoint_c: number;
+    heat_output_pct: number;
+    cool_output_pct: number;
+    hysteresis_c: number;
+    max_duration_s: number;
+  };
+  result?: {
+    ultimate_gain: number;
+    ultimate_period_s: number;
+    amplitude_c: number;
+    heating: AutotuneGains;
+    cooling: AutotuneGains;
+  };
+}
+
+export interface ThermalModel {
+  valid?: boolean;
+  gain_c_per_pct: number;
+  time_constant_s: number;
+  ambient_c: number;
+}
+
+export type ProcessValueFilterName = 'low_pass' | 'alpha_beta';
+
+export interface ProcessValuePipelineConfig {
+  filter: ProcessValueFilterName;
+  outlier_rejection: boolean; // Median/MAD rejection per thermocouple channel
+  derivative_from_rate: boolean; // PID derivative from the filter's rate estimate
+  input_weights: number[]; // One per thermocouple channel, 0..1
+  rejected_readings: number[]; // Read-only: readings replaced since boot, per channel
+}
+
+export interface FeedforwardConfig {
+  enabled: boolean;
+  lookahead_s: number;
+  gain: number;
+  model: ThermalModel;
+}
+
+export interface ThermalModelFitResult {
+  model: ThermalModel;
+  dead_time_s: number;
+  rmse_c_per_s: number;
+  samples: number;
+  applied: boolean;
+}
+
+export interface JitterBucket {
+  le_us: number | null; // null = unbounded last bucket
+  count: number;
+}
+
+export interface ControlTickDiagnostics {
+  mode: 'sample' | 'fixed';
+  tick_ms: number;
+  period_ms: number;
+  ticks: number;
+  overruns: number;
+  missed_deadlines: number;
+  last_exec_us: number;
+  worst_exec_us: number;
+  mean_exec_us: number;
+  worst_jitter_us: number;
+  jitter_histogram: JitterBucket[];
+  since_us: number;
+}
+
+export interface TaskDiagnostics {
+  name: string;
+  priority: number;
+  core: number | null; // null = not pinned
+  cpu_pct: number; // Share of one core over window_us
+  stack_free_min_bytes: number;
+}
+
+export interface HeapDiagnostics {
+  total_bytes: number;
+  free_bytes: number;
+  min_free_bytes: number;
+  largest_free_block: number;
+}
+
+export interface BootStageDiagnostics {
+  name: string;
+  state: 'pending' | 'running' | 'done' | 'skipped';
+  start_ms: number | null; // Since boot
+  duration_ms: number | null;
+  result: string | null; // esp_err_t name once done
+}
+
+export interface BootDiagnostics {
+  app_start_ms: number | null;
+  control_ready_ms: number | null; // Controller task running
+  network_ready_ms: number | null; // null while WiFi/web/SNTP bring-up is still in progress
+  stages: BootStageDiagnostics[];
+}
+
+export interface Diagnostics {
+  runtime_stats: boolean;
+  window_us: number;
+  tasks: TaskDiagnostics[];
+  tasks_omitted: number; // Running tasks beyond the firmware's listing limit
+  heap: {
+    internal: HeapDiagnostics;
+    psram: HeapDiagnostics;
+  };
+  httpd: {
+    busy_pct: number;
+    requests: number;
+    worst_us: number;
+    open_sockets: number;
+    max_open_sockets: number;
+  };
+  websocket: {
+    clients: number;
+    dropped_frames: number; // Superseded by a newer frame before the client took it
+    slow_client_closes: number; // Closed after a send timed out
+  };
+  history: {
+    points: number;
+    max_points: number;
+    storage_bytes: number;
+  };
+  settings_nvs: {
+    pending_keys: number; // Staged, waiting for the deferred write-back
+    commits: number;
+    keys_written: number;
+    keys_unchanged: number;
+    failed_writes: number;
+    failed_commits: number;
+    last_error: string | null; // Most recent NVS write/commit failure since boot; settings may not have persisted
+  };
+  boot: BootDiagnostics;
+  control_tick: ControlTickDiagnostics;
+  trace: {
+    available: boolean; // Built with CONFIG_TRACE_ENABLED and the ring allocated
+    frozen: boolean; // Stopped by a tick overrun until cleared
+    events: number;
+    capacity: number;
+  };
 }
 
 export interface HardwareStatus {
@@ -103,6 +272,33 @@ export interface ProfileDefinition {
   steps: ProfileStep[];
 }
 
+export type SimulationStateName = 'idle' | 'running' | 'complete';
+
+export type SimulationOutcome = 'completed' | 'transition_guard_abort' | 'invalid_profile' | 'timed_out' | 'cancelled';
+
+export interface SimulationPoint {
+  time_s: number;
+  setpoint: number;
+  process_value: number;
+  pid_output: number;
+  step_number: number; // 1-based
+}
+
+export interface SimulationStatus {
+  state: SimulationStateName;
+  profile_name: string;
+  simulated_s: number;
+  wall_time_ms: number;
+  result?: {
+    outcome: SimulationOutcome;
+    duration_s: number;
+    max_overshoot_c: number;
+    ticks: number;
+    step_s: number;
+    points: SimulationPoint[]; // Downsampled to at most 500, last tick included
+  };
+}
+
 export interface ProfileSlotSummary {
   slot_index: number;
   occupied: boolean;
@@ -120,6 +316,7 @@ export interface ApiEnvelope<T> {
 }
 
 export interface HistoryPoint {
+  seq: number;
   timestamp: number;
   setpoint: number;
   process_value: number;
@@ -131,6 +328,59 @@ export interface HistoryPoint {
   relay_states: number;
   servo_angle: number;
   running: boolean;
+  zones?: Array<{ process_value: number; pid_output: number }>; // Multi-zone history only
+}
+
+export interface HistoryResponse {
+  points: HistoryPoint[];
+  oldest_seq: number; // oldest sequence still retained on the device; a gap means points were lost to wraparound
+  next_seq: number; // sequence the next logged point will get
+}
+
+export type HistoryResolution = 'raw' | '10s' | '60s';
+
+export interface RunLogInfo {
+  id: number;
+  size_bytes: number;
+  start_unix_s: number; // 0 when the clock was not synced when the run started
+  first_timestamp: number;
+  active: boolean;
+}
+
+export interface RunLogListResponse {
+  runs: RunLogInfo[];
+  dropped_records: number; // records the device could not buffer to flash
+}
+
+export interface HistoryRollupStats {
+  min: number;
+  max: number;
+  mean: number;
+}
+
+export interface HistoryRollupPoint {
+  seq: number;
+  timestamp: number; // bucket start, seconds since boot
+  samples: number;
+  setpoint: HistoryRollupStats;
+  process_value: HistoryRollupStats;
+  pid_output: HistoryRollupStats;
+}
+
+export interface HistoryRollupResponse {
+  resolution_s: number;
+  points: HistoryRollupPoint[];
+  oldest_seq: number;
+  next_seq: number;
+}
+
+export type RelayDriveMode = 'window' | 'burst';
+
+// Thermocouple channels and PWM relays of one control zone. A single zone
+// always follows `inputs` and `relays.pwm_relays`.
+export interface ControlZoneConfig {
+  inputs: number[];
+  relays: number[];
 }
 
 export interface ControllerConfig {
@@ -154,6 +404,7 @@ export interface ControllerConfig {
     integral_leak_s: number;
   };
   input_filter_ms: number;
+  tick_ms?: number; // 0 = one tick per thermocouple pass
   inputs: number[];
   relays: {
     pwm_relays: number[];
@@ -162,7 +413,10 @@ export interface ControllerConfig {
       weight: number;
     }>;
     running_relays: number[];
+    drive_mode?: RelayDriveMode;
+    mains_hz?: number;
   };
+  zones?: ControlZoneConfig[];
   door: {
     closed_angle_deg: number;
     open_angle_deg: number;
@@ -176,4 +430,6 @@ export interface ControllerConfig {
     min_value_pct: number;
     force_on_below_c: number;
   };
+  feedforward?: FeedforwardConfig;
+  pv_pipeline?: ProcessValuePipelineConfig;
 }
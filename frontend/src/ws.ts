@@ -9,6 +9,74 @@ interface MessageEnvelope {
   data?: StatusData;
 }
 
+// Delta frames carry only changed fields; nested objects merge, arrays replace.
+function mergeDelta<T>(base: T, delta: unknown): T {
+  if (typeof delta !== 'object' || delta === null || Array.isArray(delta)) {
+    return delta as T;
+  }
+  const merged: Record<string, unknown> = { ...(base as Record<string, unknown>) };
+  for (const [key, value] of Object.entries(delta as Record<string, unknown>)) {
+    merged[key] = mergeDelta(merged[key], value);
+  }
+  return merged as T;
+}
+
+const TELEMETRY_BINARY_VERSION = 2;
+const TELEMETRY_BINARY_SIZE = 120;
+const FOREGROUND_RATE_HZ = 4;
+const BACKGROUND_RATE_HZ = 1;
+
+// Fast-changing fields from a binary telemetry frame, shaped as a status delta.
+// Layout matches BuildTelemetryBinaryFrame in the firmware.
+export function decodeTelemetryBinary(buffer: ArrayBuffer): Partial<StatusData> | null {
+  if (buffer.byteLength < TELEMETRY_BINARY_SIZE) {
+    return null;
+  }
+  const view = new DataView(buffer);
+  if (view.getUint8(0) !== TELEMETRY_BINARY_VERSION) {
+    return null;
+  }
+
+  const flags = view.getUint8(1);
+  const relayBits = view.getUint8(2);
+  const f32 = (offset: number) => view.getFloat32(offset, true);
+  const stateBytes = new Uint8Array(buffer, 64, 24);
+  const stateEnd = stateBytes.indexOf(0);
+  const state = new TextDecoder().decode(stateBytes.subarray(0, stateEnd < 0 ? stateBytes.length : stateEnd));
+  const zoneCount = Math.min(view.getUint8(3), 4);
+  const zones = Array.from({ length: zoneCount }, (_, zone) => ({
+    process_value_c: f32(88 + zone * 4),
+    pid_output: f32(104 + zone * 4)
+  }));
+
+  return {
+    controller: {
+      running: (flags & 0x01) !== 0,
+      door_open: (flags & 0x02) !== 0,
+      alarming: (flags & 0x04) !== 0,
+      state,
+      setpoint_c: f32(8),
+      process_value_c: f32(12),
+      pid_output: f32(16),
+      p_term: f32(20),
+      i_term: f32(24),
+      d_term: f32(28),
+      zones
+    },
+    hardware: {
+      temperatures_c: [f32(32), f32(36), f32(40), f32(44)],
+      relay_states: Array.from({ length: 6 }, (_, i) => (relayBits & (1 << i)) !== 0),
+      servo_angle: f32(48)
+    },
+    profile: {
+      running: (flags & 0x08) !== 0,
+      step_elapsed_s: f32(52),
+      profile_elapsed_s: f32(56),
+      current_step_number: view.getUint16(60, true)
+    }
+  } as Partial<StatusData>;
+}
+
 export function useLiveStatus() {
   const [status, setStatus] = useState<StatusData | null>(null);
   const [connected, setConnected] = useState(false);
@@ -30,13 +98,26 @@ export function useLiveStatus() {
       }
     };
 
+    // Binary frames at a lower rate while the tab is hidden; JSON keyframes still
+    // arrive periodically for the slow-changing sections.
+    const subscribe = () => {
+      if (ws?.readyState !== WebSocket.OPEN) return;
+      ws.send(JSON.stringify({
+        type: 'subscribe',
+        format: 'bin',
+        rate_hz: document.hidden ? BACKGROUND_RATE_HZ : FOREGROUND_RATE_HZ
+      }));
+    };
+
     const connect = () => {
       if (cancelled) return;
 
       ws = new WebSocket(WS_URL);
+      ws.binaryType = 'arraybuffer';
       ws.onopen = () => {
         setConnected(true);
         attempts = 0;
+        subscribe();
       };
       ws.onclose = () => {
         setConnected(false);
@@ -49,9 +130,22 @@ export function useLiveStatus() {
         ws?.close();
       };
       ws.onmessage = (event) => {
+        if (event.data instanceof ArrayBuffer) {
+          const delta = decodeTelemetryBinary(event.data);
+          if (delta) {
+            setStatus((previous) => (previous ? mergeDelta(previous, delta) : previous));
+          }
+          return;
+        }
         try {
           const parsed = JSON.parse(event.data) as MessageEnvelope;
-          if (parsed.data) {
+          if (!parsed.data) {
+            return;
+          }
+          if (parsed.type === 'delta') {
+            const delta = parsed.data;
+            setStatus((previous) => (previous ? mergeDelta(previous, delta) : previous));
+          } else {
             setStatus(parsed.data);
           }
         } catch {
@@ -62,6 +156,7 @@ export function useLiveStatus() {
 
     fetchInitial();
     connect();
+    document.addEventListener('visibilitychange', subscribe);
 
     const pollTimer = window.setInterval(fetchInitial, 5000);
 
@@ -71,6 +166,7 @@ export function useLiveStatus() {
         window.clearTimeout(reconnectTimer);
       }
       window.clearInterval(pollTimer);
+      document.removeEventListener('visibilitychange', subscribe);
       ws?.close();
     };
   }, []);
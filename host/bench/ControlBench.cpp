@@ -0,0 +1,634 @@
+// Host benchmarks for the control core. Every workload is fixed and runs on
+// virtual time, so two builds differ only in the code under test; compare them
+// with --json on one commit and --baseline on the next.
+#include "HostHal.hpp"
+
+#include "ControlMath.hpp"
+#include "DataManager.hpp"
+#include "HistoryBinaryEncoder.hpp"
+#include "PID.hpp"
+#include "PWM.hpp"
+#include "ProcessValueFilter.hpp"
+#include "ProfileEngine.hpp"
+#include "SettingsManager.hpp"
+#include "cJSON.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace {
+constexpr int DEFAULT_REPEATS = 15;
+constexpr int RESULT_SCHEMA_VERSION = 1;
+
+constexpr int PID_ITERATIONS = 200000;
+constexpr int PV_PASSES = 100000;
+constexpr int RAMP_TICKS = 10000;
+constexpr double RAMP_TICK_S = 0.05;
+constexpr int JUMP_BURSTS = 200;
+constexpr double JUMP_BURST_TICK_S = 31.0; // Just past the 30 s soak ahead of the jumps
+constexpr std::size_t HISTORY_READ_BATCH = 64;
+constexpr int PWM_ALARMS = 200000;
+constexpr int JSON_ITERATIONS = 500;
+
+// One repeat of a benchmark: elapsed wall time over the operations it timed.
+struct Sample {
+    double elapsedNs = 0.0;
+    uint64_t ops = 0;
+};
+
+using BenchFunction = Sample (*)();
+
+struct Benchmark {
+    const char* name;
+    const char* unit; // What one op is
+    BenchFunction run;
+};
+
+struct Result {
+    std::string name;
+    std::string unit;
+    double medianNs = 0.0;
+    double minNs = 0.0;
+    uint64_t ops = 0;
+};
+
+using Clock = std::chrono::steady_clock;
+
+double ElapsedNs(Clock::time_point start) {
+    return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+}
+
+[[noreturn]] void Fail(const char* message) {
+    std::fprintf(stderr, "control_bench: %s\n", message);
+    std::exit(1);
+}
+
+// --- PID --------------------------------------------------------------------
+
+// The same first-order plant as ControlBenchmark.cpp on the target, so the
+// setpoint change drives both the heating and cooling branches.
+template <typename T>
+Sample RunPidCalculate() {
+    BasicPID<T> pid;
+    (void)pid.TuneHeating(T(15), T(2), T(5));
+    (void)pid.TuneCooling(T(15), T(0), T(5));
+    (void)pid.SetDerivativeFilterTime(T(1));
+    (void)pid.SetIntegralLeakTimeSeconds(T(600));
+
+    const T dt = T(0.22);
+    const T alpha = dt / (T(1) + dt);
+    T plant = T(24);
+    T filtered = plant;
+    volatile T sink = T(0);
+
+    const Clock::time_point start = Clock::now();
+    for (int i = 0; i < PID_ITERATIONS; ++i) {
+        const T setPoint = (i % 4000 < 2000) ? T(150) : T(60);
+        filtered = alpha * plant + (T(1) - alpha) * filtered;
+        const T output = pid.Calculate(setPoint, filtered, dt);
+        plant += (std::max(output, T(0)) * T(0.02) - (plant - T(24)) * T(0.002) + std::min(output, T(0)) * T(0.005)) * dt;
+        sink = output;
+    }
+    (void)sink;
+    return {ElapsedNs(start), PID_ITERATIONS};
+}
+
+Sample RunPidCalculateFloat() {
+    return RunPidCalculate<float>();
+}
+
+Sample RunPidCalculateDouble() {
+    return RunPidCalculate<double>();
+}
+
+// --- Process-value pipeline --------------------------------------------------
+
+// One thermocouple pass as Controller::UpdateProcessValue runs it with four
+// channels in one zone: outlier rejection per channel, then the alpha-beta
+// filter. The readings ramp in 0.25 °C steps with a glitch every 97 passes.
+Sample RunPvPipelinePass() {
+    ChannelOutlierFilter outlierFilters[4];
+    ProcessValueFilter filter;
+    const control_real_t dt = control_real_t(0.22);
+    volatile control_real_t sink = 0;
+    uint32_t rejected = 0;
+
+    const Clock::time_point start = Clock::now();
+    for (int pass = 0; pass < PV_PASSES; ++pass) {
+        const control_real_t base = control_real_t(24) + control_real_t((pass / 4) % 800) * control_real_t(0.25);
+        control_real_t sum = 0;
+        for (int channel = 0; channel < 4; ++channel) {
+            control_real_t reading = base + control_real_t(channel) * control_real_t(0.25);
+            if (pass % 97 == channel) {
+                reading -= control_real_t(150);
+            }
+            bool wasRejected = false;
+            sum += outlierFilters[channel].Filter(reading, wasRejected);
+            rejected += wasRejected ? 1 : 0;
+        }
+        sink = filter.Update(sum / control_real_t(4), dt, control_real_t(1), ProcessValueFilterMode::AlphaBeta);
+    }
+    (void)sink;
+    if (rejected == 0) {
+        Fail("pv_pipeline_pass: no glitch was rejected");
+    }
+    return {ElapsedNs(start), PV_PASSES};
+}
+
+// --- ProfileEngine ----------------------------------------------------------
+
+ProfileStep DirectStep(double setpointC) {
+    ProfileStep step;
+    step.type = ProfileStepType::Direct;
+    step.setpointC = setpointC;
+    return step;
+}
+
+ProfileStep SoakStep(double setpointC, double soakTimeS) {
+    ProfileStep step;
+    step.type = ProfileStepType::Soak;
+    step.setpointC = setpointC;
+    step.soakTimeS = soakTimeS;
+    return step;
+}
+
+ProfileStep RampTimeStep(double setpointC, double rampTimeS) {
+    ProfileStep step;
+    step.type = ProfileStepType::RampTime;
+    step.setpointC = setpointC;
+    step.rampTimeS = rampTimeS;
+    return step;
+}
+
+ProfileStep JumpStep(int targetStepNumber, int repeatCount) {
+    ProfileStep step;
+    step.type = ProfileStepType::Jump;
+    step.targetStepNumber = targetStepNumber;
+    step.repeatCount = repeatCount;
+    return step;
+}
+
+ProfileDefinition RampProfile() {
+    ProfileDefinition profile;
+    profile.name = "bench ramp";
+    profile.steps = {DirectStep(25.0), RampTimeStep(250.0, 1000.0), SoakStep(250.0, 60.0)};
+    return profile;
+}
+
+// MAX_STEPS steps: a timed soak, then an inner loop nested in an outer loop
+// that both span most of the profile, so every jump also resets a wide range
+// of counters. outerRepeat is picked by CalibrateJumpBurstRepeat().
+ProfileDefinition JumpBurstProfile(int outerRepeat) {
+    constexpr int INNER_BODY_STEPS = 18;
+    constexpr int OUTER_TAIL_STEPS = 17;
+
+    ProfileDefinition profile;
+    profile.name = "bench nested jumps";
+    profile.description = "Worst-case transitions in one tick";
+    profile.steps.push_back(DirectStep(25.0));
+    profile.steps.push_back(SoakStep(150.0, 30.0));
+    for (int i = 0; i < INNER_BODY_STEPS; ++i) {
+        profile.steps.push_back(DirectStep(100.0 + i));
+    }
+    profile.steps.push_back(JumpStep(3, 1));
+    for (int i = 0; i < OUTER_TAIL_STEPS; ++i) {
+        profile.steps.push_back(DirectStep(200.0 + i));
+    }
+    profile.steps.push_back(JumpStep(3, outerRepeat));
+    profile.steps.push_back(SoakStep(150.0, 60.0));
+    static_assert(2 + INNER_BODY_STEPS + 1 + OUTER_TAIL_STEPS + 2 == ProfileEngine::MAX_STEPS, "fill every step");
+    return profile;
+}
+
+// True when one tick past the first soak runs every jump and lands on the
+// final soak without tripping the transition guard.
+bool JumpBurstFitsOneTick(const ProfileDefinition& profile) {
+    static ProfileEngine::Plan plan;
+    ProfileEngine::PlanCursor cursor;
+    ProfileEngine::CompilePlan(profile, plan);
+    double setpointC = 25.0;
+    ProfileEngine::BeginPlan(plan, cursor, setpointC);
+    if (ProfileEngine::AdvancePlan(plan, cursor, 0.0, 25.0, setpointC) != ProfileEngine::PlanTickResult::Running) {
+        return false;
+    }
+    const ProfileEngine::PlanTickResult result = ProfileEngine::AdvancePlan(plan, cursor, JUMP_BURST_TICK_S, 25.0, setpointC);
+    return result == ProfileEngine::PlanTickResult::Running && cursor.stepIndex == plan.stepCount - 1;
+}
+
+int CalibrateJumpBurstRepeat() {
+    int repeat = 0;
+    if (!JumpBurstFitsOneTick(JumpBurstProfile(repeat))) {
+        Fail("jump burst profile trips the transition guard with no outer repeats");
+    }
+    while (JumpBurstFitsOneTick(JumpBurstProfile(repeat + 1))) {
+        ++repeat;
+    }
+    return repeat;
+}
+
+void UploadProfile(const ProfileDefinition& profile) {
+    ProfileEngine& engine = ProfileEngine::getInstance();
+    if (engine.IsRunning()) {
+        (void)engine.CancelRunning();
+    }
+    std::vector<ProfileValidationError> errors;
+    if (engine.SetUploadedProfile(profile, &errors) != ESP_OK) {
+        Fail(errors.empty() ? "profile rejected" : errors.front().message.c_str());
+    }
+}
+
+void RestartUploadedProfile() {
+    ProfileEngine& engine = ProfileEngine::getInstance();
+    if (engine.IsRunning()) {
+        (void)engine.CancelRunning();
+    }
+    host::GetFakeController().setPointC = 25.0;
+    if (engine.StartFromUploaded() != ESP_OK) {
+        Fail("StartFromUploaded failed");
+    }
+}
+
+Sample RunProfileTickRamp() {
+    host::GetFakeController().feedforwardEnabled = true;
+    UploadProfile(RampProfile());
+    RestartUploadedProfile();
+
+    ProfileEngine& engine = ProfileEngine::getInstance();
+    const Clock::time_point start = Clock::now();
+    for (int i = 0; i < RAMP_TICKS; ++i) {
+        engine.Tick(RAMP_TICK_S);
+    }
+    const double elapsedNs = ElapsedNs(start);
+    if (engine.GetRuntimeStatus().currentStepNumber != 2) {
+        Fail("ramp profile left the ramp step");
+    }
+    return {elapsedNs, RAMP_TICKS};
+}
+
+Sample RunProfileTickJumpBurst() {
+    static const int outerRepeat = CalibrateJumpBurstRepeat();
+    host::GetFakeController().feedforwardEnabled = true;
+    UploadProfile(JumpBurstProfile(outerRepeat));
+
+    ProfileEngine& engine = ProfileEngine::getInstance();
+    double elapsedNs = 0.0;
+    for (int i = 0; i < JUMP_BURSTS; ++i) {
+        RestartUploadedProfile();
+        const Clock::time_point start = Clock::now();
+        engine.Tick(JUMP_BURST_TICK_S);
+        elapsedNs += ElapsedNs(start);
+    }
+    if (engine.GetRuntimeStatus().currentStepNumber != ProfileEngine::MAX_STEPS) {
+        Fail("jump burst did not reach the final step");
+    }
+    return {elapsedNs, JUMP_BURSTS};
+}
+
+Sample RunProfileJsonSerialize() {
+    const ProfileDefinition profile = JumpBurstProfile(3);
+    ProfileEngine& engine = ProfileEngine::getInstance();
+    std::size_t bytes = 0;
+
+    const Clock::time_point start = Clock::now();
+    for (int i = 0; i < JSON_ITERATIONS; ++i) {
+        bytes += engine.SerializeProfileJson(profile).size();
+    }
+    const double elapsedNs = ElapsedNs(start);
+    if (bytes == 0) {
+        Fail("profile serialization produced no output");
+    }
+    return {elapsedNs, JSON_ITERATIONS};
+}
+
+Sample RunProfileJsonParse() {
+    ProfileEngine& engine = ProfileEngine::getInstance();
+    const std::string json = engine.SerializeProfileJson(JumpBurstProfile(3));
+    ProfileDefinition parsed;
+    std::vector<ProfileValidationError> errors;
+
+    const Clock::time_point start = Clock::now();
+    for (int i = 0; i < JSON_ITERATIONS; ++i) {
+        if (engine.ParseProfileJson(json, parsed, errors) != ESP_OK) {
+            Fail("profile JSON did not parse");
+        }
+    }
+    return {ElapsedNs(start), JSON_ITERATIONS};
+}
+
+// --- History ----------------------------------------------------------------
+
+// The ring is sized once in the DataManager constructor, so the settings must
+// ask for more than it can hold before the first getInstance().
+DataManager& HistoryManager() {
+    static DataManager& manager = [] () -> DataManager& {
+        (void)SettingsManager::getInstance().SetMaxDataLogTimeMs(1000 * 60 * 60 * 24);
+        return DataManager::getInstance();
+    }();
+    return manager;
+}
+
+Sample RunHistoryAppend() {
+    DataManager& manager = HistoryManager();
+    const std::size_t points = manager.GetMaxDataPoints();
+    host::FakeController& fake = host::GetFakeController();
+    fake.running = true;
+    fake.processValueC = 120.0;
+
+    const Clock::time_point start = Clock::now();
+    if (host::RunTask("DataLogTask", points) != ESP_OK) {
+        Fail("DataLogTask is not running");
+    }
+    return {ElapsedNs(start), points};
+}
+
+// Fills the raw ring and the 10 s tier so the reads below see a full history.
+DataManager& FilledHistory() {
+    DataManager& manager = HistoryManager();
+    static const bool filled = [&manager] {
+        const std::size_t rollupPoints = manager.GetMaxRollupCount(DataResolution::TenSeconds) * 10;
+        return host::RunTask("DataLogTask", std::max(manager.GetMaxDataPoints(), rollupPoints)) == ESP_OK;
+    }();
+    if (!filled) {
+        Fail("DataLogTask is not running");
+    }
+    return manager;
+}
+
+Sample RunHistoryReadRaw() {
+    DataManager& manager = FilledHistory();
+    DataPoint batch[HISTORY_READ_BATCH];
+    uint64_t points = 0;
+
+    const Clock::time_point start = Clock::now();
+    DataHistoryCursor cursor = manager.OpenHistoryCursor(0);
+    std::size_t read = 0;
+    while ((read = manager.ReadHistoryBatch(cursor, batch, HISTORY_READ_BATCH)) > 0) {
+        points += read;
+    }
+    return {ElapsedNs(start), points};
+}
+
+Sample RunHistoryReadRollup() {
+    DataManager& manager = FilledHistory();
+    DataRollup batch[HISTORY_READ_BATCH];
+    uint64_t rollups = 0;
+
+    const Clock::time_point start = Clock::now();
+    DataHistoryCursor cursor = manager.OpenHistoryCursor(0, DataResolution::TenSeconds);
+    std::size_t read = 0;
+    while ((read = manager.ReadRollupBatch(cursor, batch, HISTORY_READ_BATCH)) > 0) {
+        rollups += read;
+    }
+    return {ElapsedNs(start), rollups};
+}
+
+Sample RunHistoryEncodeBinary() {
+    static const std::vector<DataPoint> points = [] {
+        DataManager& manager = FilledHistory();
+        std::vector<DataPoint> out(manager.GetDataPointCount());
+        DataHistoryCursor cursor = manager.OpenHistoryCursor(0);
+        out.resize(manager.ReadHistoryBatch(cursor, out.data(), out.size()));
+        return out;
+    }();
+    if (points.empty()) {
+        Fail("no history to encode");
+    }
+    static std::vector<uint8_t> buffer(HistoryBinaryEncoder::HEADER_SIZE + points.size() * HistoryBinaryEncoder::MAX_RECORD_SIZE);
+
+    const Clock::time_point start = Clock::now();
+    HistoryBinaryEncoder encoder;
+    encoder.EncodeHeader(points.front().timestamp, points.front().sequence, points.front().sequence,
+                         points.back().sequence + 1, 0, points.front().zoneCount, buffer.data());
+    uint8_t* out = buffer.data() + HistoryBinaryEncoder::HEADER_SIZE;
+    for (const DataPoint& point : points) {
+        encoder.EncodeRecord(point, out);
+        out += encoder.GetRecordSize();
+    }
+    return {ElapsedNs(start), points.size()};
+}
+
+// --- PWM --------------------------------------------------------------------
+
+void DiscardOutput(uint32_t onMask, uint32_t channelMask, void* userCtx) {
+    *static_cast<volatile uint32_t*>(userCtx) = onMask & channelMask;
+}
+
+Sample RunPwmAlarms(PWM::Mode mode) {
+    volatile uint32_t outputs = 0;
+    PWM pwm(1000, 0.37f, &DiscardOutput, const_cast<uint32_t*>(&outputs));
+    const float weights[PWM::MAX_CHANNELS] = {1.0f, 0.5f, 0.25f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+    (void)pwm.SetChannelWeights(0x0F, weights);
+    (void)pwm.SetMode(mode, 50);
+    if (pwm.Start() != ESP_OK) {
+        Fail("PWM failed to start");
+    }
+
+    const Clock::time_point start = Clock::now();
+    for (int i = 0; i < PWM_ALARMS; ++i) {
+        if (!host::FireTimerAlarm()) {
+            Fail("PWM stopped arming its alarm");
+        }
+    }
+    const double elapsedNs = ElapsedNs(start);
+    (void)pwm.Stop();
+    return {elapsedNs, PWM_ALARMS};
+}
+
+Sample RunPwmWindowAlarm() {
+    return RunPwmAlarms(PWM::Mode::Window);
+}
+
+Sample RunPwmBurstAlarm() {
+    return RunPwmAlarms(PWM::Mode::BurstFire);
+}
+
+const Benchmark BENCHMARKS[] = {
+    {"pid_calculate_float", "tick", &RunPidCalculateFloat},
+    {"pid_calculate_double", "tick", &RunPidCalculateDouble},
+    {"pv_pipeline_pass", "pass", &RunPvPipelinePass},
+    {"profile_tick_ramp_lookahead", "tick", &RunProfileTickRamp},
+    {"profile_tick_jump_burst", "tick", &RunProfileTickJumpBurst},
+    {"profile_json_serialize", "profile", &RunProfileJsonSerialize},
+    {"profile_json_parse", "profile", &RunProfileJsonParse},
+    {"history_append", "point", &RunHistoryAppend},
+    {"history_read_raw", "point", &RunHistoryReadRaw},
+    {"history_read_rollup_10s", "rollup", &RunHistoryReadRollup},
+    {"history_encode_binary", "point", &RunHistoryEncodeBinary},
+    {"pwm_window_alarm", "alarm", &RunPwmWindowAlarm},
+    {"pwm_burst_alarm", "alarm", &RunPwmBurstAlarm},
+};
+
+// --- Harness ----------------------------------------------------------------
+
+// One warm-up run, then the median and minimum over the timed repeats.
+Result RunBenchmark(const Benchmark& bench, int repeats) {
+    (void)bench.run();
+
+    std::vector<double> nsPerOp;
+    nsPerOp.reserve(static_cast<std::size_t>(repeats));
+    uint64_t ops = 0;
+    for (int i = 0; i < repeats; ++i) {
+        const Sample sample = bench.run();
+        if (sample.ops == 0) {
+            Fail("benchmark timed no operations");
+        }
+        ops = sample.ops;
+        nsPerOp.push_back(sample.elapsedNs / static_cast<double>(sample.ops));
+    }
+    std::sort(nsPerOp.begin(), nsPerOp.end());
+
+    Result result;
+    result.name = bench.name;
+    result.unit = bench.unit;
+    const std::size_t mid = nsPerOp.size() / 2;
+    result.medianNs = (nsPerOp.size() % 2 != 0) ? nsPerOp[mid] : (nsPerOp[mid - 1] + nsPerOp[mid]) / 2.0;
+    result.minNs = nsPerOp.front();
+    result.ops = ops;
+    return result;
+}
+
+const char* MathTypeName() {
+    return sizeof(control_real_t) == sizeof(double) ? "double" : "float";
+}
+
+bool ReadFile(const char* path, std::string& out) {
+    FILE* file = std::fopen(path, "rb");
+    if (file == nullptr) {
+        return false;
+    }
+    char chunk[4096];
+    std::size_t read = 0;
+    while ((read = std::fread(chunk, 1, sizeof(chunk), file)) > 0) {
+        out.append(chunk, read);
+    }
+    std::fclose(file);
+    return true;
+}
+
+// Median ns/op per benchmark from an earlier --json file.
+std::map<std::string, double> LoadBaseline(const char* path) {
+    std::string text;
+    if (!ReadFile(path, text)) {
+        Fail("cannot read the baseline file");
+    }
+    cJSON* root = cJSON_Parse(text.c_str());
+    cJSON* results = cJSON_GetObjectItem(root, "results");
+    if (!cJSON_IsArray(results)) {
+        cJSON_Delete(root);
+        Fail("baseline file has no results array");
+    }
+
+    std::map<std::string, double> baseline;
+    cJSON* entry = nullptr;
+    cJSON_ArrayForEach(entry, results) {
+        cJSON* name = cJSON_GetObjectItem(entry, "name");
+        cJSON* median = cJSON_GetObjectItem(entry, "median_ns");
+        if (cJSON_IsString(name) && cJSON_IsNumber(median)) {
+            baseline[name->valuestring] = median->valuedouble;
+        }
+    }
+    cJSON_Delete(root);
+    return baseline;
+}
+
+bool WriteResultsJson(const char* path, const std::vector<Result>& results, int repeats) {
+    cJSON* root = cJSON_CreateObject();
+    cJSON_AddNumberToObject(root, "schema", RESULT_SCHEMA_VERSION);
+    cJSON_AddStringToObject(root, "math", MathTypeName());
+    cJSON_AddNumberToObject(root, "repeats", repeats);
+    cJSON* list = cJSON_AddArrayToObject(root, "results");
+    for (const Result& result : results) {
+        cJSON* entry = cJSON_CreateObject();
+        cJSON_AddStringToObject(entry, "name", result.name.c_str());
+        cJSON_AddStringToObject(entry, "unit", result.unit.c_str());
+        cJSON_AddNumberToObject(entry, "median_ns", result.medianNs);
+        cJSON_AddNumberToObject(entry, "min_ns", result.minNs);
+        cJSON_AddNumberToObject(entry, "ops", static_cast<double>(result.ops));
+        cJSON_AddItemToArray(list, entry);
+    }
+
+    char* text = cJSON_Print(root);
+    cJSON_Delete(root);
+    if (text == nullptr) {
+        return false;
+    }
+    FILE* file = std::fopen(path, "wb");
+    bool ok = (file != nullptr);
+    if (ok) {
+        ok = std::fputs(text, file) >= 0 && std::fputc('\n', file) != EOF;
+        ok = (std::fclose(file) == 0) && ok;
+    }
+    cJSON_free(text);
+    return ok;
+}
+
+void PrintUsage() {
+    std::fprintf(stderr,
+        "usage: control_bench [--repeats N] [--filter SUBSTRING] [--json OUT] [--baseline IN] [--list]\n");
+}
+}
+
+int main(int argc, char** argv) {
+    int repeats = DEFAULT_REPEATS;
+    const char* filter = nullptr;
+    const char* jsonPath = nullptr;
+    const char* baselinePath = nullptr;
+
+    for (int i = 1; i < argc; ++i) {
+        const bool hasValue = (i + 1 < argc);
+        if (std::strcmp(argv[i], "--repeats") == 0 && hasValue) {
+            repeats = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--filter") == 0 && hasValue) {
+            filter = argv[++i];
+        } else if (std::strcmp(argv[i], "--json") == 0 && hasValue) {
+            jsonPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--baseline") == 0 && hasValue) {
+            baselinePath = argv[++i];
+        } else if (std::strcmp(argv[i], "--list") == 0) {
+            for (const Benchmark& bench : BENCHMARKS) {
+                std::printf("%s\n", bench.name);
+            }
+            return 0;
+        } else {
+            PrintUsage();
+            return 2;
+        }
+    }
+    if (repeats < 1) {
+        PrintUsage();
+        return 2;
+    }
+
+    const std::map<std::string, double> baseline =
+        (baselinePath != nullptr) ? LoadBaseline(baselinePath) : std::map<std::string, double>{};
+
+    std::printf("control math: %s, %d repeats, median (min) per op\n", MathTypeName(), repeats);
+    std::vector<Result> results;
+    for (const Benchmark& bench : BENCHMARKS) {
+        if (filter != nullptr && std::strstr(bench.name, filter) == nullptr) {
+            continue;
+        }
+        const Result result = RunBenchmark(bench, repeats);
+        results.push_back(result);
+
+        std::printf("%-28s %12.1f ns (%10.1f) / %-7s x%-8llu", result.name.c_str(), result.medianNs, result.minNs,
+                    result.unit.c_str(), static_cast<unsigned long long>(result.ops));
+        auto base = baseline.find(result.name);
+        if (base != baseline.end() && base->second > 0.0) {
+            std::printf(" %+7.1f%%", (result.medianNs - base->second) / base->second * 100.0);
+        }
+        std::printf("\n");
+    }
+
+    if (jsonPath != nullptr && !WriteResultsJson(jsonPath, results, repeats)) {
+        Fail("cannot write the results file");
+    }
+    return 0;
+}
@@ -0,0 +1,156 @@
+// Stand-ins for the firmware singletons that own real hardware, NVS-backed
+// settings or the flash run log. They expose only what the core modules built
+// for the host call, backed by host::FakeController so a benchmark can steer
+// the "plant" directly.
+#include "HostHal.hpp"
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "Controller.hpp"
+#include "HardwareManager.hpp"
+#include "RunLogManager.hpp"
+#include "SettingsManager.hpp"
+
+#include <cstring>
+
+// --- Controller -------------------------------------------------------------
+
+Controller* Controller::instance = nullptr;
+
+Controller& Controller::getInstance() {
+    if (instance == nullptr) {
+        instance = new Controller();
+    }
+    return *instance;
+}
+
+Controller::Controller() : relayPWM(1000, 0.0f, nullptr) {}
+
+ControllerSnapshot Controller::GetSnapshot() const {
+    const host::FakeController& fake = host::GetFakeController();
+    ControllerSnapshot snapshot;
+    snapshot.running = fake.running;
+    snapshot.setpointLockedByProfile = fake.setpointLockedByProfile;
+    std::strncpy(snapshot.state, fake.running ? "Running" : "Idle", sizeof(snapshot.state) - 1);
+    snapshot.setPoint = fake.setPointC;
+    snapshot.processValue = fake.processValueC;
+    snapshot.pidOutput = fake.pidOutputPct;
+    snapshot.zoneProcessValue[0] = fake.processValueC;
+    snapshot.zoneOutput[0] = fake.pidOutputPct;
+    return snapshot;
+}
+
+uint8_t Controller::GetZoneCount() const {
+    return 1;
+}
+
+double Controller::GetSetPoint() const {
+    return host::GetFakeController().setPointC;
+}
+
+double Controller::GetProcessValue() const {
+    return host::GetFakeController().processValueC;
+}
+
+bool Controller::IsRunning() const {
+    return host::GetFakeController().running;
+}
+
+bool Controller::IsFeedforwardEnabled() const {
+    return host::GetFakeController().feedforwardEnabled;
+}
+
+double Controller::GetFeedforwardLookaheadS() const {
+    return host::GetFakeController().feedforwardLookaheadS;
+}
+
+esp_err_t Controller::Start() {
+    host::GetFakeController().running = true;
+    return ESP_OK;
+}
+
+esp_err_t Controller::Stop() {
+    host::FakeController& fake = host::GetFakeController();
+    fake.running = false;
+    fake.setpointLockedByProfile = false;
+    return ESP_OK;
+}
+
+esp_err_t Controller::SetSetPointFromProfile(double newSetPoint) {
+    host::GetFakeController().setPointC = newSetPoint;
+    return ESP_OK;
+}
+
+void Controller::SetProfileSetpointLock(bool locked) {
+    host::GetFakeController().setpointLockedByProfile = locked;
+}
+
+void Controller::SetProfileTrajectory(double setPointAheadC, double rateCPerS) {
+    host::FakeController& fake = host::GetFakeController();
+    fake.trajectoryAheadC = setPointAheadC;
+    fake.trajectoryRateCPerS = rateCPerS;
+}
+
+// --- HardwareManager --------------------------------------------------------
+
+HardwareManager* HardwareManager::instance = nullptr;
+
+HardwareManager& HardwareManager::getInstance() {
+    if (instance == nullptr) {
+        instance = new HardwareManager();
+    }
+    return *instance;
+}
+
+HardwareManager::HardwareManager() {}
+
+double HardwareManager::getThermocoupleValue(int index) {
+    if (index < 0 || index >= NUM_THERMOCOUPLES) {
+        return THERMOCOUPLE_ERROR_VALUE;
+    }
+    return host::GetFakeController().processValueC;
+}
+
+double HardwareManager::getServoAngle() {
+    return servoAngle;
+}
+
+// --- SettingsManager --------------------------------------------------------
+
+SettingsManager* SettingsManager::instance = nullptr;
+
+SettingsManager& SettingsManager::getInstance() {
+    if (instance == nullptr) {
+        instance = new SettingsManager();
+    }
+    return *instance;
+}
+
+SettingsManager::SettingsManager() {}
+
+esp_err_t SettingsManager::SetDataLogIntervalMs(int32_t newValue) {
+    dataLogIntervalMs = newValue;
+    return ESP_OK;
+}
+
+esp_err_t SettingsManager::SetMaxDataLogTimeMs(int32_t newValue) {
+    maxDataLogTimeMs = newValue;
+    return ESP_OK;
+}
+
+// --- RunLogManager ----------------------------------------------------------
+
+RunLogManager* RunLogManager::instance = nullptr;
+
+RunLogManager::RunLogManager() {}
+
+RunLogManager& RunLogManager::getInstance() {
+    if (instance == nullptr) {
+        instance = new RunLogManager();
+    }
+    return *instance;
+}
+
+// The run log's cost is a flash page append; not a core-loop cost.
+void RunLogManager::Append(const DataPoint& /*point*/) {}
@@ -0,0 +1,470 @@
+#include "HostHal.hpp"
+
+#include "driver/gptimer.h"
+#include "esp_cpu.h"
+#include "esp_err.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "nvs.h"
+#include "nvs_flash.h"
+#include "sdkconfig.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace {
+constexpr int64_t START_TIME_US = 1000000;
+constexpr std::size_t REPORTED_FREE_HEAP_BYTES = 8u * 1024u * 1024u;
+
+int64_t nowUs = START_TIME_US;
+
+// --- Tasks ------------------------------------------------------------------
+
+struct HostTask {
+    TaskFunction_t function = nullptr;
+    void* arg = nullptr;
+    std::string name;
+};
+
+// Thrown through the task's own frames to leave it, as a real context switch
+// away from a parked or deleted task would.
+struct TaskExit {};
+
+std::vector<std::unique_ptr<HostTask>> tasks;
+HostTask* runningTask = nullptr;
+std::size_t delayBudget = 0;
+std::size_t delaysTaken = 0;
+
+TaskHandle_t ToHandle(HostTask* task) {
+    return reinterpret_cast<TaskHandle_t>(task);
+}
+
+HostTask* FromHandle(TaskHandle_t handle) {
+    return reinterpret_cast<HostTask*>(handle);
+}
+
+void RemoveTask(HostTask* task) {
+    for (auto it = tasks.begin(); it != tasks.end(); ++it) {
+        if (it->get() == task) {
+            tasks.erase(it);
+            return;
+        }
+    }
+}
+
+// --- Timers -----------------------------------------------------------------
+
+gptimer_t* lastTimer = nullptr;
+
+// --- NVS --------------------------------------------------------------------
+
+std::map<std::string, std::vector<uint8_t>> nvsValues;
+std::map<nvs_handle_t, std::string> nvsNamespaces;
+nvs_handle_t nextNvsHandle = 1;
+
+bool NvsKey(nvs_handle_t handle, const char* key, std::string& outKey) {
+    auto ns = nvsNamespaces.find(handle);
+    if (ns == nvsNamespaces.end() || key == nullptr) {
+        return false;
+    }
+    outKey = ns->second + "/" + key;
+    return true;
+}
+}
+
+// Counting semaphore; a mutex is one created with a single token.
+struct QueueDefinition {
+    std::mutex mutex;
+    std::condition_variable available;
+    unsigned tokens = 0;
+};
+
+struct gptimer_t {
+    gptimer_alarm_cb_t onAlarm = nullptr;
+    void* userContext = nullptr;
+    uint64_t count = 0;
+    uint64_t alarmCount = 0;
+    bool alarmArmed = false;
+    bool running = false;
+};
+
+// --- esp_err / esp_log --------------------------------------------------------
+
+const char* esp_err_to_name(esp_err_t code) {
+    switch (code) {
+        case ESP_OK: return "ESP_OK";
+        case ESP_FAIL: return "ESP_FAIL";
+        case ESP_ERR_NO_MEM: return "ESP_ERR_NO_MEM";
+        case ESP_ERR_INVALID_ARG: return "ESP_ERR_INVALID_ARG";
+        case ESP_ERR_INVALID_STATE: return "ESP_ERR_INVALID_STATE";
+        case ESP_ERR_INVALID_SIZE: return "ESP_ERR_INVALID_SIZE";
+        case ESP_ERR_NOT_FOUND: return "ESP_ERR_NOT_FOUND";
+        case ESP_ERR_NOT_SUPPORTED: return "ESP_ERR_NOT_SUPPORTED";
+        case ESP_ERR_TIMEOUT: return "ESP_ERR_TIMEOUT";
+        case ESP_ERR_INVALID_CRC: return "ESP_ERR_INVALID_CRC";
+        case ESP_ERR_INVALID_VERSION: return "ESP_ERR_INVALID_VERSION";
+        case ESP_ERR_NVS_NOT_FOUND: return "ESP_ERR_NVS_NOT_FOUND";
+        case ESP_ERR_NVS_INVALID_HANDLE: return "ESP_ERR_NVS_INVALID_HANDLE";
+        case ESP_ERR_NVS_INVALID_LENGTH: return "ESP_ERR_NVS_INVALID_LENGTH";
+        default: return "ESP_ERR_UNKNOWN";
+    }
+}
+
+void host_log_write(char level, const char* tag, const char* format, ...) {
+    std::fprintf(stderr, "%c (%s) ", level, tag);
+    va_list args;
+    va_start(args, format);
+    std::vfprintf(stderr, format, args);
+    va_end(args);
+    std::fputc('\n', stderr);
+}
+
+// --- esp_timer / esp_cpu ------------------------------------------------------
+
+int64_t esp_timer_get_time(void) {
+    return nowUs;
+}
+
+esp_cpu_cycle_count_t esp_cpu_get_cycle_count(void) {
+    const auto ns = std::chrono::steady_clock::now().time_since_epoch();
+    const int64_t cycles = std::chrono::duration_cast<std::chrono::nanoseconds>(ns).count()
+        * CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ / 1000;
+    return static_cast<esp_cpu_cycle_count_t>(cycles);
+}
+
+int esp_cpu_get_core_id(void) {
+    return 0;
+}
+
+// --- Heap -------------------------------------------------------------------
+
+void* heap_caps_malloc(size_t size, uint32_t /*caps*/) {
+    return std::malloc(size);
+}
+
+void* heap_caps_calloc(size_t n, size_t size, uint32_t /*caps*/) {
+    return std::calloc(n, size);
+}
+
+void heap_caps_free(void* ptr) {
+    std::free(ptr);
+}
+
+size_t heap_caps_get_free_size(uint32_t /*caps*/) {
+    return REPORTED_FREE_HEAP_BYTES;
+}
+
+size_t heap_caps_get_largest_free_block(uint32_t /*caps*/) {
+    return REPORTED_FREE_HEAP_BYTES;
+}
+
+// --- FreeRTOS ---------------------------------------------------------------
+
+BaseType_t xPortInIsrContext(void) {
+    return pdFALSE;
+}
+
+static BaseType_t CreateTask(TaskFunction_t function, const char* name, void* arg, TaskHandle_t* outHandle) {
+    auto task = std::make_unique<HostTask>();
+    task->function = function;
+    task->arg = arg;
+    task->name = (name != nullptr) ? name : "";
+    if (outHandle != nullptr) {
+        *outHandle = ToHandle(task.get());
+    }
+    tasks.push_back(std::move(task));
+    return pdPASS;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t task, const char* name, uint32_t /*stack_depth*/, void* arg,
+                       UBaseType_t /*priority*/, TaskHandle_t* out_handle) {
+    return CreateTask(task, name, arg, out_handle);
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t task, const char* name, uint32_t /*stack_depth*/, void* arg,
+                                   UBaseType_t /*priority*/, TaskHandle_t* out_handle, BaseType_t /*core_id*/) {
+    return CreateTask(task, name, arg, out_handle);
+}
+
+void vTaskDelete(TaskHandle_t task) {
+    HostTask* target = (task == nullptr) ? runningTask : FromHandle(task);
+    if (target == nullptr) {
+        return;
+    }
+    const bool self = (target == runningTask);
+    RemoveTask(target);
+    if (self) {
+        runningTask = nullptr;
+        throw TaskExit{};
+    }
+}
+
+void vTaskDelay(TickType_t ticks) {
+    nowUs += static_cast<int64_t>(ticks) * 1000 / (1000 / configTICK_RATE_HZ);
+    if (runningTask != nullptr && delayBudget > 0 && ++delaysTaken >= delayBudget) {
+        throw TaskExit{};
+    }
+}
+
+TickType_t xTaskGetTickCount(void) {
+    return static_cast<TickType_t>(nowUs / 1000);
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void) {
+    return ToHandle(runningTask);
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void) {
+    auto* semaphore = new QueueDefinition();
+    semaphore->tokens = 1;
+    return semaphore;
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void) {
+    return new QueueDefinition();
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticks_to_wait) {
+    if (semaphore == nullptr) {
+        return pdFALSE;
+    }
+    std::unique_lock<std::mutex> lock(semaphore->mutex);
+    const auto hasToken = [semaphore] { return semaphore->tokens > 0; };
+    if (ticks_to_wait == portMAX_DELAY) {
+        semaphore->available.wait(lock, hasToken);
+    } else if (!semaphore->available.wait_for(lock, std::chrono::milliseconds(ticks_to_wait), hasToken)) {
+        return pdFALSE;
+    }
+    semaphore->tokens--;
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore) {
+    if (semaphore == nullptr) {
+        return pdFALSE;
+    }
+    {
+        std::lock_guard<std::mutex> lock(semaphore->mutex);
+        semaphore->tokens++;
+    }
+    semaphore->available.notify_one();
+    return pdTRUE;
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t semaphore) {
+    delete semaphore;
+}
+
+// --- gptimer ----------------------------------------------------------------
+
+esp_err_t gptimer_new_timer(const gptimer_config_t* config, gptimer_handle_t* ret_timer) {
+    if (config == nullptr || ret_timer == nullptr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    *ret_timer = new gptimer_t();
+    lastTimer = *ret_timer;
+    return ESP_OK;
+}
+
+esp_err_t gptimer_del_timer(gptimer_handle_t timer) {
+    if (timer == lastTimer) {
+        lastTimer = nullptr;
+    }
+    delete timer;
+    return ESP_OK;
+}
+
+esp_err_t gptimer_register_event_callbacks(gptimer_handle_t timer, const gptimer_event_callbacks_t* cbs, void* user_data) {
+    if (timer == nullptr || cbs == nullptr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    timer->onAlarm = cbs->on_alarm;
+    timer->userContext = user_data;
+    return ESP_OK;
+}
+
+esp_err_t gptimer_set_alarm_action(gptimer_handle_t timer, const gptimer_alarm_config_t* config) {
+    if (timer == nullptr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    timer->alarmArmed = (config != nullptr);
+    timer->alarmCount = (config != nullptr) ? config->alarm_count : 0;
+    return ESP_OK;
+}
+
+esp_err_t gptimer_enable(gptimer_handle_t timer) {
+    return (timer == nullptr) ? ESP_ERR_INVALID_ARG : ESP_OK;
+}
+
+esp_err_t gptimer_disable(gptimer_handle_t timer) {
+    return (timer == nullptr) ? ESP_ERR_INVALID_ARG : ESP_OK;
+}
+
+esp_err_t gptimer_start(gptimer_handle_t timer) {
+    if (timer == nullptr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    timer->running = true;
+    return ESP_OK;
+}
+
+esp_err_t gptimer_stop(gptimer_handle_t timer) {
+    if (timer == nullptr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    timer->running = false;
+    return ESP_OK;
+}
+
+esp_err_t gptimer_get_raw_count(gptimer_handle_t timer, uint64_t* value) {
+    if (timer == nullptr || value == nullptr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    *value = timer->count;
+    return ESP_OK;
+}
+
+// --- NVS --------------------------------------------------------------------
+
+esp_err_t nvs_flash_init_partition(const char* /*partition_label*/) {
+    return ESP_OK;
+}
+
+esp_err_t nvs_flash_erase_partition(const char* /*partition_label*/) {
+    nvsValues.clear();
+    return ESP_OK;
+}
+
+esp_err_t nvs_open(const char* name, nvs_open_mode_t open_mode, nvs_handle_t* out_handle) {
+    return nvs_open_from_partition("nvs", name, open_mode, out_handle);
+}
+
+esp_err_t nvs_open_from_partition(const char* part_name, const char* name, nvs_open_mode_t /*open_mode*/, nvs_handle_t* out_handle) {
+    if (part_name == nullptr || name == nullptr || out_handle == nullptr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    *out_handle = nextNvsHandle++;
+    nvsNamespaces[*out_handle] = std::string(part_name) + ":" + name;
+    return ESP_OK;
+}
+
+void nvs_close(nvs_handle_t handle) {
+    nvsNamespaces.erase(handle);
+}
+
+esp_err_t nvs_commit(nvs_handle_t handle) {
+    return nvsNamespaces.count(handle) != 0 ? ESP_OK : ESP_ERR_NVS_INVALID_HANDLE;
+}
+
+esp_err_t nvs_erase_key(nvs_handle_t handle, const char* key) {
+    std::string fullKey;
+    if (!NvsKey(handle, key, fullKey)) {
+        return ESP_ERR_NVS_INVALID_HANDLE;
+    }
+    return nvsValues.erase(fullKey) != 0 ? ESP_OK : ESP_ERR_NVS_NOT_FOUND;
+}
+
+esp_err_t nvs_set_blob(nvs_handle_t handle, const char* key, const void* value, size_t length) {
+    std::string fullKey;
+    if (!NvsKey(handle, key, fullKey)) {
+        return ESP_ERR_NVS_INVALID_HANDLE;
+    }
+    const auto* bytes = static_cast<const uint8_t*>(value);
+    nvsValues[fullKey].assign(bytes, bytes + length);
+    return ESP_OK;
+}
+
+esp_err_t nvs_get_blob(nvs_handle_t handle, const char* key, void* out_value, size_t* length) {
+    std::string fullKey;
+    if (!NvsKey(handle, key, fullKey) || length == nullptr) {
+        return ESP_ERR_NVS_INVALID_HANDLE;
+    }
+    auto it = nvsValues.find(fullKey);
+    if (it == nvsValues.end()) {
+        return ESP_ERR_NVS_NOT_FOUND;
+    }
+    if (out_value == nullptr) {
+        *length = it->second.size();
+        return ESP_OK;
+    }
+    if (*length < it->second.size()) {
+        return ESP_ERR_NVS_INVALID_LENGTH;
+    }
+    std::memcpy(out_value, it->second.data(), it->second.size());
+    *length = it->second.size();
+    return ESP_OK;
+}
+
+// --- Host controls ----------------------------------------------------------
+
+namespace host {
+
+void AdvanceTimeUs(int64_t us) {
+    nowUs += us;
+}
+
+esp_err_t RunTask(const char* name, std::size_t maxDelays) {
+    HostTask* task = nullptr;
+    for (const auto& candidate : tasks) {
+        if (candidate->name == name) {
+            task = candidate.get();
+            break;
+        }
+    }
+    if (task == nullptr) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    HostTask* const previousTask = runningTask;
+    const std::size_t previousBudget = delayBudget;
+    const std::size_t previousTaken = delaysTaken;
+    runningTask = task;
+    delayBudget = maxDelays;
+    delaysTaken = 0;
+    try {
+        task->function(task->arg);
+        // A FreeRTOS task must not return; treat it like vTaskDelete(nullptr).
+        if (runningTask != nullptr) {
+            RemoveTask(runningTask);
+        }
+    } catch (const TaskExit&) {
+    }
+    runningTask = previousTask;
+    delayBudget = previousBudget;
+    delaysTaken = previousTaken;
+    return ESP_OK;
+}
+
+bool FireTimerAlarm() {
+    gptimer_t* timer = lastTimer;
+    if (timer == nullptr || !timer->running || !timer->alarmArmed || timer->onAlarm == nullptr) {
+        return false;
+    }
+    timer->count = timer->alarmCount;
+    timer->alarmArmed = false;
+    gptimer_alarm_event_data_t event = {};
+    event.count_value = timer->count;
+    event.alarm_value = timer->alarmCount;
+    (void)timer->onAlarm(timer, &event, timer->userContext);
+    return true;
+}
+
+FakeController& GetFakeController() {
+    static FakeController controller;
+    return controller;
+}
+
+} // namespace host
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "driver/gptimer.h"
+#include "esp_err.h"
+#include <cstddef>
+#include <cstdint>
+
+// Host-only controls over the shimmed ESP-IDF/FreeRTOS layer. Nothing here
+// exists on the target; only the host benchmarks use it.
+namespace host {
+
+// Virtual esp_timer clock; starts at 1 s so timestamps are never zero.
+void AdvanceTimeUs(int64_t us);
+
+// Runs a task created with xTaskCreate*() on the calling thread. It returns
+// when the task function returns, deletes itself, or has called vTaskDelay()
+// maxDelays times (0 = no limit). A task parked that way stays registered and
+// starts again from its entry function on the next call. ESP_ERR_NOT_FOUND
+// when no such task exists.
+esp_err_t RunTask(const char* name, std::size_t maxDelays = 0);
+
+// Jumps the most recently created gptimer to its armed alarm and runs the
+// alarm callback once. false when no timer is running with an alarm armed.
+bool FireTimerAlarm();
+
+// State behind the Controller and HardwareManager fakes.
+struct FakeController {
+    bool running = false;
+    double setPointC = 25.0;
+    double processValueC = 25.0;
+    double pidOutputPct = 0.0;
+    bool setpointLockedByProfile = false;
+    bool feedforwardEnabled = true;
+    double feedforwardLookaheadS = 30.0;
+    double trajectoryAheadC = 0.0;
+    double trajectoryRateCPerS = 0.0;
+};
+
+FakeController& GetFakeController();
+
+} // namespace host
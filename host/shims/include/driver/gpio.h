@@ -0,0 +1,4 @@
+#pragma once
+
+// Types only: HardwareManager is replaced by a fake on the host.
+typedef int gpio_num_t;
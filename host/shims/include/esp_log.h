@@ -0,0 +1,10 @@
+#pragma once
+
+// Errors and warnings go to stderr; info and debug are dropped so benchmark
+// output stays machine-readable.
+void host_log_write(char level, const char* tag, const char* format, ...) __attribute__((format(printf, 3, 4)));
+
+#define ESP_LOGE(tag, format, ...) host_log_write('E', tag, format, ##__VA_ARGS__)
+#define ESP_LOGW(tag, format, ...) host_log_write('W', tag, format, ##__VA_ARGS__)
+#define ESP_LOGI(tag, format, ...) do { (void)(tag); if (0) host_log_write('I', tag, format, ##__VA_ARGS__); } while (0)
+#define ESP_LOGD(tag, format, ...) do { (void)(tag); if (0) host_log_write('D', tag, format, ##__VA_ARGS__); } while (0)
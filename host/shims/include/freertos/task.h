@@ -0,0 +1,17 @@
+#pragma once
+
+#include "FreeRTOS.h"
+
+// Tasks do not run on their own: host::RunTask() runs one on the calling
+// thread, and vTaskDelay() advances the virtual clock instead of sleeping.
+typedef struct tskTaskControlBlock* TaskHandle_t;
+typedef void (*TaskFunction_t)(void* arg);
+
+#define tskIDLE_PRIORITY 0
+
+BaseType_t xTaskCreate(TaskFunction_t task, const char* name, uint32_t stack_depth, void* arg, UBaseType_t priority, TaskHandle_t* out_handle);
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t task, const char* name, uint32_t stack_depth, void* arg, UBaseType_t priority, TaskHandle_t* out_handle, BaseType_t core_id);
+void vTaskDelete(TaskHandle_t task);
+void vTaskDelay(TickType_t ticks);
+TickType_t xTaskGetTickCount(void);
+TaskHandle_t xTaskGetCurrentTaskHandle(void);
@@ -0,0 +1,8 @@
+#pragma once
+
+// The subset of the firmware's Kconfig the host build compiles against.
+// Tracing stays off; math type follows -DCONFIG_CONTROL_MATH_DOUBLE=1.
+#define CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ 240
+#if !CONFIG_CONTROL_MATH_DOUBLE
+#define CONFIG_CONTROL_MATH_FLOAT 1
+#endif
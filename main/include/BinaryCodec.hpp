@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+// Helpers shared by the compact binary formats (history ring columns, the
+// ?format=bin encoder, run logs and the WebSocket telemetry frame).
+
+// Rounds value * scale to int16, saturating at [minValue, INT16_MAX]. Pass
+// minValue = INT16_MIN + 1 to keep INT16_MIN free as a marker.
+inline int16_t QuantizeFixed(float value, float scale, int16_t minValue = INT16_MIN) {
+    const float scaled = std::round(value * scale);
+    if (!(scaled > static_cast<float>(minValue))) {
+        return minValue;
+    }
+    if (scaled > static_cast<float>(INT16_MAX)) {
+        return INT16_MAX;
+    }
+    return static_cast<int16_t>(scaled);
+}
+
+inline void PutLe16(uint8_t* out, uint16_t value) {
+    out[0] = static_cast<uint8_t>(value & 0xFF);
+    out[1] = static_cast<uint8_t>(value >> 8);
+}
+
+inline void PutLe32(uint8_t* out, uint32_t value) {
+    for (int i = 0; i < 4; ++i) {
+        out[i] = static_cast<uint8_t>((value >> (i * 8)) & 0xFF);
+    }
+}
+
+inline void PutLe64(uint8_t* out, uint64_t value) {
+    for (int i = 0; i < 8; ++i) {
+        out[i] = static_cast<uint8_t>((value >> (i * 8)) & 0xFF);
+    }
+}
+
+inline void PutLeFloat(uint8_t* out, float value) {
+    uint32_t bits = 0;
+    std::memcpy(&bits, &value, sizeof(bits));
+    PutLe32(out, bits);
+}
+
+inline uint32_t ReadLe32(const uint8_t* in) {
+    return static_cast<uint32_t>(in[0])
+        | (static_cast<uint32_t>(in[1]) << 8)
+        | (static_cast<uint32_t>(in[2]) << 16)
+        | (static_cast<uint32_t>(in[3]) << 24);
+}
+
+inline uint64_t ReadLe64(const uint8_t* in) {
+    return static_cast<uint64_t>(ReadLe32(in)) | (static_cast<uint64_t>(ReadLe32(in + 4)) << 32);
+}
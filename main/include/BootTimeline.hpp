@@ -0,0 +1,73 @@
+#pragma once
+
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include <cstddef>
+#include <cstdint>
+
+// Start-up stages in the order app_start() brings them up. Everything up to
+// ControllerTask runs on the main task before any networking; the rest runs on
+// the network bring-up task while the controller is already ticking.
+enum class BootStage : uint8_t {
+    Tracer,
+    Settings,
+    Hardware,
+    Controller,
+    ProfileEngine,
+    DataManager,
+    ControlBenchmark,
+    ControllerTask,
+    WiFiInit,
+    WebServer,
+    RunLog,
+    WiFiConnect,
+    TimeSync,
+    Count,
+};
+
+struct BootStageTiming {
+    bool started = false;
+    bool finished = false;
+    bool skipped = false; // Not part of this build or configuration
+    int64_t startUs = 0; // esp_timer time
+    int64_t durationUs = 0;
+    esp_err_t result = ESP_OK;
+};
+
+struct BootTimelineSnapshot {
+    int64_t appStartUs = 0;
+    int64_t controlReadyUs = 0; // 0 until the controller task is running
+    int64_t networkReadyUs = 0; // 0 while network bring-up is still in progress
+    BootStageTiming stages[static_cast<std::size_t>(BootStage::Count)];
+};
+
+// Timing of each start-up stage, for GET /api/v1/diagnostics. Stages finish on
+// two tasks, so every access takes the mutex.
+class BootTimeline {
+public:
+    constexpr static std::size_t STAGE_COUNT = static_cast<std::size_t>(BootStage::Count);
+
+    static BootTimeline& getInstance();
+    BootTimeline(const BootTimeline&) = delete;
+    BootTimeline& operator=(const BootTimeline&) = delete;
+    BootTimeline(BootTimeline&&) = delete;
+    BootTimeline& operator=(BootTimeline&&) = delete;
+
+    void MarkAppStart();
+    void BeginStage(BootStage stage);
+    void EndStage(BootStage stage, esp_err_t result);
+    void SkipStage(BootStage stage);
+    void MarkControlReady();
+    void MarkNetworkReady();
+    BootTimelineSnapshot GetSnapshot() const;
+
+    static const char* StageToString(BootStage stage);
+
+private:
+    BootTimeline();
+    static BootTimeline* instance;
+
+    mutable SemaphoreHandle_t stateMutex = nullptr;
+    BootTimelineSnapshot timeline;
+};
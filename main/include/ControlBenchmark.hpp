@@ -0,0 +1,6 @@
+#pragma once
+
+// Times the per-tick control math (input filter, PID and cooling door curve)
+// once in float and once in double, and logs the CPU cycles per tick of each.
+// Called from app_start() when CONFIG_CONTROL_MATH_BENCHMARK is set.
+void RunControlMathBenchmark();
@@ -0,0 +1,13 @@
+#pragma once
+
+#include "sdkconfig.h"
+
+// Numeric type of the per-tick control path (input filter, PID, door curve).
+// The ESP32-S3 FPU is single precision only; double arithmetic runs in
+// software, so float is the default. Select it under
+// "Reflow controller -> Control math type" in menuconfig.
+#if CONFIG_CONTROL_MATH_DOUBLE
+using control_real_t = double;
+#else
+using control_real_t = float;
+#endif
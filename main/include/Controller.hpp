@@ -1,13 +1,77 @@
 #pragma once
 
 #include "esp_err.h"
+#include <array>
+#include <atomic>
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <unordered_map>
 #include "freertos/FreeRTOS.h"
 #include "freertos/semphr.h"
+#include "ControlMath.hpp"
 #include "PID.hpp"
+#include "PIDAutotuner.hpp"
 #include "PWM.hpp"
+#include "ProcessValueFilter.hpp"
+#include "ThermalModel.hpp"
+
+// At most one zone per thermocouple channel; a zone count of 1 is plain
+// single-loop control.
+constexpr uint8_t MAX_CONTROL_ZONES = 4;
+// Thermocouple channels the process-value pipeline tracks (ThermocoupleSnapshot::MAX_CHANNELS).
+constexpr int PV_INPUT_CHANNELS = 4;
+
+// Inputs and heater relays of one control zone (bit i = thermocouple/relay i).
+struct ControlZoneConfig {
+    uint8_t inputMask = 0;
+    uint8_t relayMask = 0;
+};
+
+// How thermocouple readings become each zone's process value; see
+// ProcessValueFilter.hpp for the stages.
+struct ProcessValuePipelineConfig {
+    ProcessValueFilterMode filterMode = ProcessValueFilterMode::LowPass;
+    bool outlierRejection = true;
+    bool derivativeFromRate = false; // PID derivative from the filter's rate estimate
+    std::array<double, PV_INPUT_CHANNELS> inputWeights = {1.0, 1.0, 1.0, 1.0}; // 0..1, per channel
+};
+
+// Runtime state as of the end of one controller tick (or Start/Stop).
+// Everything in it comes from the same tick, unlike a series of getter calls.
+struct ControllerSnapshot {
+    uint32_t tick = 0; // Increments on every publish
+    bool running = false;
+    bool doorOpen = false;
+    bool alarming = false;
+    bool setpointLockedByProfile = false;
+    char state[24] = {};
+    double setPoint = 0.0;
+    double processValue = 0.0;
+    double pidOutput = 0.0;
+    double pTerm = 0.0;
+    double iTerm = 0.0;
+    double dTerm = 0.0;
+    double feedforward = 0.0; // Model feedforward included in pidOutput
+    double inputFilterTimeMs = 0.0;
+    double processRateCPerS = 0.0; // Mean of the zone rate estimates
+    AutotuneState autotuneState = AutotuneState::Idle;
+    uint8_t autotuneCycle = 0; // Completed cycles, including the discarded first one
+    uint8_t autotuneCycles = 0;
+    uint8_t zoneCount = 1;
+    double zoneProcessValue[MAX_CONTROL_ZONES] = {}; // Filtered PV of each zone
+    double zoneOutput[MAX_CONTROL_ZONES] = {}; // Output of each zone's PID after the cooling clamp
+};
+
+struct AutotuneStatus {
+    AutotuneState state = AutotuneState::Idle;
+    AutotuneConfig config;
+    AutotuneResult result; // Valid when state == Complete
+    int completedCycles = 0;
+    int totalCycles = 0;
+    double elapsedS = 0.0;
+    std::string failureReason;
+};
 
 class Controller{
     public:
@@ -17,8 +81,20 @@ class Controller{
         Controller(Controller&&) = delete;
         Controller& operator=(Controller&&) = delete;
 
-        esp_err_t RunTick();
+        // dtSeconds: measured time since the previous tick.
+        esp_err_t RunTick(double dtSeconds);
 
+        constexpr static uint32_t MIN_TICK_INTERVAL_MS = 50; // 20 Hz
+        constexpr static uint32_t MAX_TICK_INTERVAL_MS = 1000;
+        // 0: tick on every thermocouple pass. Otherwise the controller task ticks at
+        // this fixed period; the PID still only integrates fresh samples, while the
+        // heater duty, feedforward and door ramp update every tick.
+        uint32_t GetTickIntervalMs() const;
+        double GetNominalTickIntervalMs() const; // Used where no measured dt exists
+        esp_err_t SetTickIntervalMs(uint32_t intervalMs);
+
+        // Lock-free copy of the last published snapshot; never blocks the control task.
+        ControllerSnapshot GetSnapshot() const;
 
         // Getting state info for controller:
         double GetSetPoint() const;
@@ -30,10 +106,15 @@ class Controller{
         bool IsAlarming() const;
         bool IsSetpointLockedByProfile() const;
         double GetInputFilterTimeMs() const;
+        ProcessValuePipelineConfig GetProcessValuePipeline() const;
+        // Readings replaced by the outlier filter since boot, per channel.
+        std::array<uint32_t, PV_INPUT_CHANNELS> GetRejectedReadingCounts() const;
         std::vector<int> GetInputChannels() const;
         std::vector<int> GetRelaysPWMEnabled() const;
         std::unordered_map<int, double> GetRelaysPWMWeights() const;
         std::vector<int> GetRelaysWhenRunning() const;
+        PWM::Mode GetRelayDriveMode() const;
+        uint8_t GetMainsFrequencyHz() const;
         double GetDoorClosedAngleDeg() const;
         double GetDoorOpenAngleDeg() const;
         double GetDoorMaxSpeedDegPerSec() const;
@@ -41,7 +122,15 @@ class Controller{
         double GetCoolOffBandC() const;
         double GetHeaterMinValuePct() const;
         double GetForceHeaterOnBelowC() const;
-        PID* GetPIDController() { return &pidController; }
+        bool IsFeedforwardEnabled() const;
+        double GetFeedforwardLookaheadS() const;
+        double GetFeedforwardGain() const;
+        ThermalModel GetThermalModel() const;
+        // Zone 0's PID; every zone shares its gains and tuning.
+        PID* GetPIDController() { return &zones[0].pid; }
+        uint8_t GetZoneCount() const;
+        std::vector<ControlZoneConfig> GetControlZones() const;
+        AutotuneStatus GetAutotuneStatus() const;
         std::string GetStateTUI() const;
 
         // Interfacing with the controller settings:
@@ -53,6 +142,8 @@ class Controller{
         esp_err_t SetSetPointFromProfile(double newSetPoint);
         void SetProfileSetpointLock(bool locked);
         esp_err_t SetInputFilterTime(double newFilterTimeMs);
+        // Restarts the zone filters when the filter mode changes.
+        esp_err_t SetProcessValuePipeline(const ProcessValuePipelineConfig& config);
         esp_err_t SetHeatingPIDGains(double newKp, double newKi, double newKd);
         esp_err_t SetCoolingPIDGains(double newKp, double newKi, double newKd);
         esp_err_t SetPIDGains(double newKp, double newKi, double newKd);
@@ -67,33 +158,66 @@ class Controller{
         esp_err_t RemoveRelayPWM(int relayIndex);
         esp_err_t SetRelayPWMEnabled(const std::vector<int>& relayIndices);
         esp_err_t SetRelaysPWM(const std::unordered_map<int, double>& relayWeights);
+        // BurstFire spreads heater power over whole mains cycles; only use it with zero-crossing SSRs.
+        esp_err_t SetRelayDriveMode(PWM::Mode mode, uint8_t mainsHz);
         esp_err_t AddRelayWhenRunning(int relayIndex);
         esp_err_t RemoveRelayWhenRunning(int relayIndex);
         esp_err_t SetRelaysWhenRunning(const std::vector<int>& relayIndices);
+        // One entry = single-zone control over the input channels and PWM relays.
+        // With 2..MAX_CONTROL_ZONES entries each zone runs its own PID on the mean
+        // of its inputs and drives its relays, which must be PWM relays and not
+        // shared with another zone. Every zone is computed in the same tick from
+        // the same thermocouple pass.
+        esp_err_t SetControlZones(const std::vector<ControlZoneConfig>& zoneConfigs);
         esp_err_t SetDoorCalibrationAngles(double closedAngleDeg, double openAngleDeg);
         esp_err_t SetDoorMaxSpeedDegPerSec(double speedDegPerSec);
         esp_err_t SetCoolingDoorBands(double coolOnBandC, double coolOffBandC);
         esp_err_t SetHeaterBehavior(double heaterMinValuePct, double forceHeaterOnBelowC);
+        // Profile feedforward: while a profile runs, adds gain * the output the
+        // thermal model needs to follow the setpoint lookaheadS seconds ahead.
+        esp_err_t SetFeedforwardConfig(bool enabled, double lookaheadS, double gain);
+        esp_err_t SetThermalModel(const ThermalModel& model);
+        // Called by ProfileEngine every tick; cleared when the profile releases the setpoint.
+        void SetProfileTrajectory(double setPointAheadC, double rateCPerS);
         esp_err_t SetDoorPreviewAngle(double angleDeg);
         esp_err_t ClearDoorPreview();
 
+        // Relay autotune: starts the controller and oscillates around config.setPointC.
+        // The result is only applied (and persisted) by AcceptAutotuneResult().
+        esp_err_t StartAutotune(const AutotuneConfig& config);
+        esp_err_t CancelAutotune();
+        esp_err_t AcceptAutotuneResult();
+
 
 
     private:
         static Controller* instance;
         Controller();
-        constexpr static double TICK_INTERVAL_MS = 250.0; // 100 ms tick interval
+        constexpr static double SAMPLE_TICK_INTERVAL_MS = 220.0; // One thermocouple pass: the nominal tick when ticks follow samples
         constexpr static double MAX_SETPOINT = 300.0; // Max temp in Celsius
         constexpr static double MIN_SETPOINT = 0.0; // Min temp in Celsius
         constexpr static double MIN_PROCESS_VALUE = -100.0; // Minimum process value (alarm will turn on if value is below this, to catch sensor errors)
         constexpr static double MAX_PROCESS_VALUE = 300.0; // Max temp in Celsius (alarm will turn on if value is above this, to catch sensor errors and prevent overheating)
         constexpr static double ROOM_TEMPERATURE_C = 24.0;
         constexpr static double MIN_DOOR_COOLING_EFFECTIVENESS = 0.45;
-        constexpr static double DOOR_COOLING_NONLINEARITY = 3.0;
+        constexpr static int64_t MAX_SAMPLE_AGE_US = 1000 * 1000; // Thermocouple pass older than this = sensor error
         
         
-        PID pidController; // The actual PID controller object that will do the calculations
+        // Runtime state of one control zone. Zone 0 is also the single-zone loop.
+        struct ZoneState {
+            PID pid;
+            ProcessValueFilter filter; // Unprimed until the first pass after a reset
+            double filteredProcessValue = 0.0;
+            double processRateCPerS = 0.0;
+            double output = 0.0; // PID output after the cooling clamp
+        };
+
+        ZoneState zones[MAX_CONTROL_ZONES];
+        uint8_t zoneCount = 1;
+        ControlZoneConfig zoneConfigs[MAX_CONTROL_ZONES];
         PWM relayPWM;
+        PIDAutotuner autotuner; // Guarded by stateMutex
+        bool autotuneActive = false;
         bool running = false;
         std::string state = "Idle";
         bool alarming = false;
@@ -103,9 +227,13 @@ class Controller{
 
         // Controller Runtime properties
         double setPoint = 0.0;
-        double processValue = 0.0;
-        double filteredProcessValue = 0.0;
-        bool hasFilteredProcessValue = false;
+        double processValue = 0.0; // Mean of the zone PVs
+        bool hasFilteredProcessValue = false; // Any pass folded in since the zone layout last changed
+        bool freshSampleThisTick = false;
+        double pidElapsedS = 0.0; // Time since the PID last saw a fresh sample
+        uint32_t tickIntervalMs = 0;
+        uint32_t lastSampleSequence = 0; // Thermocouple pass last folded into the filter
+        int64_t lastSampleTimestampUs = 0;
         double PIDOutput = 0.0;
         double doorClosedAngleDeg = 50.0;
         double doorOpenAngleDeg = 90.0;
@@ -116,21 +244,51 @@ class Controller{
         double heaterMinValuePct = 0.0;
         double forceHeaterOnBelowC = 0.0;
         bool coolingDoorEnabled = false;
+        bool feedforwardEnabled = false;
+        double feedforwardLookaheadS = 30.0;
+        double feedforwardGain = 1.0;
+        ThermalModel thermalModel;
+        bool hasProfileTrajectory = false;
+        double trajectorySetpointC = 0.0; // Profile setpoint feedforwardLookaheadS ahead
+        double trajectoryRateCPerS = 0.0;
 
         // Controller Tuning Settings
         double inputFilterTimeMs = 100.0;
+        ProcessValuePipelineConfig pvPipeline;
+        ChannelOutlierFilter channelOutlierFilters[PV_INPUT_CHANNELS];
+        // Bumped whenever the pipeline or its filters are changed under the lock,
+        // so UpdateProcessValue() can drop a pass that started before the change.
+        uint32_t pvPipelineGeneration = 0;
+        uint8_t pvUsedChannelMask = 0; // Channels the last pass filtered
+        uint32_t rejectedReadingCounts[PV_INPUT_CHANNELS] = {};
         std::vector<int> inputsBeingUsed = {0}; // Default to channel 0 only.
         std::unordered_map<int, double> relaysPWM = {{0, 1.0}, {1, 0.5}}; // Default to relay 0 at 100 strength, and relay 1 at 50% strength
-        std::unordered_map<int, double> relayPWMCycleAccumulators;
+        PWM::Mode relayDriveMode = PWM::Mode::Window;
+        uint8_t mainsFrequencyHz = 50;
         std::vector<int> relaysWhenControllerRunning = {2}; // Default to turning on relay 2 when the controller is running, off otherwise
 
         mutable SemaphoreHandle_t stateMutex = nullptr;
 
+        // Seqlock over two buffers: the writer (serialised by stateMutex) makes the
+        // sequence odd, fills the idle buffer and makes it even again. Buffer
+        // (sequence >> 1) & 1 is the published one; readers retry if it moved.
+        ControllerSnapshot snapshotBuffers[2];
+        std::atomic<uint32_t> snapshotSequence{0};
+        uint32_t snapshotTick = 0;
+
 
 
-        esp_err_t PerformOnRunning();
-        esp_err_t PerformOnNotRunning();
+        esp_err_t PerformOnRunning(double dtSeconds);
+        esp_err_t PerformOnNotRunning(double dtSeconds);
+        esp_err_t PerformAutotune(double dtSeconds);
         esp_err_t Perform();
+        // Stop() with the state the published snapshot should end in.
+        // With autotune set, its setpoint and autotuneActive are applied in the
+        // same locked section that sets running, so the first tick already tunes.
+        esp_err_t StartRun(const AutotuneConfig* autotune);
+        esp_err_t StopWithState(const char* finalState);
+
+        void PublishSnapshotLocked();
 
         esp_err_t UpdateProcessValue();
         bool CheckAlarmingConditions();
@@ -141,7 +299,9 @@ class Controller{
         void ApplyInputsMask(uint8_t mask);
         void ApplyRelaysPWMMask(uint8_t mask);
         void ApplyRelaysOnMask(uint8_t mask);
-        void SyncRelayPWMAccumulatorsLocked();
+        void ApplyZoneSettings(uint8_t count, uint32_t inputMasks, uint32_t relayMasks);
+        // Pushes relaysPWM into the PWM schedule; the cycle-skip accumulators live in the PWM ISR.
+        void SyncRelayPWMScheduleLocked();
         esp_err_t PersistRelaysPWMSettings();
         double ComputeCoolingDoorOpenFraction(double pidOutput, double processValueC) const;
         double ComputeDoorAngleFromFraction(double openFraction) const;
@@ -150,10 +310,8 @@ class Controller{
 
         esp_err_t RunningRelaysOn();
         esp_err_t RunningRelaysOff();
-        static void RelayOnThunk(void* ctx);
-        static void RelayOffThunk(void* ctx);
-        void RelayOn();
-        void RelayOff();
+        // Runs in the relay PWM timer ISR.
+        static void RelayOutputThunk(uint32_t onMask, uint32_t channelMask, void* ctx);
 
 
 
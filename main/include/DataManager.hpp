@@ -6,6 +6,7 @@
 #include <cstddef>
 #include "esp_err.h"
 #include "esp_heap_caps.h"
+#include "Controller.hpp"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/semphr.h"
@@ -49,13 +50,91 @@ struct DataPoint {
     float ITerm; // The integral term of the PID output at the time of the data
     float DTerm; // The derivative term of the PID output at the time of the data point
     float temperatureReadings[4]; // The raw temperature readings from the 4 channels at the time of the data point
+    uint32_t sequence; // Monotonic sequence id of the data point, survives ring wraparound and ClearData
     uint8_t relayStates; // The state of the relays at the time of the data point, each bit represents a relay
     uint8_t servoAngle; // The angle of the servo at the time of the data point, from 0 to 180
     bool chamberRunning; // Whether the chamber was running at the time of the data point
+    uint8_t zoneCount; // Control zones below; 1 = single-zone, where zone 0 repeats processValue/PIDOutput
+    float zoneProcessValue[MAX_CONTROL_ZONES]; // Filtered PV of each control zone
+    float zoneOutput[MAX_CONTROL_ZONES]; // PID output of each control zone
 };
 
 using DataPointStorage = std::vector<DataPoint, PsramAllocator<DataPoint>>;
 
+// History resolutions served by DataManager. Raw is the full-rate ring; the
+// rollup tiers summarize it into fixed buckets so long windows stay cheap.
+enum class DataResolution : uint8_t {
+    Raw = 0,
+    TenSeconds,
+    SixtySeconds,
+};
+
+struct DataRollupStats {
+    float min;
+    float max;
+    float mean;
+};
+
+struct DataRollup {
+    uint64_t timestamp; // Start of the bucket in seconds since boot
+    uint32_t sequence; // Monotonic sequence id within the tier
+    uint16_t sampleCount; // Number of raw points folded into the bucket
+    DataRollupStats setPoint;
+    DataRollupStats processValue;
+    DataRollupStats PIDOutput;
+};
+
+using DataRollupStorage = std::vector<DataRollup, PsramAllocator<DataRollup>>;
+
+// Column-oriented storage for the raw history ring. Each field lives in its
+// own PSRAM array so a sample costs BytesPerSample() instead of
+// sizeof(DataPoint), and scanning one channel touches only that column.
+// Readers still receive DataPoint records, decoded on the way out.
+// Per-zone columns exist only for multi-zone control, so a single-zone ring
+// costs BYTES_PER_SAMPLE exactly.
+struct DataColumns {
+    template <typename T>
+    using Column = std::vector<T, PsramAllocator<T>>;
+
+    Column<uint32_t> timestamp; // Seconds since boot
+    Column<int16_t> setPoint; // 1/32 C
+    Column<int16_t> processValue; // 1/32 C
+    Column<int16_t> PIDOutput; // 1/100 %
+    Column<float> PTerm;
+    Column<float> ITerm;
+    Column<float> DTerm;
+    Column<int16_t> temperatureReadings[4]; // 1/4 C (MAX6675 resolution), INT16_MIN marks a read error
+    Column<uint8_t> flags; // Bits 0-5 relay states, bit 7 chamber running
+    Column<uint8_t> servoAngle;
+    Column<int16_t> zoneProcessValue[MAX_CONTROL_ZONES]; // 1/32 C, first zoneCount columns only
+    Column<int16_t> zoneOutput[MAX_CONTROL_ZONES]; // 1/100 %, first zoneCount columns only
+    uint8_t zoneCount = 1;
+
+    constexpr static std::size_t BYTES_PER_SAMPLE =
+        sizeof(uint32_t) + 3 * sizeof(int16_t) + 3 * sizeof(float) + 4 * sizeof(int16_t) + 2 * sizeof(uint8_t);
+    constexpr static std::size_t BYTES_PER_ZONE = 2 * sizeof(int16_t);
+
+    static std::size_t BytesPerSample(uint8_t zones) { return BYTES_PER_SAMPLE + (zones > 1 ? zones * BYTES_PER_ZONE : 0); }
+    std::size_t BytesPerSample() const { return BytesPerSample(zoneCount); }
+
+    // zones > 1 adds that many per-zone column pairs.
+    void Resize(std::size_t capacity, uint8_t zones);
+    std::size_t Capacity() const { return timestamp.size(); }
+    void Store(std::size_t index, const DataPoint& point);
+    void Load(std::size_t index, DataPoint& out) const;
+};
+
+// Read position for streaming the history ring out in batches. Indices are
+// absolute (count of points ever logged), so a cursor stays valid while the
+// ring keeps wrapping; points overwritten before they are read are skipped.
+// The absolute index doubles as the point's sequence id.
+struct DataHistoryCursor {
+    uint64_t next = 0; // Absolute index of the next point to read
+    uint64_t end = 0; // Absolute index one past the last point to read
+    uint64_t oldest = 0; // Absolute index of the oldest retained point when the cursor was opened
+    DataResolution resolution = DataResolution::Raw; // Which ring the cursor reads
+};
+
 class DataManager{
     public:
         static DataManager& getInstance();
@@ -65,32 +144,75 @@ class DataManager{
         esp_err_t ChangeDataLogInterval(int newIntervalMs);
         esp_err_t ChangeMaxTimeSaved(int newMaxTimeSavedMs);
         int GetDataLogIntervalMs() const;
+        // The interval together with the sequence of the first point logged at
+        // it; earlier points in the ring were logged at another spacing.
+        void GetDataLogInterval(int& outIntervalMs, uint64_t& outStartSequence) const;
         int GetMaxTimeSavedMS() const;
         bool IsLogging() const;
-        DataPointStorage GetRecentData(std::size_t limit) const;
+        DataPointStorage GetRecentData(std::size_t limit) const; // Decodes a copy; prefer the cursor API for large reads
         DataPointStorage GetAllData() const;
+        DataHistoryCursor OpenHistoryCursor(std::size_t limit, DataResolution resolution = DataResolution::Raw) const;
+        DataHistoryCursor OpenHistoryCursorSince(uint64_t sinceSequence, std::size_t limit, DataResolution resolution = DataResolution::Raw) const;
+        std::size_t ReadHistoryBatch(DataHistoryCursor& cursor, DataPoint* out, std::size_t maxCount) const;
+        std::size_t ReadRollupBatch(DataHistoryCursor& cursor, DataRollup* out, std::size_t maxCount) const;
+        static uint32_t GetResolutionSeconds(DataResolution resolution);
+        std::size_t GetRollupCount(DataResolution resolution) const;
+        std::size_t GetMaxRollupCount(DataResolution resolution) const;
         esp_err_t ClearData();
         std::size_t GetDataPointCount() const;
         std::size_t GetMaxDataPoints() const { return maxDataPoints; }
         std::size_t GetStorageBytesUsed() const;
+        uint8_t GetHistoryZoneCount() const; // Zones stored per point, fixed at boot
 
 
     private:
         static DataManager* instance;
         DataManager();
         constexpr static int MAX_DATA_SIZE_KB = 500; // The max size of the data log in kilobytes.
-        constexpr static int MAX_DATA_POINTS = (MAX_DATA_SIZE_KB * 1024) / sizeof(DataPoint); // The max number of data points we can save based on the max data size and the size of each data point
+        constexpr static int MAX_DATA_POINTS = (MAX_DATA_SIZE_KB * 1024) / DataColumns::BYTES_PER_SAMPLE; // The max number of single-zone data points we can save based on the max data size and the stored size of each data point
 
         // Settings
         bool LogData = true; // Whether to log data at all, if false, no data will be logged regardless of other settings
         int DataLogIntervalMs = 1000; // How often to log data in milliseconds, 250ms to 10s
         int MaxTimeSavedMS = 1000 * 60 * 30; // How much historical data to save in milliseconds, 1 minute to 24 hours, resets at boot time
 
-        DataPointStorage dataLog;
+        DataColumns dataLog; // Fixed-capacity columnar ring buffer, sized to maxDataPoints at construction
+        std::size_t dataHead = 0; // Index of the oldest point in dataLog
+        std::size_t dataCount = 0; // Number of valid points in dataLog
+        uint64_t totalLogged = 0; // Number of points ever logged, the absolute index of the next point
+        uint64_t intervalStartSequence = 0; // First point logged at DataLogIntervalMs
         std::size_t maxDataPoints = MAX_DATA_POINTS;
         mutable SemaphoreHandle_t dataMutex = nullptr;
 
+        // Rollup tiers, one per non-raw DataResolution. Each is a ring of closed
+        // buckets plus the bucket currently being accumulated.
+        constexpr static std::size_t ROLLUP_TIER_COUNT = 2;
+        constexpr static std::size_t ROLLUP_10S_MAX_BUCKETS = 6 * 60 * 6; // 6 hours of 10 s buckets
+        constexpr static std::size_t ROLLUP_60S_MAX_BUCKETS = 24 * 60; // 24 hours of 60 s buckets
+
+        struct RollupAccumulator {
+            uint64_t bucketStart = 0;
+            uint32_t sampleCount = 0;
+            float min[3] = {};
+            float max[3] = {};
+            double sum[3] = {};
+        };
+
+        struct RollupTier {
+            DataRollupStorage ring;
+            std::size_t head = 0;
+            std::size_t count = 0;
+            uint64_t total = 0;
+            RollupAccumulator pending;
+        };
+
+        RollupTier rollupTiers[ROLLUP_TIER_COUNT];
+
         bool CheckSettingsValid();
+        void GetRingStateLocked(DataResolution resolution, uint64_t& total, std::size_t& count) const;
+        void ResizeRollupTiersLocked(int windowMs);
+        void AccumulateRollupsLocked(const DataPoint& point);
+        void CloseRollupBucketLocked(RollupTier& tier);
 
         TaskHandle_t dataLogTaskHandle = nullptr;
         static void dataLogTaskEntry(void* arg);
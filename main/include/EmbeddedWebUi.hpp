@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// One web UI file linked into the app image (CONFIG_WEBUI_EMBEDDED). The table
+// is generated by main/CMakeLists.txt from main/webui; data points straight
+// into memory-mapped flash and is never copied.
+struct EmbeddedWebAsset {
+    const char* path; // Request path, without the ".gz" suffix
+    const uint8_t* start;
+    const uint8_t* end;
+    bool gzip; // Stored precompressed
+    const char* etag; // Quoted; from a SHA-256 of the stored bytes
+};
+
+extern const EmbeddedWebAsset EMBEDDED_WEB_ASSETS[];
+extern const std::size_t EMBEDDED_WEB_ASSET_COUNT;
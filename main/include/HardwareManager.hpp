@@ -1,11 +1,22 @@
 #pragma once
 
+#include <atomic>
+#include <cstdint>
 #include <vector>
 #include "esp_err.h"
 #include "driver/spi_master.h"
 #include "driver/gpio.h"
 #include "driver/mcpwm_prelude.h"
 
+// One acquisition pass over every thermocouple.
+struct ThermocoupleSnapshot {
+    static constexpr int MAX_CHANNELS = 4;
+
+    uint32_t sequence = 0; // 0 until the first pass completes
+    int64_t timestampUs = 0; // esp_timer time when the reads were started
+    double values[MAX_CHANNELS] = {-3000.0, -3000.0, -3000.0, -3000.0}; // -3000 = error
+};
+
 class HardwareManager {
 public:
     static HardwareManager& getInstance();
@@ -15,8 +26,16 @@ public:
     HardwareManager& operator=(HardwareManager&&) = delete;
 
     double getThermocoupleValue(int index);
+    // Lock-free copy of the latest acquisition pass; safe from any task.
+    ThermocoupleSnapshot getThermocoupleSnapshot() const;
+    // The task is sent a notification (xTaskNotifyGive) after every published pass.
+    void setSampleListener(TaskHandle_t task);
     esp_err_t setRelayState(int relayIndex, bool state);
     bool getRelayState(int relayIndex);
+    // Drives every relay whose bit is set in relayMask: on if also set in onMask,
+    // off otherwise. Never blocks or allocates, so it is safe from an ISR.
+    void applyRelayMask(uint32_t onMask, uint32_t relayMask);
+    uint32_t getRelayStateMask() const { return relayStateBits.load(std::memory_order_relaxed); }
     esp_err_t setServoAngle(double angle);
     double getServoAngle();
 
@@ -63,11 +82,19 @@ private:
     // Singleton instance
     static HardwareManager* instance;
 
-    // Array of current thermocouple values, indexed the same as the SPI device handles
-    std::vector<double> thermocoupleValues;
+    // Latest thermocouple pass, published by the read task (single writer) through a
+    // seqlock over two buffers so readers never block it. The sequence is odd while the
+    // idle buffer is written; buffer (sequence >> 1) & 1 is the published one.
+    ThermocoupleSnapshot thermocoupleBuffers[2];
+    std::atomic<uint32_t> thermocoupleSequence{0};
+    std::atomic<TaskHandle_t> sampleListener{nullptr};
+    spi_transaction_t thermocoupleTransactions[NUM_THERMOCOUPLES] = {};
+    // Queued and not yet collected; the driver still owns that descriptor.
+    bool thermocoupleInFlight[NUM_THERMOCOUPLES] = {};
 
-    // Relay states, indexed the same as the RELAY_GPIO_PINS array
-    std::vector<bool> relayStates;
+    // Relay states, bit i matches RELAY_GPIO_PINS[i]. Atomic because the relay
+    // PWM ISR writes it alongside the control/HTTP tasks.
+    std::atomic<uint32_t> relayStateBits{0};
 
     double servoAngle = 0;
 
@@ -78,4 +105,5 @@ private:
     esp_err_t servoSetup();
     esp_err_t startThermocoupleReadTask();
     esp_err_t readThermocouples();
+    static double decodeThermocouple(const spi_transaction_t& transaction);
 };
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include "DataManager.hpp"
+
+// Encoder for the compact binary history format. It is served by
+// /api/v1/data/history?format=bin and is also the on-flash format of run logs;
+// see decodeHistoryBinary() in frontend/src/api.ts for the matching decoder.
+//
+// Layout (little endian):
+// Header: "RFH1", u8 version, u8 record size, u8 zone count, u8 reserved, u64 first timestamp (s),
+//         u32 first seq, u32 oldest retained seq, u32 next seq, u32 start unix time (s, 0 = unknown).
+// Record: u16 timestamp delta (s), i16 setpoint/pv (0.25 C), i16 output/P/I/D (0.01 %),
+//         i16 temperatures[4] (0.25 C), u8 relay bits 0-5 with bit 7 = running, u8 servo angle,
+//         u16 seq delta, then for a zone count above 1: i16 zone PV (0.25 C) and i16 zone
+//         output (0.01 %) per zone. A single zone is the top-level PV and output.
+// Version 2 is version 3 without zone fields; its zone count byte is 0.
+class HistoryBinaryEncoder {
+public:
+    constexpr static uint8_t VERSION = 3;
+    constexpr static std::size_t HEADER_SIZE = 32;
+    constexpr static std::size_t BASE_RECORD_SIZE = 26;
+    constexpr static std::size_t ZONE_FIELDS_SIZE = 4;
+    constexpr static std::size_t MAX_RECORD_SIZE = BASE_RECORD_SIZE + MAX_CONTROL_ZONES * ZONE_FIELDS_SIZE;
+
+    static std::size_t RecordSize(uint8_t zoneCount) {
+        return BASE_RECORD_SIZE + (zoneCount > 1 ? zoneCount * ZONE_FIELDS_SIZE : 0);
+    }
+
+    // Writes the header and primes the delta state with the first point's
+    // timestamp/sequence. zoneCount (clamped to 1..MAX_CONTROL_ZONES) fixes the
+    // record size; zones a point does not have are stored as 0.
+    void EncodeHeader(
+        uint64_t firstTimestamp,
+        uint32_t firstSequence,
+        uint32_t oldestSequence,
+        uint32_t nextSequence,
+        uint32_t startUnixTime,
+        uint8_t zoneCount,
+        uint8_t* out);
+    // Writes GetRecordSize() bytes.
+    void EncodeRecord(const DataPoint& point, uint8_t* out);
+    std::size_t GetRecordSize() const { return RecordSize(zoneCount); }
+
+private:
+    uint64_t previousTimestamp = 0;
+    uint32_t previousSequence = 0;
+    uint8_t zoneCount = 1;
+};
@@ -1,67 +1,81 @@
 #pragma once
 
+#include "ControlMath.hpp"
 #include "esp_err.h"
 
-class PID{
+// T is the arithmetic type of the controller. Both float and double are
+// instantiated in PID.cpp; the firmware uses PID (control_real_t), the other
+// one is only there for the control math benchmark.
+template <typename T>
+class BasicPID{
     public:
-        PID() = default;
-        double Calculate(double setPoint, double processValue);
-        double GetPreviousOutput() const { return previousOutput; }
-        double GetPreviousP() const { return previousP; }
-        double GetPreviousI() const { return previousI; }
-        double GetPreviousD() const { return previousD; }
-        double GetKp() const { return heatingKp; } // Backward-compatible alias for heating Kp
-        double GetKi() const { return heatingKi; } // Backward-compatible alias for heating Ki
-        double GetKd() const { return heatingKd; } // Backward-compatible alias for heating Kd
-        double GetHeatingKp() const { return heatingKp; }
-        double GetHeatingKi() const { return heatingKi; }
-        double GetHeatingKd() const { return heatingKd; }
-        double GetCoolingKp() const { return coolingKp; }
-        double GetCoolingKi() const { return coolingKi; }
-        double GetCoolingKd() const { return coolingKd; }
-        double GetDerivativeFilterTime() const { return derivativeFilterTime; }
-        double GetSetpointWeight() const { return setpointWeight; }
-        double GetIntegralZoneC() const { return integralZoneC; }
-        double GetIntegralLeakTimeSeconds() const { return integralLeakTimeSeconds; }
-        esp_err_t Tune(double Kp, double Ki, double Kd);
-        esp_err_t TuneHeating(double Kp, double Ki, double Kd);
-        esp_err_t TuneCooling(double Kp, double Ki, double Kd);
-        esp_err_t SetDerivativeFilterAlpha(double alpha);
-        esp_err_t SetDerivativeFilterTime(double filterTimeSeconds);
-        esp_err_t SetSetpointWeight(double weight);
-        esp_err_t SetIntegralZoneC(double zoneC);
-        esp_err_t SetIntegralLeakTimeSeconds(double leakTimeSeconds);
+        BasicPID() = default;
+        // dtSeconds: time since the previous Calculate(), measured by the caller.
+        // feedforward is added before the output clamp, so the integrator's
+        // anti-windup limits account for it.
+        T Calculate(T setPoint, T processValue, T dtSeconds, T feedforward = T(0));
+        // Same, but the derivative term uses processRate (d(PV)/dt, e.g. from the
+        // input filter's estimate) instead of differencing successive PVs.
+        T CalculateWithRate(T setPoint, T processValue, T processRate, T dtSeconds, T feedforward = T(0));
+        T GetPreviousOutput() const { return previousOutput; }
+        T GetPreviousP() const { return previousP; }
+        T GetPreviousI() const { return previousI; }
+        T GetPreviousD() const { return previousD; }
+        T GetPreviousFeedforward() const { return previousFeedforward; }
+        T GetKp() const { return heatingKp; } // Backward-compatible alias for heating Kp
+        T GetKi() const { return heatingKi; } // Backward-compatible alias for heating Ki
+        T GetKd() const { return heatingKd; } // Backward-compatible alias for heating Kd
+        T GetHeatingKp() const { return heatingKp; }
+        T GetHeatingKi() const { return heatingKi; }
+        T GetHeatingKd() const { return heatingKd; }
+        T GetCoolingKp() const { return coolingKp; }
+        T GetCoolingKi() const { return coolingKi; }
+        T GetCoolingKd() const { return coolingKd; }
+        T GetDerivativeFilterTime() const { return derivativeFilterTime; }
+        T GetSetpointWeight() const { return setpointWeight; }
+        T GetIntegralZoneC() const { return integralZoneC; }
+        T GetIntegralLeakTimeSeconds() const { return integralLeakTimeSeconds; }
+        esp_err_t Tune(T Kp, T Ki, T Kd);
+        esp_err_t TuneHeating(T Kp, T Ki, T Kd);
+        esp_err_t TuneCooling(T Kp, T Ki, T Kd);
+        esp_err_t SetDerivativeFilterAlpha(T alpha);
+        esp_err_t SetDerivativeFilterTime(T filterTimeSeconds);
+        esp_err_t SetSetpointWeight(T weight);
+        esp_err_t SetIntegralZoneC(T zoneC);
+        esp_err_t SetIntegralLeakTimeSeconds(T leakTimeSeconds);
         esp_err_t Reset();
 
     private:
-        double heatingKp = 1.0;
-        double heatingKi = 0.0;
-        double heatingKd = 0.0;
-        double coolingKp = 1.0;
-        double coolingKi = 0.0;
-        double coolingKd = 0.0;
-        double OutputMin = -100.0;
-        double OutputMax = 100.0;
-        double setpointWeight = 0.5; // Weight for the setpoint in the error calculation, between 0 and 1
-        double integralZoneC = 0.0; // Integrator active only when |error| <= integralZoneC. 0 disables zone gating.
-        double integralLeakTimeSeconds = 0.0; // Exponential leak time constant. 0 disables leak.
+        T Compute(T setPoint, T processValue, T dtSeconds, T feedforward, const T* processRate);
 
-        double DerivativeFilterAlpha = 1; // Smoothing factor for derivative term
-        double derivativeFilterTime = 0.0; // Time constant in seconds
+        T heatingKp = 1.0;
+        T heatingKi = 0.0;
+        T heatingKd = 0.0;
+        T coolingKp = 1.0;
+        T coolingKi = 0.0;
+        T coolingKd = 0.0;
+        T OutputMin = -100.0;
+        T OutputMax = 100.0;
+        T setpointWeight = 0.5; // Weight for the setpoint in the error calculation, between 0 and 1
+        T integralZoneC = 0.0; // Integrator active only when |error| <= integralZoneC. 0 disables zone gating.
+        T integralLeakTimeSeconds = 0.0; // Exponential leak time constant. 0 disables leak.
 
-        double integral = 0.0;
-        double previousError = 0.0;
-        double previousPV = 0.0; // Previous process value for derivative calculation
-        double dFiltered = 0.0; // Filtered derivative term
+        T DerivativeFilterAlpha = 1; // Smoothing factor for derivative term
+        T derivativeFilterTime = 0.0; // Time constant in seconds
 
-        double previousOutput = 0.0;
-        double previousP = 0.0; 
-        double previousI = 0.0;
-        double previousD = 0.0;
+        T integral = 0.0;
+        T previousError = 0.0;
+        T previousPV = 0.0; // Previous process value for derivative calculation
+        T dFiltered = 0.0; // Filtered derivative term
 
-        bool firstRun = true; // Flag to handle the first run for derivative calculation
+        T previousOutput = 0.0;
+        T previousP = 0.0; 
+        T previousI = 0.0;
+        T previousD = 0.0;
+        T previousFeedforward = 0.0;
 
-        uint64_t lastTimeUs = 0; // Timestamp of the last calculation in microseconds
+        bool firstRun = true; // Flag to handle the first run for derivative calculation
 
 };
 
+using PID = BasicPID<control_real_t>;
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "esp_err.h"
+#include <cstdint>
+
+// Relay-feedback (Astrom-Hagglund) autotune.
+//
+// The output is switched between +heatOutputPct and -coolOutputPct around the
+// setpoint with a small hysteresis, which drives the oven into a limit cycle.
+// The peak-to-peak amplitude and the period of that cycle give the ultimate
+// gain Ku and period Tu, from which heating and cooling gains are proposed.
+struct AutotuneConfig {
+    double setPointC = 150.0;
+    double heatOutputPct = 100.0; // Relay "high" (heater duty, 0..100)
+    double coolOutputPct = 100.0; // Relay "low" magnitude (cooling door, 0..100)
+    double hysteresisC = 0.5; // Switch at setpoint +/- this
+    int cycles = 4; // Cycles averaged after the first (discarded) one
+    double maxDurationS = 30.0 * 60.0;
+};
+
+enum class AutotuneState : uint8_t {
+    Idle = 0,
+    Running = 1,
+    Complete = 2,
+    Failed = 3,
+};
+
+struct AutotuneResult {
+    double ultimateGain = 0.0; // Ku, % output per degree C
+    double ultimatePeriodS = 0.0; // Tu
+    double amplitudeC = 0.0; // Half of the averaged peak-to-peak PV swing
+    double heatingKp = 0.0;
+    double heatingKi = 0.0;
+    double heatingKd = 0.0;
+    double coolingKp = 0.0;
+    double coolingKi = 0.0;
+    double coolingKd = 0.0;
+};
+
+class PIDAutotuner {
+    public:
+        PIDAutotuner() = default;
+
+        esp_err_t Start(const AutotuneConfig& config);
+        void Cancel();
+
+        // Feeds one PV sample; returns the output to apply in [-100, 100].
+        double Update(double processValue, double dtSeconds);
+
+        AutotuneState GetState() const { return state; }
+        const AutotuneConfig& GetConfig() const { return config; }
+        const AutotuneResult& GetResult() const { return result; }
+        const char* GetFailureReason() const { return failureReason; }
+        int GetCompletedCycles() const { return completedCycles; } // Including the discarded first cycle
+        int GetTotalCycles() const { return config.cycles + 1; }
+        double GetElapsedS() const { return elapsedS; }
+
+    private:
+        constexpr static int MAX_CYCLES = 10;
+
+        void Finish();
+        void Fail(const char* reason);
+
+        AutotuneConfig config;
+        AutotuneState state = AutotuneState::Idle;
+        AutotuneResult result;
+        const char* failureReason = "";
+
+        bool heating = true;
+        bool seenFirstSwitch = false; // The approach to setpoint is not part of a cycle
+        double elapsedS = 0.0;
+        double lastSwitchS = 0.0;
+        double lastHeatStartS = 0.0;
+        double phaseMaxC = 0.0;
+        double phaseMinC = 0.0;
+        int completedCycles = 0;
+
+        // Per-cycle measurements; index 0 (first cycle) is discarded.
+        double heatTimeS[MAX_CYCLES + 1] = {};
+        double coolTimeS[MAX_CYCLES + 1] = {};
+        double peakHighC[MAX_CYCLES + 1] = {};
+        double peakLowC[MAX_CYCLES + 1] = {};
+};
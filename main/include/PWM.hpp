@@ -2,73 +2,138 @@
 
 #include <cstdint>
 #include "esp_err.h"
-
+#include "driver/gptimer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+// Hardware-timed, slow (relay) PWM over a set of output channels.
+//
+// A gptimer alarm ISR walks the cycle: at the start of each period it turns the
+// selected channels on, and after duty * period it turns them all off again.
+// Everything the ISR needs is precomputed by SetDutyCycle()/SetChannelWeights()
+// into a fixed-size Schedule, so the edge path never allocates and never waits
+// on a task. The ISR and the task side share it under a spinlock that is held
+// only to copy the schedule or to drive the outputs.
+// The ISR is not IRAM-resident, so edges are held off while flash is being
+// written; at relay periods (~1 s) that jitter is negligible.
+//
+// Channels with a weight below 1.0 are cycle-skipped: a weight of 0.5 turns the
+// channel on in every other cycle, 0.25 in one cycle out of four, and so on.
+// SetChannelDutyCycles() gives each channel its own duty on top of that: the
+// on-window follows the largest duty and lower-duty channels are cycle-skipped
+// down to theirs.
+//
+// Mode::BurstFire is meant for zero-crossing SSRs. Instead of one on-window per
+// period, the ISR runs once per mains cycle and spreads duty * weight of the
+// cycles evenly over time (Bresenham), so power resolution is one mains cycle
+// rather than one period. A zero-crossing SSR only switches at the next crossing,
+// so the ISR does not need to be phase-locked to the mains. Each on-window spans
+// two crossings and therefore conducts one positive and one negative half-cycle;
+// stepping per half-cycle would fire a single polarity at duty 1/2 and put DC on
+// the mains.
 class PWM
 {
 public:
-    using ToggleCallback = void(*)(void* user_ctx);
+    static constexpr int MAX_CHANNELS = 8;
+
+    enum class Mode : uint8_t { Window = 0, BurstFire = 1 };
+
+    // Called from the timer ISR (and from ForceOff() in task context) with the
+    // channels that must be on; every channel in channel_mask not in on_mask must
+    // be driven off. Must be ISR-safe: no blocking, no heap, no logging.
+    using OutputCallback = void(*)(uint32_t on_mask, uint32_t channel_mask, void* user_ctx);
 
     // period_ms: full PWM period in milliseconds (e.g., 1000 for 1 Hz)
     // duty_cycle: 0.0..1.0
     PWM(uint32_t period_ms,
                float duty_cycle,
-               ToggleCallback on_on,
-               ToggleCallback on_off,
+               OutputCallback output,
                void* user_ctx = nullptr);
 
     ~PWM();
 
-    // Start/stop the software PWM. Start() begins in the OFF state, then schedules the first transition.
+    // Start/stop the PWM. Start() begins a new cycle immediately.
     esp_err_t Start();
     esp_err_t Stop();
 
     bool IsRunning() const { return running_; }
 
-    // Update parameters (safe to call while running; takes effect on next edge).
+    // Update parameters (safe to call while running; takes effect at the next cycle start).
     esp_err_t SetPeriodMs(uint32_t period_ms);
-    esp_err_t SetDutyCycle(float duty_cycle); // clamps to [0,1]
+    esp_err_t SetDutyCycle(float duty_cycle); // clamps to [0,1]; same duty on every channel
+    // Per-channel duty (multi-zone control), each clamped to [0,1]. GetDutyCycle()
+    // then reports the largest duty among the owned channels.
+    esp_err_t SetChannelDutyCycles(const float (&duty_cycles)[MAX_CHANNELS]);
+
+    // Channels in channel_mask are owned by this PWM; weights[i] (clamped to [0,1])
+    // sets how often channel i takes part in a cycle.
+    esp_err_t SetChannelWeights(uint32_t channel_mask, const float (&weights)[MAX_CHANNELS]);
+
+    // mains_hz (50 or 60) sets the BurstFire cycle; ignored in Window mode.
+    esp_err_t SetMode(Mode mode, uint32_t mains_hz);
+    Mode GetMode() const { return mode_; }
 
     uint32_t GetPeriodMs() const { return period_ms_; }
     float GetDutyCycle() const { return duty_cycle_; }
 
-    // Force immediate state and invoke the corresponding callback.
-    // If running, the next edge is rescheduled from "now".
-    esp_err_t ForceOn();
+    // Drive every channel off right now (task context), including channels the
+    // running cycle still owns. The timer keeps running, so later cycles stay
+    // off only as long as the duty cycle is 0.
     esp_err_t ForceOff();
 
 private:
-    enum class State : uint8_t { Off = 0, On = 1 };
-
-    static void TimerThunk(void* arg);
-    void OnTimer();
-
-    // Recompute cached on/off durations based on period_ms_ and duty_cycle_
-    void RecomputeDurations();
-
-    // Schedule next timer event based on current state.
-    esp_err_t ScheduleNextEdge();
-
-    // Schedule a specific delay in microseconds.
-    esp_err_t ScheduleDelayUs(int64_t delay_us);
-
-    // Cancel any active timer.
-    void CancelTimer();
+    static constexpr uint32_t TIMER_RESOLUTION_HZ = 1000000; // 1 tick = 1 us
+    static constexpr uint32_t WEIGHT_ONE = 1u << 16;          // Q16 fixed point 1.0
+
+    // Everything the ISR reads for one cycle.
+    struct Schedule {
+        Mode mode = Mode::Window;
+        uint32_t mains_cycle_us = 20000; // BurstFire tick
+        uint32_t period_us = 1000000;
+        uint32_t on_us = 0;
+        uint32_t channel_mask = 0;      // Channels owned by this PWM
+        uint32_t full_mask = 0;         // Channels with weight 1.0 (on every cycle)
+        uint32_t weights_q16[MAX_CHANNELS] = {}; // Cycle-skip weights for the rest
+        uint32_t demand_q16[MAX_CHANNELS] = {};  // BurstFire: duty * weight per channel
+    };
+
+    enum class Phase : uint8_t { CycleStart = 0, OnEnd = 1 };
+
+    static bool AlarmThunk(gptimer_handle_t timer, const gptimer_alarm_event_data_t* edata, void* user_ctx);
+    // Both run with isr_mux_ held.
+    void OnAlarmLocked(uint64_t alarm_count);
+    // Returns the count of the next alarm.
+    uint64_t OnBurstCycleLocked(uint64_t alarm_count, const Schedule& schedule);
+
+    // Rebuild the schedule from the current parameters and publish it to the ISR.
+    void PublishSchedule();
 
 private:
     uint32_t period_ms_{1000};
     float duty_cycle_{0.5f};
+    uint32_t channel_mask_{0};
+    float weights_[MAX_CHANNELS] = {};
+    float duty_scales_[MAX_CHANNELS] = {1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f}; // Channel duty / duty_cycle_
+    Mode mode_{Mode::Window};
+    uint32_t mains_hz_{50};
 
-    uint32_t on_ms_{500};
-    uint32_t off_ms_{500};
-
-    ToggleCallback on_on_{nullptr};
-    ToggleCallback on_off_{nullptr};
+    OutputCallback output_{nullptr};
     void* user_ctx_{nullptr};
 
-    void* timer_{nullptr}; // esp_timer_handle_t but kept opaque in header
+    gptimer_handle_t timer_{nullptr};
+    SemaphoreHandle_t writer_mutex_{nullptr}; // Serialises the task-side setters only
 
-    State state_{State::Off};
+    // The ISR runs on the other core. It takes isr_mux_ for the whole alarm, so
+    // a publish never tears the schedule it reads, and once Stop() has cleared
+    // running_ under the same lock no alarm still in flight can drive an output.
+    portMUX_TYPE isr_mux_ = portMUX_INITIALIZER_UNLOCKED;
     bool running_{false};
-    bool timer_armed_{false};
-    int64_t section_started_us_{0};
-};
\ No newline at end of file
+    Schedule schedule_;
+
+    // ISR state, also guarded by isr_mux_
+    Phase phase_{Phase::CycleStart};
+    uint64_t cycle_start_count_{0};
+    uint32_t cycle_period_us_{0};
+    uint32_t cycle_channel_mask_{0};
+    uint32_t accumulators_q16_[MAX_CHANNELS] = {};
+};
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "ControlMath.hpp"
+#include <cstddef>
+#include <cstdint>
+
+// Stages of the process-value pipeline in Controller::UpdateProcessValue():
+//
+//     channel reading -> ChannelOutlierFilter -> weighted zone fusion -> ProcessValueFilter
+//
+// Plain value types with no locking; the controller owns one outlier filter
+// per thermocouple channel and one ProcessValueFilter per zone.
+
+// Median-of-N outlier rejection for one channel. Each reading is compared with
+// the median of itself and the previous WINDOW - 1 readings; if it sits more
+// than REJECT_SIGMAS robust standard deviations (1.4826 * MAD) away, the
+// median is used instead. Rejected readings stay in the window, so a real step
+// becomes the median and passes after half a window instead of being held off.
+class ChannelOutlierFilter {
+public:
+    constexpr static std::size_t WINDOW = 5;
+    constexpr static control_real_t REJECT_SIGMAS = 4;
+    // Smallest rejection band in °C. A settled MAX6675 can show a MAD of 0
+    // (or one 0.25 °C LSB), which would otherwise reject ordinary noise.
+    constexpr static control_real_t MIN_REJECT_BAND_C = 2;
+
+    // Returns the value to use for this pass; outRejected tells whether it is
+    // the window median rather than the reading.
+    control_real_t Filter(control_real_t reading, bool& outRejected);
+    void Reset();
+
+private:
+    control_real_t window[WINDOW] = {};
+    uint8_t count = 0; // Readings in window, up to WINDOW
+    uint8_t next = 0; // Slot the next reading overwrites
+};
+
+enum class ProcessValueFilterMode : uint8_t {
+    LowPass = 0, // Single-pole low-pass; rate is the slope of the filtered value
+    AlphaBeta = 1, // Critically damped alpha-beta tracker of value and rate
+};
+
+// Smooths one zone's fused reading and estimates its rate of change. Both
+// modes take the same time constant (the controller's input filter time).
+//
+// AlphaBeta is the fading-memory g-h filter, theta = exp(-dt / tau):
+//     alpha = 1 - theta^2,  beta = (1 - theta)^2
+// It predicts along the tracked slope, so on a ramp it has no steady-state lag,
+// where the low-pass trails by tau * rate. The same tau therefore filters
+// harder for the same lag, and the rate estimate can feed the PID derivative.
+class ProcessValueFilter {
+public:
+    // dtSeconds: spacing since the previous Update(). The first call after
+    // Reset() primes the filter with the reading and a zero rate.
+    control_real_t Update(control_real_t reading,
+                          control_real_t dtSeconds,
+                          control_real_t timeConstantS,
+                          ProcessValueFilterMode mode);
+    void Reset();
+
+    bool IsPrimed() const { return primed; }
+    control_real_t GetValue() const { return value; }
+    control_real_t GetRateCPerS() const { return rateCPerS; }
+
+private:
+    control_real_t value = 0;
+    control_real_t rateCPerS = 0;
+    bool primed = false;
+};
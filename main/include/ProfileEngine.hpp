@@ -5,9 +5,10 @@
 #include "freertos/semphr.h"
 #include <array>
 #include <cstddef>
+#include <cstdint>
 #include <optional>
 #include <string>
-#include <unordered_map>
+#include <type_traits>
 #include <vector>
 
 enum class ProfileStepType {
@@ -67,19 +68,7 @@ struct ProfileSlotSummary {
     std::size_t stepCount = 0;
 };
 
-struct ProfileRuntimeStatus {
-    bool running = false;
-    std::string name;
-    std::string source = "none";
-    int slotIndex = -1;
-    int currentStepNumber = 0;
-    std::string currentStepType = "none";
-    double stepElapsedS = 0.0;
-    double profileElapsedS = 0.0;
-    std::string lastEndReason = "none";
-};
-
-enum class ProfileEndReason {
+enum class ProfileEndReason : uint8_t {
     None,
     Completed,
     CancelledByUser,
@@ -89,6 +78,29 @@ enum class ProfileEndReason {
     InvalidProfile,
 };
 
+enum class ProfileSource : uint8_t {
+    None,
+    Uploaded,
+    Slot,
+};
+
+// Copied out on every telemetry frame, so it holds no strings that allocate.
+struct ProfileRuntimeStatus {
+    static constexpr std::size_t NAME_CAPACITY = 64; // Longer names are truncated here
+
+    bool running = false;
+    char name[NAME_CAPACITY] = {};
+    ProfileSource source = ProfileSource::None;
+    int slotIndex = -1;
+    int currentStepNumber = 0;
+    bool hasCurrentStep = false; // currentStepType is meaningless while false
+    ProfileStepType currentStepType = ProfileStepType::Direct;
+    double stepElapsedS = 0.0;
+    double profileElapsedS = 0.0;
+    ProfileEndReason lastEndReason = ProfileEndReason::None;
+};
+static_assert(std::is_trivially_copyable<ProfileRuntimeStatus>::value, "ProfileRuntimeStatus is copied per frame");
+
 class ProfileEngine {
 public:
     static ProfileEngine& getInstance();
@@ -97,9 +109,11 @@ public:
     ProfileEngine(ProfileEngine&&) = delete;
     ProfileEngine& operator=(ProfileEngine&&) = delete;
 
-    static constexpr int MAX_SLOTS = 5;
+    static constexpr int MAX_SLOTS = 16;
     static constexpr int MAX_STEPS = 40;
     static constexpr int SCHEMA_VERSION = 1;
+    static constexpr std::size_t MAX_NAME_BYTES = ProfileRuntimeStatus::NAME_CAPACITY - 1;
+    static constexpr std::size_t MAX_DESCRIPTION_BYTES = 255;
 
     esp_err_t Initialize();
 
@@ -113,6 +127,7 @@ public:
 
     std::array<ProfileSlotSummary, MAX_SLOTS> GetSlotSummaries() const;
     esp_err_t GetSlotProfile(int slotIndex, ProfileDefinition& outProfile) const;
+    // ESP_ERR_INVALID_STATE when the slot is occupied, ESP_ERR_NO_MEM when NVS is full.
     esp_err_t SaveProfileToSlot(int slotIndex, const ProfileDefinition& profile);
     esp_err_t DeleteSlotProfile(int slotIndex);
 
@@ -124,39 +139,121 @@ public:
     ProfileRuntimeStatus GetRuntimeStatus() const;
     bool IsRunning() const;
 
+    static const char* StepTypeToString(ProfileStepType type);
+    static const char* EndReasonToString(ProfileEndReason reason);
+    static const char* SourceToString(ProfileSource source);
+
+    // Step interpreter ops. Soak splits on the guarantee flag and ramps keep
+    // their kind because a rate ramp's duration depends on where it starts.
+    enum class PlanOp : uint8_t {
+        SetPoint,
+        Wait,
+        Soak,
+        GuaranteedSoak,
+        RampTime,
+        RampRate,
+        Jump,
+    };
+
+    // A ProfileStep with the JSON-facing optionals resolved and limits applied.
+    struct PlanStep {
+        PlanOp op = PlanOp::SetPoint;
+        ProfileStepType type = ProfileStepType::Direct; // Reported in the runtime status
+        bool hasWaitTime = false;
+        bool hasPvTarget = false;
+        double targetC = 0.0; // Setpoint, or the PV target of a wait
+        double durationS = 0.0; // Wait time, soak time or ramp time
+        double rampRateCPerS = 0.0;
+        double deviationC = 0.0; // Guaranteed soak band
+        int jumpTargetIndex = 0; // 0-based
+        int repeatCount = 0;
+    };
+
+    // Built once when a run starts so Tick() never touches the heap.
+    struct Plan {
+        char name[ProfileRuntimeStatus::NAME_CAPACITY] = {};
+        int stepCount = 0;
+        std::array<PlanStep, MAX_STEPS> steps = {};
+    };
+
+    // Progress through a Plan.
+    struct PlanCursor {
+        int stepIndex = 0;
+        double stepElapsedS = 0.0;
+        double profileElapsedS = 0.0;
+        double stepStartSetpointC = 0.0;
+        double stepDurationS = 0.0; // Ramp end time, fixed on entry
+        double stepSlopeCPerS = 0.0; // Ramp slope, fixed on entry
+        bool waitTimeLatched = false;
+        bool waitPvLatched = false;
+        double soakAccumulatedS = 0.0;
+        std::array<int, MAX_STEPS> jumpRemaining = {};
+    };
+
+    enum class PlanTickResult : uint8_t {
+        Running,
+        Completed,
+        TransitionGuard,
+        InvalidStep,
+    };
+
+    // The step interpreter, free of controller state so ProfileSimulator can
+    // drive it against a model. setpointC is the controller setpoint: ramps
+    // start from it and SetPoint/Soak/Ramp steps write it.
+    static void CompilePlan(const ProfileDefinition& profile, Plan& outPlan);
+    static void BeginPlan(const Plan& plan, PlanCursor& cursor, double setpointC);
+    // Advances by dtSeconds, then takes every transition that is due.
+    static PlanTickResult AdvancePlan(const Plan& plan, PlanCursor& cursor, double dtSeconds, double processValueC, double& setpointC);
+    // Setpoint lookaheadS from now and its slope over the following window, for
+    // the feedforward. Every remaining step is assumed to run for its nominal
+    // time; a PV-gated wait cannot be predicted and holds the setpoint.
+    static bool PredictTrajectory(const Plan& plan, const PlanCursor& cursor, double setpointC, double lookaheadS,
+                                  double& outSetpointAheadC, double& outRateCPerS);
+
 private:
     ProfileEngine();
     static ProfileEngine* instance;
 
+    // Slot blobs: a 16-byte header, the name and description bytes, then one
+    // 32-byte record per step. See StoredProfileHeader in ProfileEngine.cpp.
+    static constexpr std::size_t SLOT_BLOB_CAPACITY = 16 + MAX_NAME_BYTES + MAX_DESCRIPTION_BYTES + MAX_STEPS * 32;
+
     mutable SemaphoreHandle_t stateMutex = nullptr;
     bool initialized = false;
 
+    // Filled on first use and kept in step by saves and deletes, so listing
+    // slots does not touch NVS.
+    mutable bool slotSummariesValid = false;
+    mutable std::array<ProfileSlotSummary, MAX_SLOTS> slotSummaries = {};
+    mutable std::array<uint8_t, SLOT_BLOB_CAPACITY> slotBlobBuffer = {};
+
     bool hasUploadedProfile = false;
     ProfileDefinition uploadedProfile;
 
     bool running = false;
-    ProfileDefinition activeProfile;
-    std::string activeSource = "none"; // uploaded|slot|none
+    Plan activePlan;
+    ProfileSource activeSource = ProfileSource::None;
     int activeSlotIndex = -1;
-    int currentStepIndex = 0;
-    double currentStepElapsedS = 0.0;
-    double currentProfileElapsedS = 0.0;
-    double currentStepStartSetpointC = 0.0;
-    bool waitTimeLatched = false;
-    bool waitPvLatched = false;
-    double soakAccumulatedS = 0.0;
-    std::unordered_map<int, int> jumpRemainingByStep;
-    std::string lastEndReason = "none";
+    PlanCursor cursor;
+    ProfileEndReason lastEndReason = ProfileEndReason::None;
 
     bool IsValidSlotIndex(int slotIndex) const;
+    esp_err_t ReadSlotBlobLocked(int slotIndex, std::size_t& outBlobSize) const;
+    void EnsureSlotSummariesLocked() const;
+    void MigrateLegacySlotsLocked();
     esp_err_t LoadProfileFromSlotLocked(int slotIndex, ProfileDefinition& outProfile) const;
     esp_err_t SaveProfileToSlotLocked(int slotIndex, const ProfileDefinition& profile);
     esp_err_t DeleteSlotLocked(int slotIndex);
 
-    bool EnterStepLocked(int stepIndex);
-    bool ExecuteCurrentStepLocked(double dtSeconds, int& transitionsTaken);
-    void ResetJumpCountersInRangeLocked(int startStepInclusive, int endStepExclusive);
+    void PublishTrajectoryLocked();
+    esp_err_t StartPlanLocked(const ProfileDefinition& profile, ProfileSource source, int slotIndex);
+    // Pushes a changed setpoint to the controller and ends the run when the plan did.
+    void ApplyPlanTickLocked(PlanTickResult result, double previousSetpointC, double setpointC);
     void EndRunLocked(ProfileEndReason reason, bool stopChamber);
-    static const char* StepTypeToString(ProfileStepType type);
-    static const char* EndReasonToString(ProfileEndReason reason);
+
+    static bool PredictSetpoint(const Plan& plan, const PlanCursor& cursor, double setpointC, double horizonS, double& outSetpointC);
+    static void EnterStep(const Plan& plan, PlanCursor& cursor, int stepIndex, double setpointC);
+    static void ResetJumpCounters(const Plan& plan, PlanCursor& cursor, int startStepInclusive, int endStepExclusive);
+    // One step's worth of AdvancePlan(); returns true when the step is done.
+    static bool ExecuteStep(const Plan& plan, PlanCursor& cursor, double dtSeconds, double processValueC, double& setpointC, int& nextStepIndex);
 };
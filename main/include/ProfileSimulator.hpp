@@ -0,0 +1,148 @@
+#pragma once
+
+#include "ProcessValueFilter.hpp"
+#include "ProfileEngine.hpp"
+#include "ThermalModel.hpp"
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Controller settings a simulation runs with. CaptureControllerConfig() copies
+// them from the live Controller so a preview behaves like the oven would.
+struct SimulationControllerConfig {
+    double heatingKp = 1.0;
+    double heatingKi = 0.0;
+    double heatingKd = 0.0;
+    double coolingKp = 1.0;
+    double coolingKi = 0.0;
+    double coolingKd = 0.0;
+    double derivativeFilterTimeS = 0.0;
+    double setpointWeight = 0.5;
+    double integralZoneC = 0.0;
+    double integralLeakTimeS = 0.0;
+    double inputFilterTimeMs = 100.0;
+    ProcessValueFilterMode pvFilterMode = ProcessValueFilterMode::LowPass;
+    bool derivativeFromRate = false;
+    double coolOnBandC = 5.0;
+    double coolOffBandC = 2.0;
+    double heaterMinValuePct = 0.0;
+    double forceHeaterOnBelowC = 0.0;
+    bool feedforwardEnabled = false;
+    double feedforwardLookaheadS = 30.0;
+    double feedforwardGain = 1.0;
+};
+
+struct SimulationConfig {
+    ThermalModel model;
+    double deadTimeS = 0.0; // Heater-to-PV delay in front of the model
+    double initialPvC = 24.0; // Also the setpoint the first ramp starts from
+    double stepS = 0.22; // One thermocouple pass
+    double maxDurationS = 24.0 * 3600.0; // A PV wait the model never satisfies ends here
+    SimulationControllerConfig controller;
+};
+
+struct SimulationPoint {
+    float timeS = 0.0f;
+    float setpointC = 0.0f;
+    float processValueC = 0.0f;
+    float outputPct = 0.0f;
+    uint16_t stepNumber = 0; // 1-based
+};
+
+enum class SimulationOutcome : uint8_t {
+    Completed,
+    TransitionGuard,
+    InvalidProfile,
+    TimedOut,
+    Cancelled,
+};
+
+struct SimulationResult {
+    SimulationOutcome outcome = SimulationOutcome::Completed;
+    double durationS = 0.0; // Simulated profile time
+    double maxOvershootC = 0.0; // Largest PV above setpoint
+    uint32_t ticks = 0;
+    std::vector<SimulationPoint> points; // Downsampled; first and last tick included
+};
+
+enum class SimulationState : uint8_t {
+    Idle,
+    Running,
+    Complete,
+};
+
+struct SimulationStatus {
+    SimulationState state = SimulationState::Idle;
+    char profileName[ProfileRuntimeStatus::NAME_CAPACITY] = {};
+    double simulatedS = 0.0;
+    int64_t wallTimeUs = 0;
+    SimulationConfig config;
+    SimulationResult result; // Valid when state == Complete
+};
+
+// Fast-forwards a profile through the real step interpreter and PID against
+// the first-order ThermalModel. The cooling door is not modelled: negative
+// output leaves the heater off and the model cools passively. Simulate() is
+// deterministic and has no side effects, so it also serves as a regression
+// harness for profile and PID changes; Start() runs it on an idle-priority task.
+class ProfileSimulator {
+public:
+    constexpr static std::size_t MAX_POINTS = 500;
+    constexpr static double MIN_STEP_S = 0.05;
+    constexpr static double MAX_STEP_S = 10.0;
+    constexpr static double MAX_DEAD_TIME_S = 600.0;
+    // Dead-time delay line entries (deadTimeS / stepS), 16 KiB of floats. Keeps
+    // a long dead time at a short step from asking for an unbounded buffer.
+    constexpr static std::size_t MAX_DELAY_STEPS = 4096;
+    constexpr static double MAX_DURATION_S = 7.0 * 24.0 * 3600.0;
+
+    static ProfileSimulator& getInstance();
+    ProfileSimulator(const ProfileSimulator&) = delete;
+    ProfileSimulator& operator=(const ProfileSimulator&) = delete;
+    ProfileSimulator(ProfileSimulator&&) = delete;
+    ProfileSimulator& operator=(ProfileSimulator&&) = delete;
+
+    static SimulationControllerConfig CaptureControllerConfig();
+
+    // ESP_ERR_INVALID_ARG: invalid profile or config. ESP_ERR_INVALID_STATE: one is already running.
+    // ESP_ERR_NO_MEM: no room for the dead-time delay line or the task.
+    esp_err_t Start(const ProfileDefinition& profile, const SimulationConfig& config);
+    esp_err_t Cancel();
+    SimulationStatus GetStatus() const;
+
+    struct Progress {
+        std::atomic<bool> cancelRequested{false};
+        std::atomic<uint32_t> simulatedS{0};
+    };
+
+    static std::size_t DelayLineSteps(const SimulationConfig& config);
+    // delayLine: scratch of DelayLineSteps(config) entries (may be null when that is 0).
+    static void Simulate(const ProfileEngine::Plan& plan, const SimulationConfig& config, float* delayLine,
+                         SimulationResult& outResult, Progress* progress = nullptr);
+
+    static const char* OutcomeToString(SimulationOutcome outcome);
+    static const char* StateToString(SimulationState state);
+
+private:
+    ProfileSimulator();
+    static ProfileSimulator* instance;
+
+    static void TaskEntry(void* arg);
+    void RunTask();
+
+    mutable SemaphoreHandle_t stateMutex = nullptr;
+    TaskHandle_t taskHandle = nullptr;
+    SimulationState state = SimulationState::Idle;
+    ProfileEngine::Plan plan; // Written by Start() only while no task is running
+    SimulationConfig config;
+    float* delayLine = nullptr; // PSRAM, allocated by Start() and freed when the run ends
+    SimulationResult result;
+    int64_t startedUs = 0;
+    int64_t wallTimeUs = 0;
+    Progress progress;
+};
@@ -0,0 +1,117 @@
+#pragma once
+
+#include "DataManager.hpp"
+#include "HistoryBinaryEncoder.hpp"
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct RunLogInfo {
+    uint32_t runId = 0;
+    std::size_t sizeBytes = 0;
+    uint32_t startUnixTime = 0; // 0 when wall-clock time was not synced at run start
+    uint64_t firstTimestamp = 0; // Seconds since boot of the first record
+    bool active = false; // Currently being written
+};
+
+// Persists each chamber run to its own append-only file on the SPIFFS
+// partition, using the binary history format (HistoryBinaryEncoder).
+//
+// Append() only encodes into an in-RAM page and never touches flash; full
+// pages are handed to a low-priority writer task through a queue, so flash
+// latency cannot stall DataManager's logging loop. When the pool is exhausted
+// records are dropped (and counted) rather than blocking.
+class RunLogManager {
+public:
+    static RunLogManager& getInstance();
+    RunLogManager(const RunLogManager&) = delete;
+    RunLogManager& operator=(const RunLogManager&) = delete;
+    RunLogManager(RunLogManager&&) = delete;
+    RunLogManager& operator=(RunLogManager&&) = delete;
+
+    // SPIFFS must already be mounted (WebServerManager::Initialize does this).
+    esp_err_t Initialize();
+    bool IsInitialized() const { return initialized.load(std::memory_order_acquire); }
+
+    // Called for every logged point; opens a session on the first running
+    // point and closes it on the first idle one.
+    void Append(const DataPoint& point);
+
+    std::vector<RunLogInfo> ListRuns() const;
+    esp_err_t GetRunPath(uint32_t runId, std::string& outPath) const;
+    esp_err_t DeleteRun(uint32_t runId);
+    uint32_t GetDroppedRecordCount() const;
+    // True for "run_<id>.bin", the only files this class owns on SPIFFS.
+    static bool ParseRunFileName(const char* name, uint32_t& outRunId);
+
+    constexpr static const char* RUN_FILE_PREFIX = "run_";
+    constexpr static std::size_t PAGE_SIZE = 2048; // Buffered write size, a multiple of the SPIFFS page
+    constexpr static std::size_t PAGE_POOL_SIZE = 4;
+    constexpr static std::size_t MIN_FREE_BYTES = 64 * 1024; // Rotate out old runs below this much free space
+
+private:
+    RunLogManager();
+    static RunLogManager* instance;
+
+    enum class MessageType : uint8_t {
+        Open,
+        Data,
+        Close,
+    };
+
+    struct Message {
+        MessageType type = MessageType::Data;
+        uint8_t page = 0;
+        uint32_t runId = 0;
+        uint32_t nextSequence = 0; // Close only
+    };
+
+    struct Page {
+        std::size_t used = 0;
+        uint8_t data[PAGE_SIZE];
+    };
+
+    // Initialize() runs on the network start-up task while DataManager is already
+    // calling Append() on its own core; the release store publishes the mutex,
+    // queues and pages set up before it.
+    std::atomic<bool> initialized{false};
+    mutable SemaphoreHandle_t stateMutex = nullptr;
+    QueueHandle_t writerQueue = nullptr;
+    QueueHandle_t freePages = nullptr;
+    TaskHandle_t writerTaskHandle = nullptr;
+
+    Page* pages = nullptr;
+    int currentPage = -1;
+    bool sessionOpen = false;
+    uint32_t currentRunId = 0;
+    uint32_t nextRunId = 1;
+    uint32_t lastSequence = 0;
+    uint32_t droppedRecords = 0;
+    HistoryBinaryEncoder encoder;
+
+    // Writer-task state
+    FILE* writerFile = nullptr;
+    uint32_t writerRunId = 0;
+    bool writerHasActiveRun = false;
+
+    bool AcquirePageLocked();
+    void SubmitCurrentPageLocked();
+    void OpenSessionLocked(const DataPoint& firstPoint);
+    void CloseSessionLocked();
+
+    static void WriterTaskEntry(void* arg);
+    void WriterTaskLoop();
+    void WriterHandleOpen(uint32_t runId);
+    void WriterHandleData(uint8_t page);
+    void WriterHandleClose(uint32_t nextSequence);
+    void RotateForSpace(std::size_t neededBytes);
+
+    static std::string PathForRun(uint32_t runId);
+};
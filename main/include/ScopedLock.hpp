@@ -0,0 +1,31 @@
+#pragma once
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+// Holds a FreeRTOS mutex for the enclosing scope. A null mutex (component not
+// initialised yet) is tolerated: the scope simply runs unlocked.
+class ScopedLock {
+public:
+    explicit ScopedLock(SemaphoreHandle_t mutex)
+        : mutex_(mutex), locked_(false) {
+        if (mutex_ != nullptr) {
+            locked_ = (xSemaphoreTake(mutex_, portMAX_DELAY) == pdTRUE);
+        }
+    }
+
+    ~ScopedLock() {
+        if (locked_ && mutex_ != nullptr) {
+            xSemaphoreGive(mutex_);
+        }
+    }
+
+    ScopedLock(const ScopedLock&) = delete;
+    ScopedLock& operator=(const ScopedLock&) = delete;
+
+    bool Locked() const { return locked_; }
+
+private:
+    SemaphoreHandle_t mutex_;
+    bool locked_;
+};
@@ -1,12 +1,36 @@
 #pragma once
 
 #include "esp_err.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
 #include "nvs.h"
 #include "nvs_flash.h"
 #include <array>
+#include <cstddef>
 #include <cstdint>
 #include <string>
 
+struct SettingsWriteStats {
+    uint32_t pendingKeys = 0;
+    uint32_t commits = 0; // nvs_commit calls since boot
+    uint32_t keysWritten = 0;
+    uint32_t keysUnchanged = 0; // Staged but equal to what NVS already held
+    uint32_t failedWrites = 0;
+    uint32_t failedCommits = 0;
+    // Sticky: the most recent write or commit failure since boot, ESP_OK if none.
+    // Setters return before the deferred write runs, so this is where it shows.
+    esp_err_t lastError = ESP_OK;
+};
+
+// Getters read the RAM copy loaded at boot. Setters update it and stage the
+// key; staged keys reach NVS in one commit when the outermost batch ends, or
+// WRITE_BACK_DELAY_MS after the last unbatched change, so a slider dragged
+// across the page costs one flash write rather than one per step. Each key is
+// written at most once per commit and skipped when NVS already holds the value.
+// The deferred write runs on a low-priority task the timer wakes, not on the
+// shared esp_timer task.
 class SettingsManager {
 
     public:
@@ -16,8 +40,18 @@ class SettingsManager {
         SettingsManager(SettingsManager&&) = delete;
         SettingsManager& operator=(SettingsManager&&) = delete;
 
+        constexpr static uint32_t WRITE_BACK_DELAY_MS = 1500;
+
         esp_err_t Initialize();
 
+        // Nestable; prefer SettingsBatch. EndBatch() returns the commit result
+        // when it closes the outermost batch.
+        void BeginBatch();
+        esp_err_t EndBatch();
+        // Writes everything staged now, e.g. before a restart.
+        esp_err_t Flush();
+        SettingsWriteStats GetWriteStats() const;
+
         double GetInputFilterTime() const { return inputFilterTime; }
         esp_err_t SetInputFilterTime(double newValue);
 
@@ -67,6 +101,12 @@ class SettingsManager {
         esp_err_t SetRelayPWMWeight(int relayIndex, double newValue);
         esp_err_t SetRelayPWMWeights(const std::array<double, 8>& newValues);
 
+        // 0 = window PWM, 1 = burst-fire (zero-crossing SSRs only)
+        uint8_t GetRelayDriveMode() const { return relayDriveMode; }
+        esp_err_t SetRelayDriveMode(uint8_t newValue);
+        uint8_t GetMainsFrequencyHz() const { return mainsFrequencyHz; }
+        esp_err_t SetMainsFrequencyHz(uint8_t newValue);
+
         uint8_t GetRelaysOnMask() const { return relaysOnMask; }
         esp_err_t SetRelaysOnMask(uint8_t newValue);
 
@@ -106,6 +146,48 @@ class SettingsManager {
         double GetForceHeaterOnBelowC() const { return forceHeaterOnBelowC; }
         esp_err_t SetForceHeaterOnBelowC(double newValue);
 
+        // 0 = tick on every thermocouple pass, otherwise a fixed tick period.
+        int32_t GetControlTickMs() const { return controlTickMs; }
+        esp_err_t SetControlTickMs(int32_t newValue);
+
+        bool GetFeedforwardEnabled() const { return feedforwardEnabled != 0; }
+        esp_err_t SetFeedforwardEnabled(bool newValue);
+
+        double GetFeedforwardLookaheadS() const { return feedforwardLookaheadS; }
+        esp_err_t SetFeedforwardLookaheadS(double newValue);
+
+        double GetFeedforwardGain() const { return feedforwardGain; }
+        esp_err_t SetFeedforwardGain(double newValue);
+
+        double GetThermalModelGainCPerPct() const { return thermalModelGainCPerPct; }
+        esp_err_t SetThermalModelGainCPerPct(double newValue);
+
+        double GetThermalModelTimeConstantS() const { return thermalModelTimeConstantS; }
+        esp_err_t SetThermalModelTimeConstantS(double newValue);
+
+        double GetThermalModelAmbientC() const { return thermalModelAmbientC; }
+        esp_err_t SetThermalModelAmbientC(double newValue);
+
+        // 1 = single-zone control over the inputs/PWM relays above. Zone masks
+        // are packed one byte per zone, zone 0 in the low byte.
+        uint8_t GetControlZoneCount() const { return controlZoneCount; }
+        esp_err_t SetControlZoneCount(uint8_t newValue);
+        uint32_t GetZoneInputMasks() const { return static_cast<uint32_t>(zoneInputMasks); }
+        esp_err_t SetZoneInputMasks(uint32_t newValue);
+        uint32_t GetZoneRelayMasks() const { return static_cast<uint32_t>(zoneRelayMasks); }
+        esp_err_t SetZoneRelayMasks(uint32_t newValue);
+
+        // Process-value pipeline. Filter mode: 0 = low-pass, 1 = alpha-beta.
+        uint8_t GetProcessValueFilterMode() const { return processValueFilterMode; }
+        esp_err_t SetProcessValueFilterMode(uint8_t newValue);
+        bool GetOutlierRejectionEnabled() const { return outlierRejectionEnabled != 0; }
+        esp_err_t SetOutlierRejectionEnabled(bool newValue);
+        bool GetDerivativeFromRate() const { return derivativeFromRate != 0; }
+        esp_err_t SetDerivativeFromRate(bool newValue);
+        // Fusion weight of each thermocouple channel within its zone, 0..1.
+        std::array<double, 4> GetInputWeights() const { return inputWeights; }
+        esp_err_t SetInputWeights(const std::array<double, 4>& newValues);
+
     private:
         // NVS helper variables
         constexpr static const char* NVS_PARTITION = "nvs";
@@ -113,25 +195,56 @@ class SettingsManager {
         nvs_handle_t m_handle = 0;
         bool nvsOpen = false;
 
-        SettingsManager() = default;
+        SettingsManager();
         static SettingsManager* instance;
         bool initialized = false;
 
+        enum class StoredType : uint8_t {
+            Double,
+            U8,
+            I32,
+            String,
+        };
+
+        // The value is copied when staged, so a flush never reads a member
+        // another task is halfway through writing.
+        struct PendingWrite {
+            const char* key = nullptr; // Points at a KEY_* constant; compared by address
+            StoredType type = StoredType::Double;
+            uint64_t raw = 0; // Double bits, or the integer value
+            std::string text;
+        };
+        constexpr static std::size_t MAX_PENDING_WRITES = 48;
+
         esp_err_t OpenNVS();
         esp_err_t CloseNVS();
         esp_err_t LoadSettings();
         esp_err_t nvs_get_double(nvs_handle_t handle, const char* key, double* outValue);
-        esp_err_t NVS_Set_Double(const char* key, double value);
-        esp_err_t NVS_Set_U8(const char* key, uint8_t value);
-        esp_err_t NVS_Set_I32(const char* key, int32_t value);
-        esp_err_t NVS_Set_String(const char* key, const std::string& value);
+        esp_err_t StageDouble(const char* key, double value);
+        esp_err_t StageU8(const char* key, uint8_t value);
+        esp_err_t StageI32(const char* key, int32_t value);
+        esp_err_t StageString(const char* key, const std::string& value);
+        esp_err_t StageLocked(const char* key, StoredType type, uint64_t raw, const std::string* text);
+        esp_err_t FlushLocked();
+        esp_err_t WritePendingLocked(const PendingWrite& write, bool& outWritten);
+        static void WriteBackTimerCallback(void* arg);
+        static void WriteBackTaskEntry(void* arg);
+        void WriteBackTaskLoop();
+
+        mutable SemaphoreHandle_t pendingMutex = nullptr;
+        std::array<PendingWrite, MAX_PENDING_WRITES> pendingWrites = {};
+        std::size_t pendingCount = 0;
+        int batchDepth = 0;
+        esp_timer_handle_t writeBackTimer = nullptr;
+        TaskHandle_t writeBackTaskHandle = nullptr;
+        SettingsWriteStats writeStats;
 
         // THESE ARE THE SETTINGS
         // Every setting needs the following defined:
         // 1. A const for the key name ( <= 15 chars )
         // 2. A variable to hold the value in memory
         // 3. A getter function to access the value publically
-        // 4. A setter function to change the value publically (which also needs to save the new value to NVS)
+        // 4. A setter function to change the value publically (which also needs to stage the new value for NVS)
 
         constexpr static const char* KEY_INPUT_FILTER_TIME = "in_filt_t";
         constexpr static const char* KEY_INPUTS_INCLUDED = "in_mask";
@@ -150,6 +263,8 @@ class SettingsManager {
         constexpr static const char* KEY_I_LEAK_S = "i_leak_s";
         constexpr static const char* KEY_RELAYS_PWM = "rel_pwm";
         constexpr static const char* KEY_RELAYS_ON = "rel_on";
+        constexpr static const char* KEY_RELAY_DRIVE_MODE = "rel_mode";
+        constexpr static const char* KEY_MAINS_FREQUENCY = "mains_hz";
         constexpr static const char* KEY_TIMEZONE = "timezone";
         constexpr static const char* KEY_WIFI_SSID = "wifi_ssid";
         constexpr static const char* KEY_WIFI_PASSWORD = "wifi_pass";
@@ -162,6 +277,21 @@ class SettingsManager {
         constexpr static const char* KEY_COOL_OFF_BAND = "cool_off_bd";
         constexpr static const char* KEY_HEATER_MIN_VALUE = "heat_min_pc";
         constexpr static const char* KEY_FORCE_HEATER_BELOW = "heat_forc_c";
+        constexpr static const char* KEY_CONTROL_TICK = "ctrl_tick_ms";
+        constexpr static const char* KEY_FF_ENABLED = "ff_enabled";
+        constexpr static const char* KEY_FF_LOOKAHEAD = "ff_look_s";
+        constexpr static const char* KEY_FF_GAIN = "ff_gain";
+        constexpr static const char* KEY_MODEL_GAIN = "mdl_gain";
+        constexpr static const char* KEY_MODEL_TAU = "mdl_tau_s";
+        constexpr static const char* KEY_MODEL_AMBIENT = "mdl_amb_c";
+        constexpr static const char* KEY_ZONE_COUNT = "zone_count";
+        constexpr static const char* KEY_ZONE_INPUTS = "zone_in_msk";
+        constexpr static const char* KEY_ZONE_RELAYS = "zone_rel_msk";
+        constexpr static const char* KEY_PV_FILTER_MODE = "pv_filt_mode";
+        constexpr static const char* KEY_PV_REJECT = "pv_reject";
+        constexpr static const char* KEY_PV_RATE_DERIV = "pv_rate_d";
+        constexpr static const char* KEY_INPUT_WEIGHTS[4] = {"inw0", "inw1", "inw2", "inw3"};
+        constexpr static const char* KEY_RELAY_WEIGHTS[8] = {"relw0", "relw1", "relw2", "relw3", "relw4", "relw5", "relw6", "relw7"};
 
         double inputFilterTime = 1000.0;
         uint8_t inputsIncludedMask = 0x01;
@@ -178,6 +308,8 @@ class SettingsManager {
         uint8_t relaysPWMMask = 0x03;
         std::array<double, 8> relayPWMWeights = {1.0, 0.5, 1.0, 1.0, 1.0, 1.0, 1.0, 1.0};
         uint8_t relaysOnMask = 0x04;
+        uint8_t relayDriveMode = 0;
+        uint8_t mainsFrequencyHz = 50;
         std::string timeZone = "EST";
         std::string wifiSSID = "NETGEAR";
         std::string wifiPassword = "TYLERSETUP";
@@ -190,6 +322,45 @@ class SettingsManager {
         double coolOffBandC = 2.0;
         double heaterMinValuePct = 0.0;
         double forceHeaterOnBelowC = 0.0;
+        int32_t controlTickMs = 0;
+        uint8_t feedforwardEnabled = 0;
+        double feedforwardLookaheadS = 30.0;
+        double feedforwardGain = 1.0;
+        double thermalModelGainCPerPct = 0.0; // 0 = no model fitted yet
+        double thermalModelTimeConstantS = 0.0;
+        double thermalModelAmbientC = 24.0;
+        uint8_t controlZoneCount = 1;
+        int32_t zoneInputMasks = 0;
+        int32_t zoneRelayMasks = 0;
+        uint8_t processValueFilterMode = 0;
+        uint8_t outlierRejectionEnabled = 1;
+        uint8_t derivativeFromRate = 0;
+        std::array<double, 4> inputWeights = {1.0, 1.0, 1.0, 1.0};
 
 
 };
+
+// Stages every setter call in its scope and commits them together when it
+// ends, or earlier via Commit() to see the result.
+class SettingsBatch {
+public:
+    SettingsBatch() { SettingsManager::getInstance().BeginBatch(); }
+    ~SettingsBatch() {
+        if (!committed) {
+            (void)SettingsManager::getInstance().EndBatch();
+        }
+    }
+    SettingsBatch(const SettingsBatch&) = delete;
+    SettingsBatch& operator=(const SettingsBatch&) = delete;
+
+    esp_err_t Commit() {
+        if (committed) {
+            return ESP_OK;
+        }
+        committed = true;
+        return SettingsManager::getInstance().EndBatch();
+    }
+
+private:
+    bool committed = false;
+};
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct TaskProfile {
+    char name[configMAX_TASK_NAME_LEN] = {};
+    uint32_t priority = 0;
+    int core = -1; // -1 = not pinned
+    uint32_t stackFreeMinBytes = 0; // High-water mark: least free stack seen
+    float cpuPct = 0.0f; // Share of one core over the profile window
+};
+
+struct HeapProfile {
+    std::size_t totalBytes = 0;
+    std::size_t freeBytes = 0;
+    std::size_t minFreeBytes = 0; // Low-water mark since boot
+    std::size_t largestFreeBlock = 0;
+};
+
+struct SystemProfile {
+    static constexpr std::size_t MAX_TASKS = 32;
+
+    bool runtimeStats = false; // False when the FreeRTOS run-time counters are compiled out
+    int64_t windowUs = 0; // CPU% and httpd figures cover this much time
+    int64_t capturedUs = 0;
+    std::size_t taskCount = 0;
+    std::size_t omittedTasks = 0; // Running tasks beyond MAX_TASKS, not listed
+    std::array<TaskProfile, MAX_TASKS> tasks = {};
+    HeapProfile internalHeap;
+    HeapProfile psramHeap;
+    uint32_t httpdRequests = 0; // Handler invocations in the window
+    uint32_t httpdBusyUs = 0;
+    uint32_t httpdWorstUs = 0;
+    float httpdBusyPct = 0.0f; // Of the single httpd worker task
+};
+
+// Per-task CPU share, stack and heap headroom, and httpd load. CPU% is the
+// delta of the FreeRTOS run-time counters between two captures, so readers
+// share one sampling window instead of each resetting it.
+class SystemProfiler {
+public:
+    constexpr static int64_t MIN_WINDOW_US = 1000000;
+
+    static SystemProfiler& getInstance();
+    SystemProfiler(const SystemProfiler&) = delete;
+    SystemProfiler& operator=(const SystemProfiler&) = delete;
+    SystemProfiler(SystemProfiler&&) = delete;
+    SystemProfiler& operator=(SystemProfiler&&) = delete;
+
+    // Re-samples when the last profile is at least MIN_WINDOW_US old,
+    // otherwise returns it unchanged.
+    SystemProfile Capture();
+
+    // Called by the web server for every unit of work run on the httpd task.
+    void RecordHttpdWork(uint32_t busyUs);
+
+private:
+    SystemProfiler();
+    static SystemProfiler* instance;
+
+    void SampleLocked(int64_t nowUs);
+
+    struct RunTimeEntry {
+        UBaseType_t taskNumber = 0;
+        configRUN_TIME_COUNTER_TYPE runTime = 0;
+    };
+
+    mutable SemaphoreHandle_t profileMutex = nullptr;
+    SystemProfile latest;
+    bool hasSample = false;
+    int64_t lastSampleUs = 0;
+    configRUN_TIME_COUNTER_TYPE previousTotalRunTime = 0;
+    // Sized from uxTaskGetNumberOfTasks() on every sample: uxTaskGetSystemState()
+    // returns nothing at all when the buffer is too small.
+    std::vector<RunTimeEntry> previousRunTimes;
+    std::vector<RunTimeEntry> runTimes;
+    std::vector<TaskStatus_t> statusBuffer;
+    bool loggedOmittedTasks = false;
+
+    // Accumulated since the last sample.
+    uint32_t httpdRequests = 0;
+    uint64_t httpdBusyUs = 0;
+    uint32_t httpdWorstUs = 0;
+};
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "Controller.hpp"
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include <cstdint>
+
+// Fast-changing controller/hardware state captured once per controller tick.
+// Fixed-size so publishing it never allocates.
+struct TelemetrySnapshot {
+    uint32_t tick = 0; // Increments on every Publish()
+    bool running = false;
+    bool doorOpen = false;
+    bool alarming = false;
+    char state[sizeof(ControllerSnapshot::state)] = {};
+    float setPoint = 0.0f;
+    float processValue = 0.0f;
+    float processRate = 0.0f; // °C/s, from the input filter
+    float pidOutput = 0.0f;
+    float pTerm = 0.0f;
+    float iTerm = 0.0f;
+    float dTerm = 0.0f;
+    float feedforward = 0.0f;
+    float temperatures[4] = {};
+    uint8_t relayStates = 0; // Bit i = relay i
+    float servoAngle = 0.0f;
+    AutotuneState autotuneState = AutotuneState::Idle;
+    uint8_t autotuneCycle = 0;
+    uint8_t autotuneCycles = 0;
+    uint8_t zoneCount = 1;
+    float zoneProcessValue[MAX_CONTROL_ZONES] = {};
+    float zoneOutput[MAX_CONTROL_ZONES] = {};
+};
+
+// Hand-off point between the controller task and the websocket telemetry task.
+// The controller pushes a snapshot after every tick and wakes the subscriber,
+// so frames go out one tick after the state changed instead of on a timer.
+class TelemetryPublisher {
+public:
+    static TelemetryPublisher& getInstance();
+    TelemetryPublisher(const TelemetryPublisher&) = delete;
+    TelemetryPublisher& operator=(const TelemetryPublisher&) = delete;
+    TelemetryPublisher(TelemetryPublisher&&) = delete;
+    TelemetryPublisher& operator=(TelemetryPublisher&&) = delete;
+
+    // Builds a snapshot from the live Controller/HardwareManager state.
+    static TelemetrySnapshot CaptureCurrent();
+
+    // Called from the controller task; stamps the tick and notifies the subscriber.
+    void Publish(const TelemetrySnapshot& snapshot);
+
+    // Returns false until the first Publish().
+    bool GetLatest(TelemetrySnapshot& outSnapshot) const;
+
+    // Only one task is notified; a later call replaces the earlier subscriber.
+    void SetSubscriber(TaskHandle_t task);
+
+private:
+    TelemetryPublisher();
+    static TelemetryPublisher* instance;
+
+    mutable SemaphoreHandle_t snapshotMutex = nullptr;
+    TelemetrySnapshot latest;
+    bool hasSnapshot = false;
+    uint32_t nextTick = 1;
+    TaskHandle_t subscriber = nullptr;
+};
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "esp_err.h"
+#include <cstddef>
+#include <cstdint>
+
+// First-order model of the chamber with the heater as the only input:
+//
+//     tau * dT/dt = K * u - (T - Tamb)
+//
+// u is the controller output in % (the value logged as DataPoint::PIDOutput),
+// K the steady-state rise per % output and tau the time constant. Inverting it
+// gives the output that keeps T on a trajectory, which is the feedforward term.
+struct ThermalModel {
+    double gainCPerPct = 0.0;
+    double timeConstantS = 0.0;
+    double ambientC = 24.0;
+
+    bool IsValid() const { return gainCPerPct > 0.0 && timeConstantS > 0.0; }
+
+    // Output (% , clamped to 0..100) that holds the model on setPointC while it
+    // moves at rateCPerS.
+    double FeedforwardOutputPct(double setPointC, double rateCPerS) const;
+};
+
+struct ThermalModelFit {
+    ThermalModel model;
+    double deadTimeS = 0.0; // Input delay that fitted best; a good lookahead
+    double rmseCPerS = 0.0; // Residual of the fitted dT/dt
+    std::size_t samples = 0;
+};
+
+// Least-squares fit of dT/dt = a*u(t - d) + b*T + c over uniformly spaced
+// samples, scanning the dead time d. Samples are only compared within one
+// segment (a run of contiguous, heater-only history).
+// ESP_ERR_NOT_FOUND: not enough usable samples.
+// ESP_ERR_INVALID_STATE: the data does not excite the model (no heating
+// transients) or the fit is not physical.
+esp_err_t FitThermalModel(const float* processValueC,
+                          const float* outputPct,
+                          const uint16_t* segment,
+                          std::size_t count,
+                          double sampleIntervalS,
+                          ThermalModelFit& outFit);
+
+// Runs FitThermalModel() over the raw DataManager history.
+esp_err_t FitThermalModelFromHistory(ThermalModelFit& outFit);
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include <cstdint>
+
+// Deadline statistics of the control loop since the last reset (or period change).
+struct TickStats {
+    static constexpr int JITTER_BUCKETS = 8;
+    // Upper bound (inclusive) of each jitter bucket; the last bucket has no bound.
+    static constexpr uint32_t JITTER_BUCKET_LIMITS_US[JITTER_BUCKETS - 1] = {
+        500, 1000, 2000, 5000, 10000, 20000, 50000};
+
+    uint32_t periodUs = 0; // Nominal tick period the deadlines are measured against
+    uint32_t ticks = 0;
+    uint32_t overruns = 0; // Tick took longer than one period to execute
+    uint32_t missedDeadlines = 0; // Tick started two or more periods after the previous one
+    uint32_t lastExecUs = 0;
+    uint32_t worstExecUs = 0;
+    uint32_t meanExecUs = 0;
+    uint32_t worstJitterUs = 0;
+    uint32_t jitterHistogram[JITTER_BUCKETS] = {}; // |start interval - period|
+    int64_t sinceUs = 0; // esp_timer time of the reset
+};
+
+// Fed by the controller task once per tick; read by the diagnostics API.
+class TickMonitor {
+public:
+    static TickMonitor& getInstance();
+    TickMonitor(const TickMonitor&) = delete;
+    TickMonitor& operator=(const TickMonitor&) = delete;
+    TickMonitor(TickMonitor&&) = delete;
+    TickMonitor& operator=(TickMonitor&&) = delete;
+
+    // startUs: esp_timer time the tick began; execUs: how long it ran.
+    // A new periodUs restarts the statistics.
+    void Record(int64_t startUs, uint32_t execUs, uint32_t periodUs);
+    TickStats GetStats() const;
+    void Reset();
+
+private:
+    TickMonitor();
+    static TickMonitor* instance;
+
+    void ResetLocked(uint32_t periodUs);
+
+    mutable SemaphoreHandle_t statsMutex = nullptr;
+    TickStats stats;
+    uint64_t execSumUs = 0;
+    int64_t lastStartUs = 0;
+};
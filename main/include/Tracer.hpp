@@ -0,0 +1,108 @@
+#pragma once
+
+#include "esp_cpu.h"
+#include "esp_err.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "sdkconfig.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Scoped hot-path tracing into a PSRAM ring, exported as Chrome trace JSON.
+//
+//     TRACE_SCOPE("DataManager::LogDataPoint");
+//
+// records one complete event from that line to the end of the enclosing block.
+// Names must be string literals: only the pointer is stored. With
+// CONFIG_TRACE_ENABLED off the macro expands to nothing. Recording is lock-free
+// and ISR-safe (the gptimer ISR is not IRAM-resident, so PSRAM is always
+// reachable when it runs).
+
+struct TraceRecord {
+    const char* name = nullptr;
+    int64_t startUs = 0; // esp_timer time; comparable across cores
+    double durationUs = 0.0; // From the cycle counter when the scope stayed on one core
+    TaskHandle_t task = nullptr; // nullptr for ISR events
+    uint8_t core = 0;
+};
+
+struct TraceCursor {
+    uint32_t next = 0;
+    uint32_t end = 0;
+};
+
+class Tracer {
+public:
+    static Tracer& getInstance();
+    Tracer(const Tracer&) = delete;
+    Tracer& operator=(const Tracer&) = delete;
+    Tracer(Tracer&&) = delete;
+    Tracer& operator=(Tracer&&) = delete;
+
+    // Allocates the ring; a no-op returning ESP_ERR_NOT_SUPPORTED when tracing is compiled out.
+    esp_err_t Initialize();
+    bool IsAvailable() const { return events != nullptr; }
+    std::size_t GetCapacity() const { return capacity; }
+    std::size_t GetEventCount() const;
+
+    // A frozen ring keeps its contents until Clear(), so the events leading up
+    // to an overrun survive long enough to be downloaded.
+    void Freeze() { frozen.store(true, std::memory_order_relaxed); }
+    bool IsFrozen() const { return frozen.load(std::memory_order_relaxed); }
+    void Clear();
+
+    void Record(const char* name, int64_t startUs, uint32_t startCycles, int startCore);
+
+    // Oldest to newest; events overwritten while reading are skipped.
+    TraceCursor OpenCursor() const;
+    std::size_t ReadBatch(TraceCursor& cursor, TraceRecord* out, std::size_t maxRecords) const;
+
+private:
+    Tracer() = default;
+    static Tracer* instance;
+
+    struct Slot {
+        std::atomic<uint32_t> sequence{0}; // Index + 1 once written; 0 while being written
+        const char* name = nullptr;
+        int64_t startUs = 0;
+        uint32_t durationCycles = 0;
+        TaskHandle_t task = nullptr;
+        uint8_t core = 0;
+    };
+
+    Slot* events = nullptr;
+    std::size_t capacity = 0;
+    std::atomic<uint32_t> head{0};
+    std::atomic<bool> frozen{false};
+};
+
+class TraceScope {
+public:
+    explicit TraceScope(const char* name)
+        : name_(name),
+          startUs_(esp_timer_get_time()),
+          startCycles_(esp_cpu_get_cycle_count()),
+          startCore_(esp_cpu_get_core_id()) {}
+
+    ~TraceScope() { Tracer::getInstance().Record(name_, startUs_, startCycles_, startCore_); }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+    const char* name_;
+    int64_t startUs_;
+    uint32_t startCycles_;
+    int startCore_;
+};
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+
+#if CONFIG_TRACE_ENABLED
+#define TRACE_SCOPE(name) TraceScope TRACE_CONCAT(traceScope_, __LINE__)(name)
+#else
+#define TRACE_SCOPE(name) ((void)0)
+#endif
@@ -1,14 +1,28 @@
 #pragma once
 
 #include "DataManager.hpp"
+#include "ProfileEngine.hpp"
+#include "TelemetryPublisher.hpp"
 #include "esp_err.h"
 #include "esp_http_server.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/semphr.h"
 #include "freertos/task.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
 #include <string>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
+// Websocket delivery counters; drops and closes are cumulative since boot.
+struct WsSendStats {
+    uint32_t clients = 0;
+    uint32_t droppedFrames = 0; // Replaced by a newer frame before it went out
+    uint32_t slowClientCloses = 0; // Closed after a send timed out or failed
+};
+
 class WebServerManager {
 public:
     static WebServerManager& getInstance();
@@ -27,10 +41,52 @@ private:
     bool initialized = false;
     bool spiffsMounted = false;
     httpd_handle_t server = nullptr;
+    std::size_t maxOpenSockets = 0;
+
+    enum class WsFormat : uint8_t {
+        Json,
+        Binary,
+    };
+
+    // One encoded frame, shared by every client it is queued for.
+    struct WsPayload {
+        httpd_ws_type_t type = HTTPD_WS_TYPE_TEXT;
+        std::string data;
+    };
+
+    // Per-connection telemetry state, guarded by wsClientsMutex.
+    struct WsClient {
+        int fd = -1;
+        WsFormat format = WsFormat::Json;
+        int64_t minIntervalUs = 0; // 0 = every controller tick
+        int64_t lastSentUs = 0;
+        bool needsKeyframe = true; // On connect and after (re)subscribing
+        bool missedUpdate = false; // Something changed that this client hasn't been sent
+        std::shared_ptr<const WsPayload> pending; // Newest undelivered frame
+        bool diagnostics = false; // Also receives the 1 Hz diagnostics frame
+        std::shared_ptr<const WsPayload> pendingDiagnostics; // Kept apart so it never replaces a telemetry frame
+    };
+
+    // A SPIFFS file, or an embedded one, resolved for a request path. Neither
+    // changes without a reflash, so resolutions are cached for the life of the
+    // server; only the httpd task touches the cache and the read buffer.
+    struct StaticAsset {
+        std::string filePath;
+        const uint8_t* data = nullptr; // Memory-mapped flash with CONFIG_WEBUI_EMBEDDED; filePath is unused
+        std::size_t size = 0;
+        const char* contentType = nullptr;
+        bool gzip = false; // filePath is the precompressed "<name>.gz"
+        bool immutable = false; // Content-hashed name under /assets/
+        std::string etag;
+    };
+    std::unordered_map<std::string, StaticAsset> staticAssets;
+    std::unique_ptr<char[]> staticFileBuffer;
 
     TaskHandle_t wsTelemetryTaskHandle = nullptr;
+    TaskHandle_t wsSenderTaskHandle = nullptr;
     SemaphoreHandle_t wsClientsMutex = nullptr;
-    std::vector<int> wsClients;
+    std::vector<WsClient> wsClients;
+    WsSendStats wsSendStats; // Guarded by wsClientsMutex; clients is filled in by GetWsSendStats()
 
     esp_err_t MountSpiffs();
     esp_err_t StartServer();
@@ -39,6 +95,7 @@ private:
 
     esp_err_t HandleApiRequest(httpd_req_t* req);
     esp_err_t HandleStaticFileRequest(httpd_req_t* req);
+    const StaticAsset* ResolveStaticAsset(const std::string& localPath);
     esp_err_t HandleWebsocketRequest(httpd_req_t* req);
 
     esp_err_t HandleApiGet(httpd_req_t* req, const std::string& path);
@@ -47,13 +104,21 @@ private:
     esp_err_t HandleApiDelete(httpd_req_t* req, const std::string& path);
 
     std::string BuildStatusEnvelopeJson(const char* eventType = "status") const;
-    std::string BuildTelemetryEnvelopeJson(const char* eventType) const;
+    std::string BuildTelemetryEnvelopeJson(
+        const char* eventType,
+        const TelemetrySnapshot& snapshot,
+        const ProfileRuntimeStatus& profileStatus) const;
 
     std::string GetRequestPath(httpd_req_t* req) const;
     std::string GetRequestQuery(httpd_req_t* req) const;
     esp_err_t ReadRequestBody(httpd_req_t* req, std::string& outBody) const;
-    esp_err_t SendHistoryJson(httpd_req_t* req, const DataPointStorage& points) const;
-    esp_err_t SendHistoryCsv(httpd_req_t* req, const DataPointStorage& points) const;
+    esp_err_t SendHistoryJson(httpd_req_t* req, DataHistoryCursor cursor) const;
+    esp_err_t SendHistoryRollupJson(httpd_req_t* req, DataHistoryCursor cursor) const;
+    esp_err_t SendHistoryBinary(httpd_req_t* req, DataHistoryCursor cursor) const;
+    esp_err_t SendHistoryCsv(httpd_req_t* req) const;
+    esp_err_t SendRunFile(httpd_req_t* req, uint32_t runId) const;
+    esp_err_t SendTraceJson(httpd_req_t* req) const;
+    esp_err_t SendSimulationJson(httpd_req_t* req) const;
 
     esp_err_t SendJsonSuccess(httpd_req_t* req, const std::string& dataJson) const;
     esp_err_t SendJsonError(httpd_req_t* req, int statusCode, const char* code, const char* message) const;
@@ -67,8 +132,21 @@ private:
 
     static void WsTelemetryTaskEntry(void* arg);
     void WsTelemetryTaskLoop();
-    void BroadcastWebsocketMessage(const std::string& payload);
+    void DispatchTelemetry(
+        const TelemetrySnapshot& snapshot,
+        const ProfileRuntimeStatus& profileStatus,
+        bool keyframeForAll,
+        const std::string& deltaJson);
+    void DispatchDiagnostics();
+    void QueueWsPayloadLocked(WsClient& client, const std::shared_ptr<const WsPayload>& payload);
+    static void WsSenderTaskEntry(void* arg);
+    void WsSenderTaskLoop();
+    bool TakeWsSendBatch(std::vector<std::pair<int, std::shared_ptr<const WsPayload>>>& outBatch);
+    void SendWsFrame(int fd, const WsPayload& payload);
+    WsSendStats GetWsSendStats() const;
+    WsClient* FindWsClientLocked(int fd);
     bool HasWsClients() const;
     void AddWsClient(int fd);
     void RemoveWsClient(int fd);
+    void HandleWsClientMessage(int fd, const char* message, std::size_t length);
 };
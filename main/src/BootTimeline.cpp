@@ -0,0 +1,90 @@
+#include "BootTimeline.hpp"
+
+#include "ScopedLock.hpp"
+#include "esp_timer.h"
+
+BootTimeline* BootTimeline::instance = nullptr;
+
+BootTimeline& BootTimeline::getInstance() {
+    if (instance == nullptr) {
+        instance = new BootTimeline();
+    }
+    return *instance;
+}
+
+BootTimeline::BootTimeline() {
+    stateMutex = xSemaphoreCreateMutex();
+}
+
+void BootTimeline::MarkAppStart() {
+    ScopedLock lock(stateMutex);
+    timeline.appStartUs = esp_timer_get_time();
+}
+
+void BootTimeline::BeginStage(BootStage stage) {
+    if (stage >= BootStage::Count) {
+        return;
+    }
+    const int64_t nowUs = esp_timer_get_time();
+    ScopedLock lock(stateMutex);
+    BootStageTiming& timing = timeline.stages[static_cast<std::size_t>(stage)];
+    timing.started = true;
+    timing.startUs = nowUs;
+}
+
+void BootTimeline::EndStage(BootStage stage, esp_err_t result) {
+    if (stage >= BootStage::Count) {
+        return;
+    }
+    const int64_t nowUs = esp_timer_get_time();
+    ScopedLock lock(stateMutex);
+    BootStageTiming& timing = timeline.stages[static_cast<std::size_t>(stage)];
+    timing.finished = true;
+    timing.durationUs = nowUs - timing.startUs;
+    timing.result = result;
+}
+
+void BootTimeline::SkipStage(BootStage stage) {
+    if (stage >= BootStage::Count) {
+        return;
+    }
+    ScopedLock lock(stateMutex);
+    timeline.stages[static_cast<std::size_t>(stage)].skipped = true;
+}
+
+void BootTimeline::MarkControlReady() {
+    const int64_t nowUs = esp_timer_get_time();
+    ScopedLock lock(stateMutex);
+    timeline.controlReadyUs = nowUs;
+}
+
+void BootTimeline::MarkNetworkReady() {
+    const int64_t nowUs = esp_timer_get_time();
+    ScopedLock lock(stateMutex);
+    timeline.networkReadyUs = nowUs;
+}
+
+BootTimelineSnapshot BootTimeline::GetSnapshot() const {
+    ScopedLock lock(stateMutex);
+    return timeline;
+}
+
+const char* BootTimeline::StageToString(BootStage stage) {
+    switch (stage) {
+        case BootStage::Tracer: return "tracer";
+        case BootStage::Settings: return "settings";
+        case BootStage::Hardware: return "hardware";
+        case BootStage::Controller: return "controller";
+        case BootStage::ProfileEngine: return "profile_engine";
+        case BootStage::DataManager: return "data_manager";
+        case BootStage::ControlBenchmark: return "control_benchmark";
+        case BootStage::ControllerTask: return "controller_task";
+        case BootStage::WiFiInit: return "wifi_init";
+        case BootStage::WebServer: return "web_server";
+        case BootStage::RunLog: return "run_log";
+        case BootStage::WiFiConnect: return "wifi_connect";
+        case BootStage::TimeSync: return "time_sync";
+        case BootStage::Count: break;
+    }
+    return "unknown";
+}
@@ -0,0 +1,82 @@
+#include "ControlBenchmark.hpp"
+
+#include "PID.hpp"
+#include "esp_cpu.h"
+#include "esp_log.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+namespace {
+constexpr const char* TAG = "ControlBench";
+constexpr int ITERATIONS = 2000;
+
+struct TickCost {
+    uint32_t totalCycles = 0;
+    uint32_t pidCycles = 0;
+    uint32_t doorCycles = 0;
+};
+
+// Same arithmetic as one Controller tick, fed by a crude first-order plant so
+// the PID sees realistic errors and both the heating and cooling branches run.
+template <typename T>
+TickCost MeasureTick(bool powDoorCurve) {
+    BasicPID<T> pid;
+    (void)pid.TuneHeating(T(15), T(2), T(5));
+    (void)pid.TuneCooling(T(15), T(0), T(5));
+    (void)pid.SetDerivativeFilterTime(T(1));
+    (void)pid.SetIntegralLeakTimeSeconds(T(600));
+
+    const T dt = T(0.22);
+    const T alpha = dt / (T(1) + dt);
+    T plant = T(24);
+    T filtered = plant;
+    volatile T sink = T(0);
+
+    uint32_t pidCycles = 0;
+    uint32_t doorCycles = 0;
+    const uint32_t start = esp_cpu_get_cycle_count();
+    for (int i = 0; i < ITERATIONS; ++i) {
+        const T setPoint = (i < ITERATIONS / 2) ? T(150) : T(60);
+        filtered = alpha * plant + (T(1) - alpha) * filtered;
+
+        const uint32_t pidStart = esp_cpu_get_cycle_count();
+        const T output = pid.Calculate(setPoint, filtered, dt);
+        pidCycles += esp_cpu_get_cycle_count() - pidStart;
+
+        const uint32_t doorStart = esp_cpu_get_cycle_count();
+        T door = T(0);
+        if (output < T(0)) {
+            const T demand = std::min(-output / T(100), T(1));
+            door = powDoorCurve ? T(1) - std::pow(T(1) - demand, T(1) / T(3)) : T(1) - std::cbrt(T(1) - demand);
+        }
+        doorCycles += esp_cpu_get_cycle_count() - doorStart;
+
+        plant += (std::max(output, T(0)) * T(0.02) - (plant - T(24)) * T(0.002) - door * T(0.5)) * dt;
+        sink = door;
+    }
+    (void)sink;
+
+    TickCost cost;
+    cost.totalCycles = (esp_cpu_get_cycle_count() - start) / ITERATIONS;
+    cost.pidCycles = pidCycles / ITERATIONS;
+    cost.doorCycles = doorCycles / ITERATIONS;
+    return cost;
+}
+
+void LogCost(const char* label, const TickCost& cost) {
+    ESP_LOGI(TAG, "%-16s %6lu cycles/tick (pid %lu, door curve %lu)", label,
+        static_cast<unsigned long>(cost.totalCycles),
+        static_cast<unsigned long>(cost.pidCycles),
+        static_cast<unsigned long>(cost.doorCycles));
+}
+}
+
+void RunControlMathBenchmark() {
+    ESP_LOGI(TAG, "Control math, %d ticks per run (includes timing overhead)", ITERATIONS);
+    LogCost("double + pow", MeasureTick<double>(true));
+    LogCost("double + cbrt", MeasureTick<double>(false));
+    LogCost("float + pow", MeasureTick<float>(true));
+    LogCost("float + cbrt", MeasureTick<float>(false));
+}
@@ -1,7 +1,10 @@
 #include "Controller.hpp"
 
 #include "HardwareManager.hpp"
+#include "ScopedLock.hpp"
 #include "SettingsManager.hpp"
+#include "Tracer.hpp"
+#include "esp_timer.h"
 #include <algorithm>
 #include <array>
 #include <cmath>
@@ -9,28 +12,27 @@
 
 Controller* Controller::instance = nullptr;
 
+static_assert(MAX_CONTROL_ZONES <= ThermocoupleSnapshot::MAX_CHANNELS, "a zone needs a thermocouple of its own");
+static_assert(PV_INPUT_CHANNELS == ThermocoupleSnapshot::MAX_CHANNELS, "the PV pipeline tracks every thermocouple channel");
+
 namespace {
-class ScopedLock {
-public:
-    explicit ScopedLock(SemaphoreHandle_t mutex)
-        : mutex_(mutex), locked_(false) {
-        if (mutex_ != nullptr) {
-            locked_ = (xSemaphoreTake(mutex_, portMAX_DELAY) == pdTRUE);
+// Every zone needs at least one thermocouple and one PWM relay, and a relay
+// belongs to one zone only.
+bool ZoneConfigsValid(const ControlZoneConfig* configs, std::size_t count, uint8_t pwmRelayMask) {
+    constexpr uint8_t inputChannelsMask = static_cast<uint8_t>((1u << ThermocoupleSnapshot::MAX_CHANNELS) - 1u);
+    uint8_t claimedRelays = 0;
+    for (std::size_t zone = 0; zone < count; ++zone) {
+        const ControlZoneConfig& config = configs[zone];
+        if (config.inputMask == 0 || (config.inputMask & ~inputChannelsMask) != 0) {
+            return false;
         }
-    }
-
-    ~ScopedLock() {
-        if (locked_ && mutex_ != nullptr) {
-            xSemaphoreGive(mutex_);
+        if (config.relayMask == 0 || (config.relayMask & ~pwmRelayMask) != 0 || (config.relayMask & claimedRelays) != 0) {
+            return false;
         }
+        claimedRelays |= config.relayMask;
     }
-
-    bool Locked() const { return locked_; }
-
-private:
-    SemaphoreHandle_t mutex_;
-    bool locked_;
-};
+    return true;
+}
 }
 
 // =================================================
@@ -45,25 +47,31 @@ Controller& Controller::getInstance() {
 }
 
 Controller::Controller()
-    : pidController(),
-      relayPWM(1000, 0.0f, &Controller::RelayOnThunk, &Controller::RelayOffThunk, this)
+    : relayPWM(1000, 0.0f, &Controller::RelayOutputThunk, this)
 {
     stateMutex = xSemaphoreCreateMutex();
 
     SettingsManager& settings = SettingsManager::getInstance();
     inputFilterTimeMs = settings.GetInputFilterTime();
-    (void)pidController.TuneHeating(
-        settings.GetHeatingProportionalGain(),
-        settings.GetHeatingIntegralGain(),
-        settings.GetHeatingDerivativeGain());
-    (void)pidController.TuneCooling(
-        settings.GetCoolingProportionalGain(),
-        settings.GetCoolingIntegralGain(),
-        settings.GetCoolingDerivativeGain());
-    (void)pidController.SetDerivativeFilterTime(settings.GetDerivativeFilterTime());
-    (void)pidController.SetSetpointWeight(settings.GetSetpointWeight());
-    (void)pidController.SetIntegralZoneC(settings.GetIntegralZoneC());
-    (void)pidController.SetIntegralLeakTimeSeconds(settings.GetIntegralLeakTimeSeconds());
+    pvPipeline.filterMode = settings.GetProcessValueFilterMode() == 1
+        ? ProcessValueFilterMode::AlphaBeta : ProcessValueFilterMode::LowPass;
+    pvPipeline.outlierRejection = settings.GetOutlierRejectionEnabled();
+    pvPipeline.derivativeFromRate = settings.GetDerivativeFromRate();
+    pvPipeline.inputWeights = settings.GetInputWeights();
+    for (ZoneState& zone : zones) {
+        (void)zone.pid.TuneHeating(
+            settings.GetHeatingProportionalGain(),
+            settings.GetHeatingIntegralGain(),
+            settings.GetHeatingDerivativeGain());
+        (void)zone.pid.TuneCooling(
+            settings.GetCoolingProportionalGain(),
+            settings.GetCoolingIntegralGain(),
+            settings.GetCoolingDerivativeGain());
+        (void)zone.pid.SetDerivativeFilterTime(settings.GetDerivativeFilterTime());
+        (void)zone.pid.SetSetpointWeight(settings.GetSetpointWeight());
+        (void)zone.pid.SetIntegralZoneC(settings.GetIntegralZoneC());
+        (void)zone.pid.SetIntegralLeakTimeSeconds(settings.GetIntegralLeakTimeSeconds());
+    }
     ApplyInputsMask(settings.GetInputsIncludedMask());
     ApplyRelaysPWMMask(settings.GetRelaysPWMMask());
     const std::array<double, 8> relayWeights = settings.GetRelayPWMWeights();
@@ -72,8 +80,12 @@ Controller::Controller()
             entry.second = std::clamp(relayWeights[static_cast<std::size_t>(entry.first)], 0.0, 1.0);
         }
     }
-    SyncRelayPWMAccumulatorsLocked();
+    SyncRelayPWMScheduleLocked();
+    relayDriveMode = settings.GetRelayDriveMode() == 1 ? PWM::Mode::BurstFire : PWM::Mode::Window;
+    mainsFrequencyHz = settings.GetMainsFrequencyHz();
+    (void)relayPWM.SetMode(relayDriveMode, mainsFrequencyHz);
     ApplyRelaysOnMask(settings.GetRelaysOnMask());
+    ApplyZoneSettings(settings.GetControlZoneCount(), settings.GetZoneInputMasks(), settings.GetZoneRelayMasks());
     doorClosedAngleDeg = std::clamp(settings.GetDoorClosedAngleDeg(), 0.0, 180.0);
     doorOpenAngleDeg = std::clamp(settings.GetDoorOpenAngleDeg(), 0.0, 180.0);
     doorMaxSpeedDegPerSec = std::clamp(settings.GetDoorMaxSpeedDegPerSec(), 1.0, 360.0);
@@ -81,7 +93,15 @@ Controller::Controller()
     coolOffBandC = settings.GetCoolOffBandC();
     heaterMinValuePct = std::clamp(settings.GetHeaterMinValuePct(), 0.0, 100.0);
     forceHeaterOnBelowC = std::max(settings.GetForceHeaterOnBelowC(), 0.0);
+    tickIntervalMs = static_cast<uint32_t>(std::max<int32_t>(settings.GetControlTickMs(), 0));
+    feedforwardEnabled = settings.GetFeedforwardEnabled();
+    feedforwardLookaheadS = settings.GetFeedforwardLookaheadS();
+    feedforwardGain = settings.GetFeedforwardGain();
+    thermalModel.gainCPerPct = settings.GetThermalModelGainCPerPct();
+    thermalModel.timeConstantS = settings.GetThermalModelTimeConstantS();
+    thermalModel.ambientC = settings.GetThermalModelAmbientC();
     doorPreviewAngleDeg = doorOpenAngleDeg;
+    PublishSnapshotLocked();
 }
 
 double Controller::GetSetPoint() const {
@@ -129,6 +149,18 @@ double Controller::GetInputFilterTimeMs() const {
     return inputFilterTimeMs;
 }
 
+ProcessValuePipelineConfig Controller::GetProcessValuePipeline() const {
+    ScopedLock lock(stateMutex);
+    return pvPipeline;
+}
+
+std::array<uint32_t, PV_INPUT_CHANNELS> Controller::GetRejectedReadingCounts() const {
+    std::array<uint32_t, PV_INPUT_CHANNELS> counts = {};
+    ScopedLock lock(stateMutex);
+    std::copy(std::begin(rejectedReadingCounts), std::end(rejectedReadingCounts), counts.begin());
+    return counts;
+}
+
 std::vector<int> Controller::GetInputChannels() const {
     ScopedLock lock(stateMutex);
     return inputsBeingUsed;
@@ -157,6 +189,42 @@ std::vector<int> Controller::GetRelaysWhenRunning() const {
     return relaysWhenControllerRunning;
 }
 
+uint8_t Controller::GetZoneCount() const {
+    ScopedLock lock(stateMutex);
+    return zoneCount;
+}
+
+std::vector<ControlZoneConfig> Controller::GetControlZones() const {
+    ScopedLock lock(stateMutex);
+    if (zoneCount > 1) {
+        return std::vector<ControlZoneConfig>(zoneConfigs, zoneConfigs + zoneCount);
+    }
+
+    // The single zone is whatever the inputs and PWM relays are set to.
+    ControlZoneConfig single;
+    for (int channel : inputsBeingUsed) {
+        if (channel >= 0 && channel < ThermocoupleSnapshot::MAX_CHANNELS) {
+            single.inputMask |= static_cast<uint8_t>(1u << channel);
+        }
+    }
+    for (const auto& entry : relaysPWM) {
+        if (entry.first >= 0 && entry.first < PWM::MAX_CHANNELS) {
+            single.relayMask |= static_cast<uint8_t>(1u << entry.first);
+        }
+    }
+    return {single};
+}
+
+PWM::Mode Controller::GetRelayDriveMode() const {
+    ScopedLock lock(stateMutex);
+    return relayDriveMode;
+}
+
+uint8_t Controller::GetMainsFrequencyHz() const {
+    ScopedLock lock(stateMutex);
+    return mainsFrequencyHz;
+}
+
 double Controller::GetDoorClosedAngleDeg() const {
     ScopedLock lock(stateMutex);
     return doorClosedAngleDeg;
@@ -192,25 +260,95 @@ double Controller::GetForceHeaterOnBelowC() const {
     return forceHeaterOnBelowC;
 }
 
-esp_err_t Controller::RunTick() {
-    esp_err_t err = Perform();
+uint32_t Controller::GetTickIntervalMs() const {
+    ScopedLock lock(stateMutex);
+    return tickIntervalMs;
+}
+
+double Controller::GetNominalTickIntervalMs() const {
+    ScopedLock lock(stateMutex);
+    return tickIntervalMs == 0 ? SAMPLE_TICK_INTERVAL_MS : static_cast<double>(tickIntervalMs);
+}
+
+esp_err_t Controller::SetTickIntervalMs(uint32_t intervalMs) {
+    if (intervalMs != 0 && (intervalMs < MIN_TICK_INTERVAL_MS || intervalMs > MAX_TICK_INTERVAL_MS)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    esp_err_t err = SettingsManager::getInstance().SetControlTickMs(static_cast<int32_t>(intervalMs));
     if (err != ESP_OK) {
         return err;
     }
 
-    bool isRunning = false;
+    ScopedLock lock(stateMutex);
+    tickIntervalMs = intervalMs;
+    return ESP_OK;
+}
+
+bool Controller::IsFeedforwardEnabled() const {
+    ScopedLock lock(stateMutex);
+    return feedforwardEnabled;
+}
+
+double Controller::GetFeedforwardLookaheadS() const {
+    ScopedLock lock(stateMutex);
+    return feedforwardLookaheadS;
+}
+
+double Controller::GetFeedforwardGain() const {
+    ScopedLock lock(stateMutex);
+    return feedforwardGain;
+}
+
+ThermalModel Controller::GetThermalModel() const {
+    ScopedLock lock(stateMutex);
+    return thermalModel;
+}
+
+esp_err_t Controller::RunTick(double dtSeconds) {
+    TRACE_SCOPE("Controller::RunTick");
+    esp_err_t err = Perform();
+    if (err == ESP_OK) {
+        bool isRunning = false;
+        bool isAutotuning = false;
+        {
+            ScopedLock lock(stateMutex);
+            isRunning = running;
+            isAutotuning = autotuneActive;
+        }
+
+        if (isRunning && isAutotuning) {
+            err = PerformAutotune(dtSeconds);
+        } else {
+            err = isRunning ? PerformOnRunning(dtSeconds) : PerformOnNotRunning(dtSeconds);
+        }
+    }
+
     {
         ScopedLock lock(stateMutex);
-        isRunning = running;
+        PublishSnapshotLocked();
     }
+    return err;
+}
 
-    if (isRunning) {
-        return PerformOnRunning();
+ControllerSnapshot Controller::GetSnapshot() const {
+    while (true) {
+        // While the sequence is odd the writer is filling the other buffer, so
+        // the published one is still safe to copy.
+        const uint32_t sequence = snapshotSequence.load(std::memory_order_acquire);
+        const ControllerSnapshot copy = snapshotBuffers[(sequence >> 1) & 1];
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (snapshotSequence.load(std::memory_order_relaxed) == sequence) {
+            return copy;
+        }
     }
-    return PerformOnNotRunning();
 }
 
 esp_err_t Controller::Start() {
+    return StartRun(nullptr);
+}
+
+esp_err_t Controller::StartRun(const AutotuneConfig* autotune) {
     bool isAlarming = false;
     bool isRunning = false;
     {
@@ -237,15 +375,32 @@ esp_err_t Controller::Start() {
     {
         ScopedLock lock(stateMutex);
         running = true;
+        pidElapsedS = 0.0;
+        // A new run starts from a clean integrator and derivative history
+        // rather than whatever the previous run left behind.
+        for (ZoneState& zone : zones) {
+            (void)zone.pid.Reset();
+        }
         doorPreviewActive = false;
         coolingDoorEnabled = false;
-        state = "Steady State";
+        if (autotune != nullptr) {
+            setPoint = autotune->setPointC;
+            autotuneActive = true;
+            state = "Autotuning";
+        } else {
+            state = "Steady State";
+        }
+        PublishSnapshotLocked();
     }
 
     return ESP_OK;
 }
 
 esp_err_t Controller::Stop() {
+    return StopWithState("Idle");
+}
+
+esp_err_t Controller::StopWithState(const char* finalState) {
     bool isRunning = false;
     {
         ScopedLock lock(stateMutex);
@@ -271,9 +426,17 @@ esp_err_t Controller::Stop() {
     {
         ScopedLock lock(stateMutex);
         running = false;
-        state = "Idle";
+        state = finalState;
         PIDOutput = 0.0;
+        for (ZoneState& zone : zones) {
+            zone.output = 0.0;
+        }
         coolingDoorEnabled = false;
+        if (autotuneActive) {
+            autotuner.Cancel();
+            autotuneActive = false;
+        }
+        PublishSnapshotLocked();
     }
 
     return ESP_OK;
@@ -305,7 +468,7 @@ esp_err_t Controller::SetSetPoint(double newSetPoint) {
     }
 
     ScopedLock lock(stateMutex);
-    if (setpointLockedByProfile) {
+    if (setpointLockedByProfile || autotuneActive) {
         return ESP_ERR_INVALID_STATE;
     }
     setPoint = newSetPoint;
@@ -325,6 +488,16 @@ esp_err_t Controller::SetSetPointFromProfile(double newSetPoint) {
 void Controller::SetProfileSetpointLock(bool locked) {
     ScopedLock lockGuard(stateMutex);
     setpointLockedByProfile = locked;
+    if (!locked) {
+        hasProfileTrajectory = false;
+    }
+}
+
+void Controller::SetProfileTrajectory(double setPointAheadC, double rateCPerS) {
+    ScopedLock lock(stateMutex);
+    hasProfileTrajectory = true;
+    trajectorySetpointC = std::clamp(setPointAheadC, MIN_SETPOINT, MAX_SETPOINT);
+    trajectoryRateCPerS = rateCPerS;
 }
 
 esp_err_t Controller::SetInputFilterTime(double newFilterTimeMs) {
@@ -340,13 +513,64 @@ esp_err_t Controller::SetInputFilterTime(double newFilterTimeMs) {
     return SettingsManager::getInstance().SetInputFilterTime(newFilterTimeMs);
 }
 
+esp_err_t Controller::SetProcessValuePipeline(const ProcessValuePipelineConfig& config) {
+    if (config.filterMode != ProcessValueFilterMode::LowPass && config.filterMode != ProcessValueFilterMode::AlphaBeta) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    for (double weight : config.inputWeights) {
+        if (!(weight >= 0.0 && weight <= 1.0)) {
+            return ESP_ERR_INVALID_ARG;
+        }
+    }
+
+    {
+        ScopedLock lock(stateMutex);
+        if (config.filterMode != pvPipeline.filterMode) {
+            // The two modes keep different state; restart from the next pass
+            // rather than feed one's rate into the other.
+            for (ZoneState& zone : zones) {
+                zone.filter.Reset();
+            }
+            hasFilteredProcessValue = false;
+        }
+        if (config.outlierRejection && !pvPipeline.outlierRejection) {
+            for (ChannelOutlierFilter& filter : channelOutlierFilters) {
+                filter.Reset();
+            }
+        }
+        pvPipeline = config;
+        ++pvPipelineGeneration;
+    }
+
+    SettingsManager& settings = SettingsManager::getInstance();
+    SettingsBatch settingsBatch;
+    esp_err_t err = settings.SetProcessValueFilterMode(static_cast<uint8_t>(config.filterMode));
+    if (err == ESP_OK) {
+        err = settings.SetOutlierRejectionEnabled(config.outlierRejection);
+    }
+    if (err == ESP_OK) {
+        err = settings.SetDerivativeFromRate(config.derivativeFromRate);
+    }
+    if (err == ESP_OK) {
+        err = settings.SetInputWeights(config.inputWeights);
+    }
+    if (err == ESP_OK) {
+        err = settingsBatch.Commit();
+    }
+    return err;
+}
+
 esp_err_t Controller::SetHeatingPIDGains(double newKp, double newKi, double newKd) {
-    esp_err_t err = pidController.TuneHeating(newKp, newKi, newKd);
-    if (err != ESP_OK) {
-        return err;
+    esp_err_t err = ESP_OK;
+    for (ZoneState& zone : zones) {
+        err = zone.pid.TuneHeating(newKp, newKi, newKd);
+        if (err != ESP_OK) {
+            return err;
+        }
     }
 
     SettingsManager& settings = SettingsManager::getInstance();
+    SettingsBatch batch;
     err = settings.SetHeatingProportionalGain(newKp);
     if (err != ESP_OK) {
         return err;
@@ -355,16 +579,24 @@ esp_err_t Controller::SetHeatingPIDGains(double newKp, double newKi, double newK
     if (err != ESP_OK) {
         return err;
     }
-    return settings.SetHeatingDerivativeGain(newKd);
+    err = settings.SetHeatingDerivativeGain(newKd);
+    if (err != ESP_OK) {
+        return err;
+    }
+    return batch.Commit();
 }
 
 esp_err_t Controller::SetCoolingPIDGains(double newKp, double newKi, double newKd) {
-    esp_err_t err = pidController.TuneCooling(newKp, newKi, newKd);
-    if (err != ESP_OK) {
-        return err;
+    esp_err_t err = ESP_OK;
+    for (ZoneState& zone : zones) {
+        err = zone.pid.TuneCooling(newKp, newKi, newKd);
+        if (err != ESP_OK) {
+            return err;
+        }
     }
 
     SettingsManager& settings = SettingsManager::getInstance();
+    SettingsBatch batch;
     err = settings.SetCoolingProportionalGain(newKp);
     if (err != ESP_OK) {
         return err;
@@ -373,7 +605,11 @@ esp_err_t Controller::SetCoolingPIDGains(double newKp, double newKi, double newK
     if (err != ESP_OK) {
         return err;
     }
-    return settings.SetCoolingDerivativeGain(newKd);
+    err = settings.SetCoolingDerivativeGain(newKd);
+    if (err != ESP_OK) {
+        return err;
+    }
+    return batch.Commit();
 }
 
 esp_err_t Controller::SetPIDGains(double newKp, double newKi, double newKd) {
@@ -385,35 +621,47 @@ esp_err_t Controller::SetDerivativeFilterTime(double newFilterTimeSeconds) {
         return ESP_ERR_INVALID_ARG;
     }
 
-    esp_err_t err = pidController.SetDerivativeFilterTime(newFilterTimeSeconds);
-    if (err != ESP_OK) {
-        return err;
+    esp_err_t err = ESP_OK;
+    for (ZoneState& zone : zones) {
+        err = zone.pid.SetDerivativeFilterTime(newFilterTimeSeconds);
+        if (err != ESP_OK) {
+            return err;
+        }
     }
 
     return SettingsManager::getInstance().SetDerivativeFilterTime(newFilterTimeSeconds);
 }
 
 esp_err_t Controller::SetSetpointWeight(double newWeight) {
-    esp_err_t err = pidController.SetSetpointWeight(newWeight);
-    if (err != ESP_OK) {
-        return err;
+    esp_err_t err = ESP_OK;
+    for (ZoneState& zone : zones) {
+        err = zone.pid.SetSetpointWeight(newWeight);
+        if (err != ESP_OK) {
+            return err;
+        }
     }
 
     return SettingsManager::getInstance().SetSetpointWeight(newWeight);
 }
 
 esp_err_t Controller::SetIntegralZoneC(double zoneC) {
-    esp_err_t err = pidController.SetIntegralZoneC(zoneC);
-    if (err != ESP_OK) {
-        return err;
+    esp_err_t err = ESP_OK;
+    for (ZoneState& zone : zones) {
+        err = zone.pid.SetIntegralZoneC(zoneC);
+        if (err != ESP_OK) {
+            return err;
+        }
     }
     return SettingsManager::getInstance().SetIntegralZoneC(zoneC);
 }
 
 esp_err_t Controller::SetIntegralLeakTimeSeconds(double leakTimeSeconds) {
-    esp_err_t err = pidController.SetIntegralLeakTimeSeconds(leakTimeSeconds);
-    if (err != ESP_OK) {
-        return err;
+    esp_err_t err = ESP_OK;
+    for (ZoneState& zone : zones) {
+        err = zone.pid.SetIntegralLeakTimeSeconds(leakTimeSeconds);
+        if (err != ESP_OK) {
+            return err;
+        }
     }
     return SettingsManager::getInstance().SetIntegralLeakTimeSeconds(leakTimeSeconds);
 }
@@ -474,32 +722,68 @@ esp_err_t Controller::SetInputChannels(const std::vector<int>& channels) {
     return SettingsManager::getInstance().SetInputsIncludedMask(BuildInputsMask());
 }
 
+esp_err_t Controller::SetControlZones(const std::vector<ControlZoneConfig>& newZones) {
+    if (newZones.empty() || newZones.size() > MAX_CONTROL_ZONES) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // A single zone follows the input channels and PWM relays, so its masks are not stored.
+    const uint8_t count = static_cast<uint8_t>(newZones.size());
+    uint32_t inputMasks = 0;
+    uint32_t relayMasks = 0;
+    if (count > 1) {
+        if (!ZoneConfigsValid(newZones.data(), newZones.size(), BuildRelaysPWMMask())) {
+            return ESP_ERR_INVALID_ARG;
+        }
+        for (uint8_t zone = 0; zone < count; ++zone) {
+            inputMasks |= static_cast<uint32_t>(newZones[zone].inputMask) << (8u * zone);
+            relayMasks |= static_cast<uint32_t>(newZones[zone].relayMask) << (8u * zone);
+        }
+    }
+
+    if (IsRunning()) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    SettingsManager& settings = SettingsManager::getInstance();
+    SettingsBatch batch;
+    esp_err_t err = settings.SetControlZoneCount(count);
+    if (err == ESP_OK) {
+        err = settings.SetZoneInputMasks(inputMasks);
+    }
+    if (err == ESP_OK) {
+        err = settings.SetZoneRelayMasks(relayMasks);
+    }
+    if (err == ESP_OK) {
+        err = batch.Commit();
+    }
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    ScopedLock lock(stateMutex);
+    ApplyZoneSettings(count, inputMasks, relayMasks);
+    return ESP_OK;
+}
+
 std::string Controller::GetStateTUI() const {
     std::vector<int> channelsCopy;
     std::unordered_map<int, double> relaysPWMCopy;
     std::vector<int> relaysOnCopy;
-    bool runningCopy = false;
-    bool doorOpenCopy = false;
-    bool alarmingCopy = false;
-    std::string stateCopy;
-    double setpointCopy = 0.0;
-    double processCopy = 0.0;
-    double pidOutputCopy = 0.0;
-    double filterCopy = 0.0;
+    const ControllerSnapshot snapshot = GetSnapshot();
+    const bool runningCopy = snapshot.running;
+    const bool doorOpenCopy = snapshot.doorOpen;
+    const bool alarmingCopy = snapshot.alarming;
+    const double setpointCopy = snapshot.setPoint;
+    const double processCopy = snapshot.processValue;
+    const double pidOutputCopy = snapshot.pidOutput;
+    const double filterCopy = snapshot.inputFilterTimeMs;
 
     {
         ScopedLock lock(stateMutex);
         channelsCopy = inputsBeingUsed;
         relaysPWMCopy = relaysPWM;
         relaysOnCopy = relaysWhenControllerRunning;
-        runningCopy = running;
-        doorOpenCopy = doorOpen;
-        alarmingCopy = alarming;
-        stateCopy = state;
-        setpointCopy = setPoint;
-        processCopy = processValue;
-        pidOutputCopy = PIDOutput;
-        filterCopy = inputFilterTimeMs;
     }
 
     std::string channels = "-";
@@ -533,8 +817,8 @@ std::string Controller::GetStateTUI() const {
     std::snprintf(line1, sizeof(line1), "+---------------------------------------------------------------+");
     std::snprintf(line2, sizeof(line2), "|                    REFLOW CONTROLLER STATUS                   |");
     std::snprintf(line3, sizeof(line3), "+---------------------------------------------------------------+");
-    std::snprintf(line4, sizeof(line4), "| Mode:%-6s State:%-16.16s Alarm:%-3s                           |", runText, stateCopy.c_str(), alarmText);
-    std::snprintf(line5, sizeof(line5), "| Door:%-6s Tick(ms):%-6.0f Filter(ms):%-7.1f                    |", doorText, TICK_INTERVAL_MS, filterCopy);
+    std::snprintf(line4, sizeof(line4), "| Mode:%-6s State:%-16.16s Alarm:%-3s                           |", runText, snapshot.state, alarmText);
+    std::snprintf(line5, sizeof(line5), "| Door:%-6s Tick(ms):%-6.0f Filter(ms):%-7.1f                    |", doorText, GetNominalTickIntervalMs(), filterCopy);
     std::snprintf(line6, sizeof(line6), "| Setpoint:%8.2f  PV:%10.2f  Error:%10.2f                      |", setpointCopy, processCopy, (setpointCopy - processCopy));
     std::snprintf(line7, sizeof(line7), "| PID Out:%9.2f  PID Mode:%-8s                                 |", pidOutputCopy, pidMode);
     std::snprintf(line8, sizeof(line8), "| Inputs:%3zu  Ch:%-47.47s |", channelsCopy.size(), channels.c_str());
@@ -560,11 +844,117 @@ std::string Controller::GetStateTUI() const {
     return tui;
 }
 
+AutotuneStatus Controller::GetAutotuneStatus() const {
+    ScopedLock lock(stateMutex);
+    AutotuneStatus status;
+    status.state = autotuner.GetState();
+    status.config = autotuner.GetConfig();
+    status.result = autotuner.GetResult();
+    status.completedCycles = autotuner.GetCompletedCycles();
+    status.totalCycles = autotuner.GetTotalCycles();
+    status.elapsedS = autotuner.GetElapsedS();
+    status.failureReason = autotuner.GetFailureReason();
+    return status;
+}
+
+esp_err_t Controller::StartAutotune(const AutotuneConfig& config) {
+    if (config.setPointC < MIN_SETPOINT || config.setPointC > MAX_SETPOINT) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (IsSetpointLockedByProfile()) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    {
+        ScopedLock lock(stateMutex);
+        esp_err_t err = autotuner.Start(config);
+        if (err != ESP_OK) {
+            return err;
+        }
+    }
+
+    esp_err_t err = StartRun(&config);
+    if (err != ESP_OK) {
+        ScopedLock lock(stateMutex);
+        autotuner.Cancel();
+        return err;
+    }
+    return ESP_OK;
+}
+
+esp_err_t Controller::CancelAutotune() {
+    {
+        ScopedLock lock(stateMutex);
+        if (!autotuneActive) {
+            return ESP_ERR_INVALID_STATE;
+        }
+    }
+    return Stop();
+}
+
+esp_err_t Controller::AcceptAutotuneResult() {
+    AutotuneResult result;
+    {
+        ScopedLock lock(stateMutex);
+        if (autotuner.GetState() != AutotuneState::Complete) {
+            return ESP_ERR_INVALID_STATE;
+        }
+        result = autotuner.GetResult();
+    }
+
+    esp_err_t err = SetHeatingPIDGains(result.heatingKp, result.heatingKi, result.heatingKd);
+    if (err != ESP_OK) {
+        return err;
+    }
+    if (result.coolingKp > 0.0) {
+        err = SetCoolingPIDGains(result.coolingKp, result.coolingKi, result.coolingKd);
+    }
+    return err;
+}
+
 
 // =================================================
 // =============== PRIVATE METHODS =================
 // =================================================
 
+void Controller::PublishSnapshotLocked() {
+    const uint32_t sequence = snapshotSequence.load(std::memory_order_relaxed);
+    snapshotSequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    ControllerSnapshot& next = snapshotBuffers[((sequence >> 1) + 1) & 1];
+
+    next.tick = ++snapshotTick;
+    next.running = running;
+    next.doorOpen = doorOpen;
+    next.alarming = alarming;
+    next.setpointLockedByProfile = setpointLockedByProfile;
+    std::snprintf(next.state, sizeof(next.state), "%s", state.c_str());
+    next.setPoint = setPoint;
+    next.processValue = processValue;
+    next.pidOutput = PIDOutput;
+    next.pTerm = zones[0].pid.GetPreviousP();
+    next.iTerm = zones[0].pid.GetPreviousI();
+    next.dTerm = zones[0].pid.GetPreviousD();
+    next.feedforward = (running && !autotuneActive) ? zones[0].pid.GetPreviousFeedforward() : 0.0;
+    next.inputFilterTimeMs = inputFilterTimeMs;
+    double rateSum = 0.0;
+    for (uint8_t zone = 0; zone < zoneCount; ++zone) {
+        rateSum += zones[zone].processRateCPerS;
+    }
+    next.processRateCPerS = rateSum / static_cast<double>(zoneCount);
+    next.autotuneState = autotuner.GetState();
+    next.autotuneCycle = static_cast<uint8_t>(autotuner.GetCompletedCycles());
+    next.autotuneCycles = static_cast<uint8_t>(autotuner.GetTotalCycles());
+    next.zoneCount = zoneCount;
+    for (uint8_t zone = 0; zone < MAX_CONTROL_ZONES; ++zone) {
+        const bool active = zone < zoneCount;
+        next.zoneProcessValue[zone] = active ? zones[zone].filteredProcessValue : 0.0;
+        next.zoneOutput[zone] = active ? zones[zone].output : 0.0;
+    }
+
+    snapshotSequence.store(sequence + 2, std::memory_order_release);
+}
+
 esp_err_t Controller::Perform() {
     esp_err_t err = UpdateProcessValue();
     if (err != ESP_OK) {
@@ -610,78 +1000,203 @@ esp_err_t Controller::Perform() {
     return ESP_OK;
 }
 
-esp_err_t Controller::PerformOnRunning() {
+esp_err_t Controller::PerformOnRunning(double dtSeconds) {
     double setPointCopy = 0.0;
     double processValueCopy = 0.0;
+    double zoneProcessValues[MAX_CONTROL_ZONES] = {};
+    double zoneProcessRates[MAX_CONTROL_ZONES] = {};
+    uint8_t zoneRelayMasks[MAX_CONTROL_ZONES] = {};
+    uint8_t zoneCountCopy = 1;
     double coolOnBandCopy = 0.0;
     double coolOffBandCopy = 0.0;
     double heaterMinValueCopy = 0.0;
     double forceHeaterOnBelowCopy = 0.0;
     bool coolingEnabledCopy = false;
+    double feedforward = 0.0;
+    bool freshSample = false;
+    bool derivativeFromRate = false;
+    double pidDtSeconds = 0.0;
 
     {
         ScopedLock lock(stateMutex);
+        pidElapsedS += dtSeconds;
+        freshSample = freshSampleThisTick;
+        if (freshSample) {
+            pidDtSeconds = pidElapsedS;
+            pidElapsedS = 0.0;
+        }
         setPointCopy = setPoint;
         processValueCopy = processValue;
+        zoneCountCopy = zoneCount;
+        for (uint8_t zone = 0; zone < zoneCount; ++zone) {
+            zoneProcessValues[zone] = zones[zone].filteredProcessValue;
+            zoneProcessRates[zone] = zones[zone].processRateCPerS;
+            zoneRelayMasks[zone] = zoneConfigs[zone].relayMask;
+        }
+        derivativeFromRate = pvPipeline.derivativeFromRate;
         coolOnBandCopy = coolOnBandC;
         coolOffBandCopy = coolOffBandC;
         heaterMinValueCopy = heaterMinValuePct;
         forceHeaterOnBelowCopy = forceHeaterOnBelowC;
         coolingEnabledCopy = coolingDoorEnabled;
+        if (feedforwardEnabled && hasProfileTrajectory && thermalModel.IsValid()) {
+            feedforward = feedforwardGain * thermalModel.FeedforwardOutputPct(trajectorySetpointC, trajectoryRateCPerS);
+        }
     }
 
-    const double output = pidController.Calculate(setPointCopy, processValueCopy);
+    // The door is shared, so cooling follows the chamber PV (the mean of the zones).
     if (!coolingEnabledCopy && processValueCopy > (setPointCopy + coolOnBandCopy)) {
         coolingEnabledCopy = true;
     } else if (coolingEnabledCopy && processValueCopy < (setPointCopy + coolOffBandCopy)) {
         coolingEnabledCopy = false;
     }
 
-    double effectiveOutput = output;
-    if (!coolingEnabledCopy && effectiveOutput < 0.0) {
-        effectiveOutput = 0.0;
-    }
-
     const double clampedHeaterMinPct = std::clamp(heaterMinValueCopy, 0.0, 100.0);
-    double heaterOutputPct = 0.0;
-    if (effectiveOutput > 0.0) {
-        const double positiveDemand = std::clamp(effectiveOutput / 100.0, 0.0, 1.0);
-        heaterOutputPct = clampedHeaterMinPct + (100.0 - clampedHeaterMinPct) * positiveDemand;
-    }
-
     const bool forceHeaterEnabled = (forceHeaterOnBelowCopy > 0.0);
-    const bool shouldForceHeaterOn = forceHeaterEnabled &&
-        (processValueCopy <= (setPointCopy + forceHeaterOnBelowCopy));
-    if (shouldForceHeaterOn) {
-        heaterOutputPct = std::max(heaterOutputPct, clampedHeaterMinPct);
+    double effectiveOutputs[MAX_CONTROL_ZONES] = {};
+    double heaterOutputPcts[MAX_CONTROL_ZONES] = {};
+    double outputSum = 0.0;
+    double leastCoolingOutput = -100.0; // Largest zone output: the door only opens if every zone wants cooling
+    for (uint8_t zone = 0; zone < zoneCountCopy; ++zone) {
+        PID& pid = zones[zone].pid;
+        const double zoneProcessValue = zoneProcessValues[zone];
+
+        // Between thermocouple passes the PID holds its last output (with the current
+        // feedforward swapped in): running it on a repeated PV would zero the derivative
+        // and then spike it when the next pass lands.
+        double output = 0.0;
+        if (freshSample && derivativeFromRate) {
+            output = pid.CalculateWithRate(
+                static_cast<control_real_t>(setPointCopy),
+                static_cast<control_real_t>(zoneProcessValue),
+                static_cast<control_real_t>(zoneProcessRates[zone]),
+                static_cast<control_real_t>(pidDtSeconds),
+                static_cast<control_real_t>(feedforward));
+        } else if (freshSample) {
+            output = pid.Calculate(
+                static_cast<control_real_t>(setPointCopy),
+                static_cast<control_real_t>(zoneProcessValue),
+                static_cast<control_real_t>(pidDtSeconds),
+                static_cast<control_real_t>(feedforward));
+        } else {
+            const double heldFeedback = pid.GetPreviousOutput() - pid.GetPreviousFeedforward();
+            output = std::clamp(heldFeedback + feedforward, -100.0, 100.0);
+        }
+
+        double effectiveOutput = output;
+        if (!coolingEnabledCopy && effectiveOutput < 0.0) {
+            effectiveOutput = 0.0;
+        }
+
+        double heaterOutputPct = 0.0;
+        if (effectiveOutput > 0.0) {
+            const double positiveDemand = std::clamp(effectiveOutput / 100.0, 0.0, 1.0);
+            heaterOutputPct = clampedHeaterMinPct + (100.0 - clampedHeaterMinPct) * positiveDemand;
+        }
+
+        const bool shouldForceHeaterOn = forceHeaterEnabled &&
+            (zoneProcessValue <= (setPointCopy + forceHeaterOnBelowCopy));
+        if (shouldForceHeaterOn) {
+            heaterOutputPct = std::max(heaterOutputPct, clampedHeaterMinPct);
+        }
+
+        effectiveOutputs[zone] = effectiveOutput;
+        heaterOutputPcts[zone] = std::clamp(heaterOutputPct, 0.0, 100.0);
+        outputSum += effectiveOutput;
+        leastCoolingOutput = std::max(leastCoolingOutput, effectiveOutput);
     }
 
     {
         ScopedLock lock(stateMutex);
-        PIDOutput = effectiveOutput;
+        PIDOutput = outputSum / static_cast<double>(zoneCountCopy);
+        for (uint8_t zone = 0; zone < zoneCountCopy; ++zone) {
+            zones[zone].output = effectiveOutputs[zone];
+        }
         coolingDoorEnabled = coolingEnabledCopy;
     }
 
-    if (effectiveOutput < 0) {
-        const double doorOpenFraction = ComputeCoolingDoorOpenFraction(effectiveOutput, processValueCopy);
+    if (leastCoolingOutput < 0) {
+        const double doorOpenFraction = ComputeCoolingDoorOpenFraction(leastCoolingOutput, processValueCopy);
         const double angleFromPercent = ComputeDoorAngleFromFraction(doorOpenFraction);
-        ApplyDoorTargetAngle(angleFromPercent, TICK_INTERVAL_MS / 1000.0);
+        ApplyDoorTargetAngle(angleFromPercent, dtSeconds);
     } else {
-        ApplyDoorTargetAngle(GetDoorClosedAngleDeg(), TICK_INTERVAL_MS / 1000.0);
+        ApplyDoorTargetAngle(GetDoorClosedAngleDeg(), dtSeconds);
     }
 
-    const double clampedHeaterOutputPct = std::clamp(heaterOutputPct, 0.0, 100.0);
-    if (clampedHeaterOutputPct > 0.0) {
-        relayPWM.SetDutyCycle(static_cast<float>(clampedHeaterOutputPct / 100.0));
-    } else {
+    if (zoneCountCopy == 1) {
+        const double clampedHeaterOutputPct = heaterOutputPcts[0];
+        if (clampedHeaterOutputPct > 0.0) {
+            relayPWM.SetDutyCycle(static_cast<float>(clampedHeaterOutputPct / 100.0));
+        } else {
+            relayPWM.SetDutyCycle(0.0f);
+            (void)relayPWM.ForceOff();
+        }
+        return ESP_OK;
+    }
+
+    float dutyCycles[PWM::MAX_CHANNELS] = {};
+    bool anyHeaterOn = false;
+    for (uint8_t zone = 0; zone < zoneCountCopy; ++zone) {
+        const float duty = static_cast<float>(heaterOutputPcts[zone] / 100.0);
+        anyHeaterOn = anyHeaterOn || duty > 0.0f;
+        for (int relay = 0; relay < PWM::MAX_CHANNELS; ++relay) {
+            if ((zoneRelayMasks[zone] & (1u << relay)) != 0) {
+                dutyCycles[relay] = duty;
+            }
+        }
+    }
+    relayPWM.SetChannelDutyCycles(dutyCycles);
+    if (!anyHeaterOn) {
+        (void)relayPWM.ForceOff();
+    }
+
+    return ESP_OK;
+}
+
+// Bypasses the PID and cooling bands: the autotuner's relay output drives the
+// heater PWM (positive) or the cooling door (negative) directly.
+esp_err_t Controller::PerformAutotune(double dtSeconds) {
+    double processValueCopy = 0.0;
+    double output = 0.0;
+    AutotuneState tuneState = AutotuneState::Running;
+    {
+        ScopedLock lock(stateMutex);
+        processValueCopy = processValue;
+        output = autotuner.Update(processValueCopy, dtSeconds);
+        tuneState = autotuner.GetState();
+        PIDOutput = output;
+        if (tuneState == AutotuneState::Running) {
+            char progress[sizeof(ControllerSnapshot::state)] = {};
+            std::snprintf(progress, sizeof(progress), "Autotune %d/%d",
+                autotuner.GetCompletedCycles() + 1, autotuner.GetTotalCycles());
+            state = progress;
+        }
+    }
+
+    if (tuneState != AutotuneState::Running) {
+        {
+            ScopedLock lock(stateMutex);
+            autotuneActive = false;
+        }
+        // The final state is set and published together with the stop, so no
+        // snapshot shows the run as Idle in between.
+        return StopWithState((tuneState == AutotuneState::Complete) ? "Autotune Complete" : "Autotune Failed");
+    }
+
+    if (output < 0.0) {
+        const double doorOpenFraction = ComputeCoolingDoorOpenFraction(output, processValueCopy);
+        ApplyDoorTargetAngle(ComputeDoorAngleFromFraction(doorOpenFraction), dtSeconds);
         relayPWM.SetDutyCycle(0.0f);
         (void)relayPWM.ForceOff();
+    } else {
+        ApplyDoorTargetAngle(GetDoorClosedAngleDeg(), dtSeconds);
+        relayPWM.SetDutyCycle(static_cast<float>(std::clamp(output, 0.0, 100.0) / 100.0));
     }
 
     return ESP_OK;
 }
 
-esp_err_t Controller::PerformOnNotRunning() {
+esp_err_t Controller::PerformOnNotRunning(double dtSeconds) {
     bool localDoorOpen = false;
     bool localDoorPreviewActive = false;
     double localDoorPreviewAngleDeg = 0.0;
@@ -691,6 +1206,9 @@ esp_err_t Controller::PerformOnNotRunning() {
     {
         ScopedLock lock(stateMutex);
         PIDOutput = 0.0;
+        for (ZoneState& zone : zones) {
+            zone.output = 0.0;
+        }
         coolingDoorEnabled = false;
         localDoorOpen = doorOpen;
         localDoorPreviewActive = doorPreviewActive;
@@ -701,69 +1219,169 @@ esp_err_t Controller::PerformOnNotRunning() {
 
     relayPWM.SetDutyCycle(0);
     if (localDoorPreviewActive) {
-        ApplyDoorTargetAngle(localDoorPreviewAngleDeg, TICK_INTERVAL_MS / 1000.0);
+        ApplyDoorTargetAngle(localDoorPreviewAngleDeg, dtSeconds);
     } else if (localDoorOpen) {
-        ApplyDoorTargetAngle(localDoorOpenAngleDeg, TICK_INTERVAL_MS / 1000.0);
+        ApplyDoorTargetAngle(localDoorOpenAngleDeg, dtSeconds);
     } else {
-        ApplyDoorTargetAngle(localDoorClosedAngleDeg, TICK_INTERVAL_MS / 1000.0);
+        ApplyDoorTargetAngle(localDoorClosedAngleDeg, dtSeconds);
     }
 
     return ESP_OK;
 }
 
 esp_err_t Controller::UpdateProcessValue() {
-    std::vector<int> channels;
+    uint8_t inputMasks[MAX_CONTROL_ZONES] = {};
+    uint8_t zoneCountCopy = 1;
     double filterTimeMs = 0.0;
-    double previousFiltered = 0.0;
+    ProcessValuePipelineConfig pipeline;
+    ProcessValueFilter zoneFilters[MAX_CONTROL_ZONES];
+    ChannelOutlierFilter outlierFilters[PV_INPUT_CHANNELS];
     bool hasPrev = false;
+    uint32_t generation = 0;
+    uint8_t previousUsedMask = 0;
 
     {
         ScopedLock lock(stateMutex);
-        channels = inputsBeingUsed;
+        zoneCountCopy = zoneCount;
+        if (zoneCount == 1) {
+            for (int channel : inputsBeingUsed) {
+                if (channel >= 0 && channel < ThermocoupleSnapshot::MAX_CHANNELS) {
+                    inputMasks[0] |= static_cast<uint8_t>(1u << channel);
+                }
+            }
+        } else {
+            for (uint8_t zone = 0; zone < zoneCount; ++zone) {
+                inputMasks[zone] = zoneConfigs[zone].inputMask;
+            }
+        }
+        for (uint8_t zone = 0; zone < zoneCount; ++zone) {
+            zoneFilters[zone] = zones[zone].filter;
+        }
+        std::copy(std::begin(channelOutlierFilters), std::end(channelOutlierFilters), std::begin(outlierFilters));
         filterTimeMs = inputFilterTimeMs;
-        previousFiltered = filteredProcessValue;
+        pipeline = pvPipeline;
         hasPrev = hasFilteredProcessValue;
+        generation = pvPipelineGeneration;
+        previousUsedMask = pvUsedChannelMask;
     }
 
-    double newProcessValue = 0.0;
-    int inputsReadCorrectly = 0;
-    for (int channel : channels) {
-        double value = HardwareManager::getInstance().getThermocoupleValue(channel);
-        if (value == -3000.0) {
+    const ThermocoupleSnapshot sample = HardwareManager::getInstance().getThermocoupleSnapshot();
+    const int64_t sampleAgeUs = esp_timer_get_time() - sample.timestampUs;
+    if (sample.sequence == 0 || sampleAgeUs > MAX_SAMPLE_AGE_US) {
+        // Acquisition has stalled; treat like a sensor failure.
+        return ESP_ERR_TIMEOUT;
+    }
+    if (hasPrev && sample.sequence == lastSampleSequence) {
+        // Same pass as last tick: filtering it again would count it twice.
+        ScopedLock lock(stateMutex);
+        freshSampleThisTick = false;
+        return ESP_OK;
+    }
+
+    // Filter over the real spacing between samples rather than the nominal tick.
+    control_real_t dtSeconds = static_cast<control_real_t>(SAMPLE_TICK_INTERVAL_MS / 1000.0);
+    if (hasPrev && lastSampleTimestampUs > 0 && sample.timestampUs > lastSampleTimestampUs) {
+        dtSeconds = static_cast<control_real_t>(sample.timestampUs - lastSampleTimestampUs) / control_real_t(1e6);
+    }
+    const control_real_t timeConstantS = static_cast<control_real_t>(filterTimeMs / 1000.0);
+
+    // Outlier rejection runs once per channel, before the zones share the readings.
+    uint8_t usedMask = 0;
+    for (uint8_t zone = 0; zone < zoneCountCopy; ++zone) {
+        usedMask |= inputMasks[zone];
+    }
+    control_real_t readings[PV_INPUT_CHANNELS] = {};
+    bool readingValid[PV_INPUT_CHANNELS] = {};
+    uint32_t rejected[PV_INPUT_CHANNELS] = {};
+    for (int channel = 0; channel < PV_INPUT_CHANNELS; ++channel) {
+        const double value = sample.values[channel];
+        if ((usedMask & (1u << channel)) == 0 || value == -3000.0) {
             continue;
         }
-        newProcessValue += value;
-        inputsReadCorrectly++;
+        readings[channel] = static_cast<control_real_t>(value);
+        readingValid[channel] = true;
+        if (pipeline.outlierRejection) {
+            if ((previousUsedMask & (1u << channel)) == 0) {
+                // Newly used channel: its window holds readings from before it
+                // was dropped, which would reject the present temperature.
+                outlierFilters[channel].Reset();
+            }
+            bool wasRejected = false;
+            readings[channel] = outlierFilters[channel].Filter(readings[channel], wasRejected);
+            rejected[channel] = wasRejected ? 1 : 0;
+        }
     }
 
-    if (inputsReadCorrectly == 0) {
-        return ESP_ERR_INVALID_STATE;
-    }
+    // Every zone filters the same pass, so the loops never see different instants.
+    double filteredValues[MAX_CONTROL_ZONES] = {};
+    double rates[MAX_CONTROL_ZONES] = {};
+    double chamberSum = 0.0;
+    for (uint8_t zone = 0; zone < zoneCountCopy; ++zone) {
+        control_real_t weightedSum = 0;
+        control_real_t weightTotal = 0;
+        control_real_t plainSum = 0;
+        int inputsReadCorrectly = 0;
+        for (int channel = 0; channel < PV_INPUT_CHANNELS; ++channel) {
+            if ((inputMasks[zone] & (1u << channel)) == 0 || !readingValid[channel]) {
+                continue;
+            }
+            const control_real_t weight = static_cast<control_real_t>(pipeline.inputWeights[static_cast<std::size_t>(channel)]);
+            weightedSum += weight * readings[channel];
+            weightTotal += weight;
+            plainSum += readings[channel];
+            inputsReadCorrectly++;
+        }
 
-    const double averagedValue = newProcessValue / inputsReadCorrectly;
-    const double dt = TICK_INTERVAL_MS;
-    const double alpha = dt / (filterTimeMs + dt);
-    const double filteredValue = hasPrev ? (alpha * averagedValue + (1 - alpha) * previousFiltered) : averagedValue;
+        if (inputsReadCorrectly == 0) {
+            return ESP_ERR_INVALID_STATE;
+        }
+
+        // Zero-weighted channels only count when nothing else in the zone reads.
+        const control_real_t fusedValue = weightTotal > control_real_t(0)
+            ? weightedSum / weightTotal
+            : plainSum / static_cast<control_real_t>(inputsReadCorrectly);
+        filteredValues[zone] = zoneFilters[zone].Update(fusedValue, dtSeconds, timeConstantS, pipeline.filterMode);
+        rates[zone] = zoneFilters[zone].GetRateCPerS();
+        chamberSum += filteredValues[zone];
+    }
 
     {
         ScopedLock lock(stateMutex);
-        filteredProcessValue = filteredValue;
+        if (pvPipelineGeneration != generation) {
+            // The pipeline changed while this pass ran unlocked; writing back
+            // would undo its filter resets. Redo the sample on the next tick.
+            freshSampleThisTick = false;
+            return ESP_OK;
+        }
+        for (uint8_t zone = 0; zone < zoneCountCopy; ++zone) {
+            zones[zone].filter = zoneFilters[zone];
+            zones[zone].filteredProcessValue = filteredValues[zone];
+            zones[zone].processRateCPerS = rates[zone];
+        }
+        std::copy(std::begin(outlierFilters), std::end(outlierFilters), std::begin(channelOutlierFilters));
+        pvUsedChannelMask = usedMask;
+        for (int channel = 0; channel < PV_INPUT_CHANNELS; ++channel) {
+            rejectedReadingCounts[channel] += rejected[channel];
+        }
+        // One zone divides by 1, so single-zone control sees exactly its own filter.
+        processValue = chamberSum / static_cast<double>(zoneCountCopy);
         hasFilteredProcessValue = true;
-        processValue = filteredValue;
+        freshSampleThisTick = true;
+        lastSampleSequence = sample.sequence;
+        lastSampleTimestampUs = sample.timestampUs;
     }
 
     return ESP_OK;
 }
 
 bool Controller::CheckAlarmingConditions() {
-    double value = 0.0;
-    {
-        ScopedLock lock(stateMutex);
-        value = processValue;
-    }
-
-    if (value < MIN_PROCESS_VALUE || value > MAX_PROCESS_VALUE) {
-        return true;
+    // Any zone out of range alarms, not just the chamber mean.
+    ScopedLock lock(stateMutex);
+    for (uint8_t zone = 0; zone < zoneCount; ++zone) {
+        const double value = zones[zone].filteredProcessValue;
+        if (value < MIN_PROCESS_VALUE || value > MAX_PROCESS_VALUE) {
+            return true;
+        }
     }
     return false;
 }
@@ -801,66 +1419,9 @@ esp_err_t Controller::RunningRelaysOff(){
 }
 
 
-void Controller::RelayOnThunk(void* ctx) {
-    if (ctx == nullptr) {
-        return;
-    }
-    static_cast<Controller*>(ctx)->RelayOn();
-}
-
-void Controller::RelayOffThunk(void* ctx) {
-    if (ctx == nullptr) {
-        return;
-    }
-    static_cast<Controller*>(ctx)->RelayOff();
-}
-
-void Controller::RelayOn() {
-    std::vector<std::pair<int, bool>> nextStates;
-    {
-        ScopedLock lock(stateMutex);
-        SyncRelayPWMAccumulatorsLocked();
-        nextStates.reserve(relaysPWM.size());
-        for (const auto& entry : relaysPWM) {
-            const int relayIndex = entry.first;
-            const double weight = std::clamp(entry.second, 0.0, 1.0);
-            bool relayOn = false;
-
-            if (weight >= 1.0) {
-                relayOn = true;
-            } else if (weight > 0.0) {
-                double& accumulator = relayPWMCycleAccumulators[relayIndex];
-                accumulator += weight;
-                if (accumulator >= 1.0) {
-                    relayOn = true;
-                    while (accumulator >= 1.0) {
-                        accumulator -= 1.0;
-                    }
-                }
-            }
-
-            nextStates.emplace_back(relayIndex, relayOn);
-        }
-    }
-
-    for (const auto& entry : nextStates) {
-        HardwareManager::getInstance().setRelayState(entry.first, entry.second);
-    }
-}
-
-void Controller::RelayOff() {
-    std::vector<int> relays;
-    {
-        ScopedLock lock(stateMutex);
-        relays.reserve(relaysPWM.size());
-        for (const auto& entry : relaysPWM) {
-            relays.push_back(entry.first);
-        }
-    }
-
-    for (int relayIndex : relays) {
-        HardwareManager::getInstance().setRelayState(relayIndex, false);
-    }
+void Controller::RelayOutputThunk(uint32_t onMask, uint32_t channelMask, void* ctx) {
+    (void)ctx;
+    HardwareManager::getInstance().applyRelayMask(onMask, channelMask);
 }
 
 esp_err_t Controller::AddSetRelayPWM(int relayIndex, double pwmValue) {
@@ -875,7 +1436,7 @@ esp_err_t Controller::AddSetRelayPWM(int relayIndex, double pwmValue) {
     {
         ScopedLock lock(stateMutex);
         relaysPWM[relayIndex] = std::clamp(pwmValue, 0.0, 1.0);
-        SyncRelayPWMAccumulatorsLocked();
+        SyncRelayPWMScheduleLocked();
     }
 
     return PersistRelaysPWMSettings();
@@ -889,7 +1450,7 @@ esp_err_t Controller::RemoveRelayPWM(int relayIndex) {
             return ESP_ERR_INVALID_ARG;
         }
         relaysPWM.erase(it);
-        SyncRelayPWMAccumulatorsLocked();
+        SyncRelayPWMScheduleLocked();
     }
 
     return PersistRelaysPWMSettings();
@@ -913,7 +1474,7 @@ esp_err_t Controller::SetRelayPWMEnabled(const std::vector<int>& relayIndices) {
             }
         }
         relaysPWM = nextMap;
-        SyncRelayPWMAccumulatorsLocked();
+        SyncRelayPWMScheduleLocked();
     }
 
     return PersistRelaysPWMSettings();
@@ -935,12 +1496,40 @@ esp_err_t Controller::SetRelaysPWM(const std::unordered_map<int, double>& relayW
     {
         ScopedLock lock(stateMutex);
         relaysPWM = sanitized;
-        SyncRelayPWMAccumulatorsLocked();
+        SyncRelayPWMScheduleLocked();
     }
 
     return PersistRelaysPWMSettings();
 }
 
+esp_err_t Controller::SetRelayDriveMode(PWM::Mode mode, uint8_t mainsHz) {
+    if (mainsHz != 50 && mainsHz != 60) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    SettingsManager& settings = SettingsManager::getInstance();
+    SettingsBatch batch;
+    esp_err_t err = settings.SetRelayDriveMode(mode == PWM::Mode::BurstFire ? 1 : 0);
+    if (err == ESP_OK) {
+        err = settings.SetMainsFrequencyHz(mainsHz);
+    }
+    if (err == ESP_OK) {
+        err = batch.Commit();
+    }
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    {
+        ScopedLock lock(stateMutex);
+        relayDriveMode = mode;
+        mainsFrequencyHz = mainsHz;
+        err = relayPWM.SetMode(mode, mainsHz);
+    }
+
+    return err;
+}
+
 esp_err_t Controller::AddRelayWhenRunning(int relayIndex) {
     if (relayIndex < 0 || relayIndex > 7) {
         return ESP_ERR_INVALID_ARG;
@@ -996,6 +1585,7 @@ esp_err_t Controller::SetDoorCalibrationAngles(double closedAngleDeg, double ope
     }
 
     SettingsManager& settings = SettingsManager::getInstance();
+    SettingsBatch batch;
     esp_err_t err = settings.SetDoorClosedAngleDeg(closedAngleDeg);
     if (err != ESP_OK) {
         return err;
@@ -1004,6 +1594,10 @@ esp_err_t Controller::SetDoorCalibrationAngles(double closedAngleDeg, double ope
     if (err != ESP_OK) {
         return err;
     }
+    err = batch.Commit();
+    if (err != ESP_OK) {
+        return err;
+    }
 
     bool localRunning = false;
     bool localDoorOpen = false;
@@ -1025,7 +1619,7 @@ esp_err_t Controller::SetDoorCalibrationAngles(double closedAngleDeg, double ope
     if (localRunning) {
         return ESP_OK;
     }
-    ApplyDoorTargetAngle(localTargetAngle, TICK_INTERVAL_MS / 1000.0);
+    ApplyDoorTargetAngle(localTargetAngle, GetNominalTickIntervalMs() / 1000.0);
     return ESP_OK;
 }
 
@@ -1053,6 +1647,7 @@ esp_err_t Controller::SetCoolingDoorBands(double newCoolOnBandC, double newCoolO
     }
 
     SettingsManager& settings = SettingsManager::getInstance();
+    SettingsBatch batch;
     esp_err_t err = ESP_OK;
     const double currentOnBand = settings.GetCoolOnBandC();
     if (newCoolOffBandC < currentOnBand) {
@@ -1066,6 +1661,9 @@ esp_err_t Controller::SetCoolingDoorBands(double newCoolOnBandC, double newCoolO
             err = settings.SetCoolOffBandC(newCoolOffBandC);
         }
     }
+    if (err == ESP_OK) {
+        err = batch.Commit();
+    }
     if (err != ESP_OK) {
         return err;
     }
@@ -1084,6 +1682,7 @@ esp_err_t Controller::SetHeaterBehavior(double newHeaterMinValuePct, double newF
     }
 
     SettingsManager& settings = SettingsManager::getInstance();
+    SettingsBatch batch;
     esp_err_t err = settings.SetHeaterMinValuePct(newHeaterMinValuePct);
     if (err != ESP_OK) {
         return err;
@@ -1092,6 +1691,10 @@ esp_err_t Controller::SetHeaterBehavior(double newHeaterMinValuePct, double newF
     if (err != ESP_OK) {
         return err;
     }
+    err = batch.Commit();
+    if (err != ESP_OK) {
+        return err;
+    }
 
     {
         ScopedLock lock(stateMutex);
@@ -1101,6 +1704,70 @@ esp_err_t Controller::SetHeaterBehavior(double newHeaterMinValuePct, double newF
     return ESP_OK;
 }
 
+esp_err_t Controller::SetFeedforwardConfig(bool enabled, double lookaheadS, double gain) {
+    if (lookaheadS < 0.0 || lookaheadS > 600.0 || gain < 0.0 || gain > 2.0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    SettingsManager& settings = SettingsManager::getInstance();
+    SettingsBatch batch;
+    esp_err_t err = settings.SetFeedforwardEnabled(enabled);
+    if (err != ESP_OK) {
+        return err;
+    }
+    err = settings.SetFeedforwardLookaheadS(lookaheadS);
+    if (err != ESP_OK) {
+        return err;
+    }
+    err = settings.SetFeedforwardGain(gain);
+    if (err != ESP_OK) {
+        return err;
+    }
+    err = batch.Commit();
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    {
+        ScopedLock lock(stateMutex);
+        feedforwardEnabled = enabled;
+        feedforwardLookaheadS = lookaheadS;
+        feedforwardGain = gain;
+    }
+    return ESP_OK;
+}
+
+esp_err_t Controller::SetThermalModel(const ThermalModel& model) {
+    if (!model.IsValid() || !std::isfinite(model.ambientC)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    SettingsManager& settings = SettingsManager::getInstance();
+    SettingsBatch batch;
+    esp_err_t err = settings.SetThermalModelGainCPerPct(model.gainCPerPct);
+    if (err != ESP_OK) {
+        return err;
+    }
+    err = settings.SetThermalModelTimeConstantS(model.timeConstantS);
+    if (err != ESP_OK) {
+        return err;
+    }
+    err = settings.SetThermalModelAmbientC(model.ambientC);
+    if (err != ESP_OK) {
+        return err;
+    }
+    err = batch.Commit();
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    {
+        ScopedLock lock(stateMutex);
+        thermalModel = model;
+    }
+    return ESP_OK;
+}
+
 esp_err_t Controller::SetDoorPreviewAngle(double angleDeg) {
     if (angleDeg < 0.0 || angleDeg > 180.0) {
         return ESP_ERR_INVALID_ARG;
@@ -1115,7 +1782,7 @@ esp_err_t Controller::SetDoorPreviewAngle(double angleDeg) {
         doorPreviewAngleDeg = angleDeg;
     }
 
-    ApplyDoorTargetAngle(angleDeg, TICK_INTERVAL_MS / 1000.0);
+    ApplyDoorTargetAngle(angleDeg, GetNominalTickIntervalMs() / 1000.0);
     return ESP_OK;
 }
 
@@ -1139,7 +1806,7 @@ esp_err_t Controller::ClearDoorPreview() {
     if (localRunning) {
         return ESP_OK;
     }
-    ApplyDoorTargetAngle(localDoorOpen ? localOpenAngle : localClosedAngle, TICK_INTERVAL_MS / 1000.0);
+    ApplyDoorTargetAngle(localDoorOpen ? localOpenAngle : localClosedAngle, GetNominalTickIntervalMs() / 1000.0);
     return ESP_OK;
 }
 
@@ -1195,7 +1862,7 @@ void Controller::ApplyRelaysPWMMask(uint8_t mask) {
             relaysPWM[relayIndex] = 1.0;
         }
     }
-    SyncRelayPWMAccumulatorsLocked();
+    SyncRelayPWMScheduleLocked();
 }
 
 void Controller::ApplyRelaysOnMask(uint8_t mask) {
@@ -1207,20 +1874,42 @@ void Controller::ApplyRelaysOnMask(uint8_t mask) {
     }
 }
 
-void Controller::SyncRelayPWMAccumulatorsLocked() {
-    for (auto it = relayPWMCycleAccumulators.begin(); it != relayPWMCycleAccumulators.end();) {
-        if (relaysPWM.find(it->first) == relaysPWM.end()) {
-            it = relayPWMCycleAccumulators.erase(it);
-        } else {
-            ++it;
-        }
+void Controller::ApplyZoneSettings(uint8_t count, uint32_t inputMasks, uint32_t relayMasks) {
+    ControlZoneConfig configs[MAX_CONTROL_ZONES];
+    for (uint8_t zone = 0; zone < MAX_CONTROL_ZONES; ++zone) {
+        configs[zone].inputMask = static_cast<uint8_t>(inputMasks >> (8u * zone));
+        configs[zone].relayMask = static_cast<uint8_t>(relayMasks >> (8u * zone));
+    }
+
+    // Relays dropped from PWM since the layout was stored just stay off; a
+    // layout that is malformed in itself falls back to one zone.
+    if (count < 1 || count > MAX_CONTROL_ZONES || (count > 1 && !ZoneConfigsValid(configs, count, 0xFF))) {
+        count = 1;
+    }
+
+    zoneCount = count;
+    for (uint8_t zone = 0; zone < MAX_CONTROL_ZONES; ++zone) {
+        zoneConfigs[zone] = zone < count && count > 1 ? configs[zone] : ControlZoneConfig{};
+        zones[zone].filter.Reset();
+        (void)zones[zone].pid.Reset();
+        zones[zone].processRateCPerS = 0.0;
+        zones[zone].output = 0.0;
     }
+    hasFilteredProcessValue = false;
+    ++pvPipelineGeneration;
+}
 
+void Controller::SyncRelayPWMScheduleLocked() {
+    uint32_t channelMask = 0;
+    float weights[PWM::MAX_CHANNELS] = {};
     for (const auto& entry : relaysPWM) {
-        if (relayPWMCycleAccumulators.find(entry.first) == relayPWMCycleAccumulators.end()) {
-            relayPWMCycleAccumulators[entry.first] = 0.0;
+        if (entry.first < 0 || entry.first >= PWM::MAX_CHANNELS) {
+            continue;
         }
+        channelMask |= (1u << entry.first);
+        weights[entry.first] = static_cast<float>(std::clamp(entry.second, 0.0, 1.0));
     }
+    (void)relayPWM.SetChannelWeights(channelMask, weights);
 }
 
 esp_err_t Controller::PersistRelaysPWMSettings() {
@@ -1237,11 +1926,16 @@ esp_err_t Controller::PersistRelaysPWMSettings() {
             }
         }
     }
+    SettingsBatch batch;
     esp_err_t err = settings.SetRelaysPWMMask(mask);
     if (err != ESP_OK) {
         return err;
     }
-    return settings.SetRelayPWMWeights(weights);
+    err = settings.SetRelayPWMWeights(weights);
+    if (err != ESP_OK) {
+        return err;
+    }
+    return batch.Commit();
 }
 
 double Controller::ComputeCoolingDoorOpenFraction(double pidOutput, double processValueC) const {
@@ -1249,17 +1943,21 @@ double Controller::ComputeCoolingDoorOpenFraction(double pidOutput, double proce
         return 0.0;
     }
 
-    const double coolingDemand = std::clamp(-pidOutput / 100.0, 0.0, 1.0);
-    const double tempRange = std::max(MAX_PROCESS_VALUE - ROOM_TEMPERATURE_C, 1.0);
-    const double normalizedTemp = std::clamp((processValueC - ROOM_TEMPERATURE_C) / tempRange, 0.0, 1.0);
+    using real = control_real_t;
+    constexpr real minEffectiveness = static_cast<real>(MIN_DOOR_COOLING_EFFECTIVENESS);
+    constexpr real roomTemperature = static_cast<real>(ROOM_TEMPERATURE_C);
+    constexpr real tempRange = static_cast<real>(MAX_PROCESS_VALUE - ROOM_TEMPERATURE_C);
+
+    const real coolingDemand = std::clamp(static_cast<real>(-pidOutput) / real(100), real(0), real(1));
+    const real normalizedTemp = std::clamp((static_cast<real>(processValueC) - roomTemperature) / tempRange, real(0), real(1));
 
-    const double tempEffectiveness = MIN_DOOR_COOLING_EFFECTIVENESS +
-        (1.0 - MIN_DOOR_COOLING_EFFECTIVENESS) * normalizedTemp;
-    const double compensatedDemand = std::clamp(coolingDemand / std::max(tempEffectiveness, 0.05), 0.0, 1.0);
+    const real tempEffectiveness = minEffectiveness + (real(1) - minEffectiveness) * normalizedTemp;
+    const real compensatedDemand = std::clamp(coolingDemand / std::max(tempEffectiveness, real(0.05)), real(0), real(1));
 
     // Door cooling is strongly nonlinear: small openings provide most of the effect.
-    const double doorOpenFraction = 1.0 - std::pow(1.0 - compensatedDemand, 1.0 / DOOR_COOLING_NONLINEARITY);
-    return std::clamp(doorOpenFraction, 0.0, 1.0);
+    // The curve is 1 - (1 - demand)^(1/3); cbrt is far cheaper per tick than pow.
+    const real doorOpenFraction = real(1) - std::cbrt(real(1) - compensatedDemand);
+    return std::clamp(doorOpenFraction, real(0), real(1));
 }
 
 double Controller::ComputeDoorAngleFromFraction(double openFraction) const {
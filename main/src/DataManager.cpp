@@ -1,9 +1,15 @@
 #include "DataManager.hpp"
 
+#include <algorithm>
+#include <cmath>
+
+#include "BinaryCodec.hpp"
 #include "Controller.hpp"
 #include "HardwareManager.hpp"
-#include "PID.hpp"
+#include "RunLogManager.hpp"
+#include "ScopedLock.hpp"
 #include "SettingsManager.hpp"
+#include "Tracer.hpp"
 #include "esp_log.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
@@ -12,27 +18,19 @@
 namespace {
 constexpr const char* TAG = "DataManager";
 
-class ScopedDataLock {
-public:
-    explicit ScopedDataLock(SemaphoreHandle_t mutex)
-        : mutex_(mutex), locked_(false) {
-        if (mutex_ != nullptr) {
-            locked_ = (xSemaphoreTake(mutex_, portMAX_DELAY) == pdTRUE);
-        }
-    }
+constexpr float THERMOCOUPLE_ERROR_READING = -3000.0f; // HardwareManager's invalid-reading marker
+constexpr float TEMPERATURE_SCALE = 32.0f; // Setpoint / PV column units per degree C
+constexpr float READING_SCALE = 4.0f; // Thermocouple column units per degree C
+constexpr float OUTPUT_SCALE = 100.0f; // PID output column units per percent
 
-    ~ScopedDataLock() {
-        if (locked_ && mutex_ != nullptr) {
-            xSemaphoreGive(mutex_);
-        }
-    }
+// Column values never quantize to INT16_MIN, which marks a thermocouple read error.
+constexpr int16_t MIN_COLUMN_VALUE = INT16_MIN + 1;
 
-    bool Locked() const { return locked_; }
+constexpr uint32_t ROLLUP_BUCKET_SECONDS[] = {10, 60}; // Indexed by RollupTierIndex()
 
-private:
-    SemaphoreHandle_t mutex_;
-    bool locked_;
-};
+std::size_t RollupTierIndex(DataResolution resolution) {
+    return static_cast<std::size_t>(resolution) - 1;
+}
 
 std::size_t EstimateDataPoints(std::size_t intervalMs, std::size_t windowMs) {
     if (intervalMs == 0) {
@@ -41,7 +39,7 @@ std::size_t EstimateDataPoints(std::size_t intervalMs, std::size_t windowMs) {
     return windowMs / intervalMs;
 }
 
-std::size_t EstimateMemoryBoundDataPoints() {
+std::size_t EstimateMemoryBoundDataPoints(std::size_t bytesPerSample) {
     constexpr std::size_t kInternalReserveDivisor = 8;
     constexpr std::size_t kInternalBudgetMaxBytes = 96 * 1024;
 
@@ -58,11 +56,91 @@ std::size_t EstimateMemoryBoundDataPoints() {
         }
     }
 
-    const std::size_t points = budgetBytes / sizeof(DataPoint);
+    const std::size_t points = budgetBytes / bytesPerSample;
     return (points == 0) ? 1 : points;
 }
 }
 
+void DataColumns::Resize(std::size_t capacity, uint8_t zones) {
+    timestamp.resize(capacity);
+    setPoint.resize(capacity);
+    processValue.resize(capacity);
+    PIDOutput.resize(capacity);
+    PTerm.resize(capacity);
+    ITerm.resize(capacity);
+    DTerm.resize(capacity);
+    for (Column<int16_t>& channel : temperatureReadings) {
+        channel.resize(capacity);
+    }
+    flags.resize(capacity);
+    servoAngle.resize(capacity);
+    zoneCount = std::clamp<uint8_t>(zones, 1, MAX_CONTROL_ZONES);
+    for (uint8_t zone = 0; zone < MAX_CONTROL_ZONES; ++zone) {
+        const std::size_t zoneCapacity = (zoneCount > 1 && zone < zoneCount) ? capacity : 0;
+        zoneProcessValue[zone].resize(zoneCapacity);
+        zoneOutput[zone].resize(zoneCapacity);
+    }
+}
+
+void DataColumns::Store(std::size_t index, const DataPoint& point) {
+    timestamp[index] = static_cast<uint32_t>(std::min<uint64_t>(point.timestamp, UINT32_MAX));
+    setPoint[index] = QuantizeFixed(point.setPoint, TEMPERATURE_SCALE, MIN_COLUMN_VALUE);
+    processValue[index] = QuantizeFixed(point.processValue, TEMPERATURE_SCALE, MIN_COLUMN_VALUE);
+    PIDOutput[index] = QuantizeFixed(point.PIDOutput, OUTPUT_SCALE, MIN_COLUMN_VALUE);
+    PTerm[index] = point.PTerm;
+    ITerm[index] = point.ITerm;
+    DTerm[index] = point.DTerm;
+    for (int i = 0; i < 4; ++i) {
+        const float reading = point.temperatureReadings[i];
+        temperatureReadings[i][index] = (reading <= THERMOCOUPLE_ERROR_READING)
+            ? INT16_MIN
+            : QuantizeFixed(reading, READING_SCALE, MIN_COLUMN_VALUE);
+    }
+    flags[index] = static_cast<uint8_t>((point.relayStates & 0x3F) | (point.chamberRunning ? 0x80 : 0x00));
+    servoAngle[index] = point.servoAngle;
+    if (zoneCount > 1) {
+        // Zones beyond the layout live at logging time are stored as 0.
+        for (uint8_t zone = 0; zone < zoneCount; ++zone) {
+            const bool live = zone < point.zoneCount;
+            zoneProcessValue[zone][index] = live ? QuantizeFixed(point.zoneProcessValue[zone], TEMPERATURE_SCALE, MIN_COLUMN_VALUE) : 0;
+            zoneOutput[zone][index] = live ? QuantizeFixed(point.zoneOutput[zone], OUTPUT_SCALE, MIN_COLUMN_VALUE) : 0;
+        }
+    }
+}
+
+void DataColumns::Load(std::size_t index, DataPoint& out) const {
+    out.timestamp = timestamp[index];
+    out.setPoint = static_cast<float>(setPoint[index]) / TEMPERATURE_SCALE;
+    out.processValue = static_cast<float>(processValue[index]) / TEMPERATURE_SCALE;
+    out.PIDOutput = static_cast<float>(PIDOutput[index]) / OUTPUT_SCALE;
+    out.PTerm = PTerm[index];
+    out.ITerm = ITerm[index];
+    out.DTerm = DTerm[index];
+    for (int i = 0; i < 4; ++i) {
+        const int16_t reading = temperatureReadings[i][index];
+        out.temperatureReadings[i] = (reading == INT16_MIN)
+            ? THERMOCOUPLE_ERROR_READING
+            : static_cast<float>(reading) / READING_SCALE;
+    }
+    out.relayStates = static_cast<uint8_t>(flags[index] & 0x3F);
+    out.chamberRunning = (flags[index] & 0x80) != 0;
+    out.servoAngle = servoAngle[index];
+    out.zoneCount = zoneCount;
+    for (uint8_t zone = 0; zone < MAX_CONTROL_ZONES; ++zone) {
+        out.zoneProcessValue[zone] = 0.0f;
+        out.zoneOutput[zone] = 0.0f;
+    }
+    if (zoneCount > 1) {
+        for (uint8_t zone = 0; zone < zoneCount; ++zone) {
+            out.zoneProcessValue[zone] = static_cast<float>(zoneProcessValue[zone][index]) / TEMPERATURE_SCALE;
+            out.zoneOutput[zone] = static_cast<float>(zoneOutput[zone][index]) / OUTPUT_SCALE;
+        }
+    } else {
+        out.zoneProcessValue[0] = out.processValue;
+        out.zoneOutput[0] = out.PIDOutput;
+    }
+}
+
 DataManager* DataManager::instance = nullptr;
 
 DataManager& DataManager::getInstance() {
@@ -74,7 +152,7 @@ DataManager& DataManager::getInstance() {
 
 esp_err_t DataManager::LogginOn() {
     {
-        ScopedDataLock lock(dataMutex);
+        ScopedLock lock(dataMutex);
         if (LogData) {
             return ESP_ERR_INVALID_STATE;
         }
@@ -86,7 +164,7 @@ esp_err_t DataManager::LogginOn() {
 
 esp_err_t DataManager::LoggingOff() {
     {
-        ScopedDataLock lock(dataMutex);
+        ScopedLock lock(dataMutex);
         if (!LogData) {
             return ESP_ERR_INVALID_STATE;
         }
@@ -107,57 +185,282 @@ esp_err_t DataManager::SetLoggingEnabled(bool enabled) {
 }
 
 int DataManager::GetDataLogIntervalMs() const {
-    ScopedDataLock lock(dataMutex);
+    ScopedLock lock(dataMutex);
     return DataLogIntervalMs;
 }
 
+void DataManager::GetDataLogInterval(int& outIntervalMs, uint64_t& outStartSequence) const {
+    ScopedLock lock(dataMutex);
+    outIntervalMs = DataLogIntervalMs;
+    outStartSequence = intervalStartSequence;
+}
+
 int DataManager::GetMaxTimeSavedMS() const {
-    ScopedDataLock lock(dataMutex);
+    ScopedLock lock(dataMutex);
     return MaxTimeSavedMS;
 }
 
 bool DataManager::IsLogging() const {
-    ScopedDataLock lock(dataMutex);
+    ScopedLock lock(dataMutex);
     return LogData;
 }
 
 DataPointStorage DataManager::GetRecentData(std::size_t limit) const {
     DataPointStorage out;
 
-    ScopedDataLock lock(dataMutex);
-    if (dataLog.empty()) {
-        return out;
-    }
+    DataHistoryCursor cursor = OpenHistoryCursor(limit);
+    out.resize(static_cast<std::size_t>(cursor.end - cursor.next));
+    const std::size_t read = ReadHistoryBatch(cursor, out.data(), out.size());
+    out.resize(read);
+    return out;
+}
+
+DataPointStorage DataManager::GetAllData() const {
+    return GetRecentData(0);
+}
+
+DataHistoryCursor DataManager::OpenHistoryCursor(std::size_t limit, DataResolution resolution) const {
+    DataHistoryCursor cursor;
+    cursor.resolution = resolution;
+
+    ScopedLock lock(dataMutex);
+    uint64_t total = 0;
+    std::size_t count = 0;
+    GetRingStateLocked(resolution, total, count);
 
-    const std::size_t count = dataLog.size();
     const std::size_t take = (limit == 0 || limit > count) ? count : limit;
-    const std::size_t startIndex = count - take;
+    cursor.end = total;
+    cursor.next = total - take;
+    cursor.oldest = total - count;
+    return cursor;
+}
+
+DataHistoryCursor DataManager::OpenHistoryCursorSince(uint64_t sinceSequence, std::size_t limit, DataResolution resolution) const {
+    DataHistoryCursor cursor;
+    cursor.resolution = resolution;
 
-    out.reserve(take);
-    for (std::size_t i = startIndex; i < count; ++i) {
-        out.push_back(dataLog[i]);
+    ScopedLock lock(dataMutex);
+    uint64_t total = 0;
+    std::size_t count = 0;
+    GetRingStateLocked(resolution, total, count);
+
+    cursor.oldest = total - count;
+    cursor.end = total;
+    cursor.next = (sinceSequence >= total) ? total : std::max<uint64_t>(sinceSequence + 1, cursor.oldest);
+    if (limit != 0 && cursor.end - cursor.next > limit) {
+        cursor.end = cursor.next + limit;
     }
-    return out;
+    return cursor;
 }
 
-DataPointStorage DataManager::GetAllData() const {
-    return GetRecentData(0);
+std::size_t DataManager::ReadHistoryBatch(DataHistoryCursor& cursor, DataPoint* out, std::size_t maxCount) const {
+    if (out == nullptr || maxCount == 0 || cursor.resolution != DataResolution::Raw) {
+        return 0;
+    }
+
+    ScopedLock lock(dataMutex);
+    const uint64_t oldest = totalLogged - dataCount;
+    if (cursor.next < oldest) {
+        cursor.next = oldest;
+    }
+    const std::size_t capacity = dataLog.Capacity();
+    if (cursor.next >= cursor.end || capacity == 0) {
+        return 0;
+    }
+
+    const std::size_t take = static_cast<std::size_t>(
+        std::min<uint64_t>(cursor.end - cursor.next, maxCount));
+    std::size_t index = (dataHead + static_cast<std::size_t>(cursor.next - oldest)) % capacity;
+    for (std::size_t i = 0; i < take; ++i) {
+        dataLog.Load(index, out[i]);
+        out[i].sequence = static_cast<uint32_t>(cursor.next + i);
+        index = (index + 1 == capacity) ? 0 : index + 1;
+    }
+
+    cursor.next += take;
+    return take;
+}
+
+std::size_t DataManager::ReadRollupBatch(DataHistoryCursor& cursor, DataRollup* out, std::size_t maxCount) const {
+    if (out == nullptr || maxCount == 0 || cursor.resolution == DataResolution::Raw) {
+        return 0;
+    }
+
+    ScopedLock lock(dataMutex);
+    const RollupTier& tier = rollupTiers[RollupTierIndex(cursor.resolution)];
+    const uint64_t oldest = tier.total - tier.count;
+    if (cursor.next < oldest) {
+        cursor.next = oldest;
+    }
+    if (cursor.next >= cursor.end || tier.ring.empty()) {
+        return 0;
+    }
+
+    const std::size_t capacity = tier.ring.size();
+    const std::size_t take = static_cast<std::size_t>(
+        std::min<uint64_t>(cursor.end - cursor.next, maxCount));
+    const std::size_t startIndex = (tier.head + static_cast<std::size_t>(cursor.next - oldest)) % capacity;
+    const std::size_t firstCount = std::min(take, capacity - startIndex);
+
+    std::copy(tier.ring.begin() + startIndex, tier.ring.begin() + startIndex + firstCount, out);
+    std::copy(tier.ring.begin(), tier.ring.begin() + (take - firstCount), out + firstCount);
+
+    cursor.next += take;
+    return take;
+}
+
+uint32_t DataManager::GetResolutionSeconds(DataResolution resolution) {
+    if (resolution == DataResolution::Raw) {
+        return 0;
+    }
+    return ROLLUP_BUCKET_SECONDS[RollupTierIndex(resolution)];
+}
+
+std::size_t DataManager::GetRollupCount(DataResolution resolution) const {
+    if (resolution == DataResolution::Raw) {
+        return GetDataPointCount();
+    }
+    ScopedLock lock(dataMutex);
+    return rollupTiers[RollupTierIndex(resolution)].count;
+}
+
+std::size_t DataManager::GetMaxRollupCount(DataResolution resolution) const {
+    if (resolution == DataResolution::Raw) {
+        return maxDataPoints;
+    }
+    ScopedLock lock(dataMutex);
+    return rollupTiers[RollupTierIndex(resolution)].ring.size();
+}
+
+void DataManager::GetRingStateLocked(DataResolution resolution, uint64_t& total, std::size_t& count) const {
+    if (resolution == DataResolution::Raw) {
+        total = totalLogged;
+        count = dataCount;
+        return;
+    }
+
+    const RollupTier& tier = rollupTiers[RollupTierIndex(resolution)];
+    total = tier.total;
+    count = tier.count;
+}
+
+void DataManager::ResizeRollupTiersLocked(int windowMs) {
+    const std::size_t maxBuckets[ROLLUP_TIER_COUNT] = {ROLLUP_10S_MAX_BUCKETS, ROLLUP_60S_MAX_BUCKETS};
+    const std::size_t windowSeconds = static_cast<std::size_t>(std::max(windowMs, 0)) / 1000;
+
+    for (std::size_t i = 0; i < ROLLUP_TIER_COUNT; ++i) {
+        RollupTier& tier = rollupTiers[i];
+        const std::size_t bucketSeconds = ROLLUP_BUCKET_SECONDS[i];
+        const std::size_t desired = std::max<std::size_t>(
+            1,
+            std::min((windowSeconds + bucketSeconds - 1) / bucketSeconds, maxBuckets[i]));
+        if (desired == tier.ring.size()) {
+            continue;
+        }
+
+        // Keep the newest buckets, linearized so the new ring starts at index 0.
+        DataRollupStorage resized(desired);
+        const std::size_t keep = std::min(tier.count, desired);
+        const std::size_t oldCapacity = tier.ring.size();
+        for (std::size_t k = 0; k < keep; ++k) {
+            resized[k] = tier.ring[(tier.head + (tier.count - keep) + k) % oldCapacity];
+        }
+
+        tier.ring.swap(resized);
+        tier.head = 0;
+        tier.count = keep;
+    }
+}
+
+void DataManager::AccumulateRollupsLocked(const DataPoint& point) {
+    const float values[3] = {point.setPoint, point.processValue, point.PIDOutput};
+
+    for (std::size_t i = 0; i < ROLLUP_TIER_COUNT; ++i) {
+        RollupTier& tier = rollupTiers[i];
+        RollupAccumulator& pending = tier.pending;
+        const uint64_t bucketStart = point.timestamp - (point.timestamp % ROLLUP_BUCKET_SECONDS[i]);
+
+        if (pending.sampleCount > 0 && pending.bucketStart != bucketStart) {
+            CloseRollupBucketLocked(tier);
+        }
+
+        if (pending.sampleCount == 0) {
+            pending.bucketStart = bucketStart;
+            for (int v = 0; v < 3; ++v) {
+                pending.min[v] = values[v];
+                pending.max[v] = values[v];
+                pending.sum[v] = 0.0;
+            }
+        }
+
+        for (int v = 0; v < 3; ++v) {
+            pending.min[v] = std::min(pending.min[v], values[v]);
+            pending.max[v] = std::max(pending.max[v], values[v]);
+            pending.sum[v] += values[v];
+        }
+        ++pending.sampleCount;
+    }
+}
+
+void DataManager::CloseRollupBucketLocked(RollupTier& tier) {
+    RollupAccumulator& pending = tier.pending;
+    const std::size_t capacity = tier.ring.size();
+    if (pending.sampleCount == 0 || capacity == 0) {
+        pending = RollupAccumulator{};
+        return;
+    }
+
+    DataRollup rollup{};
+    rollup.timestamp = pending.bucketStart;
+    rollup.sequence = static_cast<uint32_t>(tier.total);
+    rollup.sampleCount = static_cast<uint16_t>(std::min<uint32_t>(pending.sampleCount, UINT16_MAX));
+    DataRollupStats* stats[3] = {&rollup.setPoint, &rollup.processValue, &rollup.PIDOutput};
+    for (int v = 0; v < 3; ++v) {
+        stats[v]->min = pending.min[v];
+        stats[v]->max = pending.max[v];
+        stats[v]->mean = static_cast<float>(pending.sum[v] / static_cast<double>(pending.sampleCount));
+    }
+
+    if (tier.count < capacity) {
+        tier.ring[(tier.head + tier.count) % capacity] = rollup;
+        ++tier.count;
+    } else {
+        tier.ring[tier.head] = rollup;
+        tier.head = (tier.head + 1) % capacity;
+    }
+    ++tier.total;
+    pending = RollupAccumulator{};
 }
 
 esp_err_t DataManager::ClearData() {
-    ScopedDataLock lock(dataMutex);
-    dataLog.clear();
+    ScopedLock lock(dataMutex);
+    dataHead = 0;
+    dataCount = 0;
+    for (RollupTier& tier : rollupTiers) {
+        tier.head = 0;
+        tier.count = 0;
+        tier.pending = RollupAccumulator{};
+    }
     return ESP_OK;
 }
 
 std::size_t DataManager::GetDataPointCount() const {
-    ScopedDataLock lock(dataMutex);
-    return dataLog.size();
+    ScopedLock lock(dataMutex);
+    return dataCount;
 }
 
 std::size_t DataManager::GetStorageBytesUsed() const {
-    ScopedDataLock lock(dataMutex);
-    return dataLog.size() * sizeof(DataPoint);
+    ScopedLock lock(dataMutex);
+    std::size_t bytes = dataCount * dataLog.BytesPerSample();
+    for (const RollupTier& tier : rollupTiers) {
+        bytes += tier.count * sizeof(DataRollup);
+    }
+    return bytes;
+}
+
+uint8_t DataManager::GetHistoryZoneCount() const {
+    ScopedLock lock(dataMutex);
+    return dataLog.zoneCount;
 }
 
 esp_err_t DataManager::ChangeDataLogInterval(int newIntervalMs) {
@@ -165,20 +468,15 @@ esp_err_t DataManager::ChangeDataLogInterval(int newIntervalMs) {
         return ESP_ERR_INVALID_ARG;
     }
 
-    int currentMaxTimeMs = 0;
+    // The raw ring keeps whatever fits at the new rate; older parts of the
+    // window are still served by the rollup tiers.
     bool currentlyLogging = false;
     {
-        ScopedDataLock lock(dataMutex);
-        currentMaxTimeMs = MaxTimeSavedMS;
+        ScopedLock lock(dataMutex);
         currentlyLogging = LogData;
-    }
-
-    if (EstimateDataPoints(static_cast<std::size_t>(newIntervalMs), static_cast<std::size_t>(currentMaxTimeMs)) > maxDataPoints) {
-        return ESP_ERR_INVALID_ARG;
-    }
-
-    {
-        ScopedDataLock lock(dataMutex);
+        if (newIntervalMs != DataLogIntervalMs) {
+            intervalStartSequence = totalLogged;
+        }
         DataLogIntervalMs = newIntervalMs;
     }
 
@@ -203,21 +501,12 @@ esp_err_t DataManager::ChangeMaxTimeSaved(int newMaxTimeSavedMs) {
         return ESP_ERR_INVALID_ARG;
     }
 
-    int currentIntervalMs = 0;
     bool currentlyLogging = false;
     {
-        ScopedDataLock lock(dataMutex);
-        currentIntervalMs = DataLogIntervalMs;
+        ScopedLock lock(dataMutex);
         currentlyLogging = LogData;
-    }
-
-    if (EstimateDataPoints(static_cast<std::size_t>(currentIntervalMs), static_cast<std::size_t>(newMaxTimeSavedMs)) > maxDataPoints) {
-        return ESP_ERR_INVALID_ARG;
-    }
-
-    {
-        ScopedDataLock lock(dataMutex);
         MaxTimeSavedMS = newMaxTimeSavedMs;
+        ResizeRollupTiersLocked(newMaxTimeSavedMs);
     }
 
     esp_err_t persistErr = SettingsManager::getInstance().SetMaxDataLogTimeMs(newMaxTimeSavedMs);
@@ -249,27 +538,37 @@ DataManager::DataManager() {
         LogData = true;
     }
 
+    // Rollup tiers are small; allocate them first so the raw ring's memory
+    // estimate already accounts for them.
+    ResizeRollupTiersLocked(MaxTimeSavedMS);
+
+    // Zone columns follow the layout at boot; a zone change takes a reboot to
+    // show up in history.
+    const uint8_t zoneCount = Controller::getInstance().GetZoneCount();
+    const std::size_t bytesPerSample = DataColumns::BytesPerSample(zoneCount);
+    const std::size_t sizeBoundPoints = (static_cast<std::size_t>(MAX_DATA_SIZE_KB) * 1024) / bytesPerSample;
     const std::size_t settingsPoints = EstimateDataPoints(
         static_cast<std::size_t>(DataLogIntervalMs),
         static_cast<std::size_t>(MaxTimeSavedMS));
     const std::size_t desiredPoints = std::max<std::size_t>(
         1,
-        std::min<std::size_t>(settingsPoints, MAX_DATA_POINTS));
+        std::min<std::size_t>(settingsPoints, sizeBoundPoints));
     const std::size_t memoryBoundPoints = std::min<std::size_t>(
-        EstimateMemoryBoundDataPoints(),
-        MAX_DATA_POINTS);
+        EstimateMemoryBoundDataPoints(bytesPerSample),
+        sizeBoundPoints);
 
     maxDataPoints = std::max<std::size_t>(1, std::min(desiredPoints, memoryBoundPoints));
-    dataLog.reserve(maxDataPoints);
+    // Allocate the whole ring up front so logging never reallocates or shifts PSRAM contents.
+    dataLog.Resize(maxDataPoints, zoneCount);
 
-    if (maxDataPoints < desiredPoints) {
-        const std::size_t adjustedWindowMs = maxDataPoints * static_cast<std::size_t>(DataLogIntervalMs);
-        MaxTimeSavedMS = static_cast<int>(adjustedWindowMs);
+    if (maxDataPoints < settingsPoints) {
+        // The rest of the window is covered by the 10 s / 60 s rollup tiers.
         ESP_LOGW(
             TAG,
-            "Limiting data log capacity to %u points (%u bytes) due to available heap",
+            "Raw data log limited to %u points (%u bytes, %u s at full rate)",
             static_cast<unsigned>(maxDataPoints),
-            static_cast<unsigned>(maxDataPoints * sizeof(DataPoint)));
+            static_cast<unsigned>(maxDataPoints * bytesPerSample),
+            static_cast<unsigned>((maxDataPoints * static_cast<std::size_t>(DataLogIntervalMs)) / 1000));
     }
 
     if (LogData) {
@@ -334,7 +633,7 @@ esp_err_t DataManager::DataLogLoop() {
     while (IsLogging()) {
         esp_err_t err = LogDataPoint();
         if (err != ESP_OK) {
-            ScopedDataLock lock(dataMutex);
+            ScopedLock lock(dataMutex);
             LogData = false;
             return err;
         }
@@ -347,38 +646,55 @@ esp_err_t DataManager::DataLogLoop() {
 }
 
 esp_err_t DataManager::LogDataPoint() {
+    TRACE_SCOPE("DataManager::LogDataPoint");
     DataPoint newDataPoint{};
 
     newDataPoint.timestamp = static_cast<uint64_t>(esp_timer_get_time() / 1000000);
-    newDataPoint.setPoint = static_cast<float>(Controller::getInstance().GetSetPoint());
-    newDataPoint.processValue = static_cast<float>(Controller::getInstance().GetProcessValue());
-    newDataPoint.PIDOutput = static_cast<float>(Controller::getInstance().GetPIDOutput());
-
-    PID* pid = Controller::getInstance().GetPIDController();
-    newDataPoint.PTerm = static_cast<float>(pid->GetPreviousP());
-    newDataPoint.ITerm = static_cast<float>(pid->GetPreviousI());
-    newDataPoint.DTerm = static_cast<float>(pid->GetPreviousD());
+    const ControllerSnapshot controller = Controller::getInstance().GetSnapshot();
+    newDataPoint.setPoint = static_cast<float>(controller.setPoint);
+    newDataPoint.processValue = static_cast<float>(controller.processValue);
+    newDataPoint.PIDOutput = static_cast<float>(controller.pidOutput);
+    newDataPoint.PTerm = static_cast<float>(controller.pTerm);
+    newDataPoint.ITerm = static_cast<float>(controller.iTerm);
+    newDataPoint.DTerm = static_cast<float>(controller.dTerm);
 
     for (int i = 0; i < 4; i++) {
         newDataPoint.temperatureReadings[i] = static_cast<float>(HardwareManager::getInstance().getThermocoupleValue(i));
     }
 
-    uint8_t relayStates = 0;
-    for (int i = 0; i < 6; i++) {
-        if (HardwareManager::getInstance().getRelayState(i)) {
-            relayStates |= static_cast<uint8_t>(1 << i);
-        }
-    }
+    const uint8_t relayStates = static_cast<uint8_t>(HardwareManager::getInstance().getRelayStateMask() & 0x3F);
 
     newDataPoint.relayStates = relayStates;
     newDataPoint.servoAngle = static_cast<uint8_t>(HardwareManager::getInstance().getServoAngle());
-    newDataPoint.chamberRunning = Controller::getInstance().IsRunning();
+    newDataPoint.chamberRunning = controller.running;
+    newDataPoint.zoneCount = controller.zoneCount;
+    for (uint8_t zone = 0; zone < MAX_CONTROL_ZONES; ++zone) {
+        newDataPoint.zoneProcessValue[zone] = static_cast<float>(controller.zoneProcessValue[zone]);
+        newDataPoint.zoneOutput[zone] = static_cast<float>(controller.zoneOutput[zone]);
+    }
 
-    ScopedDataLock lock(dataMutex);
-    if (dataLog.size() >= maxDataPoints) {
-        dataLog.erase(dataLog.begin());
+    {
+        ScopedLock lock(dataMutex);
+        const std::size_t capacity = dataLog.Capacity();
+        if (capacity == 0) {
+            return ESP_ERR_NO_MEM;
+        }
+        newDataPoint.sequence = static_cast<uint32_t>(totalLogged);
+        if (dataCount < capacity) {
+            dataLog.Store((dataHead + dataCount) % capacity, newDataPoint);
+            ++dataCount;
+        } else {
+            // Full: overwrite the oldest point and advance the head.
+            dataLog.Store(dataHead, newDataPoint);
+            dataHead = (dataHead + 1) % capacity;
+        }
+        ++totalLogged;
+
+        AccumulateRollupsLocked(newDataPoint);
     }
-    dataLog.push_back(newDataPoint);
+
+    // Outside dataMutex: the run log only copies into RAM, but keeps its own lock.
+    RunLogManager::getInstance().Append(newDataPoint);
 
     return ESP_OK;
 }
@@ -390,8 +706,5 @@ bool DataManager::CheckSettingsValid() {
     if (MaxTimeSavedMS < 1000 * 60 || MaxTimeSavedMS > 1000 * 60 * 60 * 24) {
         return false;
     }
-    if (EstimateDataPoints(static_cast<std::size_t>(DataLogIntervalMs), static_cast<std::size_t>(MaxTimeSavedMS)) > MAX_DATA_POINTS) {
-        return false;
-    }
     return true;
 }
@@ -1,4 +1,6 @@
 #include "HardwareManager.hpp"
+#include "Tracer.hpp"
+#include "esp_timer.h"
 #include <cstring>
 #include <algorithm>
 #include <cstdint>
@@ -21,7 +23,24 @@ double HardwareManager::getThermocoupleValue(int index) {
     if (index < 0 || index >= NUM_THERMOCOUPLES) {
         return THERMOCOUPLE_ERROR_VALUE; // Return error value for out of bounds index
     }
-    return thermocoupleValues[index];
+    return getThermocoupleSnapshot().values[index];
+}
+
+ThermocoupleSnapshot HardwareManager::getThermocoupleSnapshot() const {
+    while (true) {
+        // While the sequence is odd the writer is filling the other buffer, so
+        // the published one is still safe to copy.
+        const uint32_t sequence = thermocoupleSequence.load(std::memory_order_acquire);
+        const ThermocoupleSnapshot copy = thermocoupleBuffers[(sequence >> 1) & 1];
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (thermocoupleSequence.load(std::memory_order_relaxed) == sequence) {
+            return copy;
+        }
+    }
+}
+
+void HardwareManager::setSampleListener(TaskHandle_t task) {
+    sampleListener.store(task, std::memory_order_release);
 }
 
 esp_err_t HardwareManager::setRelayState(int relayIndex, bool state) {
@@ -29,15 +48,36 @@ esp_err_t HardwareManager::setRelayState(int relayIndex, bool state) {
         return ESP_ERR_INVALID_ARG; // Invalid relay index
     }
     gpio_set_level((gpio_num_t) RELAY_GPIO_PINS[relayIndex], state ? 1 : 0);
-    relayStates[relayIndex] = state;
+    const uint32_t bit = 1u << relayIndex;
+    if (state) {
+        relayStateBits.fetch_or(bit, std::memory_order_relaxed);
+    } else {
+        relayStateBits.fetch_and(~bit, std::memory_order_relaxed);
+    }
     return ESP_OK;
 }
 
+void HardwareManager::applyRelayMask(uint32_t onMask, uint32_t relayMask) {
+    relayMask &= (1u << NUM_RELAYS) - 1u;
+    for (int i = 0; i < NUM_RELAYS; i++) {
+        const uint32_t bit = 1u << i;
+        if ((relayMask & bit) != 0) {
+            gpio_set_level((gpio_num_t) RELAY_GPIO_PINS[i], (onMask & bit) != 0 ? 1 : 0);
+        }
+    }
+
+    uint32_t current = relayStateBits.load(std::memory_order_relaxed);
+    uint32_t next = 0;
+    do {
+        next = (current & ~relayMask) | (onMask & relayMask);
+    } while (!relayStateBits.compare_exchange_weak(current, next, std::memory_order_relaxed));
+}
+
 bool HardwareManager::getRelayState(int relayIndex) {
     if (relayIndex < 0 || relayIndex >= NUM_RELAYS) {
         return false; // Invalid relay index, return false as default
     }
-    return relayStates[relayIndex];
+    return (relayStateBits.load(std::memory_order_relaxed) & (1u << relayIndex)) != 0;
 }
 
 esp_err_t HardwareManager::setServoAngle(double angle) {
@@ -72,11 +112,8 @@ HardwareManager::HardwareManager() {
 esp_err_t HardwareManager::initializeHardware() {
 
     // ====== THERMOCOUPLE SET UP =========
-    // 1. Set up the array that hold the temperature
-    thermocoupleValues.resize(NUM_THERMOCOUPLES);
-    for (int i = 0; i < NUM_THERMOCOUPLES; i++) {
-        thermocoupleValues[i] = THERMOCOUPLE_ERROR_VALUE;
-    }
+    // 1. Both snapshot buffers start out holding the error value (see ThermocoupleSnapshot)
+    static_assert(NUM_THERMOCOUPLES <= ThermocoupleSnapshot::MAX_CHANNELS, "Snapshot too small for thermocouple count");
 
     // 2. Set up the SPI bus for thermocouples
     esp_err_t err = thermocoupleSPISetup();
@@ -91,9 +128,7 @@ esp_err_t HardwareManager::initializeHardware() {
     }
 
     // ======= RELAY SET UP =========
-    for (int i = 0; i < NUM_RELAYS; i++) {
-        relayStates.push_back(false); // Initialize all relays to off
-    }
+    relayStateBits.store(0, std::memory_order_relaxed); // Initialize all relays to off
     err = relaySetup();
     if (err != ESP_OK) {
         return err;
@@ -301,40 +336,81 @@ void HardwareManager::readLoop() {
     }
 }
 
-// This function will read the temps of the thermocouples in C and place them in the vector
+// Reads every thermocouple and publishes the pass as one snapshot. All transfers are queued
+// up front so the driver runs them back to back from its ISR, instead of a blocking
+// round-trip per device.
 esp_err_t HardwareManager::readThermocouples() {
+    TRACE_SCOPE("HardwareManager::readThermocouples");
     if (spiDevices.empty()) {
         return ESP_ERR_INVALID_STATE;
     }
 
+    // Odd sequence: the idle buffer is being written. The fence keeps the buffer
+    // stores below from becoming visible before the odd value.
+    const uint32_t sequence = thermocoupleSequence.load(std::memory_order_relaxed);
+    thermocoupleSequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    ThermocoupleSnapshot& next = thermocoupleBuffers[((sequence >> 1) + 1) & 1];
+    next.timestampUs = esp_timer_get_time();
+
+    bool queued[NUM_THERMOCOUPLES] = {};
     for (int i = 0; i < NUM_THERMOCOUPLES; i++) {
-        // Read the data from the thermocouple
-        spi_transaction_t t{};
+        if (thermocoupleInFlight[i]) {
+            // A transfer that timed out last pass still belongs to the driver.
+            // Collect its stale result if it has finished, otherwise leave the
+            // descriptor alone and skip this device until it does.
+            spi_transaction_t* stale = nullptr;
+            if (spi_device_get_trans_result(spiDevices[i], &stale, 0) != ESP_OK) {
+                continue;
+            }
+            thermocoupleInFlight[i] = false;
+        }
+
+        spi_transaction_t& t = thermocoupleTransactions[i];
         std::memset(&t, 0, sizeof(t));
         t.flags = SPI_TRANS_USE_RXDATA;
         t.rxlength = 16; // We read 16 bits of data
         t.length = 0; // No TX
 
-        esp_err_t err = spi_device_transmit(spiDevices[i], &t);
-        if (err != ESP_OK) {
-            thermocoupleValues[i] = THERMOCOUPLE_ERROR_VALUE; // Set to error value on failure
+        queued[i] = (spi_device_queue_trans(spiDevices[i], &t, 0) == ESP_OK);
+        thermocoupleInFlight[i] = queued[i];
+    }
+
+    for (int i = 0; i < NUM_THERMOCOUPLES; i++) {
+        next.values[i] = THERMOCOUPLE_ERROR_VALUE;
+        if (!queued[i]) {
             // TODO: print some error to the console here to specifiy that it was an SPI error, not an error state from the MAX6675
             continue;
         }
 
-        // The data comes in as a MSB-first 16-bit word
-        uint16_t rawData = (static_cast<uint16_t>(t.rx_data[0]) << 8) | t.rx_data[1];
-
-        // Check bit 2 for thermocouple error (open circuit)
-        if (rawData & (1u << 2)){
-            thermocoupleValues[i] = THERMOCOUPLE_ERROR_VALUE; // Set to error value on open circuit
+        spi_transaction_t* result = nullptr;
+        if (spi_device_get_trans_result(spiDevices[i], &result, pdMS_TO_TICKS(THERMOCOUPLE_READ_INTERVAL_MS)) != ESP_OK || result == nullptr) {
             continue;
         }
+        thermocoupleInFlight[i] = false;
+        next.values[i] = decodeThermocouple(*result);
+    }
+
+    next.sequence = (sequence >> 1) + 1;
+    thermocoupleSequence.store(sequence + 2, std::memory_order_release);
 
-        // Bits 14:3 contain the temperature data, with bit 14 as the sign bit. Shift right by 3 to get the value and then multiply by 0.25 to get the temp in C
-        uint16_t tempData = (rawData >> 3) & 0x0FFF; // Get bits 14:3
-        double temperature = tempData * 0.25; // Each bit represents 0.25 degrees C
-        thermocoupleValues[i] = temperature;
+    TaskHandle_t listener = sampleListener.load(std::memory_order_acquire);
+    if (listener != nullptr) {
+        xTaskNotifyGive(listener);
     }
     return ESP_OK;
-}
\ No newline at end of file
+}
+
+double HardwareManager::decodeThermocouple(const spi_transaction_t& transaction) {
+    // The data comes in as a MSB-first 16-bit word
+    const uint16_t rawData = (static_cast<uint16_t>(transaction.rx_data[0]) << 8) | transaction.rx_data[1];
+
+    // Check bit 2 for thermocouple error (open circuit)
+    if (rawData & (1u << 2)) {
+        return THERMOCOUPLE_ERROR_VALUE;
+    }
+
+    // Bits 14:3 contain the temperature data, with bit 14 as the sign bit. Shift right by 3 to get the value and then multiply by 0.25 to get the temp in C
+    const uint16_t tempData = (rawData >> 3) & 0x0FFF; // Get bits 14:3
+    return tempData * 0.25; // Each bit represents 0.25 degrees C
+}
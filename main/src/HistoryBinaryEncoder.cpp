@@ -0,0 +1,65 @@
+#include "HistoryBinaryEncoder.hpp"
+
+#include "BinaryCodec.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+constexpr const char MAGIC[4] = {'R', 'F', 'H', '1'};
+}
+
+void HistoryBinaryEncoder::EncodeHeader(
+    uint64_t firstTimestamp,
+    uint32_t firstSequence,
+    uint32_t oldestSequence,
+    uint32_t nextSequence,
+    uint32_t startUnixTime,
+    uint8_t zones,
+    uint8_t* out) {
+    zoneCount = std::clamp<uint8_t>(zones, 1, MAX_CONTROL_ZONES);
+
+    std::memset(out, 0, HEADER_SIZE);
+    std::memcpy(out, MAGIC, sizeof(MAGIC));
+    out[4] = VERSION;
+    out[5] = static_cast<uint8_t>(GetRecordSize());
+    out[6] = zoneCount;
+    PutLe64(out + 8, firstTimestamp);
+    PutLe32(out + 16, firstSequence);
+    PutLe32(out + 20, oldestSequence);
+    PutLe32(out + 24, nextSequence);
+    PutLe32(out + 28, startUnixTime);
+
+    previousTimestamp = firstTimestamp;
+    previousSequence = firstSequence;
+}
+
+void HistoryBinaryEncoder::EncodeRecord(const DataPoint& point, uint8_t* out) {
+    const uint64_t delta = (point.timestamp > previousTimestamp) ? (point.timestamp - previousTimestamp) : 0;
+    previousTimestamp = point.timestamp;
+
+    PutLe16(out + 0, static_cast<uint16_t>(std::min<uint64_t>(delta, UINT16_MAX)));
+    PutLe16(out + 2, static_cast<uint16_t>(QuantizeFixed(point.setPoint, 4.0f)));
+    PutLe16(out + 4, static_cast<uint16_t>(QuantizeFixed(point.processValue, 4.0f)));
+    PutLe16(out + 6, static_cast<uint16_t>(QuantizeFixed(point.PIDOutput, 100.0f)));
+    PutLe16(out + 8, static_cast<uint16_t>(QuantizeFixed(point.PTerm, 100.0f)));
+    PutLe16(out + 10, static_cast<uint16_t>(QuantizeFixed(point.ITerm, 100.0f)));
+    PutLe16(out + 12, static_cast<uint16_t>(QuantizeFixed(point.DTerm, 100.0f)));
+    for (int channel = 0; channel < 4; ++channel) {
+        PutLe16(out + 14 + channel * 2, static_cast<uint16_t>(QuantizeFixed(point.temperatureReadings[channel], 4.0f)));
+    }
+    out[22] = static_cast<uint8_t>((point.relayStates & 0x3F) | (point.chamberRunning ? 0x80 : 0x00));
+    out[23] = point.servoAngle;
+    PutLe16(out + 24, static_cast<uint16_t>(std::min<uint32_t>(point.sequence - previousSequence, UINT16_MAX)));
+    previousSequence = point.sequence;
+
+    if (zoneCount > 1) {
+        for (uint8_t zone = 0; zone < zoneCount; ++zone) {
+            const bool live = zone < point.zoneCount;
+            uint8_t* field = out + BASE_RECORD_SIZE + zone * ZONE_FIELDS_SIZE;
+            PutLe16(field, static_cast<uint16_t>(live ? QuantizeFixed(point.zoneProcessValue[zone], 4.0f) : 0));
+            PutLe16(field + 2, static_cast<uint16_t>(live ? QuantizeFixed(point.zoneOutput[zone], 100.0f) : 0));
+        }
+    }
+}
@@ -1,91 +1,103 @@
 #include "PID.hpp"
 #include <algorithm>
 #include <cmath>
-#include "esp_timer.h"
-
-esp_err_t PID::Reset() {
-    integral = 0.0;
-    previousError = 0.0;
-    dFiltered = 0.0;
-    previousOutput = 0.0;
-    previousP = 0.0;
-    previousI = 0.0;
-    previousD = 0.0;
+
+template <typename T>
+esp_err_t BasicPID<T>::Reset() {
+    integral = T(0);
+    previousError = T(0);
+    dFiltered = T(0);
+    previousOutput = T(0);
+    previousP = T(0);
+    previousI = T(0);
+    previousD = T(0);
+    previousFeedforward = T(0);
     firstRun = true;
-    lastTimeUs = 0;
-    previousPV = 0.0;
+    previousPV = T(0);
     return ESP_OK;
 }
 
-double PID::Calculate(double setPoint, double processValue) {
-    auto clampPTermToBand = [](double pTerm, double error) {
-        if (error > 0.0) {
-            return std::max(0.0, pTerm);
+template <typename T>
+T BasicPID<T>::Calculate(T setPoint, T processValue, T dtSeconds, T feedforward) {
+    return Compute(setPoint, processValue, dtSeconds, feedforward, nullptr);
+}
+
+template <typename T>
+T BasicPID<T>::CalculateWithRate(T setPoint, T processValue, T processRate, T dtSeconds, T feedforward) {
+    return Compute(setPoint, processValue, dtSeconds, feedforward, &processRate);
+}
+
+template <typename T>
+T BasicPID<T>::Compute(T setPoint, T processValue, T dtSeconds, T feedforward, const T* processRate) {
+    auto clampPTermToBand = [](T pTerm, T error) {
+        if (error > T(0)) {
+            return std::max(T(0), pTerm);
         }
-        if (error < 0.0) {
-            return std::min(0.0, pTerm);
+        if (error < T(0)) {
+            return std::min(T(0), pTerm);
         }
         return pTerm;
     };
 
-    const int64_t nowUs = esp_timer_get_time();
-    double dt = 1e-6;
-    if (!firstRun) {
-        dt = (nowUs - lastTimeUs) / 1e6; // Convert microseconds to seconds
-        if (dt <= 0.0) {
-            dt = 1e-6;
-        }
+    T dt = T(1e-6);
+    if (!firstRun && dtSeconds > T(0)) {
+        dt = dtSeconds;
     }
-    lastTimeUs = nowUs;
 
-    const double error = setPoint - processValue;
-    const double errorWeighted = (setpointWeight * setPoint) - processValue;
+    const T error = setPoint - processValue;
+    const T errorWeighted = (setpointWeight * setPoint) - processValue;
 
     const bool wasFirstRun = firstRun;
     if (wasFirstRun) {
         previousError = error;
         previousPV = processValue;
-        dFiltered = 0.0;
+        dFiltered = T(0);
         firstRun = false;
     }
 
-    if (derivativeFilterTime > 0.0) {
+    if (derivativeFilterTime > T(0)) {
         DerivativeFilterAlpha = dt / (derivativeFilterTime + dt);
     } else {
-        DerivativeFilterAlpha = 1.0;
+        DerivativeFilterAlpha = T(1);
     }
 
-    const double derivative = (wasFirstRun ? 0.0 : (-1.0 * (processValue - previousPV) / dt));
+    // Derivative on measurement. A supplied rate is valid from the first run.
+    T derivative = T(0);
+    if (processRate != nullptr) {
+        derivative = -*processRate;
+    } else if (!wasFirstRun) {
+        derivative = -(processValue - previousPV) / dt;
+    }
     previousPV = processValue;
 
     // Apply derivative filtering
-    dFiltered = DerivativeFilterAlpha * derivative + (1.0 - DerivativeFilterAlpha) * dFiltered;
+    dFiltered = DerivativeFilterAlpha * derivative + (T(1) - DerivativeFilterAlpha) * dFiltered;
 
-    const double pTermHeat = clampPTermToBand(heatingKp * errorWeighted, error);
-    const double dTermHeat = heatingKd * dFiltered;
+    const T pTermHeat = clampPTermToBand(heatingKp * errorWeighted, error);
+    const T dTermHeat = heatingKd * dFiltered;
 
-    const double pTermCool = clampPTermToBand(coolingKp * errorWeighted, error);
-    const double dTermCool = coolingKd * dFiltered;
-    const double outputNoICool = pTermCool + dTermCool;
+    const T pTermCool = clampPTermToBand(coolingKp * errorWeighted, error);
+    const T dTermCool = coolingKd * dFiltered;
+    const T outputNoICool = pTermCool + dTermCool;
 
     // Explicit asymmetric mode handling:
-    // If cooling P+D is asking for a negative command, run in cooling gain set.
-    const bool coolingMode = (outputNoICool < 0.0);
-    const double activeKi = coolingMode ? coolingKi : heatingKi;
-    const double pTerm = coolingMode ? pTermCool : pTermHeat;
-    const double dTerm = coolingMode ? dTermCool : dTermHeat;
-    const double outputNoI = pTerm + dTerm;
-
-    if (integralLeakTimeSeconds > 0.0) {
+    // If cooling P+D (plus feedforward) is asking for a negative command, run in cooling gain set.
+    const bool coolingMode = (outputNoICool + feedforward < T(0));
+    const T activeKi = coolingMode ? coolingKi : heatingKi;
+    const T pTerm = coolingMode ? pTermCool : pTermHeat;
+    const T dTerm = coolingMode ? dTermCool : dTermHeat;
+    const T outputNoI = pTerm + dTerm + feedforward;
+
+    if (integralLeakTimeSeconds > T(0)) {
         integral *= std::exp(-dt / integralLeakTimeSeconds);
     }
 
-    const bool inIZone = (integralZoneC <= 0.0) || (std::abs(error) <= integralZoneC);
-    if (activeKi > 0.0 && inIZone) {
-        const double integralCandidate = integral + error * dt;
+    const bool inIZone = (integralZoneC <= T(0)) || (std::abs(error) <= integralZoneC);
+    if (activeKi > T(0) && inIZone) {
+        const T integralCandidate = integral + error * dt;
 
         // During cooling request (negative P+D), only allow integral updates that move toward zero.
-        if (outputNoI < 0.0) {
+        if (outputNoI < T(0)) {
             if (std::abs(integralCandidate) < std::abs(integral)) {
                 integral = integralCandidate;
             }
@@ -94,8 +106,8 @@ double PID::Calculate(double setPoint, double processValue) {
         }
     }
 
-    double iTerm = 0.0;
-    if (activeKi > 0.0) {
+    T iTerm = T(0);
+    if (activeKi > T(0)) {
         iTerm = activeKi * integral;
         const bool pdSaturatedHigh = (outputNoI >= OutputMax);
         const bool pdSaturatedLow = (outputNoI <= OutputMin);
@@ -103,82 +115,94 @@ double PID::Calculate(double setPoint, double processValue) {
         // If P+D alone is already saturating output, do not back-calculate
         // integrator to the opposite sign; keep I neutral.
         if (pdSaturatedHigh || pdSaturatedLow) {
-            iTerm = 0.0;
-            integral = 0.0;
+            iTerm = T(0);
+            integral = T(0);
         } else {
-            const double iMin = OutputMin - outputNoI;
-            const double iMax = OutputMax - outputNoI;
+            const T iMin = OutputMin - outputNoI;
+            const T iMax = OutputMax - outputNoI;
             iTerm = std::clamp(iTerm, iMin, iMax);
             integral = iTerm / activeKi;
         }
     }
 
-    const double output = std::clamp(outputNoI + iTerm, OutputMin, OutputMax);
+    const T output = std::clamp(outputNoI + iTerm, OutputMin, OutputMax);
 
     previousError = error;
     previousP = pTerm;
     previousI = iTerm;
     previousD = dTerm;
+    previousFeedforward = feedforward;
     previousOutput = output;
 
     return output;
 }
 
-esp_err_t PID::Tune(double Kp, double Ki, double Kd) {
+template <typename T>
+esp_err_t BasicPID<T>::Tune(T Kp, T Ki, T Kd) {
     return TuneHeating(Kp, Ki, Kd);
 }
 
-esp_err_t PID::TuneHeating(double Kp, double Ki, double Kd) {
+template <typename T>
+esp_err_t BasicPID<T>::TuneHeating(T Kp, T Ki, T Kd) {
     heatingKp = Kp;
     heatingKi = Ki;
     heatingKd = Kd;
     return ESP_OK;
 }
 
-esp_err_t PID::TuneCooling(double Kp, double Ki, double Kd) {
+template <typename T>
+esp_err_t BasicPID<T>::TuneCooling(T Kp, T Ki, T Kd) {
     coolingKp = Kp;
     coolingKi = Ki;
     coolingKd = Kd;
     return ESP_OK;
 }
 
-esp_err_t PID::SetDerivativeFilterAlpha(double alpha) {
+template <typename T>
+esp_err_t BasicPID<T>::SetDerivativeFilterAlpha(T alpha) {
     if (alpha < 0 || alpha > 1) {
         return ESP_ERR_INVALID_ARG; // Alpha must be between 0 and 1
     }
     DerivativeFilterAlpha = alpha;
-    derivativeFilterTime = 0.0;
+    derivativeFilterTime = T(0);
     return ESP_OK;
 }
 
-esp_err_t PID::SetDerivativeFilterTime(double filterTimeSeconds) {
-    if (filterTimeSeconds < 0.0) {
+template <typename T>
+esp_err_t BasicPID<T>::SetDerivativeFilterTime(T filterTimeSeconds) {
+    if (filterTimeSeconds < T(0)) {
         return ESP_ERR_INVALID_ARG;
     }
     derivativeFilterTime = filterTimeSeconds;
     return ESP_OK;
 }
 
-esp_err_t PID::SetSetpointWeight(double weight) {
-    if (weight < 0.0 || weight > 1.0) {
+template <typename T>
+esp_err_t BasicPID<T>::SetSetpointWeight(T weight) {
+    if (weight < T(0) || weight > T(1)) {
         return ESP_ERR_INVALID_ARG;
     }
     setpointWeight = weight;
     return ESP_OK;
 }
 
-esp_err_t PID::SetIntegralZoneC(double zoneC) {
-    if (zoneC < 0.0) {
+template <typename T>
+esp_err_t BasicPID<T>::SetIntegralZoneC(T zoneC) {
+    if (zoneC < T(0)) {
         return ESP_ERR_INVALID_ARG;
     }
     integralZoneC = zoneC;
     return ESP_OK;
 }
 
-esp_err_t PID::SetIntegralLeakTimeSeconds(double leakTimeSeconds) {
-    if (leakTimeSeconds < 0.0) {
+template <typename T>
+esp_err_t BasicPID<T>::SetIntegralLeakTimeSeconds(T leakTimeSeconds) {
+    if (leakTimeSeconds < T(0)) {
         return ESP_ERR_INVALID_ARG;
     }
     integralLeakTimeSeconds = leakTimeSeconds;
     return ESP_OK;
 }
+
+template class BasicPID<float>;
+template class BasicPID<double>;
@@ -0,0 +1,151 @@
+#include "PIDAutotuner.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+constexpr double PI = 3.14159265358979323846;
+
+// Tyreus-Luyben rules: less aggressive than Ziegler-Nichols, which suits
+// lag-dominated thermal plants and keeps overshoot low.
+constexpr double TL_KP_DIVISOR = 2.2;
+constexpr double TL_TI_FACTOR = 2.2;
+constexpr double TL_TD_DIVISOR = 6.3;
+}
+
+esp_err_t PIDAutotuner::Start(const AutotuneConfig& newConfig) {
+    if (newConfig.heatOutputPct <= 0.0 || newConfig.heatOutputPct > 100.0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (newConfig.coolOutputPct < 0.0 || newConfig.coolOutputPct > 100.0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (newConfig.hysteresisC < 0.0 || newConfig.cycles < 1 || newConfig.cycles > MAX_CYCLES) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (newConfig.maxDurationS <= 0.0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    config = newConfig;
+    state = AutotuneState::Running;
+    result = AutotuneResult();
+    failureReason = "";
+    heating = true;
+    seenFirstSwitch = false;
+    elapsedS = 0.0;
+    lastSwitchS = 0.0;
+    lastHeatStartS = 0.0;
+    completedCycles = 0;
+    return ESP_OK;
+}
+
+void PIDAutotuner::Cancel() {
+    if (state == AutotuneState::Running) {
+        Fail("cancelled");
+    }
+}
+
+double PIDAutotuner::Update(double processValue, double dtSeconds) {
+    if (state != AutotuneState::Running) {
+        return 0.0;
+    }
+
+    if (elapsedS == 0.0 && !seenFirstSwitch) {
+        heating = processValue < config.setPointC;
+        phaseMinC = processValue;
+        phaseMaxC = processValue;
+    }
+    elapsedS += std::max(dtSeconds, 0.0);
+    if (elapsedS > config.maxDurationS) {
+        Fail("timeout");
+        return 0.0;
+    }
+
+    phaseMinC = std::min(phaseMinC, processValue);
+    phaseMaxC = std::max(phaseMaxC, processValue);
+
+    if (heating && processValue > config.setPointC + config.hysteresisC) {
+        // Heat -> cool. The trough of this cycle was reached during the heat phase.
+        if (seenFirstSwitch) {
+            heatTimeS[completedCycles] = elapsedS - lastHeatStartS;
+            peakLowC[completedCycles] = phaseMinC;
+        }
+        heating = false;
+        lastSwitchS = elapsedS;
+        phaseMaxC = processValue;
+    } else if (!heating && processValue < config.setPointC - config.hysteresisC) {
+        // Cool -> heat closes a cycle.
+        if (seenFirstSwitch) {
+            coolTimeS[completedCycles] = elapsedS - lastSwitchS;
+            peakHighC[completedCycles] = phaseMaxC;
+            completedCycles++;
+            if (completedCycles >= GetTotalCycles()) {
+                Finish();
+                return 0.0;
+            }
+        }
+        seenFirstSwitch = true;
+        heating = true;
+        lastSwitchS = elapsedS;
+        lastHeatStartS = elapsedS;
+        phaseMinC = processValue;
+    }
+
+    return heating ? config.heatOutputPct : -config.coolOutputPct;
+}
+
+void PIDAutotuner::Finish() {
+    double highSum = 0.0;
+    double lowSum = 0.0;
+    double periodSum = 0.0;
+    double heatWorkSum = 0.0;
+    double coolWorkSum = 0.0;
+    for (int i = 1; i < completedCycles; ++i) {
+        highSum += peakHighC[i];
+        lowSum += peakLowC[i];
+        periodSum += heatTimeS[i] + coolTimeS[i];
+        heatWorkSum += heatTimeS[i] * config.heatOutputPct;
+        coolWorkSum += coolTimeS[i] * config.coolOutputPct;
+    }
+
+    const double count = static_cast<double>(completedCycles - 1);
+    const double amplitude = (highSum - lowSum) / (2.0 * count);
+    const double period = periodSum / count;
+    if (amplitude <= config.hysteresisC || period <= 0.0) {
+        Fail("oscillation too small");
+        return;
+    }
+
+    // Describing function of a relay with hysteresis eps and amplitude d:
+    // Ku = 4d / (pi * sqrt(a^2 - eps^2)).
+    const double relayAmplitude = (config.heatOutputPct + config.coolOutputPct) / 2.0;
+    const double effectiveAmplitude = std::sqrt(amplitude * amplitude - config.hysteresisC * config.hysteresisC);
+    result.ultimateGain = (4.0 * relayAmplitude) / (PI * effectiveAmplitude);
+    result.ultimatePeriodS = period;
+    result.amplitudeC = amplitude;
+
+    const double kp = result.ultimateGain / TL_KP_DIVISOR;
+    const double ti = TL_TI_FACTOR * period;
+    const double td = period / TL_TD_DIVISOR;
+    result.heatingKp = kp;
+    result.heatingKi = kp / ti;
+    result.heatingKd = kp * td;
+
+    // The PV covers the same swing in both phases, so the process gain of each
+    // actuator is inversely proportional to output * time spent in its phase.
+    // Scale the cooling gains by that ratio; without cooling there is none to tune.
+    if (config.coolOutputPct > 0.0 && heatWorkSum > 0.0) {
+        const double coolingScale = coolWorkSum / heatWorkSum;
+        result.coolingKp = result.heatingKp * coolingScale;
+        result.coolingKi = result.heatingKi * coolingScale;
+        result.coolingKd = result.heatingKd * coolingScale;
+    }
+
+    state = AutotuneState::Complete;
+}
+
+void PIDAutotuner::Fail(const char* reason) {
+    failureReason = reason;
+    state = AutotuneState::Failed;
+}
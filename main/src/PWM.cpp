@@ -1,20 +1,20 @@
 #include "PWM.hpp"
+#include "ScopedLock.hpp"
+#include "Tracer.hpp"
 
 #include <algorithm>
-#include "esp_timer.h"
+#include <iterator>
 #include "esp_log.h"
 
 static const char* TAG = "PWM";
 
 PWM::PWM(uint32_t period_ms,
                        float duty_cycle,
-                       ToggleCallback on_on,
-                       ToggleCallback on_off,
+                       OutputCallback output,
                        void* user_ctx)
     : period_ms_(period_ms),
       duty_cycle_(duty_cycle),
-      on_on_(on_on),
-      on_off_(on_off),
+      output_(output),
       user_ctx_(user_ctx)
 {
     // sanitize inputs
@@ -23,7 +23,8 @@ PWM::PWM(uint32_t period_ms,
     }
     duty_cycle_ = std::clamp(duty_cycle_, 0.0f, 1.0f);
 
-    RecomputeDurations();
+    writer_mutex_ = xSemaphoreCreateMutex();
+    PublishSchedule();
 }
 
 PWM::~PWM()
@@ -32,244 +33,283 @@ PWM::~PWM()
     Stop();
 
     if (timer_ != nullptr) {
-        esp_timer_delete(reinterpret_cast<esp_timer_handle_t>(timer_));
+        (void)gptimer_disable(timer_);
+        (void)gptimer_del_timer(timer_);
         timer_ = nullptr;
     }
 }
 
 esp_err_t PWM::Start()
 {
+    ScopedLock lock(writer_mutex_);
     if (running_) {
         return ESP_OK;
     }
 
     if (timer_ == nullptr) {
-        esp_timer_create_args_t args = {};
-        args.callback = &PWM::TimerThunk;
-        args.arg = this;
-        args.dispatch_method = ESP_TIMER_TASK; // simple + safe for user callbacks
-        args.name = "PWM";
-
-        esp_timer_handle_t handle = nullptr;
-        esp_err_t err = esp_timer_create(&args, &handle);
+        gptimer_config_t config = {};
+        config.clk_src = GPTIMER_CLK_SRC_DEFAULT;
+        config.direction = GPTIMER_COUNT_UP;
+        config.resolution_hz = TIMER_RESOLUTION_HZ;
+
+        gptimer_handle_t handle = nullptr;
+        esp_err_t err = gptimer_new_timer(&config, &handle);
         if (err != ESP_OK) {
-            ESP_LOGE(TAG, "esp_timer_create failed: %s", esp_err_to_name(err));
+            ESP_LOGE(TAG, "gptimer_new_timer failed: %s", esp_err_to_name(err));
             return err;
         }
-        timer_ = reinterpret_cast<void*>(handle);
+
+        gptimer_event_callbacks_t callbacks = {};
+        callbacks.on_alarm = &PWM::AlarmThunk;
+        err = gptimer_register_event_callbacks(handle, &callbacks, this);
+        if (err == ESP_OK) {
+            err = gptimer_enable(handle);
+        }
+        if (err != ESP_OK) {
+            ESP_LOGE(TAG, "gptimer setup failed: %s", esp_err_to_name(err));
+            (void)gptimer_del_timer(handle);
+            return err;
+        }
+        timer_ = handle;
     }
 
-    // Start from OFF, schedule first edge based on off_ms_ (or immediate if off_ms_==0).
-    state_ = State::Off;
+    // The first cycle start runs from the task: it drives the outputs and arms
+    // the next alarm.
+    uint64_t now = 0;
+    esp_err_t err = gptimer_get_raw_count(timer_, &now);
+    if (err != ESP_OK) {
+        return err;
+    }
+    portENTER_CRITICAL(&isr_mux_);
+    phase_ = Phase::CycleStart;
+    cycle_channel_mask_ = 0;
+    std::fill(std::begin(accumulators_q16_), std::end(accumulators_q16_), 0u);
     running_ = true;
-    section_started_us_ = esp_timer_get_time();
-
-    // Invoke OFF callback once at start? Usually you *don't* want that unless forcing state.
-    // So we do not call on_off_ here.
-
-    return ScheduleNextEdge();
+    OnAlarmLocked(now);
+    portEXIT_CRITICAL(&isr_mux_);
+
+    err = gptimer_start(timer_);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "gptimer_start failed: %s", esp_err_to_name(err));
+        portENTER_CRITICAL(&isr_mux_);
+        running_ = false;
+        if (output_ != nullptr) {
+            output_(0, schedule_.channel_mask | cycle_channel_mask_, user_ctx_);
+        }
+        portEXIT_CRITICAL(&isr_mux_);
+        return err;
+    }
+    return ESP_OK;
 }
 
 esp_err_t PWM::Stop()
 {
+    ScopedLock lock(writer_mutex_);
     if (!running_) {
         return ESP_OK;
     }
 
-    CancelTimer();
+    // An alarm already in flight on the other core either finishes before this
+    // section or sees running_ cleared and returns, so this write is the last.
+    portENTER_CRITICAL(&isr_mux_);
     running_ = false;
-    return ESP_OK;
+    if (output_ != nullptr) {
+        output_(0, schedule_.channel_mask | cycle_channel_mask_, user_ctx_);
+    }
+    portEXIT_CRITICAL(&isr_mux_);
+    return gptimer_stop(timer_);
 }
 
 esp_err_t PWM::SetPeriodMs(uint32_t period_ms)
 {
+    ScopedLock lock(writer_mutex_);
     if (period_ms == 0) {
         period_ms = 1;
     }
     period_ms_ = period_ms;
-    RecomputeDurations();
-
-    if (!running_) {
-        return ESP_OK;
-    }
-
-    const int64_t now_us = esp_timer_get_time();
-    const int64_t elapsed_us = std::max<int64_t>(0, now_us - section_started_us_);
-    uint32_t section_ms = (state_ == State::Off) ? off_ms_ : on_ms_;
-    if (section_ms == 0) {
-        section_ms = 1;
-    }
-    const int64_t section_us = static_cast<int64_t>(section_ms) * 1000;
-    int64_t remaining_us = section_us - elapsed_us;
-    if (remaining_us <= 0) {
-        remaining_us = 1000;
-    }
-
-    CancelTimer();
-    return ScheduleDelayUs(remaining_us);
+    PublishSchedule();
+    return ESP_OK;
 }
 
 esp_err_t PWM::SetDutyCycle(float duty_cycle)
 {
+    ScopedLock lock(writer_mutex_);
     duty_cycle_ = std::clamp(duty_cycle, 0.0f, 1.0f);
-    RecomputeDurations();
-
-    if (!running_) {
-        return ESP_OK;
-    }
-
-    const int64_t now_us = esp_timer_get_time();
-    const int64_t elapsed_us = std::max<int64_t>(0, now_us - section_started_us_);
-    uint32_t section_ms = (state_ == State::Off) ? off_ms_ : on_ms_;
-    if (section_ms == 0) {
-        section_ms = 1;
-    }
-    const int64_t section_us = static_cast<int64_t>(section_ms) * 1000;
-    int64_t remaining_us = section_us - elapsed_us;
-    if (remaining_us <= 0) {
-        remaining_us = 1000;
-    }
-
-    CancelTimer();
-    return ScheduleDelayUs(remaining_us);
+    std::fill(std::begin(duty_scales_), std::end(duty_scales_), 1.0f);
+    PublishSchedule();
+    return ESP_OK;
 }
 
-esp_err_t PWM::ForceOn()
+esp_err_t PWM::SetChannelDutyCycles(const float (&duty_cycles)[MAX_CHANNELS])
 {
-    if (state_ != State::On) {
-        state_ = State::On;
-        section_started_us_ = esp_timer_get_time();
-        if (on_on_) {
-            on_on_(user_ctx_);
+    ScopedLock lock(writer_mutex_);
+    float max_duty = 0.0f;
+    for (int i = 0; i < MAX_CHANNELS; ++i) {
+        if ((channel_mask_ & (1u << i)) != 0) {
+            max_duty = std::max(max_duty, std::clamp(duty_cycles[i], 0.0f, 1.0f));
         }
     }
-    if (running_) {
-        CancelTimer();
-        return ScheduleNextEdge();
+    duty_cycle_ = max_duty;
+    for (int i = 0; i < MAX_CHANNELS; ++i) {
+        duty_scales_[i] = max_duty > 0.0f ? std::clamp(duty_cycles[i], 0.0f, 1.0f) / max_duty : 0.0f;
     }
+    PublishSchedule();
     return ESP_OK;
 }
 
-esp_err_t PWM::ForceOff()
+esp_err_t PWM::SetChannelWeights(uint32_t channel_mask, const float (&weights)[MAX_CHANNELS])
 {
-    if (state_ != State::Off) {
-        state_ = State::Off;
-        section_started_us_ = esp_timer_get_time();
-        if (on_off_) {
-            on_off_(user_ctx_);
-        }
-    }
-    if (running_) {
-        CancelTimer();
-        return ScheduleNextEdge();
+    ScopedLock lock(writer_mutex_);
+    channel_mask_ = channel_mask & ((1u << MAX_CHANNELS) - 1u);
+    for (int i = 0; i < MAX_CHANNELS; ++i) {
+        weights_[i] = std::clamp(weights[i], 0.0f, 1.0f);
     }
+    PublishSchedule();
     return ESP_OK;
 }
 
-void PWM::TimerThunk(void* arg)
+esp_err_t PWM::SetMode(Mode mode, uint32_t mains_hz)
 {
-    auto* self = static_cast<PWM*>(arg);
-    self->OnTimer();
+    if (mains_hz != 50 && mains_hz != 60) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    ScopedLock lock(writer_mutex_);
+    mode_ = mode;
+    mains_hz_ = mains_hz;
+    PublishSchedule();
+    return ESP_OK;
 }
 
-void PWM::OnTimer()
+esp_err_t PWM::ForceOff()
 {
-    timer_armed_ = false;
-
-    if (!running_) {
-        return;
+    portENTER_CRITICAL(&isr_mux_);
+    if (output_ != nullptr) {
+        output_(0, schedule_.channel_mask | cycle_channel_mask_, user_ctx_);
     }
+    portEXIT_CRITICAL(&isr_mux_);
+    return ESP_OK;
+}
 
-    // Toggle state
-    if (state_ == State::Off) {
-        state_ = State::On;
-        section_started_us_ = esp_timer_get_time();
-        if (on_on_) {
-            on_on_(user_ctx_);
-        }
-    } else {
-        state_ = State::Off;
-        section_started_us_ = esp_timer_get_time();
-        if (on_off_) {
-            on_off_(user_ctx_);
-        }
+bool PWM::AlarmThunk(gptimer_handle_t timer, const gptimer_alarm_event_data_t* edata, void* user_ctx)
+{
+    (void)timer;
+    auto* self = static_cast<PWM*>(user_ctx);
+    portENTER_CRITICAL_ISR(&self->isr_mux_);
+    if (self->running_) {
+        self->OnAlarmLocked(edata->alarm_value);
     }
-
-    // Schedule next edge
-    (void)ScheduleNextEdge();
+    portEXIT_CRITICAL_ISR(&self->isr_mux_);
+    return false; // No task was woken
 }
 
-void PWM::RecomputeDurations()
+void PWM::OnAlarmLocked(uint64_t alarm_count)
 {
-    // Compute on/off in ms. Ensure they sum to period_ms_ (within rounding).
-    // For very low frequency this is fine.
-    const float p = static_cast<float>(period_ms_);
-    uint32_t on = static_cast<uint32_t>(p * duty_cycle_ + 0.5f);
+    TRACE_SCOPE("PWM::OnAlarm");
+    uint64_t next_alarm = 0;
+    const Schedule& schedule = schedule_;
+
+    if (phase_ == Phase::CycleStart && schedule.mode == Mode::BurstFire) {
+        next_alarm = OnBurstCycleLocked(alarm_count, schedule);
+    } else if (phase_ == Phase::OnEnd) {
+        if (output_ != nullptr) {
+            output_(0, cycle_channel_mask_, user_ctx_);
+        }
+        phase_ = Phase::CycleStart;
+        next_alarm = cycle_start_count_ + cycle_period_us_;
+    } else {
+        uint32_t on_mask = 0;
+        if (schedule.on_us > 0) {
+            on_mask = schedule.full_mask;
+            for (int i = 0; i < MAX_CHANNELS; ++i) {
+                const uint32_t weight = schedule.weights_q16[i];
+                if (weight == 0) {
+                    continue;
+                }
+                accumulators_q16_[i] += weight;
+                if (accumulators_q16_[i] >= WEIGHT_ONE) {
+                    accumulators_q16_[i] -= WEIGHT_ONE;
+                    on_mask |= (1u << i);
+                }
+            }
+        }
 
-    if (on > period_ms_) {
-        on = period_ms_;
-    }
-    uint32_t off = period_ms_ - on;
+        // Channels dropped from the schedule since the last cycle are switched off too.
+        if (output_ != nullptr) {
+            output_(on_mask, schedule.channel_mask | cycle_channel_mask_, user_ctx_);
+        }
 
-    on_ms_ = on;
-    off_ms_ = off;
-}
+        cycle_start_count_ = alarm_count;
+        cycle_period_us_ = schedule.period_us;
+        cycle_channel_mask_ = schedule.channel_mask;
 
-esp_err_t PWM::ScheduleNextEdge()
-{
-    uint32_t delay_ms = (state_ == State::Off) ? off_ms_ : on_ms_;
-
-    // Handle 0ms sections (duty=0 or duty=1). We still need edges:
-    // - duty=0 => on_ms_=0, off_ms_=period; state toggles to ON, then immediately to OFF next tick.
-    // - duty=1 => off_ms_=0, on_ms_=period; similarly.
-    // To avoid a tight loop, force a minimum delay of 1 ms when running.
-    if (delay_ms == 0) {
-        delay_ms = 1;
+        if (on_mask != 0 && schedule.on_us < schedule.period_us) {
+            phase_ = Phase::OnEnd;
+            next_alarm = alarm_count + schedule.on_us;
+        } else {
+            // Fully on or fully off: no edge inside this cycle.
+            next_alarm = alarm_count + schedule.period_us;
+        }
     }
 
-    const int64_t delay_us = static_cast<int64_t>(delay_ms) * 1000;
-
-    return ScheduleDelayUs(delay_us);
+    gptimer_alarm_config_t alarm = {};
+    alarm.alarm_count = next_alarm;
+    (void)gptimer_set_alarm_action(timer_, &alarm);
 }
 
-esp_err_t PWM::ScheduleDelayUs(int64_t delay_us)
+uint64_t PWM::OnBurstCycleLocked(uint64_t alarm_count, const Schedule& schedule)
 {
-    if (timer_ == nullptr) {
-        return ESP_ERR_INVALID_STATE;
-    }
-
-    if (delay_us <= 0) {
-        delay_us = 1000;
+    // Bresenham: each channel fires on the cycles where its running sum of
+    // demand crosses 1.0, which spaces the on cycles as evenly as possible.
+    uint32_t on_mask = 0;
+    for (int i = 0; i < MAX_CHANNELS; ++i) {
+        const uint32_t demand = schedule.demand_q16[i];
+        if (demand == 0) {
+            continue;
+        }
+        accumulators_q16_[i] += demand;
+        if (accumulators_q16_[i] >= WEIGHT_ONE) {
+            accumulators_q16_[i] -= WEIGHT_ONE;
+            on_mask |= (1u << i);
+        }
     }
 
-    esp_timer_handle_t handle = reinterpret_cast<esp_timer_handle_t>(timer_);
-
-    // One-shot timer; we re-arm it after each edge.
-    esp_err_t err = esp_timer_start_once(handle, delay_us);
-    if (err == ESP_ERR_INVALID_STATE) {
-        // Timer might still be armed (rare race). Try stopping and rearming.
-        esp_timer_stop(handle);
-        err = esp_timer_start_once(handle, delay_us);
+    if (output_ != nullptr) {
+        output_(on_mask, schedule.channel_mask | cycle_channel_mask_, user_ctx_);
     }
 
-    if (err == ESP_OK) {
-        timer_armed_ = true;
-    } else {
-        ESP_LOGE(TAG, "esp_timer_start_once failed: %s", esp_err_to_name(err));
-    }
-    return err;
+    cycle_start_count_ = alarm_count;
+    cycle_period_us_ = schedule.mains_cycle_us;
+    cycle_channel_mask_ = schedule.channel_mask;
+    return alarm_count + schedule.mains_cycle_us;
 }
 
-void PWM::CancelTimer()
+void PWM::PublishSchedule()
 {
-    if (timer_ == nullptr) {
-        return;
-    }
-    if (!timer_armed_) {
-        return;
+    Schedule schedule;
+    schedule.mode = mode_;
+    schedule.mains_cycle_us = TIMER_RESOLUTION_HZ / mains_hz_;
+    schedule.period_us = period_ms_ * 1000u;
+    const float on_us = static_cast<float>(schedule.period_us) * duty_cycle_ + 0.5f;
+    schedule.on_us = std::min<uint32_t>(static_cast<uint32_t>(on_us), schedule.period_us);
+    schedule.channel_mask = channel_mask_;
+    schedule.full_mask = 0;
+    for (int i = 0; i < MAX_CHANNELS; ++i) {
+        schedule.weights_q16[i] = 0;
+        schedule.demand_q16[i] = 0;
+        if ((channel_mask_ & (1u << i)) == 0) {
+            continue;
+        }
+        const float weight = weights_[i] * duty_scales_[i];
+        schedule.demand_q16[i] = static_cast<uint32_t>(duty_cycle_ * weight * static_cast<float>(WEIGHT_ONE) + 0.5f);
+        if (weight >= 1.0f) {
+            schedule.full_mask |= (1u << i);
+        } else {
+            schedule.weights_q16[i] = static_cast<uint32_t>(weight * static_cast<float>(WEIGHT_ONE) + 0.5f);
+        }
     }
 
-    esp_timer_handle_t handle = reinterpret_cast<esp_timer_handle_t>(timer_);
-    (void)esp_timer_stop(handle);
-    timer_armed_ = false;
-}
\ No newline at end of file
+    portENTER_CRITICAL(&isr_mux_);
+    schedule_ = schedule;
+    portEXIT_CRITICAL(&isr_mux_);
+}
@@ -0,0 +1,105 @@
+#include "ProcessValueFilter.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+// In-place insertion sort; WINDOW is a handful of values, so this beats
+// nth_element and needs no scratch beyond the caller's array.
+void SortSmall(control_real_t* values, std::size_t count) {
+    for (std::size_t i = 1; i < count; ++i) {
+        const control_real_t key = values[i];
+        std::size_t j = i;
+        while (j > 0 && values[j - 1] > key) {
+            values[j] = values[j - 1];
+            --j;
+        }
+        values[j] = key;
+    }
+}
+
+control_real_t MedianOfSorted(const control_real_t* sorted, std::size_t count) {
+    const std::size_t mid = count / 2;
+    if ((count % 2) != 0) {
+        return sorted[mid];
+    }
+    return (sorted[mid - 1] + sorted[mid]) / control_real_t(2);
+}
+
+constexpr control_real_t MAD_TO_SIGMA = control_real_t(1.4826); // For normally distributed noise
+}
+
+control_real_t ChannelOutlierFilter::Filter(control_real_t reading, bool& outRejected) {
+    outRejected = false;
+    window[next] = reading;
+    next = static_cast<uint8_t>((next + 1) % WINDOW);
+    if (count < WINDOW) {
+        ++count;
+    }
+    if (count < 3) {
+        // No meaningful median yet: pass readings through while the window fills.
+        return reading;
+    }
+
+    control_real_t sorted[WINDOW];
+    std::copy(window, window + count, sorted);
+    SortSmall(sorted, count);
+    const control_real_t median = MedianOfSorted(sorted, count);
+
+    control_real_t deviations[WINDOW];
+    for (std::size_t i = 0; i < count; ++i) {
+        deviations[i] = std::fabs(sorted[i] - median);
+    }
+    SortSmall(deviations, count);
+    const control_real_t mad = MedianOfSorted(deviations, count);
+
+    const control_real_t band = std::max(REJECT_SIGMAS * MAD_TO_SIGMA * mad, MIN_REJECT_BAND_C);
+    if (std::fabs(reading - median) > band) {
+        outRejected = true;
+        return median;
+    }
+    return reading;
+}
+
+void ChannelOutlierFilter::Reset() {
+    count = 0;
+    next = 0;
+}
+
+control_real_t ProcessValueFilter::Update(control_real_t reading,
+                                          control_real_t dtSeconds,
+                                          control_real_t timeConstantS,
+                                          ProcessValueFilterMode mode) {
+    if (!primed) {
+        value = reading;
+        rateCPerS = 0;
+        primed = true;
+        return value;
+    }
+    if (dtSeconds <= control_real_t(0)) {
+        return value;
+    }
+
+    const control_real_t tau = std::max(timeConstantS, control_real_t(0));
+    if (mode == ProcessValueFilterMode::AlphaBeta) {
+        const control_real_t theta = std::exp(-dtSeconds / std::max(tau, control_real_t(1e-6)));
+        const control_real_t alpha = control_real_t(1) - theta * theta;
+        const control_real_t beta = (control_real_t(1) - theta) * (control_real_t(1) - theta);
+        const control_real_t predicted = value + rateCPerS * dtSeconds;
+        const control_real_t residual = reading - predicted;
+        value = predicted + alpha * residual;
+        rateCPerS += beta * residual / dtSeconds;
+        return value;
+    }
+
+    const control_real_t alpha = dtSeconds / (tau + dtSeconds);
+    const control_real_t previous = value;
+    value = alpha * reading + (control_real_t(1) - alpha) * value;
+    rateCPerS = (value - previous) / dtSeconds;
+    return value;
+}
+
+void ProcessValueFilter::Reset() {
+    value = 0;
+    rateCPerS = 0;
+    primed = false;
+}
@@ -1,57 +1,219 @@
 #include "ProfileEngine.hpp"
 
 #include "Controller.hpp"
+#include "ScopedLock.hpp"
+#include "Tracer.hpp"
 #include "cJSON.h"
+#include "esp_log.h"
 #include "nvs.h"
 #include "nvs_flash.h"
 
 #include <algorithm>
 #include <cmath>
 #include <cstdio>
+#include <cstring>
+#include <utility>
 
 namespace {
 constexpr double kMinSetpointC = 0.0;
 constexpr double kMaxSetpointC = 300.0;
 constexpr double kPvToleranceC = 1.0;
 constexpr int kMaxTransitionsPerTick = 256;
+constexpr double kTrajectoryRateWindowS = 10.0; // Feedforward slope is taken over this much of the future profile
 constexpr const char* kNvsPartition = "nvs";
 constexpr const char* kNvsNamespace = "profiles";
+constexpr const char* TAG = "ProfileEngine";
+
+constexpr uint32_t kSlotMagic = 0x464F5250; // "PROF"
+constexpr uint16_t kSlotFormatVersion = 1;
+constexpr int kLegacySlotCount = 5; // JSON slots written before the binary format
+
+// Slot blob layout; only ever read back by the device that wrote it, so
+// fields are stored in native byte order.
+struct StoredProfileHeader {
+    uint32_t magic;
+    uint16_t formatVersion;
+    uint8_t stepCount;
+    uint8_t reserved;
+    int32_t schemaVersion;
+    uint16_t nameBytes;
+    uint16_t descriptionBytes;
+};
+static_assert(sizeof(StoredProfileHeader) == 16, "slot header layout");
+
+constexpr uint8_t kStoredHasWaitTime = 0x01;
+constexpr uint8_t kStoredHasPvTarget = 0x02;
+constexpr uint8_t kStoredGuaranteedSoak = 0x04;
+
+struct StoredProfileStep {
+    uint8_t type;
+    uint8_t flags;
+    uint16_t targetStepNumber;
+    uint32_t repeatCount;
+    double setpointC;
+    double durationS; // wait_time_s, soak_time_s or ramp_time_s
+    double auxValue; // pv_target_c, deviation_c or ramp_rate_c_per_s
+};
+static_assert(sizeof(StoredProfileStep) == 32, "slot step layout");
 
-class ScopedLock {
-public:
-    explicit ScopedLock(SemaphoreHandle_t mutex)
-        : mutex_(mutex), locked_(false) {
-        if (mutex_ != nullptr) {
-            locked_ = (xSemaphoreTake(mutex_, portMAX_DELAY) == pdTRUE);
-        }
+bool BuildSlotKey(int slotIndex, char* outKey, std::size_t keyLen) {
+    if (outKey == nullptr || keyLen < 11 || slotIndex < 0 || slotIndex >= ProfileEngine::MAX_SLOTS) {
+        return false;
     }
+    std::snprintf(outKey, keyLen, "slot%d_bin", slotIndex);
+    return true;
+}
 
-    ~ScopedLock() {
-        if (locked_ && mutex_ != nullptr) {
-            xSemaphoreGive(mutex_);
-        }
+bool BuildLegacySlotBlobKey(int slotIndex, char* outKey, std::size_t keyLen) {
+    if (outKey == nullptr || keyLen < 11 || slotIndex < 0 || slotIndex >= kLegacySlotCount) {
+        return false;
     }
+    std::snprintf(outKey, keyLen, "slot%d_blob", slotIndex);
+    return true;
+}
 
-    bool Locked() const { return locked_; }
+bool BuildLegacySlotNameKey(int slotIndex, char* outKey, std::size_t keyLen) {
+    if (outKey == nullptr || keyLen < 11 || slotIndex < 0 || slotIndex >= kLegacySlotCount) {
+        return false;
+    }
+    std::snprintf(outKey, keyLen, "slot%d_name", slotIndex);
+    return true;
+}
 
-private:
-    SemaphoreHandle_t mutex_;
-    bool locked_;
-};
+void TruncateUtf8(std::string& text, std::size_t maxBytes) {
+    if (text.size() <= maxBytes) {
+        return;
+    }
+    std::size_t length = maxBytes;
+    while (length > 0 && (static_cast<unsigned char>(text[length]) & 0xC0) == 0x80) {
+        --length;
+    }
+    text.resize(length);
+}
 
-bool BuildSlotBlobKey(int slotIndex, char* outKey, std::size_t keyLen) {
-    if (outKey == nullptr || keyLen < 10 || slotIndex < 0 || slotIndex >= ProfileEngine::MAX_SLOTS) {
+std::size_t EncodeSlotBlob(const ProfileDefinition& profile, uint8_t* out, std::size_t capacity) {
+    const std::size_t stepsBytes = profile.steps.size() * sizeof(StoredProfileStep);
+    const std::size_t total = sizeof(StoredProfileHeader) + profile.name.size() + profile.description.size() + stepsBytes;
+    if (total > capacity || profile.steps.size() > UINT8_MAX) {
+        return 0;
+    }
+
+    StoredProfileHeader header = {};
+    header.magic = kSlotMagic;
+    header.formatVersion = kSlotFormatVersion;
+    header.stepCount = static_cast<uint8_t>(profile.steps.size());
+    header.schemaVersion = profile.schemaVersion;
+    header.nameBytes = static_cast<uint16_t>(profile.name.size());
+    header.descriptionBytes = static_cast<uint16_t>(profile.description.size());
+
+    uint8_t* cursor = out;
+    std::memcpy(cursor, &header, sizeof(header));
+    cursor += sizeof(header);
+    std::memcpy(cursor, profile.name.data(), profile.name.size());
+    cursor += profile.name.size();
+    std::memcpy(cursor, profile.description.data(), profile.description.size());
+    cursor += profile.description.size();
+
+    for (const ProfileStep& step : profile.steps) {
+        StoredProfileStep stored = {};
+        stored.type = static_cast<uint8_t>(step.type);
+        stored.setpointC = step.setpointC;
+        switch (step.type) {
+            case ProfileStepType::Direct:
+                break;
+            case ProfileStepType::Wait:
+                stored.flags = (step.hasWaitTime ? kStoredHasWaitTime : 0) | (step.hasPvTarget ? kStoredHasPvTarget : 0);
+                stored.durationS = step.waitTimeS;
+                stored.auxValue = step.pvTargetC;
+                break;
+            case ProfileStepType::Soak:
+                stored.flags = step.guaranteedSoak ? kStoredGuaranteedSoak : 0;
+                stored.durationS = step.soakTimeS;
+                stored.auxValue = step.deviationC;
+                break;
+            case ProfileStepType::RampTime:
+                stored.durationS = step.rampTimeS;
+                break;
+            case ProfileStepType::RampRate:
+                stored.auxValue = step.rampRateCPerS;
+                break;
+            case ProfileStepType::Jump:
+                stored.targetStepNumber = static_cast<uint16_t>(step.targetStepNumber);
+                stored.repeatCount = static_cast<uint32_t>(step.repeatCount);
+                break;
+        }
+        std::memcpy(cursor, &stored, sizeof(stored));
+        cursor += sizeof(stored);
+    }
+    return total;
+}
+
+bool DecodeSlotHeader(const uint8_t* blob, std::size_t blobSize, StoredProfileHeader& outHeader) {
+    if (blobSize < sizeof(StoredProfileHeader)) {
         return false;
     }
-    std::snprintf(outKey, keyLen, "slot%d_blob", slotIndex);
-    return true;
+    std::memcpy(&outHeader, blob, sizeof(outHeader));
+    if (outHeader.magic != kSlotMagic || outHeader.formatVersion != kSlotFormatVersion
+            || outHeader.stepCount > ProfileEngine::MAX_STEPS) {
+        return false;
+    }
+    const std::size_t expected = sizeof(StoredProfileHeader) + outHeader.nameBytes + outHeader.descriptionBytes
+        + outHeader.stepCount * sizeof(StoredProfileStep);
+    return expected == blobSize;
 }
 
-bool BuildSlotNameKey(int slotIndex, char* outKey, std::size_t keyLen) {
-    if (outKey == nullptr || keyLen < 10 || slotIndex < 0 || slotIndex >= ProfileEngine::MAX_SLOTS) {
+bool DecodeSlotBlob(const uint8_t* blob, std::size_t blobSize, ProfileDefinition& outProfile) {
+    StoredProfileHeader header = {};
+    if (!DecodeSlotHeader(blob, blobSize, header)) {
         return false;
     }
-    std::snprintf(outKey, keyLen, "slot%d_name", slotIndex);
+
+    const uint8_t* cursor = blob + sizeof(header);
+    ProfileDefinition profile;
+    profile.schemaVersion = header.schemaVersion;
+    profile.name.assign(reinterpret_cast<const char*>(cursor), header.nameBytes);
+    cursor += header.nameBytes;
+    profile.description.assign(reinterpret_cast<const char*>(cursor), header.descriptionBytes);
+    cursor += header.descriptionBytes;
+
+    profile.steps.resize(header.stepCount);
+    for (ProfileStep& step : profile.steps) {
+        StoredProfileStep stored = {};
+        std::memcpy(&stored, cursor, sizeof(stored));
+        cursor += sizeof(stored);
+        if (stored.type > static_cast<uint8_t>(ProfileStepType::Jump)) {
+            return false;
+        }
+        step.type = static_cast<ProfileStepType>(stored.type);
+        step.setpointC = stored.setpointC;
+        switch (step.type) {
+            case ProfileStepType::Direct:
+                break;
+            case ProfileStepType::Wait:
+                step.hasWaitTime = (stored.flags & kStoredHasWaitTime) != 0;
+                step.hasPvTarget = (stored.flags & kStoredHasPvTarget) != 0;
+                step.waitTimeS = stored.durationS;
+                step.pvTargetC = stored.auxValue;
+                break;
+            case ProfileStepType::Soak:
+                step.guaranteedSoak = (stored.flags & kStoredGuaranteedSoak) != 0;
+                step.soakTimeS = stored.durationS;
+                step.deviationC = stored.auxValue;
+                break;
+            case ProfileStepType::RampTime:
+                step.rampTimeS = stored.durationS;
+                break;
+            case ProfileStepType::RampRate:
+                step.rampRateCPerS = stored.auxValue;
+                break;
+            case ProfileStepType::Jump:
+                step.targetStepNumber = stored.targetStepNumber;
+                step.repeatCount = static_cast<int>(stored.repeatCount);
+                break;
+        }
+    }
+
+    outProfile = std::move(profile);
     return true;
 }
 
@@ -124,6 +286,7 @@ esp_err_t ProfileEngine::Initialize() {
         return ESP_OK;
     }
 
+    MigrateLegacySlotsLocked();
     initialized = true;
     return ESP_OK;
 }
@@ -133,6 +296,11 @@ std::vector<ProfileValidationError> ProfileEngine::ValidateProfile(const Profile
 
     if (profile.name.empty()) {
         AddValidationError(errors, -1, "name", "name is required");
+    } else if (profile.name.size() > MAX_NAME_BYTES) {
+        AddValidationError(errors, -1, "name", "name must be at most 63 bytes");
+    }
+    if (profile.description.size() > MAX_DESCRIPTION_BYTES) {
+        AddValidationError(errors, -1, "description", "description must be at most 255 bytes");
     }
 
     if (profile.steps.empty()) {
@@ -514,46 +682,47 @@ bool ProfileEngine::IsValidSlotIndex(int slotIndex) const {
     return slotIndex >= 0 && slotIndex < MAX_SLOTS;
 }
 
-esp_err_t ProfileEngine::LoadProfileFromSlotLocked(int slotIndex, ProfileDefinition& outProfile) const {
+esp_err_t ProfileEngine::ReadSlotBlobLocked(int slotIndex, std::size_t& outBlobSize) const {
+    outBlobSize = 0;
     if (!IsValidSlotIndex(slotIndex)) {
         return ESP_ERR_INVALID_ARG;
     }
 
+    char slotKey[16] = {};
+    if (!BuildSlotKey(slotIndex, slotKey, sizeof(slotKey))) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
     nvs_handle_t handle = 0;
     esp_err_t err = OpenProfilesNvs(handle);
     if (err != ESP_OK) {
         return err;
     }
 
-    char blobKey[16] = {};
-    if (!BuildSlotBlobKey(slotIndex, blobKey, sizeof(blobKey))) {
-        nvs_close(handle);
-        return ESP_ERR_INVALID_ARG;
+    std::size_t blobSize = slotBlobBuffer.size();
+    err = nvs_get_blob(handle, slotKey, slotBlobBuffer.data(), &blobSize);
+    nvs_close(handle);
+    if (err == ESP_ERR_NVS_NOT_FOUND) {
+        return ESP_ERR_NOT_FOUND;
     }
-
-    std::size_t blobSize = 0;
-    err = nvs_get_blob(handle, blobKey, nullptr, &blobSize);
     if (err != ESP_OK) {
-        nvs_close(handle);
-        if (err == ESP_ERR_NVS_NOT_FOUND) {
-            return ESP_ERR_NOT_FOUND;
-        }
         return err;
     }
 
-    std::string jsonBlob(blobSize, '\0');
-    err = nvs_get_blob(handle, blobKey, jsonBlob.data(), &blobSize);
-    nvs_close(handle);
+    outBlobSize = blobSize;
+    return ESP_OK;
+}
+
+esp_err_t ProfileEngine::LoadProfileFromSlotLocked(int slotIndex, ProfileDefinition& outProfile) const {
+    std::size_t blobSize = 0;
+    const esp_err_t err = ReadSlotBlobLocked(slotIndex, blobSize);
     if (err != ESP_OK) {
         return err;
     }
 
-    std::vector<ProfileValidationError> parseErrors;
-    err = ParseProfileJson(jsonBlob, outProfile, parseErrors);
-    if (err != ESP_OK) {
+    if (!DecodeSlotBlob(slotBlobBuffer.data(), blobSize, outProfile)) {
         return ESP_FAIL;
     }
-
     return ESP_OK;
 }
 
@@ -562,22 +731,19 @@ esp_err_t ProfileEngine::SaveProfileToSlotLocked(int slotIndex, const ProfileDef
         return ESP_ERR_INVALID_ARG;
     }
 
+    char slotKey[16] = {};
+    if (!BuildSlotKey(slotIndex, slotKey, sizeof(slotKey))) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
     nvs_handle_t handle = 0;
     esp_err_t err = OpenProfilesNvs(handle);
     if (err != ESP_OK) {
         return err;
     }
 
-    char blobKey[16] = {};
-    char nameKey[16] = {};
-    if (!BuildSlotBlobKey(slotIndex, blobKey, sizeof(blobKey)) ||
-        !BuildSlotNameKey(slotIndex, nameKey, sizeof(nameKey))) {
-        nvs_close(handle);
-        return ESP_ERR_INVALID_ARG;
-    }
-
     std::size_t existingSize = 0;
-    err = nvs_get_blob(handle, blobKey, nullptr, &existingSize);
+    err = nvs_get_blob(handle, slotKey, nullptr, &existingSize);
     if (err == ESP_OK) {
         nvs_close(handle);
         return ESP_ERR_INVALID_STATE;
@@ -587,21 +753,27 @@ esp_err_t ProfileEngine::SaveProfileToSlotLocked(int slotIndex, const ProfileDef
         return err;
     }
 
-    const std::string jsonBlob = SerializeProfileJson(profile);
-    if (jsonBlob.empty()) {
+    const std::size_t blobSize = EncodeSlotBlob(profile, slotBlobBuffer.data(), slotBlobBuffer.size());
+    if (blobSize == 0) {
         nvs_close(handle);
-        return ESP_FAIL;
+        return ESP_ERR_INVALID_SIZE;
     }
 
-    err = nvs_set_blob(handle, blobKey, jsonBlob.data(), jsonBlob.size());
-    if (err == ESP_OK) {
-        err = nvs_set_str(handle, nameKey, profile.name.c_str());
-    }
+    err = nvs_set_blob(handle, slotKey, slotBlobBuffer.data(), blobSize);
     if (err == ESP_OK) {
         err = nvs_commit(handle);
     }
-
     nvs_close(handle);
+    if (err == ESP_ERR_NVS_NOT_ENOUGH_SPACE) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    if (err == ESP_OK && slotSummariesValid) {
+        ProfileSlotSummary& summary = slotSummaries[static_cast<std::size_t>(slotIndex)];
+        summary.occupied = true;
+        summary.name = profile.name;
+        summary.stepCount = profile.steps.size();
+    }
     return err;
 }
 
@@ -610,27 +782,18 @@ esp_err_t ProfileEngine::DeleteSlotLocked(int slotIndex) {
         return ESP_ERR_INVALID_ARG;
     }
 
-    nvs_handle_t handle = 0;
-    esp_err_t err = OpenProfilesNvs(handle);
-    if (err != ESP_OK) {
-        return err;
-    }
-
-    char blobKey[16] = {};
-    char nameKey[16] = {};
-    if (!BuildSlotBlobKey(slotIndex, blobKey, sizeof(blobKey)) ||
-        !BuildSlotNameKey(slotIndex, nameKey, sizeof(nameKey))) {
-        nvs_close(handle);
+    char slotKey[16] = {};
+    if (!BuildSlotKey(slotIndex, slotKey, sizeof(slotKey))) {
         return ESP_ERR_INVALID_ARG;
     }
 
-    err = nvs_erase_key(handle, blobKey);
-    if (err != ESP_OK && err != ESP_ERR_NVS_NOT_FOUND) {
-        nvs_close(handle);
+    nvs_handle_t handle = 0;
+    esp_err_t err = OpenProfilesNvs(handle);
+    if (err != ESP_OK) {
         return err;
     }
 
-    err = nvs_erase_key(handle, nameKey);
+    err = nvs_erase_key(handle, slotKey);
     if (err != ESP_OK && err != ESP_ERR_NVS_NOT_FOUND) {
         nvs_close(handle);
         return err;
@@ -638,30 +801,112 @@ esp_err_t ProfileEngine::DeleteSlotLocked(int slotIndex) {
 
     err = nvs_commit(handle);
     nvs_close(handle);
+
+    if (err == ESP_OK && slotSummariesValid) {
+        ProfileSlotSummary& summary = slotSummaries[static_cast<std::size_t>(slotIndex)];
+        summary.occupied = false;
+        summary.name.clear();
+        summary.stepCount = 0;
+    }
     return err;
 }
 
-std::array<ProfileSlotSummary, ProfileEngine::MAX_SLOTS> ProfileEngine::GetSlotSummaries() const {
-    std::array<ProfileSlotSummary, MAX_SLOTS> out{};
-
-    ScopedLock lock(stateMutex);
-    if (!lock.Locked()) {
-        return out;
+void ProfileEngine::EnsureSlotSummariesLocked() const {
+    if (slotSummariesValid) {
+        return;
     }
 
     for (int slot = 0; slot < MAX_SLOTS; ++slot) {
-        out[static_cast<std::size_t>(slot)].slotIndex = slot;
+        ProfileSlotSummary& summary = slotSummaries[static_cast<std::size_t>(slot)];
+        summary = ProfileSlotSummary{};
+        summary.slotIndex = slot;
+
+        std::size_t blobSize = 0;
+        StoredProfileHeader header = {};
+        if (ReadSlotBlobLocked(slot, blobSize) != ESP_OK || !DecodeSlotHeader(slotBlobBuffer.data(), blobSize, header)) {
+            continue;
+        }
+        summary.occupied = true;
+        summary.name.assign(reinterpret_cast<const char*>(slotBlobBuffer.data() + sizeof(header)), header.nameBytes);
+        summary.stepCount = header.stepCount;
+    }
+    slotSummariesValid = true;
+}
+
+void ProfileEngine::MigrateLegacySlotsLocked() {
+    nvs_handle_t handle = 0;
+    if (OpenProfilesNvs(handle) != ESP_OK) {
+        return;
+    }
+
+    for (int slot = 0; slot < kLegacySlotCount; ++slot) {
+        char blobKey[16] = {};
+        char nameKey[16] = {};
+        if (!BuildLegacySlotBlobKey(slot, blobKey, sizeof(blobKey)) || !BuildLegacySlotNameKey(slot, nameKey, sizeof(nameKey))) {
+            continue;
+        }
+
+        std::size_t jsonSize = 0;
+        if (nvs_get_blob(handle, blobKey, nullptr, &jsonSize) != ESP_OK) {
+            continue;
+        }
+        std::string jsonBlob(jsonSize, '\0');
+        if (nvs_get_blob(handle, blobKey, jsonBlob.data(), &jsonSize) != ESP_OK) {
+            continue;
+        }
+
+        // Older profiles had no length limits on the text fields.
+        cJSON* root = cJSON_Parse(jsonBlob.c_str());
+        for (const auto& [field, maxBytes] : {std::make_pair("name", MAX_NAME_BYTES), std::make_pair("description", MAX_DESCRIPTION_BYTES)}) {
+            cJSON* item = cJSON_GetObjectItem(root, field);
+            if (cJSON_IsString(item) && item->valuestring != nullptr) {
+                std::string text = item->valuestring;
+                TruncateUtf8(text, maxBytes);
+                cJSON_ReplaceItemInObject(root, field, cJSON_CreateString(text.c_str()));
+            }
+        }
+        char* printed = (root != nullptr) ? cJSON_PrintUnformatted(root) : nullptr;
+        cJSON_Delete(root);
+        if (printed != nullptr) {
+            jsonBlob = printed;
+            cJSON_free(printed);
+        }
 
         ProfileDefinition profile;
-        const esp_err_t err = LoadProfileFromSlotLocked(slot, profile);
-        if (err == ESP_OK) {
-            out[static_cast<std::size_t>(slot)].occupied = true;
-            out[static_cast<std::size_t>(slot)].name = profile.name;
-            out[static_cast<std::size_t>(slot)].stepCount = profile.steps.size();
+        std::vector<ProfileValidationError> parseErrors;
+        const esp_err_t parseErr = ParseProfileJson(jsonBlob, profile, parseErrors);
+        if (parseErr != ESP_OK) {
+            // Never destroy what cannot be converted; the raw blob stays for a
+            // later firmware or a manual export.
+            ESP_LOGW(TAG, "Keeping unreadable legacy profile in slot %d", slot);
+            continue;
         }
+        // ESP_ERR_INVALID_STATE: the slot already holds this profile from a boot
+        // that was cut off before the legacy keys were erased.
+        const esp_err_t saveErr = SaveProfileToSlotLocked(slot, profile);
+        if (saveErr != ESP_OK && saveErr != ESP_ERR_INVALID_STATE) {
+            ESP_LOGW(TAG, "Keeping legacy profile in slot %d: %s", slot, esp_err_to_name(saveErr));
+            continue;
+        }
+
+        (void)nvs_erase_key(handle, blobKey);
+        (void)nvs_erase_key(handle, nameKey);
+        (void)nvs_commit(handle);
     }
 
-    return out;
+    nvs_close(handle);
+}
+
+std::array<ProfileSlotSummary, ProfileEngine::MAX_SLOTS> ProfileEngine::GetSlotSummaries() const {
+    std::array<ProfileSlotSummary, MAX_SLOTS> out{};
+
+    ScopedLock lock(stateMutex);
+    if (!lock.Locked()) {
+        return out;
+    }
+
+    EnsureSlotSummariesLocked();
+    return slotSummaries;
 }
 
 esp_err_t ProfileEngine::GetSlotProfile(int slotIndex, ProfileDefinition& outProfile) const {
@@ -696,157 +941,249 @@ esp_err_t ProfileEngine::DeleteSlotProfile(int slotIndex) {
     return DeleteSlotLocked(slotIndex);
 }
 
-bool ProfileEngine::EnterStepLocked(int stepIndex) {
-    if (stepIndex < 0 || stepIndex >= static_cast<int>(activeProfile.steps.size())) {
-        return false;
+void ProfileEngine::CompilePlan(const ProfileDefinition& profile, Plan& outPlan) {
+    outPlan = Plan{};
+
+    // Cut on a UTF-8 boundary so a truncated name still renders.
+    std::size_t nameLen = std::min(profile.name.size(), sizeof(outPlan.name) - 1);
+    while (nameLen > 0 && nameLen < profile.name.size()
+            && (static_cast<unsigned char>(profile.name[nameLen]) & 0xC0) == 0x80) {
+        --nameLen;
     }
+    std::memcpy(outPlan.name, profile.name.data(), nameLen);
 
-    currentStepIndex = stepIndex;
-    currentStepElapsedS = 0.0;
-    waitTimeLatched = false;
-    waitPvLatched = false;
-    soakAccumulatedS = 0.0;
-    currentStepStartSetpointC = Controller::getInstance().GetSetPoint();
-    return true;
-}
+    outPlan.stepCount = static_cast<int>(std::min(profile.steps.size(), static_cast<std::size_t>(MAX_STEPS)));
+    for (int idx = 0; idx < outPlan.stepCount; ++idx) {
+        const ProfileStep& step = profile.steps[static_cast<std::size_t>(idx)];
+        PlanStep& planStep = outPlan.steps[static_cast<std::size_t>(idx)];
+        planStep.type = step.type;
+        planStep.targetC = step.setpointC;
+        switch (step.type) {
+            case ProfileStepType::Direct:
+                planStep.op = PlanOp::SetPoint;
+                break;
 
-void ProfileEngine::ResetJumpCountersInRangeLocked(int startStepInclusive, int endStepExclusive) {
-    const int start = std::max(0, startStepInclusive);
-    const int end = std::min(static_cast<int>(activeProfile.steps.size()), endStepExclusive);
-    for (int idx = start; idx < end; ++idx) {
-        const ProfileStep& step = activeProfile.steps[static_cast<std::size_t>(idx)];
-        if (step.type == ProfileStepType::Jump) {
-            jumpRemainingByStep[idx] = step.repeatCount;
+            case ProfileStepType::Wait:
+                planStep.op = PlanOp::Wait;
+                planStep.hasWaitTime = step.hasWaitTime;
+                planStep.hasPvTarget = step.hasPvTarget;
+                planStep.durationS = step.waitTimeS;
+                planStep.targetC = step.pvTargetC;
+                break;
+
+            case ProfileStepType::Soak:
+                planStep.op = step.guaranteedSoak ? PlanOp::GuaranteedSoak : PlanOp::Soak;
+                planStep.durationS = step.soakTimeS;
+                planStep.deviationC = step.deviationC;
+                break;
+
+            case ProfileStepType::RampTime:
+                planStep.op = PlanOp::RampTime;
+                planStep.durationS = std::max(0.001, step.rampTimeS);
+                break;
+
+            case ProfileStepType::RampRate:
+                planStep.op = PlanOp::RampRate;
+                planStep.rampRateCPerS = std::max(step.rampRateCPerS, 0.001);
+                break;
+
+            case ProfileStepType::Jump:
+                planStep.op = PlanOp::Jump;
+                planStep.jumpTargetIndex = step.targetStepNumber - 1;
+                planStep.repeatCount = step.repeatCount;
+                break;
         }
     }
 }
 
-bool ProfileEngine::ExecuteCurrentStepLocked(double dtSeconds, int& transitionsTaken) {
-    if (currentStepIndex < 0 || currentStepIndex >= static_cast<int>(activeProfile.steps.size())) {
-        return false;
+void ProfileEngine::BeginPlan(const Plan& plan, PlanCursor& cursor, double setpointC) {
+    cursor = PlanCursor{};
+    ResetJumpCounters(plan, cursor, 0, plan.stepCount);
+    if (plan.stepCount > 0) {
+        EnterStep(plan, cursor, 0, setpointC);
     }
+}
 
-    ProfileStep& step = activeProfile.steps[static_cast<std::size_t>(currentStepIndex)];
+void ProfileEngine::EnterStep(const Plan& plan, PlanCursor& cursor, int stepIndex, double setpointC) {
+    cursor.stepIndex = stepIndex;
+    cursor.stepElapsedS = 0.0;
+    cursor.waitTimeLatched = false;
+    cursor.waitPvLatched = false;
+    cursor.soakAccumulatedS = 0.0;
+    cursor.stepStartSetpointC = setpointC;
+
+    // Ramps are fixed at entry; a rate ramp's length depends on where it starts.
+    const PlanStep& step = plan.steps[static_cast<std::size_t>(stepIndex)];
+    const double delta = step.targetC - setpointC;
+    cursor.stepDurationS = 0.0;
+    cursor.stepSlopeCPerS = 0.0;
+    if (step.op == PlanOp::RampTime) {
+        cursor.stepDurationS = step.durationS;
+        cursor.stepSlopeCPerS = delta / cursor.stepDurationS;
+    } else if (step.op == PlanOp::RampRate) {
+        cursor.stepDurationS = std::max(std::abs(delta) / step.rampRateCPerS, 0.001);
+        cursor.stepSlopeCPerS = delta / cursor.stepDurationS;
+    }
+}
 
-    currentStepElapsedS += std::max(0.0, dtSeconds);
-    currentProfileElapsedS += std::max(0.0, dtSeconds);
+void ProfileEngine::ResetJumpCounters(const Plan& plan, PlanCursor& cursor, int startStepInclusive, int endStepExclusive) {
+    const int start = std::max(0, startStepInclusive);
+    const int end = std::min(plan.stepCount, endStepExclusive);
+    for (int idx = start; idx < end; ++idx) {
+        const PlanStep& step = plan.steps[static_cast<std::size_t>(idx)];
+        if (step.op == PlanOp::Jump) {
+            cursor.jumpRemaining[static_cast<std::size_t>(idx)] = step.repeatCount;
+        }
+    }
+}
 
-    bool advance = false;
-    int nextStepIndex = currentStepIndex + 1;
+bool ProfileEngine::ExecuteStep(const Plan& plan, PlanCursor& cursor, double dtSeconds, double processValueC, double& setpointC, int& nextStepIndex) {
+    const PlanStep& step = plan.steps[static_cast<std::size_t>(cursor.stepIndex)];
+    cursor.stepElapsedS += dtSeconds;
+    nextStepIndex = cursor.stepIndex + 1;
 
-    switch (step.type) {
-        case ProfileStepType::Direct: {
-            (void)Controller::getInstance().SetSetPointFromProfile(step.setpointC);
-            advance = true;
-            break;
-        }
+    switch (step.op) {
+        case PlanOp::SetPoint:
+            setpointC = step.targetC;
+            return true;
 
-        case ProfileStepType::Wait: {
-            if (step.hasWaitTime && !waitTimeLatched && currentStepElapsedS >= step.waitTimeS) {
-                waitTimeLatched = true;
+        case PlanOp::Wait: {
+            if (step.hasWaitTime && !cursor.waitTimeLatched && cursor.stepElapsedS >= step.durationS) {
+                cursor.waitTimeLatched = true;
             }
-            if (step.hasPvTarget && !waitPvLatched) {
-                const double pv = Controller::getInstance().GetProcessValue();
-                if (std::abs(pv - step.pvTargetC) <= kPvToleranceC) {
-                    waitPvLatched = true;
-                }
+            if (step.hasPvTarget && !cursor.waitPvLatched && std::abs(processValueC - step.targetC) <= kPvToleranceC) {
+                cursor.waitPvLatched = true;
             }
 
-            const bool timeSatisfied = (!step.hasWaitTime) || waitTimeLatched;
-            const bool pvSatisfied = (!step.hasPvTarget) || waitPvLatched;
-            advance = timeSatisfied && pvSatisfied;
-            break;
+            const bool timeSatisfied = (!step.hasWaitTime) || cursor.waitTimeLatched;
+            const bool pvSatisfied = (!step.hasPvTarget) || cursor.waitPvLatched;
+            return timeSatisfied && pvSatisfied;
         }
 
-        case ProfileStepType::Soak: {
-            (void)Controller::getInstance().SetSetPointFromProfile(step.setpointC);
-            if (!step.guaranteedSoak) {
-                soakAccumulatedS += std::max(0.0, dtSeconds);
-            } else {
-                const double pv = Controller::getInstance().GetProcessValue();
-                if (std::abs(pv - step.setpointC) <= step.deviationC) {
-                    soakAccumulatedS += std::max(0.0, dtSeconds);
-                }
-            }
-            advance = soakAccumulatedS >= step.soakTimeS;
-            break;
-        }
+        case PlanOp::Soak:
+            setpointC = step.targetC;
+            cursor.soakAccumulatedS += dtSeconds;
+            return cursor.soakAccumulatedS >= step.durationS;
 
-        case ProfileStepType::RampTime: {
-            const double duration = std::max(0.001, step.rampTimeS);
-            const double progress = std::clamp(currentStepElapsedS / duration, 0.0, 1.0);
-            const double setpoint = currentStepStartSetpointC + (step.setpointC - currentStepStartSetpointC) * progress;
-            (void)Controller::getInstance().SetSetPointFromProfile(setpoint);
-            advance = currentStepElapsedS >= duration;
-            break;
-        }
+        case PlanOp::GuaranteedSoak:
+            setpointC = step.targetC;
+            if (std::abs(processValueC - step.targetC) <= step.deviationC) {
+                cursor.soakAccumulatedS += dtSeconds;
+            }
+            return cursor.soakAccumulatedS >= step.durationS;
 
-        case ProfileStepType::RampRate: {
-            const double delta = step.setpointC - currentStepStartSetpointC;
-            const double duration = std::max(std::abs(delta) / std::max(step.rampRateCPerS, 0.001), 0.001);
-            const double progress = std::clamp(currentStepElapsedS / duration, 0.0, 1.0);
-            const double setpoint = currentStepStartSetpointC + delta * progress;
-            (void)Controller::getInstance().SetSetPointFromProfile(setpoint);
-            advance = currentStepElapsedS >= duration;
-            break;
-        }
+        case PlanOp::RampTime:
+        case PlanOp::RampRate:
+            setpointC = cursor.stepStartSetpointC + cursor.stepSlopeCPerS * std::min(cursor.stepElapsedS, cursor.stepDurationS);
+            return cursor.stepElapsedS >= cursor.stepDurationS;
 
-        case ProfileStepType::Jump: {
-            int& remaining = jumpRemainingByStep[currentStepIndex];
+        case PlanOp::Jump: {
+            int& remaining = cursor.jumpRemaining[static_cast<std::size_t>(cursor.stepIndex)];
             if (remaining > 0) {
                 remaining -= 1;
-                nextStepIndex = step.targetStepNumber - 1;
-                ResetJumpCountersInRangeLocked(nextStepIndex, currentStepIndex);
-                advance = true;
+                nextStepIndex = step.jumpTargetIndex;
+                ResetJumpCounters(plan, cursor, nextStepIndex, cursor.stepIndex);
             } else {
                 // Reset for potential outer-loop re-entry.
                 remaining = step.repeatCount;
-                advance = true;
             }
-            break;
+            return true;
         }
     }
+    return false;
+}
 
-    if (!advance) {
-        return true;
+ProfileEngine::PlanTickResult ProfileEngine::AdvancePlan(const Plan& plan, PlanCursor& cursor, double dtSeconds, double processValueC, double& setpointC) {
+    if (cursor.stepIndex < 0 || cursor.stepIndex >= plan.stepCount) {
+        return PlanTickResult::InvalidStep;
     }
 
-    transitionsTaken += 1;
-    if (transitionsTaken > kMaxTransitionsPerTick) {
-        EndRunLocked(ProfileEndReason::TransitionGuard, true);
-        return false;
+    double stepDtS = std::max(0.0, dtSeconds);
+    cursor.profileElapsedS += stepDtS;
+
+    // Continue evaluating immediate transitions this tick.
+    for (int transitionsTaken = 1;; ++transitionsTaken) {
+        int nextStepIndex = 0;
+        if (!ExecuteStep(plan, cursor, stepDtS, processValueC, setpointC, nextStepIndex)) {
+            return PlanTickResult::Running;
+        }
+        stepDtS = 0.0;
+
+        if (transitionsTaken > kMaxTransitionsPerTick) {
+            return PlanTickResult::TransitionGuard;
+        }
+        if (nextStepIndex >= plan.stepCount) {
+            return PlanTickResult::Completed;
+        }
+        if (nextStepIndex < 0) {
+            return PlanTickResult::InvalidStep;
+        }
+        EnterStep(plan, cursor, nextStepIndex, setpointC);
     }
+}
 
-    if (nextStepIndex >= static_cast<int>(activeProfile.steps.size())) {
-        EndRunLocked(ProfileEndReason::Completed, true);
-        return false;
+esp_err_t ProfileEngine::StartPlanLocked(const ProfileDefinition& profile, ProfileSource source, int slotIndex) {
+    const std::vector<ProfileValidationError> errors = ValidateProfile(profile);
+    if (!errors.empty()) {
+        lastEndReason = ProfileEndReason::InvalidProfile;
+        return ESP_ERR_INVALID_ARG;
     }
 
-    if (!EnterStepLocked(nextStepIndex)) {
-        EndRunLocked(ProfileEndReason::InvalidProfile, true);
-        return false;
+    Controller& controller = Controller::getInstance();
+    CompilePlan(profile, activePlan);
+    activeSource = source;
+    activeSlotIndex = slotIndex;
+    BeginPlan(activePlan, cursor, controller.GetSetPoint());
+
+    running = true;
+    lastEndReason = ProfileEndReason::None;
+    controller.SetProfileSetpointLock(true);
+
+    if (!controller.IsRunning()) {
+        const esp_err_t startErr = controller.Start();
+        if (startErr != ESP_OK) {
+            EndRunLocked(ProfileEndReason::StartFailed, false);
+            return startErr;
+        }
     }
 
-    // Continue evaluating immediate transitions this tick.
-    return true;
+    const double previousSetpointC = controller.GetSetPoint();
+    double setpointC = previousSetpointC;
+    const PlanTickResult result = AdvancePlan(activePlan, cursor, 0.0, controller.GetProcessValue(), setpointC);
+    ApplyPlanTickLocked(result, previousSetpointC, setpointC);
+    return ESP_OK;
+}
+
+void ProfileEngine::ApplyPlanTickLocked(PlanTickResult result, double previousSetpointC, double setpointC) {
+    if (setpointC != previousSetpointC) {
+        (void)Controller::getInstance().SetSetPointFromProfile(setpointC);
+    }
+
+    switch (result) {
+        case PlanTickResult::Running:
+            break;
+        case PlanTickResult::Completed:
+            EndRunLocked(ProfileEndReason::Completed, true);
+            break;
+        case PlanTickResult::TransitionGuard:
+            EndRunLocked(ProfileEndReason::TransitionGuard, true);
+            break;
+        case PlanTickResult::InvalidStep:
+            EndRunLocked(ProfileEndReason::InvalidProfile, true);
+            break;
+    }
 }
 
 void ProfileEngine::EndRunLocked(ProfileEndReason reason, bool stopChamber) {
     const bool wasRunning = running;
     running = false;
-    lastEndReason = EndReasonToString(reason);
+    lastEndReason = reason;
 
-    activeProfile = ProfileDefinition{};
-    activeSource = "none";
+    activePlan.stepCount = 0;
+    activePlan.name[0] = '\0';
+    activeSource = ProfileSource::None;
     activeSlotIndex = -1;
-    currentStepIndex = 0;
-    currentStepElapsedS = 0.0;
-    currentProfileElapsedS = 0.0;
-    currentStepStartSetpointC = 0.0;
-    waitTimeLatched = false;
-    waitPvLatched = false;
-    soakAccumulatedS = 0.0;
-    jumpRemainingByStep.clear();
+    cursor = PlanCursor{};
 
     Controller::getInstance().SetProfileSetpointLock(false);
 
@@ -869,51 +1206,7 @@ esp_err_t ProfileEngine::StartFromUploaded() {
         return ESP_ERR_NOT_FOUND;
     }
 
-    const std::vector<ProfileValidationError> errors = ValidateProfile(uploadedProfile);
-    if (!errors.empty()) {
-        lastEndReason = EndReasonToString(ProfileEndReason::InvalidProfile);
-        return ESP_ERR_INVALID_ARG;
-    }
-
-    activeProfile = uploadedProfile;
-    activeSource = "uploaded";
-    activeSlotIndex = -1;
-
-    jumpRemainingByStep.clear();
-    for (int idx = 0; idx < static_cast<int>(activeProfile.steps.size()); ++idx) {
-        const ProfileStep& step = activeProfile.steps[static_cast<std::size_t>(idx)];
-        if (step.type == ProfileStepType::Jump) {
-            jumpRemainingByStep[idx] = step.repeatCount;
-        }
-    }
-
-    running = true;
-    lastEndReason = EndReasonToString(ProfileEndReason::None);
-    currentProfileElapsedS = 0.0;
-    EnterStepLocked(0);
-    Controller::getInstance().SetProfileSetpointLock(true);
-
-    if (!Controller::getInstance().IsRunning()) {
-        const esp_err_t startErr = Controller::getInstance().Start();
-        if (startErr != ESP_OK) {
-            EndRunLocked(ProfileEndReason::StartFailed, false);
-            return startErr;
-        }
-    }
-
-    int transitionsTaken = 0;
-    while (running) {
-        const int beforeStep = currentStepIndex;
-        const bool keepRunning = ExecuteCurrentStepLocked(0.0, transitionsTaken);
-        if (!keepRunning) {
-            break;
-        }
-        if (currentStepIndex == beforeStep) {
-            break;
-        }
-    }
-
-    return ESP_OK;
+    return StartPlanLocked(uploadedProfile, ProfileSource::Uploaded, -1);
 }
 
 esp_err_t ProfileEngine::StartFromSlot(int slotIndex) {
@@ -927,56 +1220,12 @@ esp_err_t ProfileEngine::StartFromSlot(int slotIndex) {
     }
 
     ProfileDefinition slotProfile;
-    esp_err_t err = LoadProfileFromSlotLocked(slotIndex, slotProfile);
+    const esp_err_t err = LoadProfileFromSlotLocked(slotIndex, slotProfile);
     if (err != ESP_OK) {
         return err;
     }
 
-    const std::vector<ProfileValidationError> errors = ValidateProfile(slotProfile);
-    if (!errors.empty()) {
-        lastEndReason = EndReasonToString(ProfileEndReason::InvalidProfile);
-        return ESP_ERR_INVALID_ARG;
-    }
-
-    activeProfile = slotProfile;
-    activeSource = "slot";
-    activeSlotIndex = slotIndex;
-
-    jumpRemainingByStep.clear();
-    for (int idx = 0; idx < static_cast<int>(activeProfile.steps.size()); ++idx) {
-        const ProfileStep& step = activeProfile.steps[static_cast<std::size_t>(idx)];
-        if (step.type == ProfileStepType::Jump) {
-            jumpRemainingByStep[idx] = step.repeatCount;
-        }
-    }
-
-    running = true;
-    lastEndReason = EndReasonToString(ProfileEndReason::None);
-    currentProfileElapsedS = 0.0;
-    EnterStepLocked(0);
-    Controller::getInstance().SetProfileSetpointLock(true);
-
-    if (!Controller::getInstance().IsRunning()) {
-        err = Controller::getInstance().Start();
-        if (err != ESP_OK) {
-            EndRunLocked(ProfileEndReason::StartFailed, false);
-            return err;
-        }
-    }
-
-    int transitionsTaken = 0;
-    while (running) {
-        const int beforeStep = currentStepIndex;
-        const bool keepRunning = ExecuteCurrentStepLocked(0.0, transitionsTaken);
-        if (!keepRunning) {
-            break;
-        }
-        if (currentStepIndex == beforeStep) {
-            break;
-        }
-    }
-
-    return ESP_OK;
+    return StartPlanLocked(slotProfile, ProfileSource::Slot, slotIndex);
 }
 
 esp_err_t ProfileEngine::CancelRunning(ProfileEndReason reason) {
@@ -994,28 +1243,147 @@ esp_err_t ProfileEngine::CancelRunning(ProfileEndReason reason) {
 }
 
 void ProfileEngine::Tick(double dtSeconds) {
+    TRACE_SCOPE("ProfileEngine::Tick");
     ScopedLock lock(stateMutex);
     if (!lock.Locked() || !running) {
         return;
     }
 
-    if (!Controller::getInstance().IsRunning()) {
+    Controller& controller = Controller::getInstance();
+    if (!controller.IsRunning()) {
         EndRunLocked(ProfileEndReason::ControllerStopped, false);
         return;
     }
 
-    int transitionsTaken = 0;
-    while (running) {
-        const int beforeStep = currentStepIndex;
-        const bool keepRunning = ExecuteCurrentStepLocked(dtSeconds, transitionsTaken);
-        dtSeconds = 0.0;
-        if (!keepRunning) {
-            break;
+    const double previousSetpointC = controller.GetSetPoint();
+    double setpointC = previousSetpointC;
+    const PlanTickResult result = AdvancePlan(activePlan, cursor, dtSeconds, controller.GetProcessValue(), setpointC);
+    ApplyPlanTickLocked(result, previousSetpointC, setpointC);
+
+    if (running) {
+        PublishTrajectoryLocked();
+    }
+}
+
+void ProfileEngine::PublishTrajectoryLocked() {
+    Controller& controller = Controller::getInstance();
+    if (!controller.IsFeedforwardEnabled()) {
+        return;
+    }
+
+    double aheadC = 0.0;
+    double rateCPerS = 0.0;
+    if (PredictTrajectory(activePlan, cursor, controller.GetSetPoint(), controller.GetFeedforwardLookaheadS(), aheadC, rateCPerS)) {
+        controller.SetProfileTrajectory(aheadC, rateCPerS);
+    }
+}
+
+bool ProfileEngine::PredictTrajectory(const Plan& plan, const PlanCursor& cursor, double setpointC, double lookaheadS,
+                                      double& outSetpointAheadC, double& outRateCPerS) {
+    double furtherC = 0.0;
+    if (!PredictSetpoint(plan, cursor, setpointC, lookaheadS, outSetpointAheadC)
+            || !PredictSetpoint(plan, cursor, setpointC, lookaheadS + kTrajectoryRateWindowS, furtherC)) {
+        return false;
+    }
+    outRateCPerS = (furtherC - outSetpointAheadC) / kTrajectoryRateWindowS;
+    return true;
+}
+
+bool ProfileEngine::PredictSetpoint(const Plan& plan, const PlanCursor& cursor, double setpointC, double horizonS, double& outSetpointC) {
+    const int stepCount = plan.stepCount;
+    if (cursor.stepIndex < 0 || cursor.stepIndex >= stepCount) {
+        return false;
+    }
+
+    // Simulated copy of the runtime state; jump counters are copied so loops unroll as they will run.
+    std::array<int, MAX_STEPS> jumpRemaining = cursor.jumpRemaining;
+    int stepIndex = cursor.stepIndex;
+    double stepElapsedS = cursor.stepElapsedS;
+    double soakDoneS = cursor.soakAccumulatedS;
+    double stepStartC = cursor.stepStartSetpointC;
+    double rampDurationS = cursor.stepDurationS;
+    double rampSlopeCPerS = cursor.stepSlopeCPerS;
+    double remainingS = std::max(0.0, horizonS);
+
+    for (int transitions = 0; transitions <= kMaxTransitionsPerTick; ++transitions) {
+        const PlanStep& step = plan.steps[static_cast<std::size_t>(stepIndex)];
+        int nextStepIndex = stepIndex + 1;
+        double stepLeftS = 0.0;
+        bool instant = false;
+
+        switch (step.op) {
+            case PlanOp::SetPoint:
+                setpointC = step.targetC;
+                instant = true;
+                break;
+
+            case PlanOp::Wait:
+                if (step.hasPvTarget) {
+                    outSetpointC = setpointC;
+                    return true;
+                }
+                stepLeftS = step.durationS - stepElapsedS;
+                break;
+
+            case PlanOp::Soak:
+            case PlanOp::GuaranteedSoak:
+                setpointC = step.targetC;
+                stepLeftS = step.durationS - soakDoneS;
+                break;
+
+            case PlanOp::RampTime:
+            case PlanOp::RampRate:
+                setpointC = stepStartC + rampSlopeCPerS * std::min(stepElapsedS + remainingS, rampDurationS);
+                stepLeftS = rampDurationS - stepElapsedS;
+                break;
+
+            case PlanOp::Jump: {
+                int& remaining = jumpRemaining[static_cast<std::size_t>(stepIndex)];
+                if (remaining > 0) {
+                    remaining -= 1;
+                    nextStepIndex = step.jumpTargetIndex;
+                    for (int idx = std::max(0, nextStepIndex); idx < stepIndex; ++idx) {
+                        const PlanStep& inner = plan.steps[static_cast<std::size_t>(idx)];
+                        if (inner.op == PlanOp::Jump) {
+                            jumpRemaining[static_cast<std::size_t>(idx)] = inner.repeatCount;
+                        }
+                    }
+                } else {
+                    remaining = step.repeatCount;
+                }
+                instant = true;
+                break;
+            }
         }
-        if (currentStepIndex == beforeStep) {
+
+        stepLeftS = std::max(0.0, stepLeftS);
+        if (remainingS <= stepLeftS && !instant) {
             break;
         }
+        remainingS -= stepLeftS;
+
+        if (nextStepIndex < 0 || nextStepIndex >= stepCount) {
+            break; // The profile ends inside the horizon; the last setpoint holds.
+        }
+        stepIndex = nextStepIndex;
+        stepElapsedS = 0.0;
+        soakDoneS = 0.0;
+        stepStartC = setpointC;
+
+        // Same entry rule as EnterStep(), from the predicted setpoint.
+        const PlanStep& next = plan.steps[static_cast<std::size_t>(stepIndex)];
+        const double delta = next.targetC - stepStartC;
+        if (next.op == PlanOp::RampTime) {
+            rampDurationS = next.durationS;
+            rampSlopeCPerS = delta / rampDurationS;
+        } else if (next.op == PlanOp::RampRate) {
+            rampDurationS = std::max(std::abs(delta) / next.rampRateCPerS, 0.001);
+            rampSlopeCPerS = delta / rampDurationS;
+        }
     }
+
+    outSetpointC = setpointC;
+    return true;
 }
 
 ProfileRuntimeStatus ProfileEngine::GetRuntimeStatus() const {
@@ -1033,15 +1401,16 @@ ProfileRuntimeStatus ProfileEngine::GetRuntimeStatus() const {
         return status;
     }
 
-    status.name = activeProfile.name;
+    std::memcpy(status.name, activePlan.name, sizeof(status.name));
     status.source = activeSource;
     status.slotIndex = activeSlotIndex;
-    status.currentStepNumber = currentStepIndex + 1;
-    if (currentStepIndex >= 0 && currentStepIndex < static_cast<int>(activeProfile.steps.size())) {
-        status.currentStepType = StepTypeToString(activeProfile.steps[static_cast<std::size_t>(currentStepIndex)].type);
+    status.currentStepNumber = cursor.stepIndex + 1;
+    if (cursor.stepIndex >= 0 && cursor.stepIndex < activePlan.stepCount) {
+        status.hasCurrentStep = true;
+        status.currentStepType = activePlan.steps[static_cast<std::size_t>(cursor.stepIndex)].type;
     }
-    status.stepElapsedS = currentStepElapsedS;
-    status.profileElapsedS = currentProfileElapsedS;
+    status.stepElapsedS = cursor.stepElapsedS;
+    status.profileElapsedS = cursor.profileElapsedS;
 
     return status;
 }
@@ -1078,3 +1447,12 @@ const char* ProfileEngine::EndReasonToString(ProfileEndReason reason) {
     }
     return "none";
 }
+
+const char* ProfileEngine::SourceToString(ProfileSource source) {
+    switch (source) {
+        case ProfileSource::None: return "none";
+        case ProfileSource::Uploaded: return "uploaded";
+        case ProfileSource::Slot: return "slot";
+    }
+    return "none";
+}
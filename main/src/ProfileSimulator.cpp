@@ -0,0 +1,377 @@
+#include "ProfileSimulator.hpp"
+
+#include "Controller.hpp"
+#include "PID.hpp"
+#include "ScopedLock.hpp"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <utility>
+
+namespace {
+constexpr const char* TAG = "ProfileSimulator";
+constexpr double kMinSetpointC = 0.0;
+constexpr double kMaxSetpointC = 300.0;
+
+bool IsValidConfig(const SimulationConfig& config) {
+    return config.model.IsValid()
+        && config.stepS >= ProfileSimulator::MIN_STEP_S && config.stepS <= ProfileSimulator::MAX_STEP_S
+        && config.deadTimeS >= 0.0 && config.deadTimeS <= ProfileSimulator::MAX_DEAD_TIME_S
+        && ProfileSimulator::DelayLineSteps(config) <= ProfileSimulator::MAX_DELAY_STEPS
+        && config.maxDurationS > 0.0 && config.maxDurationS <= ProfileSimulator::MAX_DURATION_S
+        && config.initialPvC >= kMinSetpointC && config.initialPvC <= kMaxSetpointC
+        && config.controller.inputFilterTimeMs > 0.0;
+}
+
+// Keeps every stride-th tick; when full, drops every other point and doubles
+// the stride, so the spacing stays uniform without knowing the run length.
+void RecordPoint(std::vector<SimulationPoint>& points, uint32_t& stride, uint32_t tick, const SimulationPoint& point) {
+    if (tick % stride != 0) {
+        return;
+    }
+    if (points.size() >= ProfileSimulator::MAX_POINTS) {
+        std::size_t kept = 0;
+        for (std::size_t idx = 0; idx < points.size(); idx += 2) {
+            points[kept++] = points[idx];
+        }
+        points.resize(kept);
+        stride *= 2;
+        if (tick % stride != 0) {
+            return;
+        }
+    }
+    points.push_back(point);
+}
+}
+
+ProfileSimulator* ProfileSimulator::instance = nullptr;
+
+ProfileSimulator& ProfileSimulator::getInstance() {
+    if (instance == nullptr) {
+        instance = new ProfileSimulator();
+    }
+    return *instance;
+}
+
+ProfileSimulator::ProfileSimulator() {
+    stateMutex = xSemaphoreCreateMutex();
+}
+
+SimulationControllerConfig ProfileSimulator::CaptureControllerConfig() {
+    Controller& controller = Controller::getInstance();
+    const PID& pid = *controller.GetPIDController();
+
+    SimulationControllerConfig out;
+    out.heatingKp = pid.GetHeatingKp();
+    out.heatingKi = pid.GetHeatingKi();
+    out.heatingKd = pid.GetHeatingKd();
+    out.coolingKp = pid.GetCoolingKp();
+    out.coolingKi = pid.GetCoolingKi();
+    out.coolingKd = pid.GetCoolingKd();
+    out.derivativeFilterTimeS = pid.GetDerivativeFilterTime();
+    out.setpointWeight = pid.GetSetpointWeight();
+    out.integralZoneC = pid.GetIntegralZoneC();
+    out.integralLeakTimeS = pid.GetIntegralLeakTimeSeconds();
+    out.inputFilterTimeMs = controller.GetInputFilterTimeMs();
+    const ProcessValuePipelineConfig pipeline = controller.GetProcessValuePipeline();
+    out.pvFilterMode = pipeline.filterMode;
+    out.derivativeFromRate = pipeline.derivativeFromRate;
+    out.coolOnBandC = controller.GetCoolOnBandC();
+    out.coolOffBandC = controller.GetCoolOffBandC();
+    out.heaterMinValuePct = controller.GetHeaterMinValuePct();
+    out.forceHeaterOnBelowC = controller.GetForceHeaterOnBelowC();
+    out.feedforwardEnabled = controller.IsFeedforwardEnabled();
+    out.feedforwardLookaheadS = controller.GetFeedforwardLookaheadS();
+    out.feedforwardGain = controller.GetFeedforwardGain();
+    return out;
+}
+
+esp_err_t ProfileSimulator::Start(const ProfileDefinition& profile, const SimulationConfig& newConfig) {
+    if (!IsValidConfig(newConfig) || !ProfileEngine::getInstance().ValidateProfile(profile).empty()) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    ScopedLock lock(stateMutex);
+    if (!lock.Locked() || state == SimulationState::Running) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    // Sized from request input, so it goes to PSRAM and a failure is reported
+    // instead of aborting in an allocator.
+    const std::size_t delaySteps = DelayLineSteps(newConfig);
+    float* newDelayLine = nullptr;
+    if (delaySteps > 0) {
+        newDelayLine = static_cast<float*>(heap_caps_malloc(delaySteps * sizeof(float), MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT));
+        if (newDelayLine == nullptr) {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    ProfileEngine::CompilePlan(profile, plan);
+    config = newConfig;
+    delayLine = newDelayLine;
+    result = SimulationResult{};
+    progress.cancelRequested.store(false, std::memory_order_relaxed);
+    progress.simulatedS.store(0, std::memory_order_relaxed);
+    startedUs = esp_timer_get_time();
+    wallTimeUs = 0;
+    state = SimulationState::Running;
+
+    // Idle priority: it shares core 0 with the idle task instead of starving it.
+    BaseType_t created;
+#if CONFIG_FREERTOS_UNICORE
+    created = xTaskCreate(
+        &ProfileSimulator::TaskEntry,
+        "ProfileSimTask",
+        4096,
+        this,
+        tskIDLE_PRIORITY,
+        &taskHandle
+    );
+#else
+    created = xTaskCreatePinnedToCore(
+        &ProfileSimulator::TaskEntry,
+        "ProfileSimTask",
+        4096,
+        this,
+        tskIDLE_PRIORITY,
+        &taskHandle,
+        0
+    );
+#endif
+    if (created != pdPASS) {
+        taskHandle = nullptr;
+        state = SimulationState::Idle;
+        heap_caps_free(delayLine);
+        delayLine = nullptr;
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+esp_err_t ProfileSimulator::Cancel() {
+    ScopedLock lock(stateMutex);
+    if (!lock.Locked() || state != SimulationState::Running) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    progress.cancelRequested.store(true, std::memory_order_relaxed);
+    return ESP_OK;
+}
+
+SimulationStatus ProfileSimulator::GetStatus() const {
+    SimulationStatus status;
+    ScopedLock lock(stateMutex);
+    if (!lock.Locked()) {
+        return status;
+    }
+
+    status.state = state;
+    std::memcpy(status.profileName, plan.name, sizeof(status.profileName));
+    status.config = config;
+    if (state == SimulationState::Running) {
+        status.simulatedS = progress.simulatedS.load(std::memory_order_relaxed);
+        status.wallTimeUs = esp_timer_get_time() - startedUs;
+    } else {
+        status.simulatedS = result.durationS;
+        status.wallTimeUs = wallTimeUs;
+        status.result = result;
+    }
+    return status;
+}
+
+void ProfileSimulator::TaskEntry(void* arg) {
+    static_cast<ProfileSimulator*>(arg)->RunTask();
+    vTaskDelete(nullptr);
+}
+
+void ProfileSimulator::RunTask() {
+    SimulationResult simulated;
+    Simulate(plan, config, delayLine, simulated, &progress);
+
+    ScopedLock lock(stateMutex);
+    heap_caps_free(delayLine);
+    delayLine = nullptr;
+    wallTimeUs = esp_timer_get_time() - startedUs;
+    ESP_LOGI(TAG, "Simulated %.0f s of \"%s\" in %lld ms (%s)",
+             simulated.durationS, plan.name, static_cast<long long>(wallTimeUs / 1000), OutcomeToString(simulated.outcome));
+    result = std::move(simulated);
+    state = SimulationState::Complete;
+    taskHandle = nullptr;
+}
+
+std::size_t ProfileSimulator::DelayLineSteps(const SimulationConfig& config) {
+    if (!(config.stepS > 0.0) || !(config.deadTimeS > 0.0)) {
+        return 0;
+    }
+    return static_cast<std::size_t>(std::lround(config.deadTimeS / config.stepS));
+}
+
+void ProfileSimulator::Simulate(const ProfileEngine::Plan& plan, const SimulationConfig& config, float* delayLine,
+                                SimulationResult& outResult, Progress* progress) {
+    using PlanTickResult = ProfileEngine::PlanTickResult;
+
+    outResult = SimulationResult{};
+    outResult.points.reserve(MAX_POINTS + 1);
+
+    const SimulationControllerConfig& control = config.controller;
+    PID pid;
+    (void)pid.TuneHeating(control.heatingKp, control.heatingKi, control.heatingKd);
+    (void)pid.TuneCooling(control.coolingKp, control.coolingKi, control.coolingKd);
+    (void)pid.SetDerivativeFilterTime(control.derivativeFilterTimeS);
+    (void)pid.SetSetpointWeight(control.setpointWeight);
+    (void)pid.SetIntegralZoneC(control.integralZoneC);
+    (void)pid.SetIntegralLeakTimeSeconds(control.integralLeakTimeS);
+
+    const ThermalModel& model = config.model;
+    const double stepS = config.stepS;
+    const double decay = std::exp(-stepS / model.timeConstantS);
+    const control_real_t filterTimeS = static_cast<control_real_t>(control.inputFilterTimeMs / 1000.0);
+
+    // Heater output delayed by the dead time; one entry per tick.
+    const std::size_t delaySteps = (delayLine != nullptr) ? DelayLineSteps(config) : 0;
+    std::fill(delayLine, delayLine + delaySteps, 0.0f);
+    std::size_t delayIndex = 0;
+    const double heaterMinPct = std::clamp(control.heaterMinValuePct, 0.0, 100.0);
+
+    double chamberC = config.initialPvC;
+    // What the controller sees, after the input filter. The model has no sensor
+    // noise, so outlier rejection and channel weights have nothing to do here.
+    ProcessValueFilter pvFilter;
+    double processValueC = pvFilter.Update(static_cast<control_real_t>(chamberC), 0, filterTimeS, control.pvFilterMode);
+    double setpointC = config.initialPvC;
+    bool coolingEnabled = false;
+    double previousSetpointC = setpointC;
+    bool approachingFromBelow = false;
+
+    ProfileEngine::PlanCursor cursor;
+    ProfileEngine::BeginPlan(plan, cursor, setpointC);
+    PlanTickResult tickResult = ProfileEngine::AdvancePlan(plan, cursor, 0.0, processValueC, setpointC);
+
+    uint32_t stride = 1;
+    uint32_t tick = 0;
+    SimulationPoint point;
+    while (tickResult == PlanTickResult::Running) {
+        if (cursor.profileElapsedS >= config.maxDurationS) {
+            outResult.outcome = SimulationOutcome::TimedOut;
+            break;
+        }
+        if (progress != nullptr && progress->cancelRequested.load(std::memory_order_relaxed)) {
+            outResult.outcome = SimulationOutcome::Cancelled;
+            break;
+        }
+
+        // Controller tick, as in Controller::PerformOnRunning.
+        double feedforward = 0.0;
+        double aheadC = 0.0;
+        double rateCPerS = 0.0;
+        if (control.feedforwardEnabled
+                && ProfileEngine::PredictTrajectory(plan, cursor, setpointC, control.feedforwardLookaheadS, aheadC, rateCPerS)) {
+            feedforward = control.feedforwardGain
+                * model.FeedforwardOutputPct(std::clamp(aheadC, kMinSetpointC, kMaxSetpointC), rateCPerS);
+        }
+        const double output = control.derivativeFromRate
+            ? pid.CalculateWithRate(
+                static_cast<control_real_t>(setpointC),
+                static_cast<control_real_t>(processValueC),
+                pvFilter.GetRateCPerS(),
+                static_cast<control_real_t>(stepS),
+                static_cast<control_real_t>(feedforward))
+            : pid.Calculate(
+                static_cast<control_real_t>(setpointC),
+                static_cast<control_real_t>(processValueC),
+                static_cast<control_real_t>(stepS),
+                static_cast<control_real_t>(feedforward));
+        if (!coolingEnabled && processValueC > (setpointC + control.coolOnBandC)) {
+            coolingEnabled = true;
+        } else if (coolingEnabled && processValueC < (setpointC + control.coolOffBandC)) {
+            coolingEnabled = false;
+        }
+        const double effectiveOutput = (!coolingEnabled && output < 0.0) ? 0.0 : output;
+
+        point.timeS = static_cast<float>(cursor.profileElapsedS);
+        point.setpointC = static_cast<float>(setpointC);
+        point.processValueC = static_cast<float>(processValueC);
+        point.outputPct = static_cast<float>(effectiveOutput);
+        point.stepNumber = static_cast<uint16_t>(cursor.stepIndex + 1);
+        RecordPoint(outResult.points, stride, tick, point);
+        // PV still above a setpoint that just dropped is not overshoot; only
+        // count it once the PV has been below the setpoint it is heading for.
+        if (setpointC < previousSetpointC) {
+            approachingFromBelow = false;
+        } else if (processValueC < setpointC) {
+            approachingFromBelow = true;
+        } else if (approachingFromBelow) {
+            outResult.maxOvershootC = std::max(outResult.maxOvershootC, processValueC - setpointC);
+        }
+        previousSetpointC = setpointC;
+
+        // Heater drive as in PerformOnRunning: demand is scaled into
+        // [heaterMinValuePct, 100], and the minimum is held while the PV is
+        // no more than forceHeaterOnBelowC above the setpoint.
+        double heaterPct = 0.0;
+        if (effectiveOutput > 0.0) {
+            heaterPct = heaterMinPct + (100.0 - heaterMinPct) * std::clamp(effectiveOutput / 100.0, 0.0, 1.0);
+        }
+        if (control.forceHeaterOnBelowC > 0.0 && processValueC <= setpointC + control.forceHeaterOnBelowC) {
+            heaterPct = std::max(heaterPct, heaterMinPct);
+        }
+
+        // Plant: exact step response of the first-order model over one tick.
+        if (delaySteps > 0) {
+            const float delayed = delayLine[delayIndex];
+            delayLine[delayIndex] = static_cast<float>(heaterPct);
+            heaterPct = delayed;
+            delayIndex = (delayIndex + 1) % delaySteps;
+        }
+        const double steadyC = model.ambientC + model.gainCPerPct * heaterPct;
+        chamberC = steadyC + (chamberC - steadyC) * decay;
+        processValueC = pvFilter.Update(
+            static_cast<control_real_t>(chamberC), static_cast<control_real_t>(stepS), filterTimeS, control.pvFilterMode);
+
+        tickResult = ProfileEngine::AdvancePlan(plan, cursor, stepS, processValueC, setpointC);
+        ++tick;
+        if (progress != nullptr) {
+            progress->simulatedS.store(static_cast<uint32_t>(cursor.profileElapsedS), std::memory_order_relaxed);
+        }
+    }
+
+    if (tickResult == PlanTickResult::TransitionGuard) {
+        outResult.outcome = SimulationOutcome::TransitionGuard;
+    } else if (tickResult == PlanTickResult::InvalidStep) {
+        outResult.outcome = SimulationOutcome::InvalidProfile;
+    }
+    outResult.durationS = cursor.profileElapsedS;
+    outResult.ticks = tick;
+
+    // The final state, even when it falls between strides.
+    point.timeS = static_cast<float>(cursor.profileElapsedS);
+    point.setpointC = static_cast<float>(setpointC);
+    point.processValueC = static_cast<float>(processValueC);
+    if (outResult.points.empty() || outResult.points.back().timeS != point.timeS) {
+        outResult.points.push_back(point);
+    }
+}
+
+const char* ProfileSimulator::OutcomeToString(SimulationOutcome outcome) {
+    switch (outcome) {
+        case SimulationOutcome::Completed: return "completed";
+        case SimulationOutcome::TransitionGuard: return "transition_guard_abort";
+        case SimulationOutcome::InvalidProfile: return "invalid_profile";
+        case SimulationOutcome::TimedOut: return "timed_out";
+        case SimulationOutcome::Cancelled: return "cancelled";
+    }
+    return "completed";
+}
+
+const char* ProfileSimulator::StateToString(SimulationState state) {
+    switch (state) {
+        case SimulationState::Idle: return "idle";
+        case SimulationState::Running: return "running";
+        case SimulationState::Complete: return "complete";
+    }
+    return "idle";
+}
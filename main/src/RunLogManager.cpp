@@ -0,0 +1,428 @@
+#include "RunLogManager.hpp"
+
+#include "BinaryCodec.hpp"
+#include "ScopedLock.hpp"
+#include "TimeManager.hpp"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_spiffs.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <dirent.h>
+#include <sys/stat.h>
+
+namespace {
+constexpr const char* TAG = "RunLog";
+constexpr const char* SPIFFS_BASE_PATH = "/spiffs";
+constexpr const char* SPIFFS_PARTITION_LABEL = "spiffs";
+constexpr std::size_t WRITER_QUEUE_LENGTH = RunLogManager::PAGE_POOL_SIZE + 4;
+
+}
+
+RunLogManager* RunLogManager::instance = nullptr;
+
+RunLogManager& RunLogManager::getInstance() {
+    if (instance == nullptr) {
+        instance = new RunLogManager();
+    }
+    return *instance;
+}
+
+// The mutex exists from construction: the web server is up and listing runs
+// before Initialize() has run.
+RunLogManager::RunLogManager() {
+    stateMutex = xSemaphoreCreateMutex();
+}
+
+esp_err_t RunLogManager::Initialize() {
+    if (initialized.load(std::memory_order_acquire)) {
+        return ESP_OK;
+    }
+
+    writerQueue = xQueueCreate(WRITER_QUEUE_LENGTH, sizeof(Message));
+    freePages = xQueueCreate(PAGE_POOL_SIZE, sizeof(uint8_t));
+    if (stateMutex == nullptr || writerQueue == nullptr || freePages == nullptr) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    pages = static_cast<Page*>(heap_caps_malloc(sizeof(Page) * PAGE_POOL_SIZE, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT));
+    if (pages == nullptr) {
+        pages = static_cast<Page*>(heap_caps_malloc(sizeof(Page) * PAGE_POOL_SIZE, MALLOC_CAP_8BIT));
+    }
+    if (pages == nullptr) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    for (std::size_t i = 0; i < PAGE_POOL_SIZE; ++i) {
+        pages[i].used = 0;
+        const uint8_t index = static_cast<uint8_t>(i);
+        xQueueSend(freePages, &index, 0);
+    }
+
+    for (const RunLogInfo& run : ListRuns()) {
+        nextRunId = std::max(nextRunId, run.runId + 1);
+    }
+
+    BaseType_t result;
+#if CONFIG_FREERTOS_UNICORE
+    result = xTaskCreate(
+        WriterTaskEntry,
+        "RunLogWriter",
+        4096,
+        this,
+        1,
+        &writerTaskHandle
+    );
+#else
+    result = xTaskCreatePinnedToCore(
+        WriterTaskEntry,
+        "RunLogWriter",
+        4096,
+        this,
+        1,
+        &writerTaskHandle,
+        0
+    );
+#endif
+    if (result != pdPASS) {
+        return ESP_FAIL;
+    }
+
+    initialized.store(true, std::memory_order_release);
+    return ESP_OK;
+}
+
+void RunLogManager::Append(const DataPoint& point) {
+    if (!initialized.load(std::memory_order_acquire)) {
+        return;
+    }
+
+    ScopedLock lock(stateMutex);
+    if (!sessionOpen) {
+        if (!point.chamberRunning) {
+            return;
+        }
+        OpenSessionLocked(point);
+        if (!sessionOpen) {
+            return;
+        }
+    }
+
+    if (currentPage >= 0 && pages[currentPage].used + encoder.GetRecordSize() > PAGE_SIZE) {
+        SubmitCurrentPageLocked();
+    }
+    if (currentPage < 0 && !AcquirePageLocked()) {
+        ++droppedRecords;
+    } else {
+        Page& page = pages[currentPage];
+        encoder.EncodeRecord(point, page.data + page.used);
+        page.used += encoder.GetRecordSize();
+    }
+    lastSequence = point.sequence;
+
+    // The first idle point is kept as the run's final record.
+    if (!point.chamberRunning) {
+        CloseSessionLocked();
+    }
+}
+
+std::vector<RunLogInfo> RunLogManager::ListRuns() const {
+    std::vector<RunLogInfo> runs;
+
+    DIR* dir = opendir(SPIFFS_BASE_PATH);
+    if (dir == nullptr) {
+        return runs;
+    }
+
+    struct dirent* entry = nullptr;
+    while ((entry = readdir(dir)) != nullptr) {
+        RunLogInfo info;
+        if (!ParseRunFileName(entry->d_name, info.runId)) {
+            continue;
+        }
+
+        const std::string path = PathForRun(info.runId);
+        struct stat st = {};
+        if (stat(path.c_str(), &st) == 0) {
+            info.sizeBytes = static_cast<std::size_t>(st.st_size);
+        }
+
+        FILE* file = std::fopen(path.c_str(), "rb");
+        if (file != nullptr) {
+            uint8_t header[HistoryBinaryEncoder::HEADER_SIZE] = {};
+            if (std::fread(header, 1, sizeof(header), file) == sizeof(header)) {
+                info.firstTimestamp = ReadLe64(header + 8);
+                info.startUnixTime = ReadLe32(header + 28);
+            }
+            std::fclose(file);
+        }
+
+        runs.push_back(info);
+    }
+    closedir(dir);
+
+    {
+        ScopedLock lock(stateMutex);
+        for (RunLogInfo& run : runs) {
+            run.active = sessionOpen && run.runId == currentRunId;
+        }
+    }
+
+    std::sort(runs.begin(), runs.end(), [](const RunLogInfo& a, const RunLogInfo& b) {
+        return a.runId < b.runId;
+    });
+    return runs;
+}
+
+esp_err_t RunLogManager::GetRunPath(uint32_t runId, std::string& outPath) const {
+    const std::string path = PathForRun(runId);
+    struct stat st = {};
+    if (stat(path.c_str(), &st) != 0) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    outPath = path;
+    return ESP_OK;
+}
+
+esp_err_t RunLogManager::DeleteRun(uint32_t runId) {
+    {
+        ScopedLock lock(stateMutex);
+        if (sessionOpen && runId == currentRunId) {
+            return ESP_ERR_INVALID_STATE;
+        }
+    }
+
+    const std::string path = PathForRun(runId);
+    if (std::remove(path.c_str()) != 0) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    return ESP_OK;
+}
+
+uint32_t RunLogManager::GetDroppedRecordCount() const {
+    ScopedLock lock(stateMutex);
+    return droppedRecords;
+}
+
+bool RunLogManager::AcquirePageLocked() {
+    uint8_t index = 0;
+    if (xQueueReceive(freePages, &index, 0) != pdTRUE) {
+        return false;
+    }
+
+    currentPage = index;
+    pages[currentPage].used = 0;
+    return true;
+}
+
+void RunLogManager::SubmitCurrentPageLocked() {
+    if (currentPage < 0) {
+        return;
+    }
+
+    const uint8_t index = static_cast<uint8_t>(currentPage);
+    currentPage = -1;
+
+    Message message;
+    message.type = MessageType::Data;
+    message.page = index;
+    message.runId = currentRunId;
+    if (xQueueSend(writerQueue, &message, 0) != pdTRUE) {
+        droppedRecords += static_cast<uint32_t>(pages[index].used / encoder.GetRecordSize());
+        xQueueSend(freePages, &index, 0);
+    }
+}
+
+void RunLogManager::OpenSessionLocked(const DataPoint& firstPoint) {
+    // Take the header's page first so a failed acquire leaves nothing queued;
+    // without a header the file would be unreadable.
+    if (currentPage < 0 && !AcquirePageLocked()) {
+        ++droppedRecords;
+        return;
+    }
+
+    Message message;
+    message.type = MessageType::Open;
+    message.runId = nextRunId;
+    if (xQueueSend(writerQueue, &message, 0) != pdTRUE) {
+        const uint8_t index = static_cast<uint8_t>(currentPage);
+        currentPage = -1;
+        xQueueSend(freePages, &index, 0);
+        ++droppedRecords;
+        return;
+    }
+
+    currentRunId = nextRunId++;
+    sessionOpen = true;
+    lastSequence = firstPoint.sequence;
+
+    const uint64_t unixMs = TimeManager::getInstance().GetCurrentUnixTimeMs();
+    Page& page = pages[currentPage];
+    encoder.EncodeHeader(
+        firstPoint.timestamp,
+        firstPoint.sequence,
+        firstPoint.sequence,
+        0, // Patched by the writer when the run closes
+        static_cast<uint32_t>(unixMs / 1000),
+        firstPoint.zoneCount,
+        page.data + page.used);
+    page.used += HistoryBinaryEncoder::HEADER_SIZE;
+}
+
+void RunLogManager::CloseSessionLocked() {
+    if (currentPage >= 0) {
+        if (pages[currentPage].used > 0) {
+            SubmitCurrentPageLocked();
+        } else {
+            const uint8_t index = static_cast<uint8_t>(currentPage);
+            currentPage = -1;
+            xQueueSend(freePages, &index, 0);
+        }
+    }
+
+    // If the queue is full the writer still closes the file when the next run opens.
+    Message message;
+    message.type = MessageType::Close;
+    message.runId = currentRunId;
+    message.nextSequence = lastSequence + 1;
+    (void)xQueueSend(writerQueue, &message, 0);
+
+    sessionOpen = false;
+}
+
+void RunLogManager::WriterTaskEntry(void* arg) {
+    static_cast<RunLogManager*>(arg)->WriterTaskLoop();
+    vTaskDelete(nullptr);
+}
+
+void RunLogManager::WriterTaskLoop() {
+    Message message;
+    while (true) {
+        if (xQueueReceive(writerQueue, &message, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
+
+        switch (message.type) {
+            case MessageType::Open:
+                WriterHandleOpen(message.runId);
+                break;
+            case MessageType::Data:
+                WriterHandleData(message.page);
+                break;
+            case MessageType::Close:
+                WriterHandleClose(message.nextSequence);
+                break;
+        }
+    }
+}
+
+void RunLogManager::WriterHandleOpen(uint32_t runId) {
+    WriterHandleClose(0);
+
+    writerRunId = runId;
+    writerHasActiveRun = true;
+    RotateForSpace(PAGE_SIZE);
+
+    const std::string path = PathForRun(runId);
+    writerFile = std::fopen(path.c_str(), "wb");
+    if (writerFile == nullptr) {
+        ESP_LOGE(TAG, "Failed to create %s", path.c_str());
+    }
+}
+
+void RunLogManager::WriterHandleData(uint8_t pageIndex) {
+    Page& page = pages[pageIndex];
+
+    if (writerFile != nullptr) {
+        RotateForSpace(page.used);
+        if (std::fwrite(page.data, 1, page.used, writerFile) != page.used) {
+            ESP_LOGE(TAG, "Write failed for run %u, closing it", static_cast<unsigned>(writerRunId));
+            std::fclose(writerFile);
+            writerFile = nullptr;
+        }
+    }
+
+    page.used = 0;
+    xQueueSend(freePages, &pageIndex, 0);
+}
+
+void RunLogManager::WriterHandleClose(uint32_t nextSequence) {
+    if (writerFile == nullptr) {
+        writerHasActiveRun = false;
+        return;
+    }
+
+    // Fill in the header's next-seq field now that the run length is known.
+    if (nextSequence != 0 && std::fseek(writerFile, 24, SEEK_SET) == 0) {
+        uint8_t patch[4] = {};
+        PutLe32(patch, nextSequence);
+        (void)std::fwrite(patch, 1, sizeof(patch), writerFile);
+    }
+
+    std::fclose(writerFile);
+    writerFile = nullptr;
+    writerHasActiveRun = false;
+}
+
+void RunLogManager::RotateForSpace(std::size_t neededBytes) {
+    while (true) {
+        std::size_t total = 0;
+        std::size_t used = 0;
+        if (esp_spiffs_info(SPIFFS_PARTITION_LABEL, &total, &used) != ESP_OK || used > total) {
+            return;
+        }
+        if (total - used >= neededBytes + MIN_FREE_BYTES) {
+            return;
+        }
+
+        // Drop the oldest finished run; never the one being written.
+        bool found = false;
+        uint32_t oldest = 0;
+        for (const RunLogInfo& run : ListRuns()) {
+            if (writerHasActiveRun && run.runId == writerRunId) {
+                continue;
+            }
+            oldest = run.runId;
+            found = true;
+            break;
+        }
+        if (!found) {
+            return;
+        }
+
+        ESP_LOGW(TAG, "Low on SPIFFS space, removing run %u", static_cast<unsigned>(oldest));
+        if (std::remove(PathForRun(oldest).c_str()) != 0) {
+            return;
+        }
+    }
+}
+
+std::string RunLogManager::PathForRun(uint32_t runId) {
+    char path[48] = {};
+    std::snprintf(path, sizeof(path), "%s/%s%05u.bin", SPIFFS_BASE_PATH, RUN_FILE_PREFIX, static_cast<unsigned>(runId));
+    return path;
+}
+
+bool RunLogManager::ParseRunFileName(const char* name, uint32_t& outRunId) {
+    if (name == nullptr) {
+        return false;
+    }
+
+    const std::size_t prefixLength = std::strlen(RUN_FILE_PREFIX);
+    if (std::strncmp(name, RUN_FILE_PREFIX, prefixLength) != 0) {
+        return false;
+    }
+
+    char* end = nullptr;
+    const unsigned long value = std::strtoul(name + prefixLength, &end, 10);
+    if (end == name + prefixLength || std::strcmp(end, ".bin") != 0) {
+        return false;
+    }
+
+    outRunId = static_cast<uint32_t>(value);
+    return true;
+}
@@ -1,19 +1,16 @@
 #include "SettingsManager.hpp"
+#include "ScopedLock.hpp"
+#include "Tracer.hpp"
+#include "esp_log.h"
 #include <algorithm>
-#include <cstdio>
 #include <cstring>
 #include <vector>
 
 SettingsManager* SettingsManager::instance = nullptr;
 
 namespace {
-bool BuildRelayWeightKey(int relayIndex, char* outKey, std::size_t outLen) {
-    if (outKey == nullptr || outLen < 6 || relayIndex < 0 || relayIndex > 7) {
-        return false;
-    }
-    std::snprintf(outKey, outLen, "relw%d", relayIndex);
-    return true;
-}
+constexpr const char* TAG = "SettingsManager";
+
 }
 
 SettingsManager& SettingsManager::getInstance(){
@@ -23,6 +20,10 @@ SettingsManager& SettingsManager::getInstance(){
     return *instance;
 }
 
+SettingsManager::SettingsManager() {
+    pendingMutex = xSemaphoreCreateMutex();
+}
+
 esp_err_t SettingsManager::Initialize() {
     if (initialized) {
         return ESP_OK;
@@ -38,10 +39,97 @@ esp_err_t SettingsManager::Initialize() {
         return err;
     }
 
+    BaseType_t created;
+#if CONFIG_FREERTOS_UNICORE
+    created = xTaskCreate(
+        &SettingsManager::WriteBackTaskEntry,
+        "SettingsWriteBack",
+        4096,
+        this,
+        1,
+        &writeBackTaskHandle
+    );
+#else
+    created = xTaskCreatePinnedToCore(
+        &SettingsManager::WriteBackTaskEntry,
+        "SettingsWriteBack",
+        4096,
+        this,
+        1,
+        &writeBackTaskHandle,
+        0
+    );
+#endif
+    if (created != pdPASS) {
+        writeBackTaskHandle = nullptr;
+        return ESP_ERR_NO_MEM;
+    }
+
+    esp_timer_create_args_t timerArgs = {};
+    timerArgs.callback = &SettingsManager::WriteBackTimerCallback;
+    timerArgs.arg = this;
+    timerArgs.dispatch_method = ESP_TIMER_TASK;
+    timerArgs.name = "settings_wb";
+    timerArgs.skip_unhandled_events = true;
+    err = esp_timer_create(&timerArgs, &writeBackTimer);
+    if (err != ESP_OK) {
+        return err;
+    }
+
     initialized = true;
     return ESP_OK;
 }
 
+void SettingsManager::BeginBatch() {
+    ScopedLock lock(pendingMutex);
+    batchDepth++;
+}
+
+esp_err_t SettingsManager::EndBatch() {
+    ScopedLock lock(pendingMutex);
+    if (batchDepth > 0) {
+        batchDepth--;
+    }
+    if (batchDepth > 0) {
+        return ESP_OK;
+    }
+    return FlushLocked();
+}
+
+esp_err_t SettingsManager::Flush() {
+    ScopedLock lock(pendingMutex);
+    return FlushLocked();
+}
+
+SettingsWriteStats SettingsManager::GetWriteStats() const {
+    ScopedLock lock(pendingMutex);
+    SettingsWriteStats stats = writeStats;
+    stats.pendingKeys = static_cast<uint32_t>(pendingCount);
+    return stats;
+}
+
+void SettingsManager::WriteBackTimerCallback(void* arg) {
+    // NVS writes and the commit can take tens of ms of flash erase; keep them
+    // off the esp_timer task that every other timer callback shares.
+    SettingsManager* self = static_cast<SettingsManager*>(arg);
+    xTaskNotifyGive(self->writeBackTaskHandle);
+}
+
+void SettingsManager::WriteBackTaskEntry(void* arg) {
+    static_cast<SettingsManager*>(arg)->WriteBackTaskLoop();
+    vTaskDelete(nullptr);
+}
+
+void SettingsManager::WriteBackTaskLoop() {
+    while (true) {
+        (void)ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        const esp_err_t err = Flush();
+        if (err != ESP_OK) {
+            ESP_LOGW(TAG, "Deferred settings write failed: %s", esp_err_to_name(err));
+        }
+    }
+}
+
 
 esp_err_t SettingsManager::OpenNVS() {
     if (nvsOpen) {
@@ -66,54 +154,162 @@ esp_err_t SettingsManager::OpenNVS() {
     return err;
 }
 
-esp_err_t SettingsManager::NVS_Set_Double(const char* key, double value) {
-    if (!nvsOpen) {
-        return ESP_ERR_INVALID_STATE;
-    }
-
+esp_err_t SettingsManager::StageDouble(const char* key, double value) {
     uint64_t rawValue = 0;
     std::memcpy(&rawValue, &value, sizeof(double));
-    esp_err_t err = nvs_set_u64(m_handle, key, rawValue);
-    if (err != ESP_OK) {
-        return err;
-    }
-    return nvs_commit(m_handle);
+    ScopedLock lock(pendingMutex);
+    return StageLocked(key, StoredType::Double, rawValue, nullptr);
+}
+
+esp_err_t SettingsManager::StageU8(const char* key, uint8_t value) {
+    ScopedLock lock(pendingMutex);
+    return StageLocked(key, StoredType::U8, value, nullptr);
+}
+
+esp_err_t SettingsManager::StageI32(const char* key, int32_t value) {
+    ScopedLock lock(pendingMutex);
+    return StageLocked(key, StoredType::I32, static_cast<uint32_t>(value), nullptr);
+}
+
+esp_err_t SettingsManager::StageString(const char* key, const std::string& value) {
+    ScopedLock lock(pendingMutex);
+    return StageLocked(key, StoredType::String, 0, &value);
 }
 
-esp_err_t SettingsManager::NVS_Set_U8(const char* key, uint8_t value) {
+esp_err_t SettingsManager::StageLocked(const char* key, StoredType type, uint64_t raw, const std::string* text) {
     if (!nvsOpen) {
         return ESP_ERR_INVALID_STATE;
     }
 
-    esp_err_t err = nvs_set_u8(m_handle, key, value);
-    if (err != ESP_OK) {
-        return err;
+    // A key staged again before the flush only keeps its newest value.
+    PendingWrite* slot = nullptr;
+    for (std::size_t i = 0; i < pendingCount; ++i) {
+        if (pendingWrites[i].key == key) {
+            slot = &pendingWrites[i];
+            break;
+        }
+    }
+    if (slot == nullptr) {
+        if (pendingCount == pendingWrites.size()) {
+            esp_err_t err = FlushLocked();
+            if (err != ESP_OK) {
+                return err;
+            }
+        }
+        slot = &pendingWrites[pendingCount++];
+        slot->key = key;
+    }
+    slot->type = type;
+    slot->raw = raw;
+    if (text != nullptr) {
+        slot->text = *text;
     }
-    return nvs_commit(m_handle);
-}
 
-esp_err_t SettingsManager::NVS_Set_I32(const char* key, int32_t value) {
-    if (!nvsOpen) {
-        return ESP_ERR_INVALID_STATE;
+    if (batchDepth == 0 && writeBackTimer != nullptr) {
+        // Restarting the one-shot on every change is what coalesces a burst.
+        (void)esp_timer_stop(writeBackTimer);
+        esp_err_t err = esp_timer_start_once(writeBackTimer, static_cast<uint64_t>(WRITE_BACK_DELAY_MS) * 1000ULL);
+        if (err != ESP_OK) {
+            return FlushLocked();
+        }
     }
+    return ESP_OK;
+}
 
-    esp_err_t err = nvs_set_i32(m_handle, key, value);
-    if (err != ESP_OK) {
-        return err;
+esp_err_t SettingsManager::WritePendingLocked(const PendingWrite& write, bool& outWritten) {
+    outWritten = false;
+    switch (write.type) {
+        case StoredType::Double: {
+            uint64_t stored = 0;
+            if (nvs_get_u64(m_handle, write.key, &stored) == ESP_OK && stored == write.raw) {
+                return ESP_OK;
+            }
+            outWritten = true;
+            return nvs_set_u64(m_handle, write.key, write.raw);
+        }
+        case StoredType::U8: {
+            uint8_t stored = 0;
+            const uint8_t value = static_cast<uint8_t>(write.raw);
+            if (nvs_get_u8(m_handle, write.key, &stored) == ESP_OK && stored == value) {
+                return ESP_OK;
+            }
+            outWritten = true;
+            return nvs_set_u8(m_handle, write.key, value);
+        }
+        case StoredType::I32: {
+            int32_t stored = 0;
+            const int32_t value = static_cast<int32_t>(static_cast<uint32_t>(write.raw));
+            if (nvs_get_i32(m_handle, write.key, &stored) == ESP_OK && stored == value) {
+                return ESP_OK;
+            }
+            outWritten = true;
+            return nvs_set_i32(m_handle, write.key, value);
+        }
+        case StoredType::String: {
+            size_t requiredSize = 0;
+            if (nvs_get_str(m_handle, write.key, nullptr, &requiredSize) == ESP_OK && requiredSize == write.text.size() + 1) {
+                std::vector<char> stored(requiredSize);
+                if (nvs_get_str(m_handle, write.key, stored.data(), &requiredSize) == ESP_OK
+                        && std::memcmp(stored.data(), write.text.c_str(), requiredSize) == 0) {
+                    return ESP_OK;
+                }
+            }
+            outWritten = true;
+            return nvs_set_str(m_handle, write.key, write.text.c_str());
+        }
     }
-    return nvs_commit(m_handle);
+    return ESP_ERR_INVALID_ARG;
 }
 
-esp_err_t SettingsManager::NVS_Set_String(const char* key, const std::string& value) {
+esp_err_t SettingsManager::FlushLocked() {
+    if (writeBackTimer != nullptr) {
+        (void)esp_timer_stop(writeBackTimer);
+    }
+    if (pendingCount == 0) {
+        return ESP_OK;
+    }
     if (!nvsOpen) {
         return ESP_ERR_INVALID_STATE;
     }
 
-    esp_err_t err = nvs_set_str(m_handle, key, value.c_str());
-    if (err != ESP_OK) {
-        return err;
+    // A failed key is dropped rather than retried: NVS full or a bad key would
+    // fail the same way on every later flush.
+    esp_err_t result = ESP_OK;
+    bool anyWritten = false;
+    for (std::size_t i = 0; i < pendingCount; ++i) {
+        bool written = false;
+        const esp_err_t err = WritePendingLocked(pendingWrites[i], written);
+        if (err != ESP_OK) {
+            ESP_LOGW(TAG, "Failed to write %s: %s", pendingWrites[i].key, esp_err_to_name(err));
+            writeStats.failedWrites++;
+            writeStats.lastError = err;
+            if (result == ESP_OK) {
+                result = err;
+            }
+        } else if (written) {
+            writeStats.keysWritten++;
+            anyWritten = true;
+        } else {
+            writeStats.keysUnchanged++;
+        }
+        pendingWrites[i].text.clear();
     }
-    return nvs_commit(m_handle);
+    pendingCount = 0;
+
+    if (anyWritten) {
+        TRACE_SCOPE("SettingsManager::commit");
+        const esp_err_t err = nvs_commit(m_handle);
+        writeStats.commits++;
+        if (err != ESP_OK) {
+            ESP_LOGW(TAG, "Settings commit failed: %s", esp_err_to_name(err));
+            writeStats.failedCommits++;
+            writeStats.lastError = err;
+        }
+        if (result == ESP_OK) {
+            result = err;
+        }
+    }
+    return result;
 }
 
 esp_err_t SettingsManager::CloseNVS() {
@@ -226,12 +422,8 @@ esp_err_t SettingsManager::LoadSettings() {
     }
 
     for (int relayIndex = 0; relayIndex < 8; ++relayIndex) {
-        char key[16] = {};
-        if (!BuildRelayWeightKey(relayIndex, key, sizeof(key))) {
-            return ESP_ERR_INVALID_ARG;
-        }
         double value = relayPWMWeights[static_cast<std::size_t>(relayIndex)];
-        err = this->nvs_get_double(m_handle, key, &value);
+        err = this->nvs_get_double(m_handle, KEY_RELAY_WEIGHTS[relayIndex], &value);
         if (err == ESP_OK) {
             relayPWMWeights[static_cast<std::size_t>(relayIndex)] = std::clamp(value, 0.0, 1.0);
         } else if (err != ESP_ERR_NVS_NOT_FOUND) {
@@ -244,6 +436,20 @@ esp_err_t SettingsManager::LoadSettings() {
         return err;
     }
 
+    err = nvs_get_u8(m_handle, KEY_RELAY_DRIVE_MODE, &relayDriveMode);
+    if (err == ESP_OK) {
+        relayDriveMode = relayDriveMode > 1 ? 0 : relayDriveMode;
+    } else if (err != ESP_ERR_NVS_NOT_FOUND) {
+        return err;
+    }
+
+    err = nvs_get_u8(m_handle, KEY_MAINS_FREQUENCY, &mainsFrequencyHz);
+    if (err == ESP_OK) {
+        mainsFrequencyHz = (mainsFrequencyHz == 60) ? 60 : 50;
+    } else if (err != ESP_ERR_NVS_NOT_FOUND) {
+        return err;
+    }
+
     size_t requiredSize = 0;
     err = nvs_get_str(m_handle, KEY_TIMEZONE, nullptr, &requiredSize);
     if (err == ESP_OK && requiredSize > 0) {
@@ -347,59 +553,156 @@ esp_err_t SettingsManager::LoadSettings() {
         return err;
     }
 
+    err = nvs_get_i32(m_handle, KEY_CONTROL_TICK, &controlTickMs);
+    if (err == ESP_OK) {
+        if (controlTickMs != 0) {
+            controlTickMs = std::clamp<int32_t>(controlTickMs, 50, 1000);
+        }
+    } else if (err != ESP_ERR_NVS_NOT_FOUND) {
+        return err;
+    }
+
+    err = nvs_get_u8(m_handle, KEY_FF_ENABLED, &feedforwardEnabled);
+    if (err == ESP_OK) {
+        feedforwardEnabled = feedforwardEnabled ? 1 : 0;
+    } else if (err != ESP_ERR_NVS_NOT_FOUND) {
+        return err;
+    }
+
+    err = this->nvs_get_double(m_handle, KEY_FF_LOOKAHEAD, &feedforwardLookaheadS);
+    if (err == ESP_OK) {
+        feedforwardLookaheadS = std::clamp(feedforwardLookaheadS, 0.0, 600.0);
+    } else if (err != ESP_ERR_NVS_NOT_FOUND) {
+        return err;
+    }
+
+    err = this->nvs_get_double(m_handle, KEY_FF_GAIN, &feedforwardGain);
+    if (err == ESP_OK) {
+        feedforwardGain = std::clamp(feedforwardGain, 0.0, 2.0);
+    } else if (err != ESP_ERR_NVS_NOT_FOUND) {
+        return err;
+    }
+
+    err = this->nvs_get_double(m_handle, KEY_MODEL_GAIN, &thermalModelGainCPerPct);
+    if (err == ESP_OK) {
+        thermalModelGainCPerPct = std::max(thermalModelGainCPerPct, 0.0);
+    } else if (err != ESP_ERR_NVS_NOT_FOUND) {
+        return err;
+    }
+
+    err = this->nvs_get_double(m_handle, KEY_MODEL_TAU, &thermalModelTimeConstantS);
+    if (err == ESP_OK) {
+        thermalModelTimeConstantS = std::max(thermalModelTimeConstantS, 0.0);
+    } else if (err != ESP_ERR_NVS_NOT_FOUND) {
+        return err;
+    }
+
+    err = this->nvs_get_double(m_handle, KEY_MODEL_AMBIENT, &thermalModelAmbientC);
+    if (err != ESP_OK && err != ESP_ERR_NVS_NOT_FOUND) {
+        return err;
+    }
+
+    err = nvs_get_u8(m_handle, KEY_ZONE_COUNT, &controlZoneCount);
+    if (err == ESP_OK) {
+        controlZoneCount = std::clamp<uint8_t>(controlZoneCount, 1, 4);
+    } else if (err != ESP_ERR_NVS_NOT_FOUND) {
+        return err;
+    }
+
+    err = nvs_get_i32(m_handle, KEY_ZONE_INPUTS, &zoneInputMasks);
+    if (err != ESP_OK && err != ESP_ERR_NVS_NOT_FOUND) {
+        return err;
+    }
+
+    err = nvs_get_i32(m_handle, KEY_ZONE_RELAYS, &zoneRelayMasks);
+    if (err != ESP_OK && err != ESP_ERR_NVS_NOT_FOUND) {
+        return err;
+    }
+
+    err = nvs_get_u8(m_handle, KEY_PV_FILTER_MODE, &processValueFilterMode);
+    if (err == ESP_OK) {
+        processValueFilterMode = processValueFilterMode > 1 ? 0 : processValueFilterMode;
+    } else if (err != ESP_ERR_NVS_NOT_FOUND) {
+        return err;
+    }
+
+    err = nvs_get_u8(m_handle, KEY_PV_REJECT, &outlierRejectionEnabled);
+    if (err == ESP_OK) {
+        outlierRejectionEnabled = outlierRejectionEnabled ? 1 : 0;
+    } else if (err != ESP_ERR_NVS_NOT_FOUND) {
+        return err;
+    }
+
+    err = nvs_get_u8(m_handle, KEY_PV_RATE_DERIV, &derivativeFromRate);
+    if (err == ESP_OK) {
+        derivativeFromRate = derivativeFromRate ? 1 : 0;
+    } else if (err != ESP_ERR_NVS_NOT_FOUND) {
+        return err;
+    }
+
+    for (int channel = 0; channel < 4; ++channel) {
+        double value = inputWeights[static_cast<std::size_t>(channel)];
+        err = this->nvs_get_double(m_handle, KEY_INPUT_WEIGHTS[channel], &value);
+        if (err == ESP_OK) {
+            inputWeights[static_cast<std::size_t>(channel)] = std::clamp(value, 0.0, 1.0);
+        } else if (err != ESP_ERR_NVS_NOT_FOUND) {
+            return err;
+        }
+    }
+
     return ESP_OK;
 }
 
 esp_err_t SettingsManager::SetInputFilterTime(double newValue) {
     inputFilterTime = newValue;
-    return NVS_Set_Double(KEY_INPUT_FILTER_TIME, inputFilterTime);
+    return StageDouble(KEY_INPUT_FILTER_TIME, inputFilterTime);
 }
 
 esp_err_t SettingsManager::SetInputsIncludedMask(uint8_t newValue) {
     inputsIncludedMask = newValue;
-    return NVS_Set_U8(KEY_INPUTS_INCLUDED, inputsIncludedMask);
+    return StageU8(KEY_INPUTS_INCLUDED, inputsIncludedMask);
 }
 
 esp_err_t SettingsManager::SetHeatingProportionalGain(double newValue) {
     heatingProportionalGain = newValue;
-    esp_err_t err = NVS_Set_Double(KEY_HEAT_KP, heatingProportionalGain);
+    esp_err_t err = StageDouble(KEY_HEAT_KP, heatingProportionalGain);
     if (err != ESP_OK) {
         return err;
     }
-    return NVS_Set_Double(KEY_PROPORTIONAL_GAIN, heatingProportionalGain);
+    return StageDouble(KEY_PROPORTIONAL_GAIN, heatingProportionalGain);
 }
 
 esp_err_t SettingsManager::SetHeatingIntegralGain(double newValue) {
     heatingIntegralGain = newValue;
-    esp_err_t err = NVS_Set_Double(KEY_HEAT_KI, heatingIntegralGain);
+    esp_err_t err = StageDouble(KEY_HEAT_KI, heatingIntegralGain);
     if (err != ESP_OK) {
         return err;
     }
-    return NVS_Set_Double(KEY_INTEGRAL_GAIN, heatingIntegralGain);
+    return StageDouble(KEY_INTEGRAL_GAIN, heatingIntegralGain);
 }
 
 esp_err_t SettingsManager::SetHeatingDerivativeGain(double newValue) {
     heatingDerivativeGain = newValue;
-    esp_err_t err = NVS_Set_Double(KEY_HEAT_KD, heatingDerivativeGain);
+    esp_err_t err = StageDouble(KEY_HEAT_KD, heatingDerivativeGain);
     if (err != ESP_OK) {
         return err;
     }
-    return NVS_Set_Double(KEY_DERIVATIVE_GAIN, heatingDerivativeGain);
+    return StageDouble(KEY_DERIVATIVE_GAIN, heatingDerivativeGain);
 }
 
 esp_err_t SettingsManager::SetCoolingProportionalGain(double newValue) {
     coolingProportionalGain = newValue;
-    return NVS_Set_Double(KEY_COOL_KP, coolingProportionalGain);
+    return StageDouble(KEY_COOL_KP, coolingProportionalGain);
 }
 
 esp_err_t SettingsManager::SetCoolingIntegralGain(double newValue) {
     coolingIntegralGain = newValue;
-    return NVS_Set_Double(KEY_COOL_KI, coolingIntegralGain);
+    return StageDouble(KEY_COOL_KI, coolingIntegralGain);
 }
 
 esp_err_t SettingsManager::SetCoolingDerivativeGain(double newValue) {
     coolingDerivativeGain = newValue;
-    return NVS_Set_Double(KEY_COOL_KD, coolingDerivativeGain);
+    return StageDouble(KEY_COOL_KD, coolingDerivativeGain);
 }
 
 esp_err_t SettingsManager::SetProportionalGain(double newValue) {
@@ -416,12 +719,12 @@ esp_err_t SettingsManager::SetDerivativeGain(double newValue) {
 
 esp_err_t SettingsManager::SetDerivativeFilterTime(double newValue) {
     derivativeFilterTime = newValue;
-    return NVS_Set_Double(KEY_DERIV_FILTER_TIME, derivativeFilterTime);
+    return StageDouble(KEY_DERIV_FILTER_TIME, derivativeFilterTime);
 }
 
 esp_err_t SettingsManager::SetSetpointWeight(double newValue) {
     setpointWeight = newValue;
-    return NVS_Set_Double(KEY_SETPOINT_WEIGHT, setpointWeight);
+    return StageDouble(KEY_SETPOINT_WEIGHT, setpointWeight);
 }
 
 esp_err_t SettingsManager::SetIntegralZoneC(double newValue) {
@@ -429,7 +732,7 @@ esp_err_t SettingsManager::SetIntegralZoneC(double newValue) {
         return ESP_ERR_INVALID_ARG;
     }
     integralZoneC = newValue;
-    return NVS_Set_Double(KEY_I_ZONE_C, integralZoneC);
+    return StageDouble(KEY_I_ZONE_C, integralZoneC);
 }
 
 esp_err_t SettingsManager::SetIntegralLeakTimeSeconds(double newValue) {
@@ -437,12 +740,12 @@ esp_err_t SettingsManager::SetIntegralLeakTimeSeconds(double newValue) {
         return ESP_ERR_INVALID_ARG;
     }
     integralLeakTimeSeconds = newValue;
-    return NVS_Set_Double(KEY_I_LEAK_S, integralLeakTimeSeconds);
+    return StageDouble(KEY_I_LEAK_S, integralLeakTimeSeconds);
 }
 
 esp_err_t SettingsManager::SetRelaysPWMMask(uint8_t newValue) {
     relaysPWMMask = newValue;
-    return NVS_Set_U8(KEY_RELAYS_PWM, relaysPWMMask);
+    return StageU8(KEY_RELAYS_PWM, relaysPWMMask);
 }
 
 double SettingsManager::GetRelayPWMWeight(int relayIndex) const {
@@ -458,13 +761,7 @@ esp_err_t SettingsManager::SetRelayPWMWeight(int relayIndex, double newValue) {
     }
 
     relayPWMWeights[static_cast<std::size_t>(relayIndex)] = std::clamp(newValue, 0.0, 1.0);
-
-    char key[16] = {};
-    if (!BuildRelayWeightKey(relayIndex, key, sizeof(key))) {
-        return ESP_ERR_INVALID_ARG;
-    }
-
-    return NVS_Set_Double(key, relayPWMWeights[static_cast<std::size_t>(relayIndex)]);
+    return StageDouble(KEY_RELAY_WEIGHTS[relayIndex], relayPWMWeights[static_cast<std::size_t>(relayIndex)]);
 }
 
 esp_err_t SettingsManager::SetRelayPWMWeights(const std::array<double, 8>& newValues) {
@@ -477,34 +774,50 @@ esp_err_t SettingsManager::SetRelayPWMWeights(const std::array<double, 8>& newVa
     return ESP_OK;
 }
 
+esp_err_t SettingsManager::SetRelayDriveMode(uint8_t newValue) {
+    if (newValue > 1) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    relayDriveMode = newValue;
+    return StageU8(KEY_RELAY_DRIVE_MODE, relayDriveMode);
+}
+
+esp_err_t SettingsManager::SetMainsFrequencyHz(uint8_t newValue) {
+    if (newValue != 50 && newValue != 60) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    mainsFrequencyHz = newValue;
+    return StageU8(KEY_MAINS_FREQUENCY, mainsFrequencyHz);
+}
+
 esp_err_t SettingsManager::SetRelaysOnMask(uint8_t newValue) {
     relaysOnMask = newValue;
-    return NVS_Set_U8(KEY_RELAYS_ON, relaysOnMask);
+    return StageU8(KEY_RELAYS_ON, relaysOnMask);
 }
 
 esp_err_t SettingsManager::SetTimeZone(const std::string& newValue) {
     timeZone = newValue;
-    return NVS_Set_String(KEY_TIMEZONE, timeZone);
+    return StageString(KEY_TIMEZONE, timeZone);
 }
 
 esp_err_t SettingsManager::SetWiFiSSID(const std::string& newValue) {
     wifiSSID = newValue;
-    return NVS_Set_String(KEY_WIFI_SSID, wifiSSID);
+    return StageString(KEY_WIFI_SSID, wifiSSID);
 }
 
 esp_err_t SettingsManager::SetWiFiPassword(const std::string& newValue) {
     wifiPassword = newValue;
-    return NVS_Set_String(KEY_WIFI_PASSWORD, wifiPassword);
+    return StageString(KEY_WIFI_PASSWORD, wifiPassword);
 }
 
 esp_err_t SettingsManager::SetDataLogIntervalMs(int32_t newValue) {
     dataLogIntervalMs = newValue;
-    return NVS_Set_I32(KEY_DATA_LOG_INTERVAL, dataLogIntervalMs);
+    return StageI32(KEY_DATA_LOG_INTERVAL, dataLogIntervalMs);
 }
 
 esp_err_t SettingsManager::SetMaxDataLogTimeMs(int32_t newValue) {
     maxDataLogTimeMs = newValue;
-    return NVS_Set_I32(KEY_MAX_DATA_LOG_TIME, maxDataLogTimeMs);
+    return StageI32(KEY_MAX_DATA_LOG_TIME, maxDataLogTimeMs);
 }
 
 esp_err_t SettingsManager::SetDoorClosedAngleDeg(double newValue) {
@@ -512,7 +825,7 @@ esp_err_t SettingsManager::SetDoorClosedAngleDeg(double newValue) {
         return ESP_ERR_INVALID_ARG;
     }
     doorClosedAngleDeg = newValue;
-    return NVS_Set_Double(KEY_DOOR_CLOSED_ANGLE, doorClosedAngleDeg);
+    return StageDouble(KEY_DOOR_CLOSED_ANGLE, doorClosedAngleDeg);
 }
 
 esp_err_t SettingsManager::SetDoorOpenAngleDeg(double newValue) {
@@ -520,7 +833,7 @@ esp_err_t SettingsManager::SetDoorOpenAngleDeg(double newValue) {
         return ESP_ERR_INVALID_ARG;
     }
     doorOpenAngleDeg = newValue;
-    return NVS_Set_Double(KEY_DOOR_OPEN_ANGLE, doorOpenAngleDeg);
+    return StageDouble(KEY_DOOR_OPEN_ANGLE, doorOpenAngleDeg);
 }
 
 esp_err_t SettingsManager::SetDoorMaxSpeedDegPerSec(double newValue) {
@@ -528,7 +841,7 @@ esp_err_t SettingsManager::SetDoorMaxSpeedDegPerSec(double newValue) {
         return ESP_ERR_INVALID_ARG;
     }
     doorMaxSpeedDegPerSec = newValue;
-    return NVS_Set_Double(KEY_DOOR_MAX_SPEED, doorMaxSpeedDegPerSec);
+    return StageDouble(KEY_DOOR_MAX_SPEED, doorMaxSpeedDegPerSec);
 }
 
 esp_err_t SettingsManager::SetCoolOnBandC(double newValue) {
@@ -536,7 +849,7 @@ esp_err_t SettingsManager::SetCoolOnBandC(double newValue) {
         return ESP_ERR_INVALID_ARG;
     }
     coolOnBandC = newValue;
-    return NVS_Set_Double(KEY_COOL_ON_BAND, coolOnBandC);
+    return StageDouble(KEY_COOL_ON_BAND, coolOnBandC);
 }
 
 esp_err_t SettingsManager::SetCoolOffBandC(double newValue) {
@@ -544,7 +857,7 @@ esp_err_t SettingsManager::SetCoolOffBandC(double newValue) {
         return ESP_ERR_INVALID_ARG;
     }
     coolOffBandC = newValue;
-    return NVS_Set_Double(KEY_COOL_OFF_BAND, coolOffBandC);
+    return StageDouble(KEY_COOL_OFF_BAND, coolOffBandC);
 }
 
 esp_err_t SettingsManager::SetHeaterMinValuePct(double newValue) {
@@ -552,7 +865,7 @@ esp_err_t SettingsManager::SetHeaterMinValuePct(double newValue) {
         return ESP_ERR_INVALID_ARG;
     }
     heaterMinValuePct = newValue;
-    return NVS_Set_Double(KEY_HEATER_MIN_VALUE, heaterMinValuePct);
+    return StageDouble(KEY_HEATER_MIN_VALUE, heaterMinValuePct);
 }
 
 esp_err_t SettingsManager::SetForceHeaterOnBelowC(double newValue) {
@@ -560,5 +873,108 @@ esp_err_t SettingsManager::SetForceHeaterOnBelowC(double newValue) {
         return ESP_ERR_INVALID_ARG;
     }
     forceHeaterOnBelowC = newValue;
-    return NVS_Set_Double(KEY_FORCE_HEATER_BELOW, forceHeaterOnBelowC);
+    return StageDouble(KEY_FORCE_HEATER_BELOW, forceHeaterOnBelowC);
+}
+
+esp_err_t SettingsManager::SetControlTickMs(int32_t newValue) {
+    if (newValue != 0 && (newValue < 50 || newValue > 1000)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    controlTickMs = newValue;
+    return StageI32(KEY_CONTROL_TICK, controlTickMs);
+}
+
+esp_err_t SettingsManager::SetFeedforwardEnabled(bool newValue) {
+    feedforwardEnabled = newValue ? 1 : 0;
+    return StageU8(KEY_FF_ENABLED, feedforwardEnabled);
+}
+
+esp_err_t SettingsManager::SetFeedforwardLookaheadS(double newValue) {
+    if (newValue < 0.0 || newValue > 600.0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    feedforwardLookaheadS = newValue;
+    return StageDouble(KEY_FF_LOOKAHEAD, feedforwardLookaheadS);
+}
+
+esp_err_t SettingsManager::SetFeedforwardGain(double newValue) {
+    if (newValue < 0.0 || newValue > 2.0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    feedforwardGain = newValue;
+    return StageDouble(KEY_FF_GAIN, feedforwardGain);
+}
+
+esp_err_t SettingsManager::SetThermalModelGainCPerPct(double newValue) {
+    if (newValue < 0.0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    thermalModelGainCPerPct = newValue;
+    return StageDouble(KEY_MODEL_GAIN, thermalModelGainCPerPct);
+}
+
+esp_err_t SettingsManager::SetThermalModelTimeConstantS(double newValue) {
+    if (newValue < 0.0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    thermalModelTimeConstantS = newValue;
+    return StageDouble(KEY_MODEL_TAU, thermalModelTimeConstantS);
+}
+
+esp_err_t SettingsManager::SetThermalModelAmbientC(double newValue) {
+    thermalModelAmbientC = newValue;
+    return StageDouble(KEY_MODEL_AMBIENT, thermalModelAmbientC);
+}
+
+esp_err_t SettingsManager::SetControlZoneCount(uint8_t newValue) {
+    if (newValue < 1 || newValue > 4) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    controlZoneCount = newValue;
+    return StageU8(KEY_ZONE_COUNT, controlZoneCount);
+}
+
+esp_err_t SettingsManager::SetZoneInputMasks(uint32_t newValue) {
+    zoneInputMasks = static_cast<int32_t>(newValue);
+    return StageI32(KEY_ZONE_INPUTS, zoneInputMasks);
+}
+
+esp_err_t SettingsManager::SetZoneRelayMasks(uint32_t newValue) {
+    zoneRelayMasks = static_cast<int32_t>(newValue);
+    return StageI32(KEY_ZONE_RELAYS, zoneRelayMasks);
+}
+
+esp_err_t SettingsManager::SetProcessValueFilterMode(uint8_t newValue) {
+    if (newValue > 1) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    processValueFilterMode = newValue;
+    return StageU8(KEY_PV_FILTER_MODE, processValueFilterMode);
+}
+
+esp_err_t SettingsManager::SetOutlierRejectionEnabled(bool newValue) {
+    outlierRejectionEnabled = newValue ? 1 : 0;
+    return StageU8(KEY_PV_REJECT, outlierRejectionEnabled);
+}
+
+esp_err_t SettingsManager::SetDerivativeFromRate(bool newValue) {
+    derivativeFromRate = newValue ? 1 : 0;
+    return StageU8(KEY_PV_RATE_DERIV, derivativeFromRate);
+}
+
+esp_err_t SettingsManager::SetInputWeights(const std::array<double, 4>& newValues) {
+    for (int channel = 0; channel < 4; ++channel) {
+        const double value = newValues[static_cast<std::size_t>(channel)];
+        if (value < 0.0 || value > 1.0) {
+            return ESP_ERR_INVALID_ARG;
+        }
+    }
+    for (int channel = 0; channel < 4; ++channel) {
+        inputWeights[static_cast<std::size_t>(channel)] = newValues[static_cast<std::size_t>(channel)];
+        esp_err_t err = StageDouble(KEY_INPUT_WEIGHTS[channel], inputWeights[static_cast<std::size_t>(channel)]);
+        if (err != ESP_OK) {
+            return err;
+        }
+    }
+    return ESP_OK;
 }
@@ -0,0 +1,125 @@
+#include "SystemProfiler.hpp"
+
+#include "ScopedLock.hpp"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+constexpr const char* TAG = "SystemProfiler";
+constexpr UBaseType_t TASK_BUFFER_SLACK = 4; // Room for tasks created between the count and the snapshot
+
+HeapProfile CaptureHeap(uint32_t caps) {
+    HeapProfile heap;
+    heap.totalBytes = heap_caps_get_total_size(caps);
+    heap.freeBytes = heap_caps_get_free_size(caps);
+    heap.minFreeBytes = heap_caps_get_minimum_free_size(caps);
+    heap.largestFreeBlock = heap_caps_get_largest_free_block(caps);
+    return heap;
+}
+}
+
+SystemProfiler* SystemProfiler::instance = nullptr;
+
+SystemProfiler& SystemProfiler::getInstance() {
+    if (instance == nullptr) {
+        instance = new SystemProfiler();
+    }
+    return *instance;
+}
+
+SystemProfiler::SystemProfiler() {
+    profileMutex = xSemaphoreCreateMutex();
+}
+
+SystemProfile SystemProfiler::Capture() {
+    ScopedLock lock(profileMutex);
+    const int64_t nowUs = esp_timer_get_time();
+    if (!hasSample || nowUs - lastSampleUs >= MIN_WINDOW_US) {
+        SampleLocked(nowUs);
+    }
+    return latest;
+}
+
+void SystemProfiler::RecordHttpdWork(uint32_t busyUs) {
+    ScopedLock lock(profileMutex);
+    httpdRequests++;
+    httpdBusyUs += busyUs;
+    httpdWorstUs = std::max(httpdWorstUs, busyUs);
+}
+
+void SystemProfiler::SampleLocked(int64_t nowUs) {
+    SystemProfile profile;
+    profile.capturedUs = nowUs;
+    profile.windowUs = hasSample ? nowUs - lastSampleUs : 0;
+    profile.internalHeap = CaptureHeap(MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    profile.psramHeap = CaptureHeap(MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+
+#if configUSE_TRACE_FACILITY
+    configRUN_TIME_COUNTER_TYPE totalRunTime = 0;
+    statusBuffer.resize(uxTaskGetNumberOfTasks() + TASK_BUFFER_SLACK);
+    const UBaseType_t count = uxTaskGetSystemState(statusBuffer.data(), statusBuffer.size(), &totalRunTime);
+    const configRUN_TIME_COUNTER_TYPE totalDelta = totalRunTime - previousTotalRunTime;
+#if configGENERATE_RUN_TIME_STATS
+    profile.runtimeStats = true;
+#endif
+
+    // Every task keeps its run-time entry so CPU shares stay right; only the
+    // first MAX_TASKS are listed in the profile.
+    runTimes.resize(count);
+    for (UBaseType_t i = 0; i < count; ++i) {
+        const TaskStatus_t& status = statusBuffer[i];
+        runTimes[i].taskNumber = status.xTaskNumber;
+        runTimes[i].runTime = status.ulRunTimeCounter;
+        if (i >= SystemProfile::MAX_TASKS) {
+            continue;
+        }
+
+        TaskProfile& task = profile.tasks[i];
+        std::strncpy(task.name, status.pcTaskName, sizeof(task.name) - 1);
+        task.priority = status.uxCurrentPriority;
+        const BaseType_t core = xTaskGetCoreID(status.xHandle);
+        task.core = (core == tskNO_AFFINITY) ? -1 : static_cast<int>(core);
+        task.stackFreeMinBytes = status.usStackHighWaterMark; // StackType_t is a byte on ESP-IDF
+        if (!hasSample || totalDelta == 0) {
+            continue;
+        }
+        // A task without a previous entry started inside the window.
+        configRUN_TIME_COUNTER_TYPE previous = 0;
+        for (const RunTimeEntry& entry : previousRunTimes) {
+            if (entry.taskNumber == status.xTaskNumber) {
+                previous = entry.runTime;
+                break;
+            }
+        }
+        const configRUN_TIME_COUNTER_TYPE taskDelta = status.ulRunTimeCounter - previous;
+        task.cpuPct = static_cast<float>(100.0 * static_cast<double>(taskDelta) / static_cast<double>(totalDelta));
+    }
+    profile.taskCount = std::min<std::size_t>(count, SystemProfile::MAX_TASKS);
+    profile.omittedTasks = count - profile.taskCount;
+    if (profile.omittedTasks > 0 && !loggedOmittedTasks) {
+        ESP_LOGW(TAG, "%u tasks running, profiling only the first %u",
+            static_cast<unsigned>(count), static_cast<unsigned>(SystemProfile::MAX_TASKS));
+        loggedOmittedTasks = true;
+    }
+    std::swap(previousRunTimes, runTimes);
+    previousTotalRunTime = totalRunTime;
+#endif
+
+    profile.httpdRequests = httpdRequests;
+    profile.httpdBusyUs = static_cast<uint32_t>(std::min<uint64_t>(httpdBusyUs, UINT32_MAX));
+    profile.httpdWorstUs = httpdWorstUs;
+    if (profile.windowUs > 0) {
+        profile.httpdBusyPct = static_cast<float>(100.0 * static_cast<double>(httpdBusyUs) / static_cast<double>(profile.windowUs));
+    }
+    httpdRequests = 0;
+    httpdBusyUs = 0;
+    httpdWorstUs = 0;
+
+    latest = profile;
+    hasSample = true;
+    lastSampleUs = nowUs;
+}
@@ -0,0 +1,86 @@
+#include "TelemetryPublisher.hpp"
+
+#include "Controller.hpp"
+#include "HardwareManager.hpp"
+#include "ScopedLock.hpp"
+#include "Tracer.hpp"
+
+#include <cstring>
+
+TelemetryPublisher* TelemetryPublisher::instance = nullptr;
+
+TelemetryPublisher& TelemetryPublisher::getInstance() {
+    if (instance == nullptr) {
+        instance = new TelemetryPublisher();
+    }
+    return *instance;
+}
+
+TelemetryPublisher::TelemetryPublisher() {
+    snapshotMutex = xSemaphoreCreateMutex();
+}
+
+TelemetrySnapshot TelemetryPublisher::CaptureCurrent() {
+    const ControllerSnapshot controller = Controller::getInstance().GetSnapshot();
+    HardwareManager& hardware = HardwareManager::getInstance();
+
+    TelemetrySnapshot snapshot;
+    snapshot.running = controller.running;
+    snapshot.doorOpen = controller.doorOpen;
+    snapshot.alarming = controller.alarming;
+    std::memcpy(snapshot.state, controller.state, sizeof(snapshot.state));
+    snapshot.setPoint = static_cast<float>(controller.setPoint);
+    snapshot.processValue = static_cast<float>(controller.processValue);
+    snapshot.processRate = static_cast<float>(controller.processRateCPerS);
+    snapshot.pidOutput = static_cast<float>(controller.pidOutput);
+    snapshot.pTerm = static_cast<float>(controller.pTerm);
+    snapshot.iTerm = static_cast<float>(controller.iTerm);
+    snapshot.dTerm = static_cast<float>(controller.dTerm);
+    snapshot.feedforward = static_cast<float>(controller.feedforward);
+    snapshot.autotuneState = controller.autotuneState;
+    snapshot.autotuneCycle = controller.autotuneCycle;
+    snapshot.autotuneCycles = controller.autotuneCycles;
+    snapshot.zoneCount = controller.zoneCount;
+    for (uint8_t zone = 0; zone < MAX_CONTROL_ZONES; ++zone) {
+        snapshot.zoneProcessValue[zone] = static_cast<float>(controller.zoneProcessValue[zone]);
+        snapshot.zoneOutput[zone] = static_cast<float>(controller.zoneOutput[zone]);
+    }
+
+    for (int i = 0; i < 4; ++i) {
+        snapshot.temperatures[i] = static_cast<float>(hardware.getThermocoupleValue(i));
+    }
+    snapshot.relayStates = static_cast<uint8_t>(hardware.getRelayStateMask() & 0x3F);
+    snapshot.servoAngle = static_cast<float>(hardware.getServoAngle());
+    return snapshot;
+}
+
+void TelemetryPublisher::Publish(const TelemetrySnapshot& snapshot) {
+    TRACE_SCOPE("TelemetryPublisher::Publish");
+    TaskHandle_t notifyTask = nullptr;
+    {
+        ScopedLock lock(snapshotMutex);
+        latest = snapshot;
+        latest.tick = nextTick++;
+        hasSnapshot = true;
+        notifyTask = subscriber;
+    }
+
+    if (notifyTask != nullptr) {
+        xTaskNotifyGive(notifyTask);
+    }
+}
+
+bool TelemetryPublisher::GetLatest(TelemetrySnapshot& outSnapshot) const {
+    ScopedLock lock(snapshotMutex);
+    if (!hasSnapshot) {
+        return false;
+    }
+
+    outSnapshot = latest;
+    return true;
+}
+
+void TelemetryPublisher::SetSubscriber(TaskHandle_t task) {
+    ScopedLock lock(snapshotMutex);
+    subscriber = task;
+}
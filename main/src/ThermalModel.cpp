@@ -0,0 +1,217 @@
+#include "ThermalModel.hpp"
+
+#include "DataManager.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace {
+constexpr std::size_t MAX_FIT_POINTS = 3600; // An hour at the default 1 s log interval
+constexpr std::size_t MIN_FIT_SAMPLES = 60;
+constexpr std::size_t READ_BATCH = 16;
+constexpr double SLOPE_HALF_WINDOW_S = 5.0; // dT/dt is a central difference over +/- this
+constexpr double MAX_DEAD_TIME_S = 120.0;
+constexpr double DEAD_TIME_STEP_S = 2.0;
+constexpr double MIN_OUTPUT_STDDEV_PCT = 5.0; // Below this the heater never moved enough to fit K
+constexpr double MIN_TIME_CONSTANT_S = 1.0;
+constexpr double MAX_TIME_CONSTANT_S = 100000.0;
+
+// Normal equations of the 3-parameter regression y = a*u + b*T + c.
+struct RegressionSums {
+    double n = 0.0;
+    double u = 0.0, t = 0.0, y = 0.0;
+    double uu = 0.0, ut = 0.0, tt = 0.0;
+    double uy = 0.0, ty = 0.0, yy = 0.0;
+
+    void Add(double ui, double ti, double yi) {
+        n += 1.0;
+        u += ui; t += ti; y += yi;
+        uu += ui * ui; ut += ui * ti; tt += ti * ti;
+        uy += ui * yi; ty += ti * yi; yy += yi * yi;
+    }
+};
+
+// Gaussian elimination with partial pivoting; false if singular.
+bool Solve3(double m[3][4], double out[3]) {
+    for (int col = 0; col < 3; ++col) {
+        int pivot = col;
+        for (int row = col + 1; row < 3; ++row) {
+            if (std::fabs(m[row][col]) > std::fabs(m[pivot][col])) {
+                pivot = row;
+            }
+        }
+        if (std::fabs(m[pivot][col]) < 1e-12) {
+            return false;
+        }
+        if (pivot != col) {
+            for (int k = 0; k < 4; ++k) {
+                std::swap(m[col][k], m[pivot][k]);
+            }
+        }
+        for (int row = col + 1; row < 3; ++row) {
+            const double factor = m[row][col] / m[col][col];
+            for (int k = col; k < 4; ++k) {
+                m[row][k] -= factor * m[col][k];
+            }
+        }
+    }
+    for (int row = 2; row >= 0; --row) {
+        double value = m[row][3];
+        for (int k = row + 1; k < 3; ++k) {
+            value -= m[row][k] * out[k];
+        }
+        out[row] = value / m[row][row];
+    }
+    return true;
+}
+}
+
+double ThermalModel::FeedforwardOutputPct(double setPointC, double rateCPerS) const {
+    if (!IsValid()) {
+        return 0.0;
+    }
+    const double output = ((setPointC - ambientC) + timeConstantS * rateCPerS) / gainCPerPct;
+    return std::clamp(output, 0.0, 100.0);
+}
+
+esp_err_t FitThermalModel(const float* processValueC,
+                          const float* outputPct,
+                          const uint16_t* segment,
+                          std::size_t count,
+                          double sampleIntervalS,
+                          ThermalModelFit& outFit) {
+    if (processValueC == nullptr || outputPct == nullptr || segment == nullptr || sampleIntervalS <= 0.0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    const std::size_t halfWindow = std::max<std::size_t>(1, static_cast<std::size_t>(std::lround(SLOPE_HALF_WINDOW_S / sampleIntervalS)));
+    const std::size_t maxLag = static_cast<std::size_t>(MAX_DEAD_TIME_S / sampleIntervalS);
+    const std::size_t lagStep = std::max<std::size_t>(1, static_cast<std::size_t>(std::lround(DEAD_TIME_STEP_S / sampleIntervalS)));
+    const double slopeSpanS = 2.0 * static_cast<double>(halfWindow) * sampleIntervalS;
+
+    bool found = false;
+    double bestMse = 0.0;
+    for (std::size_t lag = 0; lag <= maxLag; lag += lagStep) {
+        RegressionSums sums;
+        const std::size_t first = std::max(halfWindow, lag);
+        for (std::size_t k = first; k + halfWindow < count; ++k) {
+            const uint16_t seg = segment[k];
+            if (segment[k - first] != seg || segment[k + halfWindow] != seg) {
+                continue;
+            }
+            const double slope = (processValueC[k + halfWindow] - processValueC[k - halfWindow]) / slopeSpanS;
+            sums.Add(outputPct[k - lag], processValueC[k], slope);
+        }
+        if (sums.n < static_cast<double>(MIN_FIT_SAMPLES)) {
+            continue;
+        }
+
+        const double outputVariance = sums.uu / sums.n - (sums.u / sums.n) * (sums.u / sums.n);
+        if (outputVariance < MIN_OUTPUT_STDDEV_PCT * MIN_OUTPUT_STDDEV_PCT) {
+            continue;
+        }
+
+        double m[3][4] = {
+            {sums.uu, sums.ut, sums.u, sums.uy},
+            {sums.ut, sums.tt, sums.t, sums.ty},
+            {sums.u, sums.t, sums.n, sums.y},
+        };
+        double coeffs[3] = {};
+        if (!Solve3(m, coeffs)) {
+            continue;
+        }
+        const double a = coeffs[0];
+        const double b = coeffs[1];
+        const double c = coeffs[2];
+        if (a <= 0.0 || b >= 0.0) {
+            continue; // Heating must raise T and the chamber must lose heat
+        }
+        const double tau = -1.0 / b;
+        if (tau < MIN_TIME_CONSTANT_S || tau > MAX_TIME_CONSTANT_S) {
+            continue;
+        }
+
+        // SSE of a least-squares solution is y'y - coeffs . X'y.
+        const double sse = sums.yy - (a * sums.uy + b * sums.ty + c * sums.y);
+        const double mse = std::max(sse, 0.0) / sums.n;
+        if (found && mse >= bestMse) {
+            continue;
+        }
+
+        found = true;
+        bestMse = mse;
+        outFit.model.timeConstantS = tau;
+        outFit.model.gainCPerPct = a * tau;
+        outFit.model.ambientC = c * tau;
+        outFit.deadTimeS = static_cast<double>(lag) * sampleIntervalS;
+        outFit.rmseCPerS = std::sqrt(mse);
+        outFit.samples = static_cast<std::size_t>(sums.n);
+    }
+
+    if (found) {
+        return ESP_OK;
+    }
+    // Distinguish "too little history" from "history that cannot be fitted".
+    return count < MIN_FIT_SAMPLES + 2 * halfWindow ? ESP_ERR_NOT_FOUND : ESP_ERR_INVALID_STATE;
+}
+
+esp_err_t FitThermalModelFromHistory(ThermalModelFit& outFit) {
+    DataManager& dataManager = DataManager::getInstance();
+    int intervalMs = 0;
+    uint64_t intervalStartSequence = 0;
+    dataManager.GetDataLogInterval(intervalMs, intervalStartSequence);
+    const double intervalS = static_cast<double>(intervalMs) / 1000.0;
+    if (intervalS <= 0.0) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    std::vector<float, PsramAllocator<float>> processValues;
+    std::vector<float, PsramAllocator<float>> outputs;
+    std::vector<uint16_t, PsramAllocator<uint16_t>> segments;
+    processValues.reserve(MAX_FIT_POINTS);
+    outputs.reserve(MAX_FIT_POINTS);
+    segments.reserve(MAX_FIT_POINTS);
+
+    // A new segment starts at every gap in the log and at every point the model
+    // does not describe: chamber stopped, or the cooling door in use (negative output).
+    // Timestamps are whole seconds, so a gap is anything clearly over one interval.
+    const double maxGapS = 2.0 * intervalS + 1.0;
+    uint16_t segment = 0;
+    bool inSegment = false;
+    uint64_t previousTimestamp = 0;
+
+    // The fit assumes every pair of samples is intervalS apart, so points logged
+    // before the last interval change are left out; whole-second timestamps
+    // cannot tell a 0.5 s spacing from a 1 s one.
+    DataHistoryCursor cursor = dataManager.OpenHistoryCursor(MAX_FIT_POINTS);
+    cursor.next = std::max(cursor.next, intervalStartSequence);
+    DataPoint batch[READ_BATCH];
+    while (true) {
+        const std::size_t read = dataManager.ReadHistoryBatch(cursor, batch, READ_BATCH);
+        if (read == 0) {
+            break;
+        }
+        for (std::size_t i = 0; i < read; ++i) {
+            const DataPoint& point = batch[i];
+            const bool usable = point.chamberRunning && point.PIDOutput >= 0.0f;
+            const bool contiguous = inSegment
+                && static_cast<double>(point.timestamp - previousTimestamp) <= maxGapS;
+            previousTimestamp = point.timestamp;
+            if (!usable) {
+                inSegment = false;
+                continue;
+            }
+            if (!contiguous && !processValues.empty()) {
+                segment++;
+            }
+            inSegment = true;
+            processValues.push_back(point.processValue);
+            outputs.push_back(point.PIDOutput);
+            segments.push_back(segment);
+        }
+    }
+
+    return FitThermalModel(processValues.data(), outputs.data(), segments.data(),
+                           processValues.size(), intervalS, outFit);
+}
@@ -0,0 +1,76 @@
+#include "TickMonitor.hpp"
+
+#include "ScopedLock.hpp"
+#include "esp_timer.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+TickMonitor* TickMonitor::instance = nullptr;
+
+TickMonitor& TickMonitor::getInstance() {
+    if (instance == nullptr) {
+        instance = new TickMonitor();
+    }
+    return *instance;
+}
+
+TickMonitor::TickMonitor() {
+    statsMutex = xSemaphoreCreateMutex();
+    ResetLocked(0);
+}
+
+void TickMonitor::Record(int64_t startUs, uint32_t execUs, uint32_t periodUs) {
+    ScopedLock lock(statsMutex);
+    if (periodUs != stats.periodUs) {
+        ResetLocked(periodUs);
+    }
+
+    stats.ticks++;
+    stats.lastExecUs = execUs;
+    stats.worstExecUs = std::max(stats.worstExecUs, execUs);
+    execSumUs += execUs;
+    stats.meanExecUs = static_cast<uint32_t>(execSumUs / stats.ticks);
+    if (execUs > periodUs) {
+        stats.overruns++;
+    }
+
+    // The first tick after a reset has no previous start to measure against.
+    if (lastStartUs > 0) {
+        const int64_t intervalUs = startUs - lastStartUs;
+        const uint32_t jitterUs = static_cast<uint32_t>(std::min<int64_t>(
+            std::llabs(intervalUs - static_cast<int64_t>(periodUs)), UINT32_MAX));
+        stats.worstJitterUs = std::max(stats.worstJitterUs, jitterUs);
+        if (intervalUs >= 2 * static_cast<int64_t>(periodUs)) {
+            stats.missedDeadlines++;
+        }
+
+        int bucket = TickStats::JITTER_BUCKETS - 1;
+        for (int i = 0; i < TickStats::JITTER_BUCKETS - 1; ++i) {
+            if (jitterUs <= TickStats::JITTER_BUCKET_LIMITS_US[i]) {
+                bucket = i;
+                break;
+            }
+        }
+        stats.jitterHistogram[bucket]++;
+    }
+    lastStartUs = startUs;
+}
+
+TickStats TickMonitor::GetStats() const {
+    ScopedLock lock(statsMutex);
+    return stats;
+}
+
+void TickMonitor::Reset() {
+    ScopedLock lock(statsMutex);
+    ResetLocked(stats.periodUs);
+}
+
+void TickMonitor::ResetLocked(uint32_t periodUs) {
+    stats = TickStats();
+    stats.periodUs = periodUs;
+    stats.sinceUs = esp_timer_get_time();
+    execSumUs = 0;
+    lastStartUs = 0;
+}
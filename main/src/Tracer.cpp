@@ -0,0 +1,128 @@
+#include "Tracer.hpp"
+
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+
+#include <algorithm>
+#include <new>
+
+namespace {
+constexpr const char* TAG = "Tracer";
+
+#if CONFIG_TRACE_ENABLED
+constexpr std::size_t TRACE_BUFFER_EVENTS = CONFIG_TRACE_BUFFER_EVENTS;
+#else
+constexpr std::size_t TRACE_BUFFER_EVENTS = 0;
+#endif
+constexpr double CPU_CYCLES_PER_US = CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ;
+}
+
+Tracer* Tracer::instance = nullptr;
+
+Tracer& Tracer::getInstance() {
+    if (instance == nullptr) {
+        instance = new Tracer();
+    }
+    return *instance;
+}
+
+esp_err_t Tracer::Initialize() {
+    if (events != nullptr) {
+        return ESP_OK;
+    }
+    if (TRACE_BUFFER_EVENTS == 0) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+
+    void* memory = heap_caps_malloc(TRACE_BUFFER_EVENTS * sizeof(Slot), MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (memory == nullptr) {
+        ESP_LOGW(TAG, "No PSRAM for %u trace events", static_cast<unsigned>(TRACE_BUFFER_EVENTS));
+        return ESP_ERR_NO_MEM;
+    }
+    Slot* slots = static_cast<Slot*>(memory);
+    for (std::size_t i = 0; i < TRACE_BUFFER_EVENTS; ++i) {
+        new (&slots[i]) Slot();
+    }
+    capacity = TRACE_BUFFER_EVENTS;
+    events = slots;
+    return ESP_OK;
+}
+
+std::size_t Tracer::GetEventCount() const {
+    return std::min<std::size_t>(head.load(std::memory_order_relaxed), capacity);
+}
+
+void Tracer::Clear() {
+    // Slots keep their old sequence numbers, which no longer match any index
+    // below the reset head, so readers ignore them.
+    head.store(0, std::memory_order_relaxed);
+    for (std::size_t i = 0; i < capacity; ++i) {
+        events[i].sequence.store(0, std::memory_order_relaxed);
+    }
+    frozen.store(false, std::memory_order_release);
+}
+
+void Tracer::Record(const char* name, int64_t startUs, uint32_t startCycles, int startCore) {
+    if (events == nullptr || frozen.load(std::memory_order_relaxed)) {
+        return;
+    }
+
+    const uint32_t endCycles = esp_cpu_get_cycle_count();
+    const int endCore = esp_cpu_get_core_id();
+    // Each core has its own cycle counter; a task that migrated mid-scope
+    // falls back to the coarser esp_timer difference.
+    const uint32_t durationCycles = (endCore == startCore)
+        ? endCycles - startCycles
+        : static_cast<uint32_t>(static_cast<double>(esp_timer_get_time() - startUs) * CPU_CYCLES_PER_US);
+
+    const uint32_t index = head.fetch_add(1, std::memory_order_relaxed);
+    Slot& slot = events[index % capacity];
+    slot.sequence.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.name = name;
+    slot.startUs = startUs;
+    slot.durationCycles = durationCycles;
+    slot.task = xPortInIsrContext() ? nullptr : xTaskGetCurrentTaskHandle();
+    slot.core = static_cast<uint8_t>(startCore);
+    slot.sequence.store(index + 1, std::memory_order_release);
+}
+
+TraceCursor Tracer::OpenCursor() const {
+    TraceCursor cursor;
+    cursor.end = head.load(std::memory_order_acquire);
+    cursor.next = (cursor.end > capacity) ? cursor.end - static_cast<uint32_t>(capacity) : 0;
+    return cursor;
+}
+
+std::size_t Tracer::ReadBatch(TraceCursor& cursor, TraceRecord* out, std::size_t maxRecords) const {
+    if (events == nullptr || out == nullptr) {
+        return 0;
+    }
+
+    // Writers that lapped the cursor have already replaced the oldest slots.
+    const uint32_t newest = head.load(std::memory_order_acquire);
+    if (newest > capacity && cursor.next < newest - capacity) {
+        cursor.next = newest - static_cast<uint32_t>(capacity);
+    }
+
+    std::size_t count = 0;
+    while (count < maxRecords && cursor.next < cursor.end) {
+        const uint32_t index = cursor.next++;
+        const Slot& slot = events[index % capacity];
+        if (slot.sequence.load(std::memory_order_acquire) != index + 1) {
+            continue;
+        }
+        TraceRecord record;
+        record.name = slot.name;
+        record.startUs = slot.startUs;
+        record.durationUs = static_cast<double>(slot.durationCycles) / CPU_CYCLES_PER_US;
+        record.task = slot.task;
+        record.core = slot.core;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) != index + 1) {
+            continue; // Rewritten while copying
+        }
+        out[count++] = record;
+    }
+    return count;
+}
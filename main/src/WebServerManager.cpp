@@ -1,11 +1,22 @@
 
 #include "WebServerManager.hpp"
 
+#include "BinaryCodec.hpp"
+#include "BootTimeline.hpp"
 #include "Controller.hpp"
 #include "DataManager.hpp"
+#include "EmbeddedWebUi.hpp"
 #include "HardwareManager.hpp"
+#include "HistoryBinaryEncoder.hpp"
 #include "PID.hpp"
 #include "ProfileEngine.hpp"
+#include "ProfileSimulator.hpp"
+#include "RunLogManager.hpp"
+#include "SettingsManager.hpp"
+#include "SystemProfiler.hpp"
+#include "TelemetryPublisher.hpp"
+#include "TickMonitor.hpp"
+#include "Tracer.hpp"
 #include "TimeManager.hpp"
 #include "WiFiManager.hpp"
 
@@ -17,23 +28,90 @@
 #include "esp_spiffs.h"
 #include "esp_system.h"
 #include "esp_timer.h"
+#include "lwip/sockets.h"
 
 #include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdint>
 #include <cstdlib>
 #include <cstdio>
 #include <cstring>
+#include <dirent.h>
+#include <new>
 #include <optional>
 #include <string>
 #include <sys/stat.h>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace {
 constexpr const char* TAG = "WebServer";
 constexpr const char* SPIFFS_BASE_PATH = "/spiffs";
 constexpr const char* SPIFFS_PARTITION_LABEL = "spiffs";
-constexpr TickType_t WS_TELEMETRY_PERIOD_TICKS = pdMS_TO_TICKS(500);
-constexpr TickType_t WS_IDLE_PERIOD_TICKS = pdMS_TO_TICKS(1000);
+constexpr TickType_t WS_IDLE_PERIOD_TICKS = pdMS_TO_TICKS(1000); // Wake-up when no controller tick arrives
+constexpr int64_t WS_KEYFRAME_PERIOD_US = 10LL * 1000 * 1000;
+constexpr int64_t WS_DIAGNOSTICS_PERIOD_US = SystemProfiler::MIN_WINDOW_US;
+constexpr float WS_DELTA_EPSILON = 0.005f; // Ignore float changes below display precision
+constexpr double WS_MAX_RATE_HZ = 20.0;
+constexpr int64_t WS_SEND_TIMEOUT_US = 250 * 1000; // A client that can't take one frame in this long is closed
+constexpr uint8_t WS_BINARY_FRAME_VERSION = 2;
+constexpr std::size_t WS_BINARY_FRAME_SIZE = 120;
+constexpr std::size_t HISTORY_STREAM_BATCH_POINTS = 16;
+constexpr std::size_t TRACE_STREAM_BATCH_EVENTS = 32;
+constexpr std::size_t TRACE_MAX_THREADS = 48; // Distinct (core, task) tracks named in an export
+constexpr std::size_t CHUNK_BUFFER_SIZE = 1536;
+constexpr std::size_t STATIC_FILE_CHUNK_BYTES = 8192; // Several SPIFFS pages and TCP segments per send
+constexpr const char* STATIC_IMMUTABLE_PREFIX = "/assets/"; // Vite's content-hashed output
+
+// Coalesces small writes into fixed-size chunks so streamed responses make a
+// bounded number of httpd_resp_send_chunk calls with constant memory.
+class ChunkedResponseWriter {
+public:
+    explicit ChunkedResponseWriter(httpd_req_t* req) : req_(req), used_(0) {}
+
+    esp_err_t Append(const char* data) {
+        return Append(data, std::strlen(data));
+    }
+
+    esp_err_t Append(const char* data, std::size_t len) {
+        if (used_ + len > sizeof(buffer_)) {
+            esp_err_t err = Flush();
+            if (err != ESP_OK) {
+                return err;
+            }
+        }
+        if (len > sizeof(buffer_)) {
+            return httpd_resp_send_chunk(req_, data, static_cast<ssize_t>(len));
+        }
+        std::memcpy(buffer_ + used_, data, len);
+        used_ += len;
+        return ESP_OK;
+    }
+
+    esp_err_t Flush() {
+        if (used_ == 0) {
+            return ESP_OK;
+        }
+        esp_err_t err = httpd_resp_send_chunk(req_, buffer_, static_cast<ssize_t>(used_));
+        used_ = 0;
+        return err;
+    }
+
+    esp_err_t Finish() {
+        esp_err_t err = Flush();
+        if (err != ESP_OK) {
+            return err;
+        }
+        return httpd_resp_send_chunk(req_, nullptr, 0);
+    }
+
+private:
+    httpd_req_t* req_;
+    char buffer_[CHUNK_BUFFER_SIZE];
+    std::size_t used_;
+};
 
 std::string JsonStringFromObject(cJSON* json) {
     if (json == nullptr) {
@@ -71,6 +149,33 @@ bool ParseIntArray(cJSON* arr, std::vector<int>& out) {
     return true;
 }
 
+// Channel indices in [0, maxChannels); duplicates collapse into one bit.
+bool ParseMaskArray(cJSON* arr, int maxChannels, uint8_t& out) {
+    std::vector<int> channels;
+    if (!ParseIntArray(arr, channels)) {
+        return false;
+    }
+
+    out = 0;
+    for (int channel : channels) {
+        if (channel < 0 || channel >= maxChannels) {
+            return false;
+        }
+        out |= static_cast<uint8_t>(1u << channel);
+    }
+    return true;
+}
+
+cJSON* BuildMaskArray(uint8_t mask) {
+    cJSON* arr = cJSON_CreateArray();
+    for (int bit = 0; bit < 8; ++bit) {
+        if ((mask & (1u << bit)) != 0) {
+            cJSON_AddItemToArray(arr, cJSON_CreateNumber(bit));
+        }
+    }
+    return arr;
+}
+
 bool ParseRelayWeightArray(cJSON* arr, std::unordered_map<int, double>& out) {
     if (!cJSON_IsArray(arr)) {
         return false;
@@ -124,6 +229,31 @@ bool ParseSlotPath(const std::string& path, int& outSlot) {
     return true;
 }
 
+std::string SlotIndexRangeMessage() {
+    return "slot index must be in [0," + std::to_string(ProfileEngine::MAX_SLOTS - 1) + "]";
+}
+
+bool ParseRunPath(const std::string& path, uint32_t& outRunId) {
+    constexpr const char* kPrefix = "/api/v1/runs/";
+    if (path.rfind(kPrefix, 0) != 0) {
+        return false;
+    }
+
+    const std::string suffix = path.substr(std::strlen(kPrefix));
+    if (suffix.empty() || suffix.size() > 9) {
+        return false;
+    }
+
+    for (char ch : suffix) {
+        if (ch < '0' || ch > '9') {
+            return false;
+        }
+    }
+
+    outRunId = static_cast<uint32_t>(std::strtoul(suffix.c_str(), nullptr, 10));
+    return true;
+}
+
 std::string BuildValidationMessage(const std::vector<ProfileValidationError>& errors) {
     if (errors.empty()) {
         return "Profile validation failed";
@@ -156,55 +286,456 @@ const char* ContentTypeForPath(const std::string& path) {
     return "application/octet-stream";
 }
 
-cJSON* BuildStatusDataObject() {
-    Controller& controller = Controller::getInstance();
+#if CONFIG_WEBUI_EMBEDDED
+// A UI flashed before CONFIG_WEBUI_EMBEDDED was turned on is still in SPIFFS;
+// removing it hands the space back to run logs. The old image held whatever
+// the frontend build emitted (icons, manifest, fonts...), so everything that
+// is not a run log goes. SPIFFS names are flat, so "assets/..." is a single
+// directory entry.
+void RemoveSpiffsWebUiFiles() {
+    DIR* dir = opendir(SPIFFS_BASE_PATH);
+    if (dir == nullptr) {
+        return;
+    }
+
+    std::vector<std::string> stale;
+    struct dirent* entry = nullptr;
+    while ((entry = readdir(dir)) != nullptr) {
+        uint32_t runId = 0;
+        if (!RunLogManager::ParseRunFileName(entry->d_name, runId)) {
+            stale.push_back(std::string(SPIFFS_BASE_PATH) + "/" + entry->d_name);
+        }
+    }
+    closedir(dir);
+
+    for (const std::string& path : stale) {
+        if (std::remove(path.c_str()) == 0) {
+            ESP_LOGI(TAG, "Removed stale web UI file %s", path.c_str());
+        }
+    }
+}
+#else
+// Strong ETag from the file contents (FNV-1a) and size.
+bool ComputeFileEtag(const std::string& filePath, char* buffer, std::size_t bufferLen, std::string& outEtag) {
+    FILE* file = std::fopen(filePath.c_str(), "rb");
+    if (file == nullptr) {
+        return false;
+    }
+    std::setvbuf(file, nullptr, _IONBF, 0);
+
+    uint32_t hash = 2166136261u;
+    std::size_t totalBytes = 0;
+    std::size_t read = 0;
+    while ((read = std::fread(buffer, 1, bufferLen, file)) > 0) {
+        for (std::size_t i = 0; i < read; ++i) {
+            hash = (hash ^ static_cast<uint8_t>(buffer[i])) * 16777619u;
+        }
+        totalBytes += read;
+    }
+    std::fclose(file);
+
+    char etag[32] = {};
+    std::snprintf(etag, sizeof(etag), "\"%08lx-%lx\"", static_cast<unsigned long>(hash), static_cast<unsigned long>(totalBytes));
+    outEtag = etag;
+    return true;
+}
+#endif
+
+std::string GetRequestHeader(httpd_req_t* req, const char* name) {
+    const std::size_t length = httpd_req_get_hdr_value_len(req, name);
+    if (length == 0) {
+        return std::string();
+    }
+    std::string value(length + 1, '\0');
+    if (httpd_req_get_hdr_value_str(req, name, value.data(), value.size()) != ESP_OK) {
+        return std::string();
+    }
+    value.resize(length);
+    return value;
+}
+
+// Charges the time spent in one httpd callback to the httpd utilisation figure.
+class HttpdWorkScope {
+public:
+    HttpdWorkScope() : startUs_(esp_timer_get_time()) {}
+
+    ~HttpdWorkScope() {
+        SystemProfiler::getInstance().RecordHttpdWork(static_cast<uint32_t>(esp_timer_get_time() - startUs_));
+    }
+
+private:
+    int64_t startUs_;
+};
+
+// Send override for websocket sessions. The default httpd send blocks for the
+// socket's send_wait_timeout (seconds); this gives up after WS_SEND_TIMEOUT_US
+// so one stalled client can only hold up the sender task briefly.
+int WsSessionSend(httpd_handle_t hd, int sockfd, const char* buf, size_t bufLen, int flags) {
+    (void)hd;
+    if (buf == nullptr) {
+        return HTTPD_SOCK_ERR_INVALID;
+    }
+
+    const int64_t deadlineUs = esp_timer_get_time() + WS_SEND_TIMEOUT_US;
+    std::size_t sent = 0;
+    while (sent < bufLen) {
+        const int64_t remainingUs = deadlineUs - esp_timer_get_time();
+        if (remainingUs <= 0) {
+            return HTTPD_SOCK_ERR_TIMEOUT;
+        }
+
+        fd_set writeSet;
+        FD_ZERO(&writeSet);
+        FD_SET(sockfd, &writeSet);
+        struct timeval timeout = {};
+        timeout.tv_sec = static_cast<long>(remainingUs / 1000000);
+        timeout.tv_usec = static_cast<long>(remainingUs % 1000000);
+        const int ready = select(sockfd + 1, nullptr, &writeSet, nullptr, &timeout);
+        if (ready == 0) {
+            return HTTPD_SOCK_ERR_TIMEOUT;
+        }
+        if (ready < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return HTTPD_SOCK_ERR_FAIL;
+        }
+
+        const int written = send(sockfd, buf + sent, bufLen - sent, flags | MSG_DONTWAIT);
+        if (written < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+                continue;
+            }
+            return HTTPD_SOCK_ERR_FAIL;
+        }
+        sent += static_cast<std::size_t>(written);
+    }
+    return static_cast<int>(sent);
+}
+
+TelemetrySnapshot LatestTelemetrySnapshot() {
+    TelemetrySnapshot snapshot;
+    if (!TelemetryPublisher::getInstance().GetLatest(snapshot)) {
+        snapshot = TelemetryPublisher::CaptureCurrent();
+    }
+    return snapshot;
+}
+
+cJSON* BuildTemperaturesArray(const TelemetrySnapshot& snapshot) {
+    cJSON* temperatures = cJSON_CreateArray();
+    for (int i = 0; i < 4; ++i) {
+        cJSON_AddItemToArray(temperatures, cJSON_CreateNumber(snapshot.temperatures[i]));
+    }
+    return temperatures;
+}
+
+// ",\"zones\":[...]" for a multi-zone history point; empty for single-zone
+// points, whose one zone is the top-level PV and output.
+void FormatHistoryZonesJson(const DataPoint& point, char* out, std::size_t size) {
+    out[0] = '\0';
+    if (point.zoneCount <= 1) {
+        return;
+    }
+
+    std::size_t length = 0;
+    for (uint8_t zone = 0; zone < point.zoneCount && zone < MAX_CONTROL_ZONES; ++zone) {
+        const int written = std::snprintf(
+            out + length,
+            size - length,
+            "%s{\"process_value\":%.3f,\"pid_output\":%.3f}",
+            zone == 0 ? ",\"zones\":[" : ",",
+            point.zoneProcessValue[zone],
+            point.zoneOutput[zone]);
+        if (written <= 0 || static_cast<std::size_t>(written) >= size - length) {
+            out[0] = '\0';
+            return;
+        }
+        length += static_cast<std::size_t>(written);
+    }
+    if (length + 1 < size) {
+        out[length] = ']';
+        out[length + 1] = '\0';
+    } else {
+        out[0] = '\0';
+    }
+}
+
+// One entry per control zone; a single-zone controller reports one zone.
+cJSON* BuildZonesArray(const TelemetrySnapshot& snapshot) {
+    cJSON* zones = cJSON_CreateArray();
+    for (uint8_t zone = 0; zone < snapshot.zoneCount && zone < MAX_CONTROL_ZONES; ++zone) {
+        cJSON* zoneObj = cJSON_CreateObject();
+        cJSON_AddNumberToObject(zoneObj, "process_value_c", snapshot.zoneProcessValue[zone]);
+        cJSON_AddNumberToObject(zoneObj, "pid_output", snapshot.zoneOutput[zone]);
+        cJSON_AddItemToArray(zones, zoneObj);
+    }
+    return zones;
+}
+
+cJSON* BuildRelayStatesArray(const TelemetrySnapshot& snapshot) {
+    cJSON* relays = cJSON_CreateArray();
+    for (int i = 0; i < 6; ++i) {
+        cJSON_AddItemToArray(relays, cJSON_CreateBool((snapshot.relayStates & (1 << i)) != 0));
+    }
+    return relays;
+}
+
+const char* AutotuneStateName(AutotuneState state) {
+    switch (state) {
+        case AutotuneState::Running:
+            return "running";
+        case AutotuneState::Complete:
+            return "complete";
+        case AutotuneState::Failed:
+            return "failed";
+        case AutotuneState::Idle:
+        default:
+            return "idle";
+    }
+}
+
+const char* ProcessValueFilterModeName(ProcessValueFilterMode mode) {
+    return mode == ProcessValueFilterMode::AlphaBeta ? "alpha_beta" : "low_pass";
+}
+
+bool ParseProcessValueFilterMode(const char* name, ProcessValueFilterMode& outMode) {
+    if (std::strcmp(name, "low_pass") == 0) {
+        outMode = ProcessValueFilterMode::LowPass;
+        return true;
+    }
+    if (std::strcmp(name, "alpha_beta") == 0) {
+        outMode = ProcessValueFilterMode::AlphaBeta;
+        return true;
+    }
+    return false;
+}
+
+cJSON* BuildAutotuneProgressObject(const TelemetrySnapshot& snapshot) {
+    cJSON* autotuneObj = cJSON_CreateObject();
+    cJSON_AddStringToObject(autotuneObj, "state", AutotuneStateName(snapshot.autotuneState));
+    cJSON_AddNumberToObject(autotuneObj, "cycle", snapshot.autotuneCycle);
+    cJSON_AddNumberToObject(autotuneObj, "cycles", snapshot.autotuneCycles);
+    return autotuneObj;
+}
+
+cJSON* BuildThermalModelObject(const ThermalModel& model) {
+    cJSON* modelObj = cJSON_CreateObject();
+    cJSON_AddBoolToObject(modelObj, "valid", model.IsValid());
+    cJSON_AddNumberToObject(modelObj, "gain_c_per_pct", model.gainCPerPct);
+    cJSON_AddNumberToObject(modelObj, "time_constant_s", model.timeConstantS);
+    cJSON_AddNumberToObject(modelObj, "ambient_c", model.ambientC);
+    return modelObj;
+}
+
+cJSON* BuildControlTickObject(const TickStats& stats, uint32_t configuredIntervalMs) {
+    cJSON* tickObj = cJSON_CreateObject();
+    cJSON_AddStringToObject(tickObj, "mode", configuredIntervalMs == 0 ? "sample" : "fixed");
+    cJSON_AddNumberToObject(tickObj, "tick_ms", configuredIntervalMs);
+    cJSON_AddNumberToObject(tickObj, "period_ms", static_cast<double>(stats.periodUs) / 1000.0);
+    cJSON_AddNumberToObject(tickObj, "ticks", stats.ticks);
+    cJSON_AddNumberToObject(tickObj, "overruns", stats.overruns);
+    cJSON_AddNumberToObject(tickObj, "missed_deadlines", stats.missedDeadlines);
+    cJSON_AddNumberToObject(tickObj, "last_exec_us", stats.lastExecUs);
+    cJSON_AddNumberToObject(tickObj, "worst_exec_us", stats.worstExecUs);
+    cJSON_AddNumberToObject(tickObj, "mean_exec_us", stats.meanExecUs);
+    cJSON_AddNumberToObject(tickObj, "worst_jitter_us", stats.worstJitterUs);
+
+    cJSON* histogram = cJSON_CreateArray();
+    for (int i = 0; i < TickStats::JITTER_BUCKETS; ++i) {
+        cJSON* bucket = cJSON_CreateObject();
+        if (i < TickStats::JITTER_BUCKETS - 1) {
+            cJSON_AddNumberToObject(bucket, "le_us", TickStats::JITTER_BUCKET_LIMITS_US[i]);
+        } else {
+            cJSON_AddNullToObject(bucket, "le_us");
+        }
+        cJSON_AddNumberToObject(bucket, "count", stats.jitterHistogram[i]);
+        cJSON_AddItemToArray(histogram, bucket);
+    }
+    cJSON_AddItemToObject(tickObj, "jitter_histogram", histogram);
+    cJSON_AddNumberToObject(tickObj, "since_us", static_cast<double>(stats.sinceUs));
+    return tickObj;
+}
+
+cJSON* BuildHeapObject(const HeapProfile& heap) {
+    cJSON* heapObj = cJSON_CreateObject();
+    cJSON_AddNumberToObject(heapObj, "total_bytes", static_cast<double>(heap.totalBytes));
+    cJSON_AddNumberToObject(heapObj, "free_bytes", static_cast<double>(heap.freeBytes));
+    cJSON_AddNumberToObject(heapObj, "min_free_bytes", static_cast<double>(heap.minFreeBytes));
+    cJSON_AddNumberToObject(heapObj, "largest_free_block", static_cast<double>(heap.largestFreeBlock));
+    return heapObj;
+}
+
+void AddBootTimeMs(cJSON* obj, const char* name, int64_t timeUs) {
+    if (timeUs > 0) {
+        cJSON_AddNumberToObject(obj, name, static_cast<double>(timeUs) / 1000.0);
+    } else {
+        cJSON_AddNullToObject(obj, name);
+    }
+}
+
+const char* BootStageState(const BootStageTiming& timing) {
+    if (timing.skipped) return "skipped";
+    if (timing.finished) return "done";
+    if (timing.started) return "running";
+    return "pending";
+}
+
+// Times are esp_timer milliseconds since boot.
+cJSON* BuildBootObject(const BootTimelineSnapshot& timeline) {
+    cJSON* bootObj = cJSON_CreateObject();
+    AddBootTimeMs(bootObj, "app_start_ms", timeline.appStartUs);
+    AddBootTimeMs(bootObj, "control_ready_ms", timeline.controlReadyUs);
+    AddBootTimeMs(bootObj, "network_ready_ms", timeline.networkReadyUs);
+
+    cJSON* stages = cJSON_CreateArray();
+    for (std::size_t i = 0; i < BootTimeline::STAGE_COUNT; ++i) {
+        const BootStageTiming& timing = timeline.stages[i];
+        cJSON* stageObj = cJSON_CreateObject();
+        cJSON_AddStringToObject(stageObj, "name", BootTimeline::StageToString(static_cast<BootStage>(i)));
+        cJSON_AddStringToObject(stageObj, "state", BootStageState(timing));
+        AddBootTimeMs(stageObj, "start_ms", timing.started ? timing.startUs : 0);
+        if (timing.finished) {
+            cJSON_AddNumberToObject(stageObj, "duration_ms", static_cast<double>(timing.durationUs) / 1000.0);
+            cJSON_AddStringToObject(stageObj, "result", esp_err_to_name(timing.result));
+        } else {
+            cJSON_AddNullToObject(stageObj, "duration_ms");
+            cJSON_AddNullToObject(stageObj, "result");
+        }
+        cJSON_AddItemToArray(stages, stageObj);
+    }
+    cJSON_AddItemToObject(bootObj, "stages", stages);
+    return bootObj;
+}
+
+cJSON* BuildDiagnosticsDataObject(httpd_handle_t server, std::size_t maxOpenSockets, const WsSendStats& wsStats) {
+    const SystemProfile profile = SystemProfiler::getInstance().Capture();
+    cJSON* root = cJSON_CreateObject();
+    cJSON_AddBoolToObject(root, "runtime_stats", profile.runtimeStats);
+    cJSON_AddNumberToObject(root, "window_us", static_cast<double>(profile.windowUs));
+
+    cJSON* tasks = cJSON_CreateArray();
+    for (std::size_t i = 0; i < profile.taskCount; ++i) {
+        const TaskProfile& task = profile.tasks[i];
+        cJSON* taskObj = cJSON_CreateObject();
+        cJSON_AddStringToObject(taskObj, "name", task.name);
+        cJSON_AddNumberToObject(taskObj, "priority", task.priority);
+        if (task.core >= 0) {
+            cJSON_AddNumberToObject(taskObj, "core", task.core);
+        } else {
+            cJSON_AddNullToObject(taskObj, "core");
+        }
+        cJSON_AddNumberToObject(taskObj, "cpu_pct", task.cpuPct);
+        cJSON_AddNumberToObject(taskObj, "stack_free_min_bytes", task.stackFreeMinBytes);
+        cJSON_AddItemToArray(tasks, taskObj);
+    }
+    cJSON_AddItemToObject(root, "tasks", tasks);
+    cJSON_AddNumberToObject(root, "tasks_omitted", static_cast<double>(profile.omittedTasks));
+
+    cJSON* heapObj = cJSON_CreateObject();
+    cJSON_AddItemToObject(heapObj, "internal", BuildHeapObject(profile.internalHeap));
+    cJSON_AddItemToObject(heapObj, "psram", BuildHeapObject(profile.psramHeap));
+    cJSON_AddItemToObject(root, "heap", heapObj);
+
+    cJSON* httpdObj = cJSON_CreateObject();
+    cJSON_AddNumberToObject(httpdObj, "busy_pct", profile.httpdBusyPct);
+    cJSON_AddNumberToObject(httpdObj, "requests", profile.httpdRequests);
+    cJSON_AddNumberToObject(httpdObj, "worst_us", profile.httpdWorstUs);
+    std::size_t openSockets = maxOpenSockets;
+    std::vector<int> clientFds(maxOpenSockets);
+    if (server == nullptr || httpd_get_client_list(server, &openSockets, clientFds.data()) != ESP_OK) {
+        openSockets = 0;
+    }
+    cJSON_AddNumberToObject(httpdObj, "open_sockets", static_cast<double>(openSockets));
+    cJSON_AddNumberToObject(httpdObj, "max_open_sockets", static_cast<double>(maxOpenSockets));
+    cJSON_AddItemToObject(root, "httpd", httpdObj);
+
+    cJSON* wsObj = cJSON_CreateObject();
+    cJSON_AddNumberToObject(wsObj, "clients", wsStats.clients);
+    cJSON_AddNumberToObject(wsObj, "dropped_frames", wsStats.droppedFrames);
+    cJSON_AddNumberToObject(wsObj, "slow_client_closes", wsStats.slowClientCloses);
+    cJSON_AddItemToObject(root, "websocket", wsObj);
+
+    DataManager& dataManager = DataManager::getInstance();
+    cJSON* historyObj = cJSON_CreateObject();
+    cJSON_AddNumberToObject(historyObj, "points", static_cast<double>(dataManager.GetDataPointCount()));
+    cJSON_AddNumberToObject(historyObj, "max_points", static_cast<double>(dataManager.GetMaxDataPoints()));
+    cJSON_AddNumberToObject(historyObj, "storage_bytes", static_cast<double>(dataManager.GetStorageBytesUsed()));
+    cJSON_AddItemToObject(root, "history", historyObj);
+
+    const SettingsWriteStats settingsStats = SettingsManager::getInstance().GetWriteStats();
+    cJSON* settingsObj = cJSON_CreateObject();
+    cJSON_AddNumberToObject(settingsObj, "pending_keys", settingsStats.pendingKeys);
+    cJSON_AddNumberToObject(settingsObj, "commits", settingsStats.commits);
+    cJSON_AddNumberToObject(settingsObj, "keys_written", settingsStats.keysWritten);
+    cJSON_AddNumberToObject(settingsObj, "keys_unchanged", settingsStats.keysUnchanged);
+    cJSON_AddNumberToObject(settingsObj, "failed_writes", settingsStats.failedWrites);
+    cJSON_AddNumberToObject(settingsObj, "failed_commits", settingsStats.failedCommits);
+    if (settingsStats.lastError != ESP_OK) {
+        cJSON_AddStringToObject(settingsObj, "last_error", esp_err_to_name(settingsStats.lastError));
+    } else {
+        cJSON_AddNullToObject(settingsObj, "last_error");
+    }
+    cJSON_AddItemToObject(root, "settings_nvs", settingsObj);
+
+    cJSON_AddItemToObject(root, "boot", BuildBootObject(BootTimeline::getInstance().GetSnapshot()));
+
+    cJSON_AddItemToObject(root, "control_tick",
+        BuildControlTickObject(TickMonitor::getInstance().GetStats(), Controller::getInstance().GetTickIntervalMs()));
+
+    Tracer& tracer = Tracer::getInstance();
+    cJSON* traceObj = cJSON_CreateObject();
+    cJSON_AddBoolToObject(traceObj, "available", tracer.IsAvailable());
+    cJSON_AddBoolToObject(traceObj, "frozen", tracer.IsFrozen());
+    cJSON_AddNumberToObject(traceObj, "events", static_cast<double>(tracer.GetEventCount()));
+    cJSON_AddNumberToObject(traceObj, "capacity", static_cast<double>(tracer.GetCapacity()));
+    cJSON_AddItemToObject(root, "trace", traceObj);
+    return root;
+}
+
+const char* CurrentStepTypeName(const ProfileRuntimeStatus& profileStatus) {
+    return profileStatus.hasCurrentStep ? ProfileEngine::StepTypeToString(profileStatus.currentStepType) : "none";
+}
+
+cJSON* BuildStatusDataObject(const TelemetrySnapshot& snapshot, const ProfileRuntimeStatus& profileStatus) {
     DataManager& dataManager = DataManager::getInstance();
-    ProfileEngine& profileEngine = ProfileEngine::getInstance();
     WiFiManager& wifiManager = WiFiManager::getInstance();
     TimeManager& timeManager = TimeManager::getInstance();
-    HardwareManager& hardware = HardwareManager::getInstance();
 
     cJSON* root = cJSON_CreateObject();
 
     cJSON* controllerObj = cJSON_CreateObject();
-    cJSON_AddBoolToObject(controllerObj, "running", controller.IsRunning());
-    cJSON_AddBoolToObject(controllerObj, "door_open", controller.IsDoorOpen());
-    cJSON_AddBoolToObject(controllerObj, "alarming", controller.IsAlarming());
-    cJSON_AddStringToObject(controllerObj, "state", controller.GetState().c_str());
-    cJSON_AddNumberToObject(controllerObj, "setpoint_c", controller.GetSetPoint());
-    cJSON_AddNumberToObject(controllerObj, "process_value_c", controller.GetProcessValue());
-    cJSON_AddNumberToObject(controllerObj, "pid_output", controller.GetPIDOutput());
-    cJSON_AddNumberToObject(controllerObj, "p_term", controller.GetPIDController()->GetPreviousP());
-    cJSON_AddNumberToObject(controllerObj, "i_term", controller.GetPIDController()->GetPreviousI());
-    cJSON_AddNumberToObject(controllerObj, "d_term", controller.GetPIDController()->GetPreviousD());
+    cJSON_AddBoolToObject(controllerObj, "running", snapshot.running);
+    cJSON_AddBoolToObject(controllerObj, "door_open", snapshot.doorOpen);
+    cJSON_AddBoolToObject(controllerObj, "alarming", snapshot.alarming);
+    cJSON_AddStringToObject(controllerObj, "state", snapshot.state);
+    cJSON_AddNumberToObject(controllerObj, "setpoint_c", snapshot.setPoint);
+    cJSON_AddNumberToObject(controllerObj, "process_value_c", snapshot.processValue);
+    cJSON_AddNumberToObject(controllerObj, "process_rate_c_per_s", snapshot.processRate);
+    cJSON_AddNumberToObject(controllerObj, "pid_output", snapshot.pidOutput);
+    cJSON_AddNumberToObject(controllerObj, "p_term", snapshot.pTerm);
+    cJSON_AddNumberToObject(controllerObj, "i_term", snapshot.iTerm);
+    cJSON_AddNumberToObject(controllerObj, "d_term", snapshot.dTerm);
+    cJSON_AddNumberToObject(controllerObj, "ff_term", snapshot.feedforward);
+    cJSON_AddItemToObject(controllerObj, "autotune", BuildAutotuneProgressObject(snapshot));
+    cJSON_AddItemToObject(controllerObj, "zones", BuildZonesArray(snapshot));
     cJSON_AddItemToObject(root, "controller", controllerObj);
 
-    const ProfileRuntimeStatus profileStatus = profileEngine.GetRuntimeStatus();
     cJSON* profileObj = cJSON_CreateObject();
     cJSON_AddBoolToObject(profileObj, "running", profileStatus.running);
-    cJSON_AddStringToObject(profileObj, "name", profileStatus.name.c_str());
-    cJSON_AddStringToObject(profileObj, "source", profileStatus.source.c_str());
+    cJSON_AddStringToObject(profileObj, "name", profileStatus.name);
+    cJSON_AddStringToObject(profileObj, "source", ProfileEngine::SourceToString(profileStatus.source));
     cJSON_AddNumberToObject(profileObj, "slot_index", profileStatus.slotIndex);
     cJSON_AddNumberToObject(profileObj, "current_step_number", profileStatus.currentStepNumber);
-    cJSON_AddStringToObject(profileObj, "current_step_type", profileStatus.currentStepType.c_str());
+    cJSON_AddStringToObject(profileObj, "current_step_type", CurrentStepTypeName(profileStatus));
     cJSON_AddNumberToObject(profileObj, "step_elapsed_s", profileStatus.stepElapsedS);
     cJSON_AddNumberToObject(profileObj, "profile_elapsed_s", profileStatus.profileElapsedS);
-    cJSON_AddStringToObject(profileObj, "last_end_reason", profileStatus.lastEndReason.c_str());
+    cJSON_AddStringToObject(profileObj, "last_end_reason", ProfileEngine::EndReasonToString(profileStatus.lastEndReason));
     cJSON_AddItemToObject(root, "profile", profileObj);
 
     cJSON* hardwareObj = cJSON_CreateObject();
-    cJSON* temperatures = cJSON_CreateArray();
-    for (int i = 0; i < 4; ++i) {
-        cJSON_AddItemToArray(temperatures, cJSON_CreateNumber(hardware.getThermocoupleValue(i)));
-    }
-    cJSON_AddItemToObject(hardwareObj, "temperatures_c", temperatures);
-
-    cJSON* relays = cJSON_CreateArray();
-    for (int i = 0; i < 6; ++i) {
-        cJSON_AddItemToArray(relays, cJSON_CreateBool(hardware.getRelayState(i)));
-    }
-    cJSON_AddItemToObject(hardwareObj, "relay_states", relays);
-    cJSON_AddNumberToObject(hardwareObj, "servo_angle", hardware.getServoAngle());
+    cJSON_AddItemToObject(hardwareObj, "temperatures_c", BuildTemperaturesArray(snapshot));
+    cJSON_AddItemToObject(hardwareObj, "relay_states", BuildRelayStatesArray(snapshot));
+    cJSON_AddNumberToObject(hardwareObj, "servo_angle", snapshot.servoAngle);
     cJSON_AddItemToObject(root, "hardware", hardwareObj);
 
     const WiFiConnectionStatus wifiStatus = wifiManager.GetConnectionStatus();
@@ -236,6 +767,190 @@ cJSON* BuildStatusDataObject() {
 
     return root;
 }
+
+bool FloatChanged(float current, float sent) {
+    return std::fabs(current - sent) >= WS_DELTA_EPSILON;
+}
+
+// Adds only the fields that differ from what clients last received and
+// updates `sent` to match. Returns nullptr when nothing changed.
+cJSON* BuildTelemetryDeltaObject(
+    const TelemetrySnapshot& snapshot,
+    const ProfileRuntimeStatus& profileStatus,
+    TelemetrySnapshot& sent,
+    ProfileRuntimeStatus& sentProfile) {
+    TRACE_SCOPE("WebServerManager::BuildTelemetryDelta");
+    cJSON* controllerObj = cJSON_CreateObject();
+    if (snapshot.running != sent.running) {
+        cJSON_AddBoolToObject(controllerObj, "running", snapshot.running);
+        sent.running = snapshot.running;
+    }
+    if (snapshot.doorOpen != sent.doorOpen) {
+        cJSON_AddBoolToObject(controllerObj, "door_open", snapshot.doorOpen);
+        sent.doorOpen = snapshot.doorOpen;
+    }
+    if (snapshot.alarming != sent.alarming) {
+        cJSON_AddBoolToObject(controllerObj, "alarming", snapshot.alarming);
+        sent.alarming = snapshot.alarming;
+    }
+    if (std::strcmp(snapshot.state, sent.state) != 0) {
+        cJSON_AddStringToObject(controllerObj, "state", snapshot.state);
+        std::memcpy(sent.state, snapshot.state, sizeof(sent.state));
+    }
+
+    const struct {
+        const char* key;
+        float TelemetrySnapshot::* field;
+    } controllerFloats[] = {
+        {"setpoint_c", &TelemetrySnapshot::setPoint},
+        {"process_value_c", &TelemetrySnapshot::processValue},
+        {"process_rate_c_per_s", &TelemetrySnapshot::processRate},
+        {"pid_output", &TelemetrySnapshot::pidOutput},
+        {"p_term", &TelemetrySnapshot::pTerm},
+        {"i_term", &TelemetrySnapshot::iTerm},
+        {"d_term", &TelemetrySnapshot::dTerm},
+        {"ff_term", &TelemetrySnapshot::feedforward},
+    };
+    for (const auto& entry : controllerFloats) {
+        if (FloatChanged(snapshot.*entry.field, sent.*entry.field)) {
+            cJSON_AddNumberToObject(controllerObj, entry.key, snapshot.*entry.field);
+            sent.*entry.field = snapshot.*entry.field;
+        }
+    }
+    if (snapshot.autotuneState != sent.autotuneState
+            || snapshot.autotuneCycle != sent.autotuneCycle
+            || snapshot.autotuneCycles != sent.autotuneCycles) {
+        cJSON_AddItemToObject(controllerObj, "autotune", BuildAutotuneProgressObject(snapshot));
+        sent.autotuneState = snapshot.autotuneState;
+        sent.autotuneCycle = snapshot.autotuneCycle;
+        sent.autotuneCycles = snapshot.autotuneCycles;
+    }
+    bool zonesChanged = snapshot.zoneCount != sent.zoneCount;
+    for (uint8_t zone = 0; zone < MAX_CONTROL_ZONES; ++zone) {
+        zonesChanged = zonesChanged
+            || FloatChanged(snapshot.zoneProcessValue[zone], sent.zoneProcessValue[zone])
+            || FloatChanged(snapshot.zoneOutput[zone], sent.zoneOutput[zone]);
+    }
+    if (zonesChanged) {
+        cJSON_AddItemToObject(controllerObj, "zones", BuildZonesArray(snapshot));
+        sent.zoneCount = snapshot.zoneCount;
+        std::memcpy(sent.zoneProcessValue, snapshot.zoneProcessValue, sizeof(sent.zoneProcessValue));
+        std::memcpy(sent.zoneOutput, snapshot.zoneOutput, sizeof(sent.zoneOutput));
+    }
+
+    cJSON* hardwareObj = cJSON_CreateObject();
+    bool temperaturesChanged = false;
+    for (int i = 0; i < 4; ++i) {
+        temperaturesChanged = temperaturesChanged || FloatChanged(snapshot.temperatures[i], sent.temperatures[i]);
+    }
+    if (temperaturesChanged) {
+        // Arrays are sent whole; clients replace rather than merge them.
+        cJSON_AddItemToObject(hardwareObj, "temperatures_c", BuildTemperaturesArray(snapshot));
+        std::memcpy(sent.temperatures, snapshot.temperatures, sizeof(sent.temperatures));
+    }
+    if (snapshot.relayStates != sent.relayStates) {
+        cJSON_AddItemToObject(hardwareObj, "relay_states", BuildRelayStatesArray(snapshot));
+        sent.relayStates = snapshot.relayStates;
+    }
+    if (FloatChanged(snapshot.servoAngle, sent.servoAngle)) {
+        cJSON_AddNumberToObject(hardwareObj, "servo_angle", snapshot.servoAngle);
+        sent.servoAngle = snapshot.servoAngle;
+    }
+
+    cJSON* profileObj = cJSON_CreateObject();
+    if (profileStatus.running != sentProfile.running) {
+        cJSON_AddBoolToObject(profileObj, "running", profileStatus.running);
+    }
+    if (std::strcmp(profileStatus.name, sentProfile.name) != 0) {
+        cJSON_AddStringToObject(profileObj, "name", profileStatus.name);
+    }
+    if (profileStatus.source != sentProfile.source) {
+        cJSON_AddStringToObject(profileObj, "source", ProfileEngine::SourceToString(profileStatus.source));
+    }
+    if (profileStatus.slotIndex != sentProfile.slotIndex) {
+        cJSON_AddNumberToObject(profileObj, "slot_index", profileStatus.slotIndex);
+    }
+    if (profileStatus.currentStepNumber != sentProfile.currentStepNumber) {
+        cJSON_AddNumberToObject(profileObj, "current_step_number", profileStatus.currentStepNumber);
+    }
+    if (std::strcmp(CurrentStepTypeName(profileStatus), CurrentStepTypeName(sentProfile)) != 0) {
+        cJSON_AddStringToObject(profileObj, "current_step_type", CurrentStepTypeName(profileStatus));
+    }
+    if (profileStatus.stepElapsedS != sentProfile.stepElapsedS) {
+        cJSON_AddNumberToObject(profileObj, "step_elapsed_s", profileStatus.stepElapsedS);
+    }
+    if (profileStatus.profileElapsedS != sentProfile.profileElapsedS) {
+        cJSON_AddNumberToObject(profileObj, "profile_elapsed_s", profileStatus.profileElapsedS);
+    }
+    if (profileStatus.lastEndReason != sentProfile.lastEndReason) {
+        cJSON_AddStringToObject(profileObj, "last_end_reason", ProfileEngine::EndReasonToString(profileStatus.lastEndReason));
+    }
+    sentProfile = profileStatus;
+
+    cJSON* root = cJSON_CreateObject();
+    const std::pair<const char*, cJSON*> sections[] = {
+        {"controller", controllerObj},
+        {"hardware", hardwareObj},
+        {"profile", profileObj},
+    };
+    for (const auto& section : sections) {
+        if (section.second->child != nullptr) {
+            cJSON_AddItemToObject(root, section.first, section.second);
+        } else {
+            cJSON_Delete(section.second);
+        }
+    }
+
+    if (root->child == nullptr) {
+        cJSON_Delete(root);
+        return nullptr;
+    }
+    return root;
+}
+
+// Fixed little-endian layout, see decodeTelemetryBinary in frontend/src/ws.ts:
+//   0 u8 version, 1 u8 flags (running, door_open, alarming, profile running),
+//   2 u8 relay bits, 3 u8 zone count, 4 u32 tick, 8..32 f32 SP/PV/out/P/I/D,
+//   32..48 f32 temperatures[4], 48 f32 servo, 52 f32 step elapsed,
+//   56 f32 profile elapsed, 60 u16 step number, 62 reserved, 64 char state[24],
+//   88..104 f32 zone PV[4], 104..120 f32 zone output[4]
+std::string BuildTelemetryBinaryFrame(const TelemetrySnapshot& snapshot, const ProfileRuntimeStatus& profileStatus) {
+    std::string frame(WS_BINARY_FRAME_SIZE, '\0');
+    uint8_t* out = reinterpret_cast<uint8_t*>(&frame[0]);
+
+    uint8_t flags = 0;
+    flags |= snapshot.running ? 0x01 : 0;
+    flags |= snapshot.doorOpen ? 0x02 : 0;
+    flags |= snapshot.alarming ? 0x04 : 0;
+    flags |= profileStatus.running ? 0x08 : 0;
+
+    out[0] = WS_BINARY_FRAME_VERSION;
+    out[1] = flags;
+    out[2] = snapshot.relayStates;
+    out[3] = snapshot.zoneCount;
+    PutLe32(out + 4, snapshot.tick);
+    PutLeFloat(out + 8, snapshot.setPoint);
+    PutLeFloat(out + 12, snapshot.processValue);
+    PutLeFloat(out + 16, snapshot.pidOutput);
+    PutLeFloat(out + 20, snapshot.pTerm);
+    PutLeFloat(out + 24, snapshot.iTerm);
+    PutLeFloat(out + 28, snapshot.dTerm);
+    for (int i = 0; i < 4; ++i) {
+        PutLeFloat(out + 32 + i * 4, snapshot.temperatures[i]);
+    }
+    PutLeFloat(out + 48, snapshot.servoAngle);
+    PutLeFloat(out + 52, static_cast<float>(profileStatus.stepElapsedS));
+    PutLeFloat(out + 56, static_cast<float>(profileStatus.profileElapsedS));
+    const uint16_t stepNumber = static_cast<uint16_t>(std::clamp(profileStatus.currentStepNumber, 0, 0xFFFF));
+    PutLe16(out + 60, stepNumber);
+    std::memcpy(out + 64, snapshot.state, sizeof(snapshot.state));
+    out[64 + sizeof(snapshot.state) - 1] = 0;
+    for (int i = 0; i < MAX_CONTROL_ZONES; ++i) {
+        PutLeFloat(out + 88 + i * 4, snapshot.zoneProcessValue[i]);
+        PutLeFloat(out + 104 + i * 4, snapshot.zoneOutput[i]);
+    }
+    return frame;
+}
 }
 
 WebServerManager* WebServerManager::instance = nullptr;
@@ -295,6 +1010,10 @@ esp_err_t WebServerManager::MountSpiffs() {
         return err;
     }
 
+#if CONFIG_WEBUI_EMBEDDED
+    // Run logs are the only SPIFFS user left.
+    RemoveSpiffsWebUiFiles();
+#endif
     spiffsMounted = true;
     return ESP_OK;
 }
@@ -310,6 +1029,7 @@ esp_err_t WebServerManager::StartServer() {
     // cJSON + float formatting in status/config endpoints can exceed the default
     // httpd stack on ESP32-S3. Use a larger stack to avoid stack corruption/panics.
     config.stack_size = 8192;
+    maxOpenSockets = config.max_open_sockets;
 
     esp_err_t err = httpd_start(&server, &config);
     if (err != ESP_OK) {
@@ -376,7 +1096,33 @@ esp_err_t WebServerManager::StartWebsocketTelemetryTask() {
         return ESP_OK;
     }
 
+    // Frames are written by their own task rather than httpd work items, so a
+    // client with a full socket buffer never stalls the httpd task.
     BaseType_t result;
+#if CONFIG_FREERTOS_UNICORE
+    result = xTaskCreate(
+        &WebServerManager::WsSenderTaskEntry,
+        "WsSenderTask",
+        4096,
+        this,
+        1,
+        &wsSenderTaskHandle
+    );
+#else
+    result = xTaskCreatePinnedToCore(
+        &WebServerManager::WsSenderTaskEntry,
+        "WsSenderTask",
+        4096,
+        this,
+        1,
+        &wsSenderTaskHandle,
+        1
+    );
+#endif
+    if (result != pdPASS) {
+        return ESP_FAIL;
+    }
+
 #if CONFIG_FREERTOS_UNICORE
     result = xTaskCreate(
         &WebServerManager::WsTelemetryTaskEntry,
@@ -412,40 +1158,302 @@ void WebServerManager::WsTelemetryTaskEntry(void* arg) {
 }
 
 void WebServerManager::WsTelemetryTaskLoop() {
+    TelemetryPublisher::getInstance().SetSubscriber(xTaskGetCurrentTaskHandle());
+
+    TelemetrySnapshot sentSnapshot;
+    ProfileRuntimeStatus sentProfile;
+    uint32_t lastTick = 0;
+    int64_t lastKeyframeUs = 0;
+
+    int64_t lastDiagnosticsUs = 0;
+
     while (true) {
+        // Woken by every controller tick; the timeout only matters if ticks stop.
+        (void)ulTaskNotifyTake(pdTRUE, WS_IDLE_PERIOD_TICKS);
         if (!HasWsClients()) {
-            vTaskDelay(WS_IDLE_PERIOD_TICKS);
             continue;
         }
-        BroadcastWebsocketMessage(BuildTelemetryEnvelopeJson("telemetry"));
-        vTaskDelay(WS_TELEMETRY_PERIOD_TICKS);
+
+        if (esp_timer_get_time() - lastDiagnosticsUs >= WS_DIAGNOSTICS_PERIOD_US) {
+            lastDiagnosticsUs = esp_timer_get_time();
+            DispatchDiagnostics();
+        }
+
+        const TelemetrySnapshot snapshot = LatestTelemetrySnapshot();
+        const int64_t nowUs = esp_timer_get_time();
+        const bool keyframeForAll = nowUs - lastKeyframeUs >= WS_KEYFRAME_PERIOD_US;
+        if (!keyframeForAll && snapshot.tick == lastTick) {
+            continue;
+        }
+        lastTick = snapshot.tick;
+
+        const ProfileRuntimeStatus profileStatus = ProfileEngine::getInstance().GetRuntimeStatus();
+        std::string deltaJson;
+        if (keyframeForAll) {
+            // The periodic keyframe resyncs every client's baseline.
+            sentSnapshot = snapshot;
+            sentProfile = profileStatus;
+            lastKeyframeUs = nowUs;
+        } else {
+            cJSON* delta = BuildTelemetryDeltaObject(snapshot, profileStatus, sentSnapshot, sentProfile);
+            if (delta != nullptr) {
+                cJSON* envelope = cJSON_CreateObject();
+                cJSON_AddStringToObject(envelope, "type", "delta");
+                cJSON_AddItemToObject(envelope, "data", delta);
+                deltaJson = JsonStringFromObject(envelope);
+            }
+        }
+
+        DispatchTelemetry(snapshot, profileStatus, keyframeForAll, deltaJson);
     }
 }
 
-void WebServerManager::BroadcastWebsocketMessage(const std::string& payload) {
-    if (server == nullptr || payload.empty()) {
+namespace {
+enum class WsFrameKind : uint8_t {
+    None,
+    Keyframe,
+    Delta,
+    Binary,
+};
+}
+
+void WebServerManager::DispatchTelemetry(
+    const TelemetrySnapshot& snapshot,
+    const ProfileRuntimeStatus& profileStatus,
+    bool keyframeForAll,
+    const std::string& deltaJson) {
+    TRACE_SCOPE("WebServerManager::DispatchTelemetry");
+    if (server == nullptr || wsClientsMutex == nullptr) {
         return;
     }
 
-    std::vector<int> clientsCopy;
-    if (wsClientsMutex != nullptr && xSemaphoreTake(wsClientsMutex, portMAX_DELAY) == pdTRUE) {
-        clientsCopy = wsClients;
+    const bool hasDelta = !deltaJson.empty();
+    const int64_t nowUs = esp_timer_get_time();
+
+    // JSON clients only get deltas while they have seen every earlier one;
+    // once a client skipped a frame (rate limit or backlog) it gets a keyframe.
+    const auto chooseFrame = [&](const WsClient& client) {
+        if (keyframeForAll || client.needsKeyframe) {
+            return WsFrameKind::Keyframe;
+        }
+        if (!hasDelta && !client.missedUpdate) {
+            return WsFrameKind::None;
+        }
+        if (nowUs - client.lastSentUs < client.minIntervalUs) {
+            return WsFrameKind::None;
+        }
+        if (client.format == WsFormat::Binary) {
+            return WsFrameKind::Binary;
+        }
+        if (client.missedUpdate || client.pending != nullptr) {
+            return WsFrameKind::Keyframe;
+        }
+        return WsFrameKind::Delta;
+    };
+
+    // Work out which encodings are needed so each is built at most once,
+    // outside the client lock.
+    bool needKeyframe = false;
+    bool needBinary = false;
+    if (xSemaphoreTake(wsClientsMutex, portMAX_DELAY) == pdTRUE) {
+        for (const WsClient& client : wsClients) {
+            const WsFrameKind kind = chooseFrame(client);
+            needKeyframe = needKeyframe || kind == WsFrameKind::Keyframe;
+            needBinary = needBinary || kind == WsFrameKind::Binary;
+        }
         xSemaphoreGive(wsClientsMutex);
     }
 
-    for (int fd : clientsCopy) {
-        httpd_ws_frame_t frame = {};
-        frame.type = HTTPD_WS_TYPE_TEXT;
-        frame.payload = reinterpret_cast<uint8_t*>(const_cast<char*>(payload.c_str()));
-        frame.len = payload.size();
+    std::shared_ptr<WsPayload> keyframePayload;
+    if (needKeyframe) {
+        keyframePayload = std::make_shared<WsPayload>();
+        keyframePayload->type = HTTPD_WS_TYPE_TEXT;
+        keyframePayload->data = BuildTelemetryEnvelopeJson("telemetry", snapshot, profileStatus);
+    }
+    std::shared_ptr<WsPayload> deltaPayload;
+    if (hasDelta) {
+        deltaPayload = std::make_shared<WsPayload>();
+        deltaPayload->type = HTTPD_WS_TYPE_TEXT;
+        deltaPayload->data = deltaJson;
+    }
+    std::shared_ptr<WsPayload> binaryPayload;
+    if (needBinary) {
+        binaryPayload = std::make_shared<WsPayload>();
+        binaryPayload->type = HTTPD_WS_TYPE_BINARY;
+        binaryPayload->data = BuildTelemetryBinaryFrame(snapshot, profileStatus);
+    }
 
-        esp_err_t err = httpd_ws_send_frame_async(server, fd, &frame);
-        if (err != ESP_OK) {
-            RemoveWsClient(fd);
+    if (xSemaphoreTake(wsClientsMutex, portMAX_DELAY) != pdTRUE) {
+        return;
+    }
+
+    for (WsClient& client : wsClients) {
+        std::shared_ptr<WsPayload> payload;
+        switch (chooseFrame(client)) {
+            case WsFrameKind::Keyframe:
+                payload = keyframePayload;
+                break;
+            case WsFrameKind::Delta:
+                payload = deltaPayload;
+                break;
+            case WsFrameKind::Binary:
+                payload = binaryPayload;
+                break;
+            case WsFrameKind::None:
+                break;
+        }
+
+        if (payload == nullptr) {
+            // Not sent this tick (or joined after the encode pass); catch up later.
+            client.missedUpdate = client.missedUpdate || hasDelta;
+            continue;
+        }
+
+        if (payload == keyframePayload) {
+            client.needsKeyframe = false;
+        }
+        client.missedUpdate = false;
+        client.lastSentUs = nowUs;
+        QueueWsPayloadLocked(client, payload);
+    }
+
+    xSemaphoreGive(wsClientsMutex);
+}
+
+void WebServerManager::DispatchDiagnostics() {
+    if (server == nullptr || wsClientsMutex == nullptr) {
+        return;
+    }
+
+    bool wanted = false;
+    if (xSemaphoreTake(wsClientsMutex, portMAX_DELAY) == pdTRUE) {
+        wanted = std::any_of(wsClients.begin(), wsClients.end(), [](const WsClient& client) { return client.diagnostics; });
+        xSemaphoreGive(wsClientsMutex);
+    }
+    if (!wanted) {
+        return;
+    }
+
+    // Built outside the client lock; the task scan takes a while with many tasks.
+    cJSON* envelope = cJSON_CreateObject();
+    cJSON_AddStringToObject(envelope, "type", "diagnostics");
+    cJSON_AddItemToObject(envelope, "data", BuildDiagnosticsDataObject(server, maxOpenSockets, GetWsSendStats()));
+    auto payload = std::make_shared<WsPayload>();
+    payload->type = HTTPD_WS_TYPE_TEXT;
+    payload->data = JsonStringFromObject(envelope);
+
+    if (xSemaphoreTake(wsClientsMutex, portMAX_DELAY) != pdTRUE) {
+        return;
+    }
+    for (WsClient& client : wsClients) {
+        if (client.diagnostics) {
+            client.pendingDiagnostics = payload;
+        }
+    }
+    xSemaphoreGive(wsClientsMutex);
+    xTaskNotifyGive(wsSenderTaskHandle);
+}
+
+void WebServerManager::QueueWsPayloadLocked(WsClient& client, const std::shared_ptr<const WsPayload>& payload) {
+    // Only the newest frame is kept for a client that hasn't drained the last one.
+    if (client.pending != nullptr) {
+        ++wsSendStats.droppedFrames;
+    }
+    client.pending = payload;
+    xTaskNotifyGive(wsSenderTaskHandle);
+}
+
+void WebServerManager::WsSenderTaskEntry(void* arg) {
+    if (arg == nullptr) {
+        vTaskDelete(nullptr);
+        return;
+    }
+
+    static_cast<WebServerManager*>(arg)->WsSenderTaskLoop();
+    vTaskDelete(nullptr);
+}
+
+void WebServerManager::WsSenderTaskLoop() {
+    std::vector<std::pair<int, std::shared_ptr<const WsPayload>>> batch;
+    while (true) {
+        (void)ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        // One frame per client per pass, so a client with a backlog takes turns
+        // with the others. A stalled socket costs at most WS_SEND_TIMEOUT_US
+        // before it is closed.
+        while (TakeWsSendBatch(batch)) {
+            for (const auto& [fd, payload] : batch) {
+                SendWsFrame(fd, *payload);
+            }
+            batch.clear();
         }
     }
 }
 
+bool WebServerManager::TakeWsSendBatch(std::vector<std::pair<int, std::shared_ptr<const WsPayload>>>& outBatch) {
+    outBatch.clear();
+    if (xSemaphoreTake(wsClientsMutex, portMAX_DELAY) != pdTRUE) {
+        return false;
+    }
+
+    for (WsClient& client : wsClients) {
+        std::shared_ptr<const WsPayload> payload = std::move(client.pending);
+        client.pending.reset();
+        if (payload == nullptr) {
+            payload = std::move(client.pendingDiagnostics);
+            client.pendingDiagnostics.reset();
+        }
+        if (payload != nullptr) {
+            outBatch.emplace_back(client.fd, std::move(payload));
+        }
+    }
+    xSemaphoreGive(wsClientsMutex);
+
+    return !outBatch.empty();
+}
+
+void WebServerManager::SendWsFrame(int fd, const WsPayload& payload) {
+    TRACE_SCOPE("WebServerManager::SendWsFrame");
+    httpd_ws_frame_t frame = {};
+    frame.type = payload.type;
+    frame.payload = reinterpret_cast<uint8_t*>(const_cast<char*>(payload.data.data()));
+    frame.len = payload.data.size();
+    if (httpd_ws_send_frame_async(server, fd, &frame) == ESP_OK) {
+        return;
+    }
+
+    // A partial frame may be on the wire, so the connection can't be reused.
+    ESP_LOGW(TAG, "Websocket send to fd %d failed or timed out, closing it", fd);
+    RemoveWsClient(fd);
+    if (xSemaphoreTake(wsClientsMutex, portMAX_DELAY) == pdTRUE) {
+        ++wsSendStats.slowClientCloses;
+        xSemaphoreGive(wsClientsMutex);
+    }
+    (void)httpd_sess_trigger_close(server, fd);
+}
+
+WsSendStats WebServerManager::GetWsSendStats() const {
+    WsSendStats stats;
+    if (wsClientsMutex == nullptr) {
+        return stats;
+    }
+
+    if (xSemaphoreTake(wsClientsMutex, portMAX_DELAY) == pdTRUE) {
+        stats = wsSendStats;
+        stats.clients = static_cast<uint32_t>(wsClients.size());
+        xSemaphoreGive(wsClientsMutex);
+    }
+    return stats;
+}
+
+WebServerManager::WsClient* WebServerManager::FindWsClientLocked(int fd) {
+    for (WsClient& client : wsClients) {
+        if (client.fd == fd) {
+            return &client;
+        }
+    }
+    return nullptr;
+}
+
 bool WebServerManager::HasWsClients() const {
     if (wsClientsMutex == nullptr) {
         return false;
@@ -466,8 +1474,10 @@ void WebServerManager::AddWsClient(int fd) {
     }
 
     if (xSemaphoreTake(wsClientsMutex, portMAX_DELAY) == pdTRUE) {
-        if (std::find(wsClients.begin(), wsClients.end(), fd) == wsClients.end()) {
-            wsClients.push_back(fd);
+        if (FindWsClientLocked(fd) == nullptr) {
+            WsClient client;
+            client.fd = fd;
+            wsClients.push_back(client);
         }
         xSemaphoreGive(wsClientsMutex);
     }
@@ -479,7 +1489,64 @@ void WebServerManager::RemoveWsClient(int fd) {
     }
 
     if (xSemaphoreTake(wsClientsMutex, portMAX_DELAY) == pdTRUE) {
-        wsClients.erase(std::remove(wsClients.begin(), wsClients.end(), fd), wsClients.end());
+        wsClients.erase(
+            std::remove_if(wsClients.begin(), wsClients.end(), [fd](const WsClient& client) { return client.fd == fd; }),
+            wsClients.end());
+        xSemaphoreGive(wsClientsMutex);
+    }
+}
+
+void WebServerManager::HandleWsClientMessage(int fd, const char* message, std::size_t length) {
+    // {"type":"subscribe","format":"json"|"bin","rate_hz":4,"diagnostics":true};
+    // rate_hz 0 or absent = every tick, diagnostics adds the 1 Hz "diagnostics" frame.
+    cJSON* json = cJSON_ParseWithLength(message, length);
+    if (json == nullptr) {
+        return;
+    }
+
+    cJSON* type = cJSON_GetObjectItem(json, "type");
+    if (!cJSON_IsString(type) || std::strcmp(type->valuestring, "subscribe") != 0) {
+        cJSON_Delete(json);
+        return;
+    }
+
+    std::optional<WsFormat> format;
+    cJSON* formatItem = cJSON_GetObjectItem(json, "format");
+    if (cJSON_IsString(formatItem)) {
+        if (std::strcmp(formatItem->valuestring, "bin") == 0) {
+            format = WsFormat::Binary;
+        } else if (std::strcmp(formatItem->valuestring, "json") == 0) {
+            format = WsFormat::Json;
+        }
+    }
+
+    std::optional<int64_t> minIntervalUs;
+    cJSON* rateItem = cJSON_GetObjectItem(json, "rate_hz");
+    if (cJSON_IsNumber(rateItem)) {
+        const double rateHz = std::clamp(rateItem->valuedouble, 0.0, WS_MAX_RATE_HZ);
+        minIntervalUs = (rateHz > 0.0) ? static_cast<int64_t>(1000000.0 / rateHz) : 0;
+    }
+    std::optional<bool> diagnostics;
+    cJSON* diagnosticsItem = cJSON_GetObjectItem(json, "diagnostics");
+    if (cJSON_IsBool(diagnosticsItem)) {
+        diagnostics = cJSON_IsTrue(diagnosticsItem);
+    }
+    cJSON_Delete(json);
+
+    if (xSemaphoreTake(wsClientsMutex, portMAX_DELAY) == pdTRUE) {
+        WsClient* client = FindWsClientLocked(fd);
+        if (client != nullptr) {
+            if (diagnostics.has_value()) {
+                client->diagnostics = diagnostics.value();
+            }
+            if (format.has_value()) {
+                client->format = format.value();
+            }
+            if (minIntervalUs.has_value()) {
+                client->minIntervalUs = minIntervalUs.value();
+            }
+            client->needsKeyframe = true;
+        }
         xSemaphoreGive(wsClientsMutex);
     }
 }
@@ -488,14 +1555,19 @@ std::string WebServerManager::BuildStatusEnvelopeJson(const char* eventType) con
     cJSON* envelope = cJSON_CreateObject();
     cJSON_AddBoolToObject(envelope, "ok", true);
     cJSON_AddStringToObject(envelope, "type", eventType);
-    cJSON_AddItemToObject(envelope, "data", BuildStatusDataObject());
+    cJSON_AddItemToObject(
+        envelope, "data", BuildStatusDataObject(LatestTelemetrySnapshot(), ProfileEngine::getInstance().GetRuntimeStatus()));
     return JsonStringFromObject(envelope);
 }
 
-std::string WebServerManager::BuildTelemetryEnvelopeJson(const char* eventType) const {
+std::string WebServerManager::BuildTelemetryEnvelopeJson(
+    const char* eventType,
+    const TelemetrySnapshot& snapshot,
+    const ProfileRuntimeStatus& profileStatus) const {
+    TRACE_SCOPE("WebServerManager::BuildTelemetryJson");
     cJSON* envelope = cJSON_CreateObject();
     cJSON_AddStringToObject(envelope, "type", eventType);
-    cJSON_AddItemToObject(envelope, "data", BuildStatusDataObject());
+    cJSON_AddItemToObject(envelope, "data", BuildStatusDataObject(snapshot, profileStatus));
     return JsonStringFromObject(envelope);
 }
 
@@ -546,119 +1618,512 @@ esp_err_t WebServerManager::ReadRequestBody(httpd_req_t* req, std::string& outBo
         if (received <= 0) {
             return ESP_FAIL;
         }
-        outBody.append(buffer, static_cast<std::size_t>(received));
-        remaining -= received;
+        outBody.append(buffer, static_cast<std::size_t>(received));
+        remaining -= received;
+    }
+
+    return ESP_OK;
+}
+
+esp_err_t WebServerManager::SendHistoryJson(httpd_req_t* req, DataHistoryCursor cursor) const {
+    if (req == nullptr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    httpd_resp_set_type(req, "application/json; charset=utf-8");
+    httpd_resp_set_status(req, "200 OK");
+
+    ChunkedResponseWriter writer(req);
+    char prefix[96] = {};
+    std::snprintf(
+        prefix,
+        sizeof(prefix),
+        "{\"ok\":true,\"data\":{\"oldest_seq\":%llu,\"next_seq\":%llu,\"points\":[",
+        static_cast<unsigned long long>(cursor.oldest),
+        static_cast<unsigned long long>(cursor.end));
+    esp_err_t err = writer.Append(prefix);
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    DataManager& data = DataManager::getInstance();
+    DataPoint batch[HISTORY_STREAM_BATCH_POINTS];
+    bool firstPoint = true;
+
+    std::size_t count = 0;
+    while ((count = data.ReadHistoryBatch(cursor, batch, HISTORY_STREAM_BATCH_POINTS)) > 0) {
+        for (std::size_t idx = 0; idx < count; ++idx) {
+            const DataPoint& point = batch[idx];
+            char zonesJson[256] = {};
+            FormatHistoryZonesJson(point, zonesJson, sizeof(zonesJson));
+            char pointJson[768] = {};
+            const int written = std::snprintf(
+                pointJson,
+                sizeof(pointJson),
+                "%s{\"seq\":%lu,\"timestamp\":%llu,\"setpoint\":%.3f,\"process_value\":%.3f,\"pid_output\":%.3f,\"p\":%.3f,\"i\":%.3f,\"d\":%.3f,"
+                "\"temperatures\":[%.3f,%.3f,%.3f,%.3f],\"relay_states\":%u,\"servo_angle\":%u,\"running\":%s%s}",
+                firstPoint ? "" : ",",
+                static_cast<unsigned long>(point.sequence),
+                static_cast<unsigned long long>(point.timestamp),
+                point.setPoint,
+                point.processValue,
+                point.PIDOutput,
+                point.PTerm,
+                point.ITerm,
+                point.DTerm,
+                point.temperatureReadings[0],
+                point.temperatureReadings[1],
+                point.temperatureReadings[2],
+                point.temperatureReadings[3],
+                static_cast<unsigned>(point.relayStates),
+                static_cast<unsigned>(point.servoAngle),
+                point.chamberRunning ? "true" : "false",
+                zonesJson);
+            if (written <= 0 || static_cast<std::size_t>(written) >= sizeof(pointJson)) {
+                return ESP_FAIL;
+            }
+
+            err = writer.Append(pointJson, static_cast<std::size_t>(written));
+            if (err != ESP_OK) {
+                return err;
+            }
+            firstPoint = false;
+        }
+    }
+
+    err = writer.Append("]}}");
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    return writer.Finish();
+}
+
+esp_err_t WebServerManager::SendHistoryRollupJson(httpd_req_t* req, DataHistoryCursor cursor) const {
+    if (req == nullptr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    httpd_resp_set_type(req, "application/json; charset=utf-8");
+    httpd_resp_set_status(req, "200 OK");
+
+    ChunkedResponseWriter writer(req);
+    char prefix[128] = {};
+    std::snprintf(
+        prefix,
+        sizeof(prefix),
+        "{\"ok\":true,\"data\":{\"resolution_s\":%u,\"oldest_seq\":%llu,\"next_seq\":%llu,\"points\":[",
+        static_cast<unsigned>(DataManager::GetResolutionSeconds(cursor.resolution)),
+        static_cast<unsigned long long>(cursor.oldest),
+        static_cast<unsigned long long>(cursor.end));
+    esp_err_t err = writer.Append(prefix);
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    DataManager& data = DataManager::getInstance();
+    DataRollup batch[HISTORY_STREAM_BATCH_POINTS];
+    bool firstPoint = true;
+
+    std::size_t count = 0;
+    while ((count = data.ReadRollupBatch(cursor, batch, HISTORY_STREAM_BATCH_POINTS)) > 0) {
+        for (std::size_t idx = 0; idx < count; ++idx) {
+            const DataRollup& rollup = batch[idx];
+            char pointJson[384] = {};
+            const int written = std::snprintf(
+                pointJson,
+                sizeof(pointJson),
+                "%s{\"seq\":%lu,\"timestamp\":%llu,\"samples\":%u,"
+                "\"setpoint\":{\"min\":%.3f,\"max\":%.3f,\"mean\":%.3f},"
+                "\"process_value\":{\"min\":%.3f,\"max\":%.3f,\"mean\":%.3f},"
+                "\"pid_output\":{\"min\":%.3f,\"max\":%.3f,\"mean\":%.3f}}",
+                firstPoint ? "" : ",",
+                static_cast<unsigned long>(rollup.sequence),
+                static_cast<unsigned long long>(rollup.timestamp),
+                static_cast<unsigned>(rollup.sampleCount),
+                rollup.setPoint.min,
+                rollup.setPoint.max,
+                rollup.setPoint.mean,
+                rollup.processValue.min,
+                rollup.processValue.max,
+                rollup.processValue.mean,
+                rollup.PIDOutput.min,
+                rollup.PIDOutput.max,
+                rollup.PIDOutput.mean);
+            if (written <= 0 || static_cast<std::size_t>(written) >= sizeof(pointJson)) {
+                return ESP_FAIL;
+            }
+
+            err = writer.Append(pointJson, static_cast<std::size_t>(written));
+            if (err != ESP_OK) {
+                return err;
+            }
+            firstPoint = false;
+        }
+    }
+
+    err = writer.Append("]}}");
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    return writer.Finish();
+}
+
+esp_err_t WebServerManager::SendHistoryBinary(httpd_req_t* req, DataHistoryCursor cursor) const {
+    if (req == nullptr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    httpd_resp_set_type(req, "application/octet-stream");
+    httpd_resp_set_status(req, "200 OK");
+
+    ChunkedResponseWriter writer(req);
+    DataManager& data = DataManager::getInstance();
+    DataPoint batch[HISTORY_STREAM_BATCH_POINTS];
+
+    std::size_t count = data.ReadHistoryBatch(cursor, batch, HISTORY_STREAM_BATCH_POINTS);
+
+    // The header carries the first timestamp and sequence so every record can store small deltas.
+    HistoryBinaryEncoder encoder;
+    uint8_t header[HistoryBinaryEncoder::HEADER_SIZE] = {};
+    encoder.EncodeHeader(
+        (count > 0) ? batch[0].timestamp : 0,
+        (count > 0) ? batch[0].sequence : static_cast<uint32_t>(cursor.end),
+        static_cast<uint32_t>(cursor.oldest),
+        static_cast<uint32_t>(cursor.end),
+        0,
+        data.GetHistoryZoneCount(),
+        header);
+
+    esp_err_t err = writer.Append(reinterpret_cast<const char*>(header), sizeof(header));
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    while (count > 0) {
+        for (std::size_t idx = 0; idx < count; ++idx) {
+            uint8_t record[HistoryBinaryEncoder::MAX_RECORD_SIZE] = {};
+            encoder.EncodeRecord(batch[idx], record);
+
+            err = writer.Append(reinterpret_cast<const char*>(record), encoder.GetRecordSize());
+            if (err != ESP_OK) {
+                return err;
+            }
+        }
+
+        count = data.ReadHistoryBatch(cursor, batch, HISTORY_STREAM_BATCH_POINTS);
+    }
+
+    return writer.Finish();
+}
+
+esp_err_t WebServerManager::SendHistoryCsv(httpd_req_t* req) const {
+    if (req == nullptr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    httpd_resp_set_type(req, "text/csv; charset=utf-8");
+    httpd_resp_set_hdr(req, "Content-Disposition", "attachment; filename=history.csv");
+
+    DataManager& data = DataManager::getInstance();
+    const uint8_t zoneCount = data.GetHistoryZoneCount();
+
+    ChunkedResponseWriter writer(req);
+    esp_err_t err = writer.Append(
+        "timestamp,setpoint,process_value,pid_output,p_term,i_term,d_term,temp0,temp1,temp2,temp3,relay_states,servo_angle,running");
+    // Multi-zone history appends a PV and output column per zone.
+    for (uint8_t zone = 0; err == ESP_OK && zone < zoneCount && zoneCount > 1; ++zone) {
+        char zoneHeader[40] = {};
+        std::snprintf(zoneHeader, sizeof(zoneHeader), ",zone%u_pv,zone%u_output", static_cast<unsigned>(zone), static_cast<unsigned>(zone));
+        err = writer.Append(zoneHeader);
+    }
+    if (err == ESP_OK) {
+        err = writer.Append("\n");
+    }
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    DataHistoryCursor cursor = data.OpenHistoryCursor(0);
+    DataPoint batch[HISTORY_STREAM_BATCH_POINTS];
+
+    std::size_t count = 0;
+    while ((count = data.ReadHistoryBatch(cursor, batch, HISTORY_STREAM_BATCH_POINTS)) > 0) {
+        for (std::size_t idx = 0; idx < count; ++idx) {
+            const DataPoint& point = batch[idx];
+            char line[320] = {};
+            const int written = std::snprintf(
+                line,
+                sizeof(line),
+                "%llu,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%u,%u,%u",
+                static_cast<unsigned long long>(point.timestamp),
+                point.setPoint,
+                point.processValue,
+                point.PIDOutput,
+                point.PTerm,
+                point.ITerm,
+                point.DTerm,
+                point.temperatureReadings[0],
+                point.temperatureReadings[1],
+                point.temperatureReadings[2],
+                point.temperatureReadings[3],
+                static_cast<unsigned>(point.relayStates),
+                static_cast<unsigned>(point.servoAngle),
+                point.chamberRunning ? 1U : 0U);
+            if (written <= 0 || static_cast<std::size_t>(written) >= sizeof(line)) {
+                return ESP_FAIL;
+            }
+            std::size_t length = static_cast<std::size_t>(written);
+            for (uint8_t zone = 0; zone < zoneCount && zoneCount > 1; ++zone) {
+                const int zoneWritten = std::snprintf(
+                    line + length, sizeof(line) - length, ",%.3f,%.3f", point.zoneProcessValue[zone], point.zoneOutput[zone]);
+                if (zoneWritten <= 0 || static_cast<std::size_t>(zoneWritten) >= sizeof(line) - length) {
+                    return ESP_FAIL;
+                }
+                length += static_cast<std::size_t>(zoneWritten);
+            }
+            if (length + 1 >= sizeof(line)) {
+                return ESP_FAIL;
+            }
+            line[length++] = '\n';
+            line[length] = '\0';
+
+            err = writer.Append(line, length);
+            if (err != ESP_OK) {
+                return err;
+            }
+        }
+    }
+
+    return writer.Finish();
+}
+
+esp_err_t WebServerManager::SendTraceJson(httpd_req_t* req) const {
+    if (req == nullptr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    Tracer& tracer = Tracer::getInstance();
+    if (!tracer.IsAvailable()) {
+        return SendJsonError(req, 409, "TRACE_DISABLED", "Firmware built without CONFIG_TRACE_ENABLED or no PSRAM for the ring");
+    }
+
+    // Chrome trace format: one "X" (complete) event per scope, pid = core,
+    // tid = task, then metadata naming the tracks. Loads in Perfetto/chrome://tracing.
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_set_hdr(req, "Content-Disposition", "attachment; filename=trace.json");
+
+    ChunkedResponseWriter writer(req);
+    esp_err_t err = writer.Append("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    struct Track {
+        uint8_t core;
+        TaskHandle_t task;
+    };
+    Track tracks[TRACE_MAX_THREADS] = {};
+    std::size_t trackCount = 0;
+    bool first = true;
+
+    TraceCursor cursor = tracer.OpenCursor();
+    TraceRecord batch[TRACE_STREAM_BATCH_EVENTS];
+    std::size_t count = 0;
+    while ((count = tracer.ReadBatch(cursor, batch, TRACE_STREAM_BATCH_EVENTS)) > 0) {
+        for (std::size_t idx = 0; idx < count; ++idx) {
+            const TraceRecord& record = batch[idx];
+            bool known = false;
+            for (std::size_t t = 0; t < trackCount; ++t) {
+                known = known || (tracks[t].core == record.core && tracks[t].task == record.task);
+            }
+            if (!known && trackCount < TRACE_MAX_THREADS) {
+                tracks[trackCount++] = {record.core, record.task};
+            }
+
+            char line[192] = {};
+            const int written = std::snprintf(
+                line,
+                sizeof(line),
+                "%s{\"name\":\"%s\",\"ph\":\"X\",\"ts\":%lld,\"dur\":%.3f,\"pid\":%u,\"tid\":%lu}",
+                first ? "" : ",",
+                record.name,
+                static_cast<long long>(record.startUs),
+                record.durationUs,
+                static_cast<unsigned>(record.core),
+                static_cast<unsigned long>(reinterpret_cast<uintptr_t>(record.task)));
+            if (written <= 0 || static_cast<std::size_t>(written) >= sizeof(line)) {
+                return ESP_FAIL;
+            }
+            first = false;
+            err = writer.Append(line, static_cast<std::size_t>(written));
+            if (err != ESP_OK) {
+                return err;
+            }
+        }
+    }
+
+    for (std::size_t t = 0; t < trackCount; ++t) {
+        const char* taskName = (tracks[t].task == nullptr) ? "ISR" : pcTaskGetName(tracks[t].task);
+        char line[160] = {};
+        const int written = std::snprintf(
+            line,
+            sizeof(line),
+            "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%u,\"tid\":%lu,\"args\":{\"name\":\"%s\"}}",
+            first ? "" : ",",
+            static_cast<unsigned>(tracks[t].core),
+            static_cast<unsigned long>(reinterpret_cast<uintptr_t>(tracks[t].task)),
+            taskName);
+        if (written <= 0 || static_cast<std::size_t>(written) >= sizeof(line)) {
+            return ESP_FAIL;
+        }
+        first = false;
+        err = writer.Append(line, static_cast<std::size_t>(written));
+        if (err != ESP_OK) {
+            return err;
+        }
     }
 
-    return ESP_OK;
+    err = writer.Append("]}");
+    if (err != ESP_OK) {
+        return err;
+    }
+    return writer.Finish();
 }
 
-esp_err_t WebServerManager::SendHistoryJson(httpd_req_t* req, const DataPointStorage& points) const {
+esp_err_t WebServerManager::SendSimulationJson(httpd_req_t* req) const {
     if (req == nullptr) {
         return ESP_ERR_INVALID_ARG;
     }
 
+    const SimulationStatus status = ProfileSimulator::getInstance().GetStatus();
+    cJSON* nameJson = cJSON_CreateString(status.profileName);
+    char* nameText = (nameJson != nullptr) ? cJSON_PrintUnformatted(nameJson) : nullptr;
+    cJSON_Delete(nameJson);
+    if (nameText == nullptr) {
+        return SendJsonError(req, 500, "JSON_ENCODE_FAILED", "Failed to encode simulation");
+    }
+
     httpd_resp_set_type(req, "application/json; charset=utf-8");
     httpd_resp_set_status(req, "200 OK");
 
-    esp_err_t err = httpd_resp_send_chunk(req, "{\"ok\":true,\"data\":{\"points\":[", HTTPD_RESP_USE_STRLEN);
+    ChunkedResponseWriter writer(req);
+    char prefix[64] = {};
+    std::snprintf(
+        prefix,
+        sizeof(prefix),
+        "{\"ok\":true,\"data\":{\"state\":\"%s\",\"profile_name\":",
+        ProfileSimulator::StateToString(status.state));
+    esp_err_t err = writer.Append(prefix);
+    if (err == ESP_OK) {
+        err = writer.Append(nameText);
+    }
+    cJSON_free(nameText);
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    char progressJson[96] = {};
+    std::snprintf(
+        progressJson,
+        sizeof(progressJson),
+        ",\"simulated_s\":%.1f,\"wall_time_ms\":%lld",
+        status.simulatedS,
+        static_cast<long long>(status.wallTimeUs / 1000));
+    err = writer.Append(progressJson);
     if (err != ESP_OK) {
         return err;
     }
 
-    for (std::size_t idx = 0; idx < points.size(); ++idx) {
-        if (idx > 0) {
-            err = httpd_resp_send_chunk(req, ",", 1);
+    if (status.state == SimulationState::Complete) {
+        const SimulationResult& result = status.result;
+        char resultJson[256] = {};
+        std::snprintf(
+            resultJson,
+            sizeof(resultJson),
+            ",\"result\":{\"outcome\":\"%s\",\"duration_s\":%.1f,\"max_overshoot_c\":%.3f,\"ticks\":%lu,\"step_s\":%.3f,\"points\":[",
+            ProfileSimulator::OutcomeToString(result.outcome),
+            result.durationS,
+            result.maxOvershootC,
+            static_cast<unsigned long>(result.ticks),
+            status.config.stepS);
+        err = writer.Append(resultJson);
+        if (err != ESP_OK) {
+            return err;
+        }
+
+        for (std::size_t idx = 0; idx < result.points.size(); ++idx) {
+            const SimulationPoint& point = result.points[idx];
+            char pointJson[160] = {};
+            const int written = std::snprintf(
+                pointJson,
+                sizeof(pointJson),
+                "%s{\"time_s\":%.1f,\"setpoint\":%.2f,\"process_value\":%.2f,\"pid_output\":%.2f,\"step_number\":%u}",
+                idx == 0 ? "" : ",",
+                point.timeS,
+                point.setpointC,
+                point.processValueC,
+                point.outputPct,
+                static_cast<unsigned>(point.stepNumber));
+            if (written <= 0 || static_cast<std::size_t>(written) >= sizeof(pointJson)) {
+                return ESP_FAIL;
+            }
+            err = writer.Append(pointJson, static_cast<std::size_t>(written));
             if (err != ESP_OK) {
                 return err;
             }
         }
-
-        const DataPoint& point = points[idx];
-        char pointJson[512] = {};
-        const int written = std::snprintf(
-            pointJson,
-            sizeof(pointJson),
-            "{\"timestamp\":%llu,\"setpoint\":%.3f,\"process_value\":%.3f,\"pid_output\":%.3f,\"p\":%.3f,\"i\":%.3f,\"d\":%.3f,"
-            "\"temperatures\":[%.3f,%.3f,%.3f,%.3f],\"relay_states\":%u,\"servo_angle\":%u,\"running\":%s}",
-            static_cast<unsigned long long>(point.timestamp),
-            point.setPoint,
-            point.processValue,
-            point.PIDOutput,
-            point.PTerm,
-            point.ITerm,
-            point.DTerm,
-            point.temperatureReadings[0],
-            point.temperatureReadings[1],
-            point.temperatureReadings[2],
-            point.temperatureReadings[3],
-            static_cast<unsigned>(point.relayStates),
-            static_cast<unsigned>(point.servoAngle),
-            point.chamberRunning ? "true" : "false");
-        if (written <= 0 || static_cast<std::size_t>(written) >= sizeof(pointJson)) {
-            return ESP_FAIL;
-        }
-
-        err = httpd_resp_send_chunk(req, pointJson, static_cast<std::size_t>(written));
+        err = writer.Append("]}");
         if (err != ESP_OK) {
             return err;
         }
     }
 
-    err = httpd_resp_send_chunk(req, "]}}", HTTPD_RESP_USE_STRLEN);
+    err = writer.Append("}}");
     if (err != ESP_OK) {
         return err;
     }
 
-    return httpd_resp_send_chunk(req, nullptr, 0);
+    return writer.Finish();
 }
 
-esp_err_t WebServerManager::SendHistoryCsv(httpd_req_t* req, const DataPointStorage& points) const {
+esp_err_t WebServerManager::SendRunFile(httpd_req_t* req, uint32_t runId) const {
     if (req == nullptr) {
         return ESP_ERR_INVALID_ARG;
     }
 
-    httpd_resp_set_type(req, "text/csv; charset=utf-8");
-    httpd_resp_set_hdr(req, "Content-Disposition", "attachment; filename=history.csv");
+    std::string filePath;
+    if (RunLogManager::getInstance().GetRunPath(runId, filePath) != ESP_OK) {
+        return SendJsonError(req, 404, "RUN_NOT_FOUND", "Run not found");
+    }
 
-    esp_err_t err = httpd_resp_send_chunk(
-        req,
-        "timestamp,setpoint,process_value,pid_output,p_term,i_term,d_term,temp0,temp1,temp2,temp3,relay_states,servo_angle,running\n",
-        HTTPD_RESP_USE_STRLEN);
-    if (err != ESP_OK) {
-        return err;
+    FILE* file = std::fopen(filePath.c_str(), "rb");
+    if (file == nullptr) {
+        return SendJsonError(req, 500, "FILE_OPEN_FAILED", "Failed to open run log");
     }
 
-    for (const DataPoint& point : points) {
-        char line[320] = {};
-        const int written = std::snprintf(
-            line,
-            sizeof(line),
-            "%llu,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%u,%u,%u\n",
-            static_cast<unsigned long long>(point.timestamp),
-            point.setPoint,
-            point.processValue,
-            point.PIDOutput,
-            point.PTerm,
-            point.ITerm,
-            point.DTerm,
-            point.temperatureReadings[0],
-            point.temperatureReadings[1],
-            point.temperatureReadings[2],
-            point.temperatureReadings[3],
-            static_cast<unsigned>(point.relayStates),
-            static_cast<unsigned>(point.servoAngle),
-            point.chamberRunning ? 1U : 0U);
-        if (written <= 0 || static_cast<std::size_t>(written) >= sizeof(line)) {
-            return ESP_FAIL;
-        }
+    char disposition[64] = {};
+    std::snprintf(disposition, sizeof(disposition), "attachment; filename=run_%05u.bin", static_cast<unsigned>(runId));
+    httpd_resp_set_type(req, "application/octet-stream");
+    httpd_resp_set_hdr(req, "Content-Disposition", disposition);
 
-        err = httpd_resp_send_chunk(req, line, static_cast<std::size_t>(written));
-        if (err != ESP_OK) {
-            return err;
+    char buffer[1024] = {};
+    while (!std::feof(file)) {
+        const std::size_t read = std::fread(buffer, 1, sizeof(buffer), file);
+        if (read > 0) {
+            esp_err_t err = httpd_resp_send_chunk(req, buffer, read);
+            if (err != ESP_OK) {
+                std::fclose(file);
+                return err;
+            }
+        }
+        if (std::ferror(file)) {
+            break;
         }
     }
 
+    std::fclose(file);
     return httpd_resp_send_chunk(req, nullptr, 0);
 }
 
@@ -697,26 +2162,31 @@ esp_err_t WebServerManager::SendJsonError(httpd_req_t* req, int statusCode, cons
 }
 
 esp_err_t WebServerManager::ApiGetHandler(httpd_req_t* req) {
+    HttpdWorkScope work;
     auto* self = static_cast<WebServerManager*>(req->user_ctx);
     return (self == nullptr) ? ESP_FAIL : self->HandleApiRequest(req);
 }
 
 esp_err_t WebServerManager::ApiPostHandler(httpd_req_t* req) {
+    HttpdWorkScope work;
     auto* self = static_cast<WebServerManager*>(req->user_ctx);
     return (self == nullptr) ? ESP_FAIL : self->HandleApiRequest(req);
 }
 
 esp_err_t WebServerManager::ApiPutHandler(httpd_req_t* req) {
+    HttpdWorkScope work;
     auto* self = static_cast<WebServerManager*>(req->user_ctx);
     return (self == nullptr) ? ESP_FAIL : self->HandleApiRequest(req);
 }
 
 esp_err_t WebServerManager::ApiDeleteHandler(httpd_req_t* req) {
+    HttpdWorkScope work;
     auto* self = static_cast<WebServerManager*>(req->user_ctx);
     return (self == nullptr) ? ESP_FAIL : self->HandleApiRequest(req);
 }
 
 esp_err_t WebServerManager::HandleApiRequest(httpd_req_t* req) {
+    TRACE_SCOPE("WebServerManager::HandleApiRequest");
     if (req == nullptr) {
         return ESP_FAIL;
     }
@@ -740,7 +2210,8 @@ esp_err_t WebServerManager::HandleApiRequest(httpd_req_t* req) {
 }
 esp_err_t WebServerManager::HandleApiGet(httpd_req_t* req, const std::string& path) {
     if (path == "/api/v1/status") {
-        return SendJsonSuccess(req, JsonStringFromObject(BuildStatusDataObject()));
+        return SendJsonSuccess(
+            req, JsonStringFromObject(BuildStatusDataObject(LatestTelemetrySnapshot(), ProfileEngine::getInstance().GetRuntimeStatus())));
     }
 
     if (path == "/api/v1/controller/config") {
@@ -773,6 +2244,7 @@ esp_err_t WebServerManager::HandleApiGet(httpd_req_t* req, const std::string& pa
         cJSON_AddItemToObject(root, "pid", pidObj);
 
         cJSON_AddNumberToObject(root, "input_filter_ms", controller.GetInputFilterTimeMs());
+        cJSON_AddNumberToObject(root, "tick_ms", controller.GetTickIntervalMs());
 
         cJSON* inputs = cJSON_CreateArray();
         for (int channel : controller.GetInputChannels()) {
@@ -812,8 +2284,19 @@ esp_err_t WebServerManager::HandleApiGet(httpd_req_t* req, const std::string& pa
             cJSON_AddItemToArray(runningRelays, cJSON_CreateNumber(relay));
         }
         cJSON_AddItemToObject(relaysObj, "running_relays", runningRelays);
+        cJSON_AddStringToObject(relaysObj, "drive_mode", controller.GetRelayDriveMode() == PWM::Mode::BurstFire ? "burst" : "window");
+        cJSON_AddNumberToObject(relaysObj, "mains_hz", controller.GetMainsFrequencyHz());
         cJSON_AddItemToObject(root, "relays", relaysObj);
 
+        cJSON* zonesArr = cJSON_CreateArray();
+        for (const ControlZoneConfig& zone : controller.GetControlZones()) {
+            cJSON* zoneObj = cJSON_CreateObject();
+            cJSON_AddItemToObject(zoneObj, "inputs", BuildMaskArray(zone.inputMask));
+            cJSON_AddItemToObject(zoneObj, "relays", BuildMaskArray(zone.relayMask));
+            cJSON_AddItemToArray(zonesArr, zoneObj);
+        }
+        cJSON_AddItemToObject(root, "zones", zonesArr);
+
         cJSON* doorObj = cJSON_CreateObject();
         cJSON_AddNumberToObject(doorObj, "closed_angle_deg", controller.GetDoorClosedAngleDeg());
         cJSON_AddNumberToObject(doorObj, "open_angle_deg", controller.GetDoorOpenAngleDeg());
@@ -830,6 +2313,70 @@ esp_err_t WebServerManager::HandleApiGet(httpd_req_t* req, const std::string& pa
         cJSON_AddNumberToObject(heaterObj, "force_on_below_c", controller.GetForceHeaterOnBelowC());
         cJSON_AddItemToObject(root, "heater", heaterObj);
 
+        cJSON* feedforwardObj = cJSON_CreateObject();
+        cJSON_AddBoolToObject(feedforwardObj, "enabled", controller.IsFeedforwardEnabled());
+        cJSON_AddNumberToObject(feedforwardObj, "lookahead_s", controller.GetFeedforwardLookaheadS());
+        cJSON_AddNumberToObject(feedforwardObj, "gain", controller.GetFeedforwardGain());
+        cJSON_AddItemToObject(feedforwardObj, "model", BuildThermalModelObject(controller.GetThermalModel()));
+        cJSON_AddItemToObject(root, "feedforward", feedforwardObj);
+
+        const ProcessValuePipelineConfig pipeline = controller.GetProcessValuePipeline();
+        cJSON* pipelineObj = cJSON_CreateObject();
+        cJSON_AddStringToObject(pipelineObj, "filter", ProcessValueFilterModeName(pipeline.filterMode));
+        cJSON_AddBoolToObject(pipelineObj, "outlier_rejection", pipeline.outlierRejection);
+        cJSON_AddBoolToObject(pipelineObj, "derivative_from_rate", pipeline.derivativeFromRate);
+        cJSON* weights = cJSON_CreateArray();
+        for (double weight : pipeline.inputWeights) {
+            cJSON_AddItemToArray(weights, cJSON_CreateNumber(weight));
+        }
+        cJSON_AddItemToObject(pipelineObj, "input_weights", weights);
+        cJSON* rejectedReadings = cJSON_CreateArray();
+        for (uint32_t count : controller.GetRejectedReadingCounts()) {
+            cJSON_AddItemToArray(rejectedReadings, cJSON_CreateNumber(static_cast<double>(count)));
+        }
+        cJSON_AddItemToObject(pipelineObj, "rejected_readings", rejectedReadings);
+        cJSON_AddItemToObject(root, "pv_pipeline", pipelineObj);
+
+        return SendJsonSuccess(req, JsonStringFromObject(root));
+    }
+
+    if (path == "/api/v1/controller/autotune") {
+        const AutotuneStatus status = Controller::getInstance().GetAutotuneStatus();
+        cJSON* root = cJSON_CreateObject();
+        cJSON_AddStringToObject(root, "state", AutotuneStateName(status.state));
+        cJSON_AddNumberToObject(root, "cycle", status.completedCycles);
+        cJSON_AddNumberToObject(root, "cycles", status.totalCycles);
+        cJSON_AddNumberToObject(root, "elapsed_s", status.elapsedS);
+        cJSON_AddStringToObject(root, "failure_reason", status.failureReason.c_str());
+
+        cJSON* configObj = cJSON_CreateObject();
+        cJSON_AddNumberToObject(configObj, "setpoint_c", status.config.setPointC);
+        cJSON_AddNumberToObject(configObj, "heat_output_pct", status.config.heatOutputPct);
+        cJSON_AddNumberToObject(configObj, "cool_output_pct", status.config.coolOutputPct);
+        cJSON_AddNumberToObject(configObj, "hysteresis_c", status.config.hysteresisC);
+        cJSON_AddNumberToObject(configObj, "max_duration_s", status.config.maxDurationS);
+        cJSON_AddItemToObject(root, "config", configObj);
+
+        if (status.state == AutotuneState::Complete) {
+            cJSON* resultObj = cJSON_CreateObject();
+            cJSON_AddNumberToObject(resultObj, "ultimate_gain", status.result.ultimateGain);
+            cJSON_AddNumberToObject(resultObj, "ultimate_period_s", status.result.ultimatePeriodS);
+            cJSON_AddNumberToObject(resultObj, "amplitude_c", status.result.amplitudeC);
+
+            cJSON* heatingObj = cJSON_CreateObject();
+            cJSON_AddNumberToObject(heatingObj, "kp", status.result.heatingKp);
+            cJSON_AddNumberToObject(heatingObj, "ki", status.result.heatingKi);
+            cJSON_AddNumberToObject(heatingObj, "kd", status.result.heatingKd);
+            cJSON_AddItemToObject(resultObj, "heating", heatingObj);
+
+            cJSON* coolingObj = cJSON_CreateObject();
+            cJSON_AddNumberToObject(coolingObj, "kp", status.result.coolingKp);
+            cJSON_AddNumberToObject(coolingObj, "ki", status.result.coolingKi);
+            cJSON_AddNumberToObject(coolingObj, "kd", status.result.coolingKd);
+            cJSON_AddItemToObject(resultObj, "cooling", coolingObj);
+            cJSON_AddItemToObject(root, "result", resultObj);
+        }
+
         return SendJsonSuccess(req, JsonStringFromObject(root));
     }
 
@@ -876,26 +2423,106 @@ esp_err_t WebServerManager::HandleApiGet(httpd_req_t* req, const std::string& pa
         cJSON_AddNumberToObject(root, "points", static_cast<double>(data.GetDataPointCount()));
         cJSON_AddNumberToObject(root, "bytes_used", static_cast<double>(data.GetStorageBytesUsed()));
         cJSON_AddNumberToObject(root, "max_points", static_cast<double>(data.GetMaxDataPoints()));
+        cJSON* tiers = cJSON_AddArrayToObject(root, "rollup_tiers");
+        for (DataResolution resolution : {DataResolution::TenSeconds, DataResolution::SixtySeconds}) {
+            cJSON* tier = cJSON_CreateObject();
+            cJSON_AddNumberToObject(tier, "resolution_s", DataManager::GetResolutionSeconds(resolution));
+            cJSON_AddNumberToObject(tier, "points", static_cast<double>(data.GetRollupCount(resolution)));
+            cJSON_AddNumberToObject(tier, "max_points", static_cast<double>(data.GetMaxRollupCount(resolution)));
+            cJSON_AddItemToArray(tiers, tier);
+        }
         return SendJsonSuccess(req, JsonStringFromObject(root));
     }
 
     if (path == "/api/v1/data/history") {
         std::size_t limit = 0;
+        bool binary = false;
+        bool hasSince = false;
+        DataResolution resolution = DataResolution::Raw;
+        uint64_t since = 0;
         const std::string query = GetRequestQuery(req);
         if (!query.empty()) {
-            char value[16] = {};
+            char value[24] = {};
             if (httpd_query_key_value(query.c_str(), "limit", value, sizeof(value)) == ESP_OK) {
                 limit = static_cast<std::size_t>(std::strtoul(value, nullptr, 10));
             }
+
+            char sinceValue[24] = {};
+            if (httpd_query_key_value(query.c_str(), "since", sinceValue, sizeof(sinceValue)) == ESP_OK) {
+                char* end = nullptr;
+                since = static_cast<uint64_t>(std::strtoull(sinceValue, &end, 10));
+                if (end == sinceValue || *end != '\0') {
+                    return SendJsonError(req, 400, "INVALID_SINCE", "since must be a sequence number");
+                }
+                hasSince = true;
+            }
+
+            char format[8] = {};
+            if (httpd_query_key_value(query.c_str(), "format", format, sizeof(format)) == ESP_OK) {
+                if (std::strcmp(format, "bin") == 0) {
+                    binary = true;
+                } else if (std::strcmp(format, "json") != 0) {
+                    return SendJsonError(req, 400, "INVALID_FORMAT", "format must be json or bin");
+                }
+            }
+
+            char resolutionValue[8] = {};
+            if (httpd_query_key_value(query.c_str(), "resolution", resolutionValue, sizeof(resolutionValue)) == ESP_OK) {
+                if (std::strcmp(resolutionValue, "10s") == 0) {
+                    resolution = DataResolution::TenSeconds;
+                } else if (std::strcmp(resolutionValue, "60s") == 0) {
+                    resolution = DataResolution::SixtySeconds;
+                } else if (std::strcmp(resolutionValue, "raw") != 0) {
+                    return SendJsonError(req, 400, "INVALID_RESOLUTION", "resolution must be raw, 10s or 60s");
+                }
+            }
         }
 
-        const DataPointStorage points = DataManager::getInstance().GetRecentData(limit);
-        return SendHistoryJson(req, points);
+        DataManager& data = DataManager::getInstance();
+        const DataHistoryCursor cursor = hasSince
+            ? data.OpenHistoryCursorSince(since, limit, resolution)
+            : data.OpenHistoryCursor(limit, resolution);
+        if (resolution != DataResolution::Raw) {
+            if (binary) {
+                return SendJsonError(req, 400, "INVALID_FORMAT", "binary format is only available at raw resolution");
+            }
+            return SendHistoryRollupJson(req, cursor);
+        }
+        if (binary) {
+            return SendHistoryBinary(req, cursor);
+        }
+        return SendHistoryJson(req, cursor);
     }
 
     if (path == "/api/v1/data/export.csv") {
-        const DataPointStorage points = DataManager::getInstance().GetAllData();
-        return SendHistoryCsv(req, points);
+        return SendHistoryCsv(req);
+    }
+
+    if (path == "/api/v1/runs") {
+        RunLogManager& runLog = RunLogManager::getInstance();
+        if (!runLog.IsInitialized()) {
+            return SendJsonError(req, 503, "RUN_LOG_UNAVAILABLE", "Run log storage is not available");
+        }
+
+        cJSON* root = cJSON_CreateObject();
+        cJSON* runsArr = cJSON_CreateArray();
+        for (const RunLogInfo& run : runLog.ListRuns()) {
+            cJSON* runObj = cJSON_CreateObject();
+            cJSON_AddNumberToObject(runObj, "id", static_cast<double>(run.runId));
+            cJSON_AddNumberToObject(runObj, "size_bytes", static_cast<double>(run.sizeBytes));
+            cJSON_AddNumberToObject(runObj, "start_unix_s", static_cast<double>(run.startUnixTime));
+            cJSON_AddNumberToObject(runObj, "first_timestamp", static_cast<double>(run.firstTimestamp));
+            cJSON_AddBoolToObject(runObj, "active", run.active);
+            cJSON_AddItemToArray(runsArr, runObj);
+        }
+        cJSON_AddItemToObject(root, "runs", runsArr);
+        cJSON_AddNumberToObject(root, "dropped_records", static_cast<double>(runLog.GetDroppedRecordCount()));
+        return SendJsonSuccess(req, JsonStringFromObject(root));
+    }
+
+    uint32_t runId = 0;
+    if (ParseRunPath(path, runId)) {
+        return SendRunFile(req, runId);
     }
 
     if (path == "/api/v1/system/info") {
@@ -916,6 +2543,14 @@ esp_err_t WebServerManager::HandleApiGet(httpd_req_t* req, const std::string& pa
         return SendJsonSuccess(req, JsonStringFromObject(root));
     }
 
+    if (path == "/api/v1/diagnostics/trace") {
+        return SendTraceJson(req);
+    }
+
+    if (path == "/api/v1/diagnostics") {
+        return SendJsonSuccess(req, JsonStringFromObject(BuildDiagnosticsDataObject(server, maxOpenSockets, GetWsSendStats())));
+    }
+
     if (path == "/api/v1/profiles") {
         ProfileEngine& profiles = ProfileEngine::getInstance();
         cJSON* root = cJSON_CreateObject();
@@ -924,6 +2559,8 @@ esp_err_t WebServerManager::HandleApiGet(httpd_req_t* req, const std::string& pa
         cJSON* limits = cJSON_CreateObject();
         cJSON_AddNumberToObject(limits, "max_slots", ProfileEngine::MAX_SLOTS);
         cJSON_AddNumberToObject(limits, "max_steps", ProfileEngine::MAX_STEPS);
+        cJSON_AddNumberToObject(limits, "max_name_bytes", static_cast<double>(ProfileEngine::MAX_NAME_BYTES));
+        cJSON_AddNumberToObject(limits, "max_description_bytes", static_cast<double>(ProfileEngine::MAX_DESCRIPTION_BYTES));
         cJSON_AddItemToObject(root, "limits", limits);
 
         cJSON* uploaded = cJSON_CreateObject();
@@ -950,6 +2587,10 @@ esp_err_t WebServerManager::HandleApiGet(httpd_req_t* req, const std::string& pa
         return SendJsonSuccess(req, JsonStringFromObject(root));
     }
 
+    if (path == "/api/v1/profiles/simulate") {
+        return SendSimulationJson(req);
+    }
+
     if (path == "/api/v1/profiles/uploaded") {
         const std::optional<ProfileDefinition> uploadedProfile = ProfileEngine::getInstance().GetUploadedProfile();
         if (!uploadedProfile.has_value()) {
@@ -962,7 +2603,7 @@ esp_err_t WebServerManager::HandleApiGet(httpd_req_t* req, const std::string& pa
     int slotIndex = -1;
     if (ParseSlotPath(path, slotIndex)) {
         if (slotIndex < 0 || slotIndex >= ProfileEngine::MAX_SLOTS) {
-            return SendJsonError(req, 400, "PROFILE_SLOT_INVALID", "slot index must be in [0,4]");
+            return SendJsonError(req, 400, "PROFILE_SLOT_INVALID", SlotIndexRangeMessage().c_str());
         }
 
         ProfileDefinition slotProfile;
@@ -1020,46 +2661,291 @@ esp_err_t WebServerManager::HandleApiPost(httpd_req_t* req, const std::string& p
         cJSON* setpoint = cJSON_GetObjectItem(json, "setpoint_c");
         if (!cJSON_IsNumber(setpoint)) {
             cJSON_Delete(json);
-            return SendJsonError(req, 400, "BAD_SETPOINT", "setpoint_c must be numeric");
+            return SendJsonError(req, 400, "BAD_SETPOINT", "setpoint_c must be numeric");
+        }
+
+        if (Controller::getInstance().IsSetpointLockedByProfile()) {
+            cJSON_Delete(json);
+            return SendJsonError(req, 409, "PROFILE_SETPOINT_LOCKED", "setpoint is locked while a profile is running");
+        }
+
+        esp_err_t err = Controller::getInstance().SetSetPoint(setpoint->valuedouble);
+        cJSON_Delete(json);
+        if (err != ESP_OK) {
+            return SendJsonError(req, 400, "SETPOINT_FAILED", esp_err_to_name(err));
+        }
+
+        return SendJsonSuccess(req, "{}");
+    }
+
+    if (path == "/api/v1/control/door/open") {
+        esp_err_t err = Controller::getInstance().OpenDoor();
+        if (err == ESP_ERR_INVALID_STATE) {
+            return SendJsonError(req, 409, "DOOR_CONTROL_BLOCKED", "door control is only allowed while not running");
+        }
+        if (err != ESP_OK) {
+            return SendJsonError(req, 400, "DOOR_CONTROL_FAILED", esp_err_to_name(err));
+        }
+        return SendJsonSuccess(req, "{}");
+    }
+
+    if (path == "/api/v1/control/door/close") {
+        esp_err_t err = Controller::getInstance().CloseDoor();
+        if (err == ESP_ERR_INVALID_STATE) {
+            return SendJsonError(req, 409, "DOOR_CONTROL_BLOCKED", "door control is only allowed while not running");
+        }
+        if (err != ESP_OK) {
+            return SendJsonError(req, 400, "DOOR_CONTROL_FAILED", esp_err_to_name(err));
+        }
+        return SendJsonSuccess(req, "{}");
+    }
+
+    if (path == "/api/v1/control/door/preview") {
+        std::string body;
+        if (ReadRequestBody(req, body) != ESP_OK) {
+            return SendJsonError(req, 400, "BAD_BODY", "Failed to read request body");
+        }
+
+        cJSON* json = cJSON_Parse(body.c_str());
+        if (json == nullptr) {
+            return SendJsonError(req, 400, "BAD_JSON", "Invalid JSON");
+        }
+
+        cJSON* angleDeg = cJSON_GetObjectItem(json, "angle_deg");
+        if (!cJSON_IsNumber(angleDeg)) {
+            cJSON_Delete(json);
+            return SendJsonError(req, 400, "BAD_DOOR_PREVIEW_ARGS", "angle_deg is required numeric field");
+        }
+
+        esp_err_t err = Controller::getInstance().SetDoorPreviewAngle(angleDeg->valuedouble);
+        cJSON_Delete(json);
+        if (err == ESP_ERR_INVALID_STATE) {
+            return SendJsonError(req, 409, "DOOR_PREVIEW_BLOCKED", "door preview is only allowed while not running");
+        }
+        if (err != ESP_OK) {
+            return SendJsonError(req, 400, "DOOR_PREVIEW_FAILED", esp_err_to_name(err));
+        }
+        return SendJsonSuccess(req, "{}");
+    }
+
+    if (path == "/api/v1/profiles/uploaded") {
+        std::string body;
+        if (ReadRequestBody(req, body) != ESP_OK) {
+            return SendJsonError(req, 400, "BAD_BODY", "Failed to read request body");
+        }
+
+        ProfileDefinition parsedProfile;
+        std::vector<ProfileValidationError> errors;
+        esp_err_t err = ProfileEngine::getInstance().ParseProfileJson(body, parsedProfile, errors);
+        if (err != ESP_OK) {
+            return SendJsonError(req, 400, "PROFILE_VALIDATION_FAILED", BuildValidationMessage(errors).c_str());
+        }
+
+        err = ProfileEngine::getInstance().SetUploadedProfile(parsedProfile, &errors);
+        if (err != ESP_OK) {
+            return SendJsonError(req, 400, "PROFILE_VALIDATION_FAILED", BuildValidationMessage(errors).c_str());
+        }
+
+        return SendJsonSuccess(req, "{}");
+    }
+
+    if (path == "/api/v1/profiles/run") {
+        std::string body;
+        if (ReadRequestBody(req, body) != ESP_OK) {
+            return SendJsonError(req, 400, "BAD_BODY", "Failed to read request body");
+        }
+
+        cJSON* json = cJSON_Parse(body.c_str());
+        if (json == nullptr) {
+            return SendJsonError(req, 400, "BAD_JSON", "Invalid JSON");
+        }
+
+        cJSON* source = cJSON_GetObjectItem(json, "source");
+        if (!cJSON_IsString(source) || source->valuestring == nullptr) {
+            cJSON_Delete(json);
+            return SendJsonError(req, 400, "BAD_PROFILE_RUN_ARGS", "source must be 'uploaded' or 'slot'");
+        }
+
+        esp_err_t err = ESP_OK;
+        const std::string sourceValue = source->valuestring;
+        if (sourceValue == "uploaded") {
+            err = ProfileEngine::getInstance().StartFromUploaded();
+        } else if (sourceValue == "slot") {
+            cJSON* slotIndex = cJSON_GetObjectItem(json, "slot_index");
+            if (!cJSON_IsNumber(slotIndex)) {
+                cJSON_Delete(json);
+                return SendJsonError(req, 400, "BAD_PROFILE_RUN_ARGS", "slot_index must be numeric when source is slot");
+            }
+            if (slotIndex->valueint < 0 || slotIndex->valueint >= ProfileEngine::MAX_SLOTS) {
+                cJSON_Delete(json);
+                return SendJsonError(req, 400, "PROFILE_SLOT_INVALID", SlotIndexRangeMessage().c_str());
+            }
+            err = ProfileEngine::getInstance().StartFromSlot(slotIndex->valueint);
+        } else {
+            cJSON_Delete(json);
+            return SendJsonError(req, 400, "BAD_PROFILE_RUN_ARGS", "source must be 'uploaded' or 'slot'");
+        }
+
+        cJSON_Delete(json);
+
+        if (err == ESP_ERR_INVALID_STATE && ProfileEngine::getInstance().IsRunning()) {
+            return SendJsonError(req, 409, "PROFILE_ALREADY_RUNNING", "A profile is already running");
+        }
+        if (err == ESP_ERR_NOT_FOUND) {
+            return SendJsonError(req, 404, "PROFILE_NOT_FOUND", "Requested profile source was not found");
+        }
+        if (err == ESP_ERR_INVALID_ARG) {
+            return SendJsonError(req, 400, "PROFILE_VALIDATION_FAILED", "Profile failed validation");
+        }
+        if (err != ESP_OK) {
+            return SendJsonError(req, 409, "PROFILE_START_FAILED", esp_err_to_name(err));
+        }
+
+        return SendJsonSuccess(req, "{}");
+    }
+
+    if (path == "/api/v1/profiles/simulate/start") {
+        std::string body;
+        if (ReadRequestBody(req, body) != ESP_OK) {
+            return SendJsonError(req, 400, "BAD_BODY", "Failed to read request body");
+        }
+
+        cJSON* json = cJSON_Parse(body.c_str());
+        if (json == nullptr) {
+            return SendJsonError(req, 400, "BAD_JSON", "Invalid JSON");
+        }
+
+        // The profile comes inline (an unsaved editor draft) or from the same
+        // sources /profiles/run accepts.
+        ProfileEngine& profileEngine = ProfileEngine::getInstance();
+        ProfileDefinition profile;
+        cJSON* profileJson = cJSON_GetObjectItem(json, "profile");
+        cJSON* source = cJSON_GetObjectItem(json, "source");
+        if (cJSON_IsObject(profileJson)) {
+            char* profileText = cJSON_PrintUnformatted(profileJson);
+            if (profileText == nullptr) {
+                cJSON_Delete(json);
+                return SendJsonError(req, 500, "JSON_ENCODE_FAILED", "Failed to encode profile");
+            }
+            std::vector<ProfileValidationError> errors;
+            const esp_err_t err = profileEngine.ParseProfileJson(profileText, profile, errors);
+            cJSON_free(profileText);
+            if (err != ESP_OK) {
+                cJSON_Delete(json);
+                return SendJsonError(req, 400, "PROFILE_VALIDATION_FAILED", BuildValidationMessage(errors).c_str());
+            }
+        } else if (cJSON_IsString(source) && source->valuestring != nullptr && std::string(source->valuestring) == "uploaded") {
+            const std::optional<ProfileDefinition> uploadedProfile = profileEngine.GetUploadedProfile();
+            if (!uploadedProfile.has_value()) {
+                cJSON_Delete(json);
+                return SendJsonError(req, 404, "PROFILE_NOT_FOUND", "No uploaded profile in memory");
+            }
+            profile = uploadedProfile.value();
+        } else if (cJSON_IsString(source) && source->valuestring != nullptr && std::string(source->valuestring) == "slot") {
+            cJSON* slotIndex = cJSON_GetObjectItem(json, "slot_index");
+            if (!cJSON_IsNumber(slotIndex)) {
+                cJSON_Delete(json);
+                return SendJsonError(req, 400, "BAD_SIMULATION_ARGS", "slot_index must be numeric when source is slot");
+            }
+            if (slotIndex->valueint < 0 || slotIndex->valueint >= ProfileEngine::MAX_SLOTS) {
+                cJSON_Delete(json);
+                return SendJsonError(req, 400, "PROFILE_SLOT_INVALID", SlotIndexRangeMessage().c_str());
+            }
+            const esp_err_t err = profileEngine.GetSlotProfile(slotIndex->valueint, profile);
+            if (err != ESP_OK) {
+                cJSON_Delete(json);
+                if (err == ESP_ERR_NOT_FOUND) {
+                    return SendJsonError(req, 404, "PROFILE_NOT_FOUND", "Profile slot is empty");
+                }
+                return SendJsonError(req, 500, "PROFILE_LOAD_FAILED", esp_err_to_name(err));
+            }
+        } else {
+            cJSON_Delete(json);
+            return SendJsonError(req, 400, "BAD_SIMULATION_ARGS", "profile must be an object, or source 'uploaded' or 'slot'");
         }
 
-        if (Controller::getInstance().IsSetpointLockedByProfile()) {
-            cJSON_Delete(json);
-            return SendJsonError(req, 409, "PROFILE_SETPOINT_LOCKED", "setpoint is locked while a profile is running");
+        Controller& controller = Controller::getInstance();
+        SimulationConfig config;
+        config.model = controller.GetThermalModel();
+        config.initialPvC = controller.GetProcessValue();
+        config.stepS = static_cast<double>(controller.GetNominalTickIntervalMs()) / 1000.0;
+        config.controller = ProfileSimulator::CaptureControllerConfig();
+
+        const struct {
+            const char* key;
+            double* value;
+        } optionalFields[] = {
+            {"initial_pv_c", &config.initialPvC},
+            {"dead_time_s", &config.deadTimeS},
+            {"step_s", &config.stepS},
+            {"max_duration_s", &config.maxDurationS},
+        };
+        for (const auto& field : optionalFields) {
+            cJSON* item = cJSON_GetObjectItem(json, field.key);
+            if (item == nullptr) {
+                continue;
+            }
+            if (!cJSON_IsNumber(item)) {
+                cJSON_Delete(json);
+                return SendJsonError(req, 400, "BAD_SIMULATION_ARGS", "simulation parameters must be numeric");
+            }
+            *field.value = item->valuedouble;
         }
-
-        esp_err_t err = Controller::getInstance().SetSetPoint(setpoint->valuedouble);
-        cJSON_Delete(json);
-        if (err != ESP_OK) {
-            return SendJsonError(req, 400, "SETPOINT_FAILED", esp_err_to_name(err));
+        cJSON* model = cJSON_GetObjectItem(json, "model");
+        if (model != nullptr) {
+            if (!cJSON_IsObject(model)) {
+                cJSON_Delete(json);
+                return SendJsonError(req, 400, "BAD_SIMULATION_ARGS", "model must be an object");
+            }
+            const struct {
+                const char* key;
+                double* value;
+            } modelFields[] = {
+                {"gain_c_per_pct", &config.model.gainCPerPct},
+                {"time_constant_s", &config.model.timeConstantS},
+                {"ambient_c", &config.model.ambientC},
+            };
+            for (const auto& field : modelFields) {
+                cJSON* item = cJSON_GetObjectItem(model, field.key);
+                if (item == nullptr) {
+                    continue;
+                }
+                if (!cJSON_IsNumber(item)) {
+                    cJSON_Delete(json);
+                    return SendJsonError(req, 400, "BAD_SIMULATION_ARGS", "model fields must be numeric");
+                }
+                *field.value = item->valuedouble;
+            }
         }
+        cJSON_Delete(json);
 
-        return SendJsonSuccess(req, "{}");
-    }
+        if (!config.model.IsValid()) {
+            return SendJsonError(req, 409, "MODEL_NOT_FITTED", "Fit or supply a thermal model before simulating");
+        }
 
-    if (path == "/api/v1/control/door/open") {
-        esp_err_t err = Controller::getInstance().OpenDoor();
+        ProfileSimulator& simulator = ProfileSimulator::getInstance();
+        esp_err_t err = simulator.Start(profile, config);
         if (err == ESP_ERR_INVALID_STATE) {
-            return SendJsonError(req, 409, "DOOR_CONTROL_BLOCKED", "door control is only allowed while not running");
+            return SendJsonError(req, 409, "SIMULATION_RUNNING", "A simulation is already running");
+        }
+        if (err == ESP_ERR_INVALID_ARG) {
+            return SendJsonError(req, 400, "BAD_SIMULATION_ARGS", "simulation parameters out of range");
         }
         if (err != ESP_OK) {
-            return SendJsonError(req, 400, "DOOR_CONTROL_FAILED", esp_err_to_name(err));
+            return SendJsonError(req, 500, "SIMULATION_START_FAILED", esp_err_to_name(err));
         }
         return SendJsonSuccess(req, "{}");
     }
 
-    if (path == "/api/v1/control/door/close") {
-        esp_err_t err = Controller::getInstance().CloseDoor();
-        if (err == ESP_ERR_INVALID_STATE) {
-            return SendJsonError(req, 409, "DOOR_CONTROL_BLOCKED", "door control is only allowed while not running");
-        }
+    if (path == "/api/v1/profiles/simulate/cancel") {
+        esp_err_t err = ProfileSimulator::getInstance().Cancel();
         if (err != ESP_OK) {
-            return SendJsonError(req, 400, "DOOR_CONTROL_FAILED", esp_err_to_name(err));
+            return SendJsonError(req, 409, "SIMULATION_NOT_RUNNING", esp_err_to_name(err));
         }
         return SendJsonSuccess(req, "{}");
     }
 
-    if (path == "/api/v1/control/door/preview") {
+    if (path == "/api/v1/controller/autotune/start") {
         std::string body;
         if (ReadRequestBody(req, body) != ESP_OK) {
             return SendJsonError(req, 400, "BAD_BODY", "Failed to read request body");
@@ -1070,96 +2956,128 @@ esp_err_t WebServerManager::HandleApiPost(httpd_req_t* req, const std::string& p
             return SendJsonError(req, 400, "BAD_JSON", "Invalid JSON");
         }
 
-        cJSON* angleDeg = cJSON_GetObjectItem(json, "angle_deg");
-        if (!cJSON_IsNumber(angleDeg)) {
+        AutotuneConfig config;
+        cJSON* setpoint = cJSON_GetObjectItem(json, "setpoint_c");
+        if (!cJSON_IsNumber(setpoint)) {
             cJSON_Delete(json);
-            return SendJsonError(req, 400, "BAD_DOOR_PREVIEW_ARGS", "angle_deg is required numeric field");
+            return SendJsonError(req, 400, "BAD_AUTOTUNE_ARGS", "setpoint_c must be numeric");
+        }
+        config.setPointC = setpoint->valuedouble;
+
+        const struct {
+            const char* key;
+            double* value;
+        } optionalFields[] = {
+            {"heat_output_pct", &config.heatOutputPct},
+            {"cool_output_pct", &config.coolOutputPct},
+            {"hysteresis_c", &config.hysteresisC},
+            {"max_duration_s", &config.maxDurationS},
+        };
+        for (const auto& field : optionalFields) {
+            cJSON* item = cJSON_GetObjectItem(json, field.key);
+            if (item == nullptr) {
+                continue;
+            }
+            if (!cJSON_IsNumber(item)) {
+                cJSON_Delete(json);
+                return SendJsonError(req, 400, "BAD_AUTOTUNE_ARGS", "autotune parameters must be numeric");
+            }
+            *field.value = item->valuedouble;
+        }
+        cJSON* cycles = cJSON_GetObjectItem(json, "cycles");
+        if (cycles != nullptr) {
+            if (!cJSON_IsNumber(cycles)) {
+                cJSON_Delete(json);
+                return SendJsonError(req, 400, "BAD_AUTOTUNE_ARGS", "cycles must be numeric");
+            }
+            config.cycles = cycles->valueint;
         }
-
-        esp_err_t err = Controller::getInstance().SetDoorPreviewAngle(angleDeg->valuedouble);
         cJSON_Delete(json);
-        if (err == ESP_ERR_INVALID_STATE) {
-            return SendJsonError(req, 409, "DOOR_PREVIEW_BLOCKED", "door preview is only allowed while not running");
+
+        if (ProfileEngine::getInstance().IsRunning()) {
+            return SendJsonError(req, 409, "PROFILE_RUNNING", "Stop the running profile before autotuning");
+        }
+
+        esp_err_t err = Controller::getInstance().StartAutotune(config);
+        if (err == ESP_ERR_INVALID_ARG) {
+            return SendJsonError(req, 400, "BAD_AUTOTUNE_ARGS", "autotune parameters out of range");
         }
         if (err != ESP_OK) {
-            return SendJsonError(req, 400, "DOOR_PREVIEW_FAILED", esp_err_to_name(err));
+            return SendJsonError(req, 409, "AUTOTUNE_START_FAILED", esp_err_to_name(err));
         }
         return SendJsonSuccess(req, "{}");
     }
 
-    if (path == "/api/v1/profiles/uploaded") {
-        std::string body;
-        if (ReadRequestBody(req, body) != ESP_OK) {
-            return SendJsonError(req, 400, "BAD_BODY", "Failed to read request body");
-        }
-
-        ProfileDefinition parsedProfile;
-        std::vector<ProfileValidationError> errors;
-        esp_err_t err = ProfileEngine::getInstance().ParseProfileJson(body, parsedProfile, errors);
+    if (path == "/api/v1/controller/autotune/cancel") {
+        esp_err_t err = Controller::getInstance().CancelAutotune();
         if (err != ESP_OK) {
-            return SendJsonError(req, 400, "PROFILE_VALIDATION_FAILED", BuildValidationMessage(errors).c_str());
+            return SendJsonError(req, 409, "AUTOTUNE_NOT_RUNNING", esp_err_to_name(err));
         }
+        return SendJsonSuccess(req, "{}");
+    }
 
-        err = ProfileEngine::getInstance().SetUploadedProfile(parsedProfile, &errors);
+    if (path == "/api/v1/controller/autotune/accept") {
+        esp_err_t err = Controller::getInstance().AcceptAutotuneResult();
+        if (err == ESP_ERR_INVALID_STATE) {
+            return SendJsonError(req, 409, "AUTOTUNE_NOT_COMPLETE", "No completed autotune result to accept");
+        }
         if (err != ESP_OK) {
-            return SendJsonError(req, 400, "PROFILE_VALIDATION_FAILED", BuildValidationMessage(errors).c_str());
+            return SendJsonError(req, 500, "AUTOTUNE_ACCEPT_FAILED", esp_err_to_name(err));
         }
-
         return SendJsonSuccess(req, "{}");
     }
 
-    if (path == "/api/v1/profiles/run") {
+    if (path == "/api/v1/controller/feedforward/fit") {
+        // Optional body {"apply": true} stores the fitted model and uses its dead time as the lookahead.
+        bool apply = false;
         std::string body;
-        if (ReadRequestBody(req, body) != ESP_OK) {
-            return SendJsonError(req, 400, "BAD_BODY", "Failed to read request body");
+        if (ReadRequestBody(req, body) == ESP_OK && !body.empty()) {
+            cJSON* json = cJSON_Parse(body.c_str());
+            if (json == nullptr) {
+                return SendJsonError(req, 400, "BAD_JSON", "Invalid JSON");
+            }
+            apply = cJSON_IsTrue(cJSON_GetObjectItem(json, "apply"));
+            cJSON_Delete(json);
         }
 
-        cJSON* json = cJSON_Parse(body.c_str());
-        if (json == nullptr) {
-            return SendJsonError(req, 400, "BAD_JSON", "Invalid JSON");
+        ThermalModelFit fit;
+        esp_err_t err = FitThermalModelFromHistory(fit);
+        if (err == ESP_ERR_NOT_FOUND) {
+            return SendJsonError(req, 409, "MODEL_FIT_NO_DATA", "Not enough logged heating history to fit a model");
         }
-
-        cJSON* source = cJSON_GetObjectItem(json, "source");
-        if (!cJSON_IsString(source) || source->valuestring == nullptr) {
-            cJSON_Delete(json);
-            return SendJsonError(req, 400, "BAD_PROFILE_RUN_ARGS", "source must be 'uploaded' or 'slot'");
+        if (err != ESP_OK) {
+            return SendJsonError(req, 422, "MODEL_FIT_FAILED", "Logged history does not fit a first-order model; log a heat-up with setpoint changes");
         }
 
-        esp_err_t err = ESP_OK;
-        const std::string sourceValue = source->valuestring;
-        if (sourceValue == "uploaded") {
-            err = ProfileEngine::getInstance().StartFromUploaded();
-        } else if (sourceValue == "slot") {
-            cJSON* slotIndex = cJSON_GetObjectItem(json, "slot_index");
-            if (!cJSON_IsNumber(slotIndex)) {
-                cJSON_Delete(json);
-                return SendJsonError(req, 400, "BAD_PROFILE_RUN_ARGS", "slot_index must be numeric when source is slot");
+        Controller& controller = Controller::getInstance();
+        if (apply) {
+            err = controller.SetThermalModel(fit.model);
+            if (err == ESP_OK) {
+                err = controller.SetFeedforwardConfig(controller.IsFeedforwardEnabled(),
+                    std::clamp(fit.deadTimeS, 0.0, 600.0), controller.GetFeedforwardGain());
             }
-            if (slotIndex->valueint < 0 || slotIndex->valueint >= ProfileEngine::MAX_SLOTS) {
-                cJSON_Delete(json);
-                return SendJsonError(req, 400, "PROFILE_SLOT_INVALID", "slot index must be in [0,4]");
+            if (err != ESP_OK) {
+                return SendJsonError(req, 500, "MODEL_APPLY_FAILED", esp_err_to_name(err));
             }
-            err = ProfileEngine::getInstance().StartFromSlot(slotIndex->valueint);
-        } else {
-            cJSON_Delete(json);
-            return SendJsonError(req, 400, "BAD_PROFILE_RUN_ARGS", "source must be 'uploaded' or 'slot'");
         }
 
-        cJSON_Delete(json);
+        cJSON* root = cJSON_CreateObject();
+        cJSON_AddItemToObject(root, "model", BuildThermalModelObject(fit.model));
+        cJSON_AddNumberToObject(root, "dead_time_s", fit.deadTimeS);
+        cJSON_AddNumberToObject(root, "rmse_c_per_s", fit.rmseCPerS);
+        cJSON_AddNumberToObject(root, "samples", static_cast<double>(fit.samples));
+        cJSON_AddBoolToObject(root, "applied", apply);
+        return SendJsonSuccess(req, JsonStringFromObject(root));
+    }
 
-        if (err == ESP_ERR_INVALID_STATE && ProfileEngine::getInstance().IsRunning()) {
-            return SendJsonError(req, 409, "PROFILE_ALREADY_RUNNING", "A profile is already running");
-        }
-        if (err == ESP_ERR_NOT_FOUND) {
-            return SendJsonError(req, 404, "PROFILE_NOT_FOUND", "Requested profile source was not found");
-        }
-        if (err == ESP_ERR_INVALID_ARG) {
-            return SendJsonError(req, 400, "PROFILE_VALIDATION_FAILED", "Profile failed validation");
-        }
-        if (err != ESP_OK) {
-            return SendJsonError(req, 409, "PROFILE_START_FAILED", esp_err_to_name(err));
-        }
+    if (path == "/api/v1/diagnostics/reset") {
+        TickMonitor::getInstance().Reset();
+        return SendJsonSuccess(req, "{}");
+    }
 
+    if (path == "/api/v1/diagnostics/trace/clear") {
+        // Also re-arms a trace frozen by a tick overrun.
+        Tracer::getInstance().Clear();
         return SendJsonSuccess(req, "{}");
     }
 
@@ -1216,7 +3134,7 @@ esp_err_t WebServerManager::HandleApiPut(httpd_req_t* req, const std::string& pa
     if (ParseSlotPath(path, slotIndex)) {
         if (slotIndex < 0 || slotIndex >= ProfileEngine::MAX_SLOTS) {
             cJSON_Delete(json);
-            return SendJsonError(req, 400, "PROFILE_SLOT_INVALID", "slot index must be in [0,4]");
+            return SendJsonError(req, 400, "PROFILE_SLOT_INVALID", SlotIndexRangeMessage().c_str());
         }
 
         ProfileDefinition parsedProfile;
@@ -1233,6 +3151,9 @@ esp_err_t WebServerManager::HandleApiPut(httpd_req_t* req, const std::string& pa
         if (err == ESP_ERR_INVALID_STATE) {
             return SendJsonError(req, 409, "SLOT_OCCUPIED", "Slot already occupied; delete it first");
         }
+        if (err == ESP_ERR_NO_MEM) {
+            return SendJsonError(req, 409, "PROFILE_STORAGE_FULL", "Not enough profile storage; delete a slot first");
+        }
         if (err != ESP_OK) {
             return SendJsonError(req, 500, "PROFILE_SAVE_FAILED", esp_err_to_name(err));
         }
@@ -1310,6 +3231,8 @@ esp_err_t WebServerManager::HandleApiPut(httpd_req_t* req, const std::string& pa
             updateCooling = true;
         }
 
+        // One NVS commit for the whole form instead of one per gain.
+        SettingsBatch settingsBatch;
         esp_err_t err = controller.SetHeatingPIDGains(heatingKp, heatingKi, heatingKd);
         if (err == ESP_OK && updateCooling) {
             err = controller.SetCoolingPIDGains(coolingKp, coolingKi, coolingKd);
@@ -1326,6 +3249,9 @@ esp_err_t WebServerManager::HandleApiPut(httpd_req_t* req, const std::string& pa
         if (err == ESP_OK && integralLeakS != nullptr) {
             err = controller.SetIntegralLeakTimeSeconds(integralLeakS->valuedouble);
         }
+        if (err == ESP_OK) {
+            err = settingsBatch.Commit();
+        }
 
         cJSON_Delete(json);
         if (err != ESP_OK) {
@@ -1367,6 +3293,61 @@ esp_err_t WebServerManager::HandleApiPut(httpd_req_t* req, const std::string& pa
         return SendJsonSuccess(req, "{}");
     }
 
+    if (path == "/api/v1/controller/config/feedforward") {
+        Controller& controller = Controller::getInstance();
+        cJSON* enabled = cJSON_GetObjectItem(json, "enabled");
+        cJSON* lookahead = cJSON_GetObjectItem(json, "lookahead_s");
+        cJSON* gain = cJSON_GetObjectItem(json, "gain");
+        cJSON* model = cJSON_GetObjectItem(json, "model");
+        if ((enabled != nullptr && !cJSON_IsBool(enabled))
+                || (lookahead != nullptr && !cJSON_IsNumber(lookahead))
+                || (gain != nullptr && !cJSON_IsNumber(gain))
+                || (model != nullptr && !cJSON_IsObject(model))) {
+            cJSON_Delete(json);
+            return SendJsonError(req, 400, "BAD_FEEDFORWARD_ARGS", "enabled must be boolean, lookahead_s and gain numeric, model an object");
+        }
+
+        SettingsBatch settingsBatch;
+        esp_err_t err = ESP_OK;
+        if (model != nullptr) {
+            ThermalModel parsed = controller.GetThermalModel();
+            const struct {
+                const char* key;
+                double* value;
+            } modelFields[] = {
+                {"gain_c_per_pct", &parsed.gainCPerPct},
+                {"time_constant_s", &parsed.timeConstantS},
+                {"ambient_c", &parsed.ambientC},
+            };
+            for (const auto& field : modelFields) {
+                cJSON* item = cJSON_GetObjectItem(model, field.key);
+                if (item == nullptr) {
+                    continue;
+                }
+                if (!cJSON_IsNumber(item)) {
+                    cJSON_Delete(json);
+                    return SendJsonError(req, 400, "BAD_FEEDFORWARD_ARGS", "model fields must be numeric");
+                }
+                *field.value = item->valuedouble;
+            }
+            err = controller.SetThermalModel(parsed);
+        }
+        if (err == ESP_OK) {
+            err = controller.SetFeedforwardConfig(
+                enabled != nullptr ? cJSON_IsTrue(enabled) : controller.IsFeedforwardEnabled(),
+                lookahead != nullptr ? lookahead->valuedouble : controller.GetFeedforwardLookaheadS(),
+                gain != nullptr ? gain->valuedouble : controller.GetFeedforwardGain());
+        }
+        if (err == ESP_OK) {
+            err = settingsBatch.Commit();
+        }
+        cJSON_Delete(json);
+        if (err != ESP_OK) {
+            return SendJsonError(req, 400, "FEEDFORWARD_UPDATE_FAILED", esp_err_to_name(err));
+        }
+        return SendJsonSuccess(req, "{}");
+    }
+
     if (path == "/api/v1/controller/config/filter") {
         cJSON* filter = cJSON_GetObjectItem(json, "input_filter_ms");
         if (!cJSON_IsNumber(filter)) {
@@ -1383,6 +3364,65 @@ esp_err_t WebServerManager::HandleApiPut(httpd_req_t* req, const std::string& pa
         return SendJsonSuccess(req, "{}");
     }
 
+    if (path == "/api/v1/controller/config/pv_pipeline") {
+        // Fields are optional; anything left out keeps its current value.
+        Controller& controller = Controller::getInstance();
+        ProcessValuePipelineConfig pipeline = controller.GetProcessValuePipeline();
+        cJSON* filterMode = cJSON_GetObjectItem(json, "filter");
+        cJSON* outlierRejection = cJSON_GetObjectItem(json, "outlier_rejection");
+        cJSON* derivativeFromRate = cJSON_GetObjectItem(json, "derivative_from_rate");
+        cJSON* weights = cJSON_GetObjectItem(json, "input_weights");
+        bool valid = (outlierRejection == nullptr || cJSON_IsBool(outlierRejection))
+            && (derivativeFromRate == nullptr || cJSON_IsBool(derivativeFromRate))
+            && (filterMode == nullptr || (cJSON_IsString(filterMode)
+                && ParseProcessValueFilterMode(filterMode->valuestring, pipeline.filterMode)));
+        if (valid && weights != nullptr) {
+            valid = cJSON_IsArray(weights) && cJSON_GetArraySize(weights) == PV_INPUT_CHANNELS;
+            for (int channel = 0; valid && channel < PV_INPUT_CHANNELS; ++channel) {
+                cJSON* weight = cJSON_GetArrayItem(weights, channel);
+                valid = cJSON_IsNumber(weight) && weight->valuedouble >= 0.0 && weight->valuedouble <= 1.0;
+                if (valid) {
+                    pipeline.inputWeights[static_cast<std::size_t>(channel)] = weight->valuedouble;
+                }
+            }
+        }
+        if (!valid) {
+            cJSON_Delete(json);
+            return SendJsonError(req, 400, "BAD_PV_PIPELINE_ARGS",
+                "filter must be low_pass or alpha_beta, outlier_rejection and derivative_from_rate boolean, input_weights 4 numbers in 0..1");
+        }
+        if (outlierRejection != nullptr) {
+            pipeline.outlierRejection = cJSON_IsTrue(outlierRejection);
+        }
+        if (derivativeFromRate != nullptr) {
+            pipeline.derivativeFromRate = cJSON_IsTrue(derivativeFromRate);
+        }
+
+        esp_err_t err = controller.SetProcessValuePipeline(pipeline);
+        cJSON_Delete(json);
+        if (err != ESP_OK) {
+            return SendJsonError(req, 400, "PV_PIPELINE_UPDATE_FAILED", esp_err_to_name(err));
+        }
+        return SendJsonSuccess(req, "{}");
+    }
+
+    if (path == "/api/v1/controller/config/tick") {
+        // 0 ticks on every thermocouple pass; otherwise a fixed interval in ms.
+        cJSON* tick = cJSON_GetObjectItem(json, "tick_ms");
+        if (!cJSON_IsNumber(tick) || tick->valuedouble < 0.0) {
+            cJSON_Delete(json);
+            return SendJsonError(req, 400, "BAD_TICK_ARGS", "tick_ms is required non-negative numeric field");
+        }
+
+        esp_err_t err = Controller::getInstance().SetTickIntervalMs(static_cast<uint32_t>(tick->valuedouble));
+        cJSON_Delete(json);
+        if (err != ESP_OK) {
+            return SendJsonError(req, 400, "TICK_UPDATE_FAILED", esp_err_to_name(err));
+        }
+
+        return SendJsonSuccess(req, "{}");
+    }
+
     if (path == "/api/v1/controller/config/inputs") {
         cJSON* channels = cJSON_GetObjectItem(json, "channels");
         std::vector<int> parsed;
@@ -1400,10 +3440,43 @@ esp_err_t WebServerManager::HandleApiPut(httpd_req_t* req, const std::string& pa
         return SendJsonSuccess(req, "{}");
     }
 
+    if (path == "/api/v1/controller/config/zones") {
+        cJSON* zones = cJSON_GetObjectItem(json, "zones");
+        const int zoneCount = cJSON_IsArray(zones) ? cJSON_GetArraySize(zones) : 0;
+        if (zoneCount < 1 || zoneCount > MAX_CONTROL_ZONES) {
+            cJSON_Delete(json);
+            return SendJsonError(req, 400, "BAD_ZONES_ARGS", "zones must be an array of 1 to 4 {inputs, relays} entries");
+        }
+
+        std::vector<ControlZoneConfig> parsed(static_cast<std::size_t>(zoneCount));
+        for (int zone = 0; zone < zoneCount; ++zone) {
+            cJSON* entry = cJSON_GetArrayItem(zones, zone);
+            if (!ParseMaskArray(cJSON_GetObjectItem(entry, "inputs"), ThermocoupleSnapshot::MAX_CHANNELS, parsed[zone].inputMask)
+                    || !ParseMaskArray(cJSON_GetObjectItem(entry, "relays"), PWM::MAX_CHANNELS, parsed[zone].relayMask)) {
+                cJSON_Delete(json);
+                return SendJsonError(req, 400, "BAD_ZONES_ARGS", "zone inputs must be thermocouple channels and relays must be relay indices");
+            }
+        }
+        cJSON_Delete(json);
+
+        esp_err_t err = Controller::getInstance().SetControlZones(parsed);
+        if (err == ESP_ERR_INVALID_STATE) {
+            return SendJsonError(req, 409, "CONTROLLER_RUNNING", "stop the controller before changing zones");
+        }
+        if (err != ESP_OK) {
+            return SendJsonError(req, 400, "ZONES_UPDATE_FAILED",
+                err == ESP_ERR_INVALID_ARG ? "every zone needs inputs and its own PWM relays" : esp_err_to_name(err));
+        }
+
+        return SendJsonSuccess(req, "{}");
+    }
+
     if (path == "/api/v1/controller/config/relays") {
         cJSON* pwmRelays = cJSON_GetObjectItem(json, "pwm_relays");
         cJSON* runningRelays = cJSON_GetObjectItem(json, "running_relays");
         cJSON* pwmRelayWeights = cJSON_GetObjectItem(json, "pwm_relay_weights");
+        cJSON* driveMode = cJSON_GetObjectItem(json, "drive_mode");
+        cJSON* mainsHz = cJSON_GetObjectItem(json, "mains_hz");
 
         std::vector<int> parsedPwm;
         std::vector<int> parsedRunning;
@@ -1419,6 +3492,25 @@ esp_err_t WebServerManager::HandleApiPut(httpd_req_t* req, const std::string& pa
         }
 
         Controller& controller = Controller::getInstance();
+        PWM::Mode parsedMode = controller.GetRelayDriveMode();
+        if (driveMode != nullptr) {
+            if (!cJSON_IsString(driveMode)
+                    || (std::strcmp(driveMode->valuestring, "window") != 0 && std::strcmp(driveMode->valuestring, "burst") != 0)) {
+                cJSON_Delete(json);
+                return SendJsonError(req, 400, "BAD_RELAYS_ARGS", "drive_mode must be \"window\" or \"burst\"");
+            }
+            parsedMode = std::strcmp(driveMode->valuestring, "burst") == 0 ? PWM::Mode::BurstFire : PWM::Mode::Window;
+        }
+        uint8_t parsedMainsHz = controller.GetMainsFrequencyHz();
+        if (mainsHz != nullptr) {
+            if (!cJSON_IsNumber(mainsHz) || (mainsHz->valueint != 50 && mainsHz->valueint != 60)) {
+                cJSON_Delete(json);
+                return SendJsonError(req, 400, "BAD_RELAYS_ARGS", "mains_hz must be 50 or 60");
+            }
+            parsedMainsHz = static_cast<uint8_t>(mainsHz->valueint);
+        }
+
+        SettingsBatch settingsBatch;
         esp_err_t err = ESP_OK;
         if (pwmRelayWeights != nullptr) {
             std::unordered_map<int, double> mergedWeights;
@@ -1439,6 +3531,12 @@ esp_err_t WebServerManager::HandleApiPut(httpd_req_t* req, const std::string& pa
         if (err == ESP_OK) {
             err = controller.SetRelaysWhenRunning(parsedRunning);
         }
+        if (err == ESP_OK && (driveMode != nullptr || mainsHz != nullptr)) {
+            err = controller.SetRelayDriveMode(parsedMode, parsedMainsHz);
+        }
+        if (err == ESP_OK) {
+            err = settingsBatch.Commit();
+        }
 
         cJSON_Delete(json);
         if (err != ESP_OK) {
@@ -1542,10 +3640,26 @@ esp_err_t WebServerManager::HandleApiDelete(httpd_req_t* req, const std::string&
         return SendJsonSuccess(req, "{}");
     }
 
+    uint32_t runId = 0;
+    if (ParseRunPath(path, runId)) {
+        const esp_err_t err = RunLogManager::getInstance().DeleteRun(runId);
+        if (err == ESP_ERR_INVALID_STATE) {
+            return SendJsonError(req, 409, "RUN_ACTIVE", "Cannot delete the run currently being recorded");
+        }
+        if (err == ESP_ERR_NOT_FOUND) {
+            return SendJsonError(req, 404, "RUN_NOT_FOUND", "Run not found");
+        }
+        if (err != ESP_OK) {
+            return SendJsonError(req, 500, "RUN_DELETE_FAILED", esp_err_to_name(err));
+        }
+
+        return SendJsonSuccess(req, "{}");
+    }
+
     int slotIndex = -1;
     if (ParseSlotPath(path, slotIndex)) {
         if (slotIndex < 0 || slotIndex >= ProfileEngine::MAX_SLOTS) {
-            return SendJsonError(req, 400, "PROFILE_SLOT_INVALID", "slot index must be in [0,4]");
+            return SendJsonError(req, 400, "PROFILE_SLOT_INVALID", SlotIndexRangeMessage().c_str());
         }
 
         const esp_err_t err = ProfileEngine::getInstance().DeleteSlotProfile(slotIndex);
@@ -1560,6 +3674,7 @@ esp_err_t WebServerManager::HandleApiDelete(httpd_req_t* req, const std::string&
 }
 
 esp_err_t WebServerManager::WsHandler(httpd_req_t* req) {
+    HttpdWorkScope work;
     auto* self = static_cast<WebServerManager*>(req->user_ctx);
     return (self == nullptr) ? ESP_FAIL : self->HandleWebsocketRequest(req);
 }
@@ -1571,14 +3686,21 @@ esp_err_t WebServerManager::HandleWebsocketRequest(httpd_req_t* req) {
 
     if (req->method == HTTP_GET) {
         const int fd = httpd_req_to_sockfd(req);
-        AddWsClient(fd);
+        (void)httpd_sess_set_send_override(server, fd, &WsSessionSend);
 
-        const std::string payload = BuildTelemetryEnvelopeJson("hello");
+        const std::string payload =
+            BuildTelemetryEnvelopeJson("hello", LatestTelemetrySnapshot(), ProfileEngine::getInstance().GetRuntimeStatus());
         httpd_ws_frame_t frame = {};
         frame.type = HTTPD_WS_TYPE_TEXT;
         frame.payload = reinterpret_cast<uint8_t*>(const_cast<char*>(payload.c_str()));
         frame.len = payload.size();
-        return httpd_ws_send_frame(req, &frame);
+        const esp_err_t err = httpd_ws_send_frame(req, &frame);
+        // Registered only after the hello is out, so the sender task never
+        // writes to this socket at the same time.
+        if (err == ESP_OK) {
+            AddWsClient(fd);
+        }
+        return err;
     }
 
     httpd_ws_frame_t frame = {};
@@ -1588,8 +3710,9 @@ esp_err_t WebServerManager::HandleWebsocketRequest(httpd_req_t* req) {
         return err;
     }
 
+    std::vector<uint8_t> payload;
     if (frame.len > 0) {
-        std::vector<uint8_t> payload(frame.len + 1, 0);
+        payload.assign(frame.len + 1, 0);
         frame.payload = payload.data();
         err = httpd_ws_recv_frame(req, &frame, frame.len);
         if (err != ESP_OK) {
@@ -1599,16 +3722,68 @@ esp_err_t WebServerManager::HandleWebsocketRequest(httpd_req_t* req) {
 
     if (frame.type == HTTPD_WS_TYPE_CLOSE) {
         RemoveWsClient(httpd_req_to_sockfd(req));
+    } else if (frame.type == HTTPD_WS_TYPE_TEXT && frame.len > 0 && frame.payload != nullptr) {
+        HandleWsClientMessage(httpd_req_to_sockfd(req), reinterpret_cast<const char*>(frame.payload), frame.len);
     }
 
     return ESP_OK;
 }
 
 esp_err_t WebServerManager::StaticFileHandler(httpd_req_t* req) {
+    HttpdWorkScope work;
     auto* self = static_cast<WebServerManager*>(req->user_ctx);
     return (self == nullptr) ? ESP_FAIL : self->HandleStaticFileRequest(req);
 }
 
+const WebServerManager::StaticAsset* WebServerManager::ResolveStaticAsset(const std::string& localPath) {
+    auto cached = staticAssets.find(localPath);
+    if (cached != staticAssets.end()) {
+        return &cached->second;
+    }
+
+    StaticAsset asset;
+#if CONFIG_WEBUI_EMBEDDED
+    const EmbeddedWebAsset* embedded = nullptr;
+    for (std::size_t i = 0; i < EMBEDDED_WEB_ASSET_COUNT; ++i) {
+        if (localPath == EMBEDDED_WEB_ASSETS[i].path) {
+            embedded = &EMBEDDED_WEB_ASSETS[i];
+            break;
+        }
+    }
+    if (embedded == nullptr) {
+        return nullptr;
+    }
+    asset.data = embedded->start;
+    asset.size = static_cast<std::size_t>(embedded->end - embedded->start);
+    asset.gzip = embedded->gzip;
+    asset.etag = embedded->etag; // Hashed at build time
+    asset.contentType = ContentTypeForPath(localPath);
+    asset.immutable = localPath.rfind(STATIC_IMMUTABLE_PREFIX, 0) == 0;
+#else
+    const std::string basePath = std::string(SPIFFS_BASE_PATH) + localPath;
+    struct stat st = {};
+    if (stat((basePath + ".gz").c_str(), &st) == 0) {
+        asset.filePath = basePath + ".gz";
+        asset.gzip = true;
+    } else if (stat(basePath.c_str(), &st) == 0) {
+        asset.filePath = basePath; // Uncompressed, e.g. built straight from frontend/dist
+    } else {
+        return nullptr;
+    }
+    asset.contentType = ContentTypeForPath(localPath);
+    asset.immutable = localPath.rfind(STATIC_IMMUTABLE_PREFIX, 0) == 0;
+
+    if (asset.immutable) {
+        // The name already changes with the contents.
+        asset.etag = "\"" + localPath.substr(std::strlen(STATIC_IMMUTABLE_PREFIX)) + (asset.gzip ? ".gz" : "") + "\"";
+    } else if (!ComputeFileEtag(asset.filePath, staticFileBuffer.get(), STATIC_FILE_CHUNK_BYTES, asset.etag)) {
+        return nullptr;
+    }
+#endif
+
+    return &staticAssets.emplace(localPath, std::move(asset)).first->second;
+}
+
 esp_err_t WebServerManager::HandleStaticFileRequest(httpd_req_t* req) {
     if (req == nullptr) {
         return ESP_FAIL;
@@ -1628,30 +3803,72 @@ esp_err_t WebServerManager::HandleStaticFileRequest(httpd_req_t* req) {
         return SendJsonError(req, 400, "BAD_PATH", "Invalid path");
     }
 
-    std::string filePath = std::string(SPIFFS_BASE_PATH) + localPath;
-    struct stat st = {};
-    if (stat(filePath.c_str(), &st) != 0) {
-        filePath = std::string(SPIFFS_BASE_PATH) + "/index.html";
-        if (stat(filePath.c_str(), &st) != 0) {
+#if !CONFIG_WEBUI_EMBEDDED
+    if (!staticFileBuffer) {
+        staticFileBuffer.reset(new (std::nothrow) char[STATIC_FILE_CHUNK_BYTES]);
+        if (!staticFileBuffer) {
+            return SendJsonError(req, 500, "NO_MEMORY", "No memory for the static file buffer");
+        }
+    }
+#endif
+
+    // Client-side routes fall back to the app shell.
+    const StaticAsset* asset = ResolveStaticAsset(localPath);
+    if (asset == nullptr) {
+        asset = ResolveStaticAsset("/index.html");
+        if (asset == nullptr) {
             return SendJsonError(req, 404, "NOT_FOUND", "Static file not found");
         }
     }
 
-    FILE* file = std::fopen(filePath.c_str(), "rb");
+    if (asset->gzip && GetRequestHeader(req, "Accept-Encoding").find("gzip") == std::string::npos) {
+        httpd_resp_set_status(req, "406 Not Acceptable");
+        httpd_resp_set_type(req, "text/plain");
+        return httpd_resp_sendstr(req, "This asset is only stored gzip-compressed");
+    }
+
+    // Hashed bundles never change under their name; everything else is
+    // revalidated with the ETag on each load.
+    httpd_resp_set_hdr(req, "Cache-Control", asset->immutable ? "public, max-age=31536000, immutable" : "no-cache");
+    httpd_resp_set_hdr(req, "ETag", asset->etag.c_str());
+    if (asset->gzip) {
+        httpd_resp_set_hdr(req, "Vary", "Accept-Encoding");
+    }
+
+    const std::string ifNoneMatch = GetRequestHeader(req, "If-None-Match");
+    if (!ifNoneMatch.empty() && (ifNoneMatch == "*" || ifNoneMatch.find(asset->etag) != std::string::npos)) {
+        httpd_resp_set_status(req, "304 Not Modified");
+        return httpd_resp_send(req, nullptr, 0);
+    }
+
+    if (asset->data != nullptr) {
+        // Flash is memory-mapped: hand httpd the mapping itself, with a
+        // Content-Length instead of chunked framing.
+        httpd_resp_set_type(req, asset->contentType);
+        if (asset->gzip) {
+            httpd_resp_set_hdr(req, "Content-Encoding", "gzip");
+        }
+        return httpd_resp_send(req, reinterpret_cast<const char*>(asset->data), static_cast<ssize_t>(asset->size));
+    }
+
+    FILE* file = std::fopen(asset->filePath.c_str(), "rb");
     if (file == nullptr) {
         return SendJsonError(req, 500, "FILE_OPEN_FAILED", "Failed to open static file");
     }
+    // Reads already go straight into a full chunk; stdio buffering would only add a copy.
+    std::setvbuf(file, nullptr, _IONBF, 0);
 
-    httpd_resp_set_type(req, ContentTypeForPath(filePath));
-    char buffer[1024] = {};
-    while (!std::feof(file)) {
-        const std::size_t read = std::fread(buffer, 1, sizeof(buffer), file);
-        if (read > 0) {
-            esp_err_t err = httpd_resp_send_chunk(req, buffer, read);
-            if (err != ESP_OK) {
-                std::fclose(file);
-                return err;
-            }
+    httpd_resp_set_type(req, asset->contentType);
+    if (asset->gzip) {
+        httpd_resp_set_hdr(req, "Content-Encoding", "gzip");
+    }
+    char* buffer = staticFileBuffer.get();
+    std::size_t read = 0;
+    while ((read = std::fread(buffer, 1, STATIC_FILE_CHUNK_BYTES, file)) > 0) {
+        esp_err_t err = httpd_resp_send_chunk(req, buffer, read);
+        if (err != ESP_OK) {
+            std::fclose(file);
+            return err;
         }
     }
 
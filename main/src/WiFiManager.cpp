@@ -150,11 +150,16 @@ esp_err_t WiFiManager::Connect(const std::string& ssid, const std::string& passw
 
     if ((bits & WIFI_CONNECTED_BIT) != 0) {
         SettingsManager& settings = SettingsManager::getInstance();
+        SettingsBatch batch;
         err = settings.SetWiFiSSID(ssid);
         if (err != ESP_OK) {
             return err;
         }
-        return settings.SetWiFiPassword(password);
+        err = settings.SetWiFiPassword(password);
+        if (err != ESP_OK) {
+            return err;
+        }
+        return batch.Commit();
     }
 
     if ((bits & WIFI_DISCONNECTED_BIT) != 0) {
@@ -1,29 +1,86 @@
 #include "app.hpp"
 
+#include "BootTimeline.hpp"
+#include "ControlBenchmark.hpp"
 #include "Controller.hpp"
 #include "DataManager.hpp"
 #include "HardwareManager.hpp"
 #include "ProfileEngine.hpp"
+#include "RunLogManager.hpp"
 #include "SettingsManager.hpp"
+#include "SystemProfiler.hpp"
+#include "TelemetryPublisher.hpp"
+#include "TickMonitor.hpp"
+#include "Tracer.hpp"
 #include "TimeManager.hpp"
 #include "WebServerManager.hpp"
 #include "WiFiManager.hpp"
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 
+#include <algorithm>
+
 namespace {
 constexpr const char* TAG = "app";
-constexpr uint32_t CONTROLLER_TICK_MS = 250;
+// With no fixed tick interval configured, ticks are driven by fresh thermocouple
+// passes; the timeout keeps the loop (and its stale-sensor detection) alive if
+// acquisition stops.
+constexpr uint32_t CONTROLLER_SAMPLE_TIMEOUT_MS = 500;
+constexpr double CONTROLLER_MAX_DT_S = 1.0;
+constexpr uint32_t NETWORK_STARTUP_TASK_STACK = 6144;
 TaskHandle_t controllerTaskHandle = nullptr;
+TaskHandle_t networkStartupTaskHandle = nullptr;
+
+template <typename Fn>
+esp_err_t RunBootStage(BootStage stage, Fn&& fn) {
+    BootTimeline& timeline = BootTimeline::getInstance();
+    timeline.BeginStage(stage);
+    const esp_err_t err = fn();
+    timeline.EndStage(stage, err);
+    return err;
+}
 
 void ControllerTaskEntry(void* /*arg*/) {
     Controller& controller = Controller::getInstance();
     ProfileEngine& profileEngine = ProfileEngine::getInstance();
+    TelemetryPublisher& telemetry = TelemetryPublisher::getInstance();
+    HardwareManager::getInstance().setSampleListener(xTaskGetCurrentTaskHandle());
+
+    TickMonitor& tickMonitor = TickMonitor::getInstance();
+
+    int64_t lastTickUs = esp_timer_get_time();
+    TickType_t lastWake = xTaskGetTickCount();
+    uint32_t previousIntervalMs = 0;
     while (true) {
-        (void)controller.RunTick();
-        profileEngine.Tick(static_cast<double>(CONTROLLER_TICK_MS) / 1000.0);
-        vTaskDelay(pdMS_TO_TICKS(CONTROLLER_TICK_MS));
+        const uint32_t intervalMs = controller.GetTickIntervalMs();
+        if (intervalMs == 0) {
+            (void)ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(CONTROLLER_SAMPLE_TIMEOUT_MS));
+        } else {
+            if (intervalMs != previousIntervalMs) {
+                lastWake = xTaskGetTickCount(); // Don't try to catch up across a rate change
+            }
+            vTaskDelayUntil(&lastWake, std::max<TickType_t>(1, pdMS_TO_TICKS(intervalMs)));
+        }
+        previousIntervalMs = intervalMs;
+
+        const int64_t nowUs = esp_timer_get_time();
+        const double dtSeconds = std::clamp(static_cast<double>(nowUs - lastTickUs) / 1e6, 1e-3, CONTROLLER_MAX_DT_S);
+        lastTickUs = nowUs;
+
+        (void)controller.RunTick(dtSeconds);
+        profileEngine.Tick(dtSeconds);
+        telemetry.Publish(TelemetryPublisher::CaptureCurrent());
+
+        const uint32_t execUs = static_cast<uint32_t>(esp_timer_get_time() - nowUs);
+        const uint32_t periodUs = static_cast<uint32_t>(controller.GetNominalTickIntervalMs() * 1000.0);
+        tickMonitor.Record(nowUs, execUs, periodUs);
+#if CONFIG_TRACE_FREEZE_ON_OVERRUN
+        if (execUs > periodUs) {
+            Tracer::getInstance().Freeze();
+        }
+#endif
     }
 }
 
@@ -56,27 +113,131 @@ esp_err_t StartControllerTask() {
 
     return (result == pdPASS) ? ESP_OK : ESP_FAIL;
 }
+
+// Everything that can block on the network, off the main task. The controller
+// is already ticking, so a failure here only costs its own feature.
+void NetworkStartupTaskEntry(void* /*arg*/) {
+    BootTimeline& timeline = BootTimeline::getInstance();
+
+    esp_err_t err = RunBootStage(BootStage::WiFiInit, [] { return WiFiManager::getInstance().Initialize(); });
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "WiFi init failed: %s", esp_err_to_name(err));
+    }
+
+    // Listening before the connect completes means the UI answers as soon as
+    // the station gets its address.
+    err = RunBootStage(BootStage::WebServer, [] { return WebServerManager::getInstance().Initialize(); });
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Web server failed to start: %s", esp_err_to_name(err));
+        timeline.SkipStage(BootStage::RunLog);
+    } else {
+        // Needs the SPIFFS mount from WebServerManager; runs are optional.
+        err = RunBootStage(BootStage::RunLog, [] { return RunLogManager::getInstance().Initialize(); });
+        if (err != ESP_OK) {
+            ESP_LOGW(TAG, "Run log unavailable: %s", esp_err_to_name(err));
+        }
+    }
+
+    if (SettingsManager::getInstance().GetWiFiSSID().empty()) {
+        timeline.SkipStage(BootStage::WiFiConnect);
+    } else {
+        err = RunBootStage(BootStage::WiFiConnect, [] { return WiFiManager::getInstance().ConnectToSavedNetwork(); });
+        if (err != ESP_OK) {
+            ESP_LOGW(TAG, "Saved network not joined: %s", esp_err_to_name(err));
+        }
+    }
+
+    // Started after the connect attempt so the first SNTP poll has a route.
+    err = RunBootStage(BootStage::TimeSync, [] { return TimeManager::getInstance().Initialize(); });
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Time sync task failed to start: %s", esp_err_to_name(err));
+    }
+
+    timeline.MarkNetworkReady();
+    const BootTimelineSnapshot snapshot = timeline.GetSnapshot();
+    ESP_LOGI(TAG, "Network bring-up finished %.1f ms after app start",
+             static_cast<double>(snapshot.networkReadyUs - snapshot.appStartUs) / 1000.0);
+
+    networkStartupTaskHandle = nullptr;
+    vTaskDelete(nullptr);
 }
 
+esp_err_t StartNetworkStartupTask() {
+    if (networkStartupTaskHandle != nullptr) {
+        return ESP_OK;
+    }
+
+    BaseType_t result;
+#if CONFIG_FREERTOS_UNICORE
+    result = xTaskCreate(
+        &NetworkStartupTaskEntry,
+        "NetStartupTask",
+        NETWORK_STARTUP_TASK_STACK,
+        nullptr,
+        1,
+        &networkStartupTaskHandle
+    );
+#else
+    result = xTaskCreatePinnedToCore(
+        &NetworkStartupTaskEntry,
+        "NetStartupTask",
+        NETWORK_STARTUP_TASK_STACK,
+        nullptr,
+        1,
+        &networkStartupTaskHandle,
+        0
+    );
+#endif
+
+    return (result == pdPASS) ? ESP_OK : ESP_FAIL;
+}
+}
+
+// The control path (settings, thermocouples, controller and its safety checks)
+// comes up first and in order; WiFi, the web server, run logs and SNTP follow
+// on a background task so a slow or absent network never delays them.
 void app_start()
 {
-    SettingsManager& settings = SettingsManager::getInstance();
-    ESP_ERROR_CHECK(settings.Initialize());
+    BootTimeline& timeline = BootTimeline::getInstance();
+    timeline.MarkAppStart();
+
+    // Before anything that records trace events; a missing ring only disables tracing.
+    (void)RunBootStage(BootStage::Tracer, [] { return Tracer::getInstance().Initialize(); });
 
-    WiFiManager& wifiManager = WiFiManager::getInstance();
-    ESP_ERROR_CHECK(wifiManager.Initialize());
-    (void)wifiManager.ConnectToSavedNetwork();
+    ESP_ERROR_CHECK(RunBootStage(BootStage::Settings, [] { return SettingsManager::getInstance().Initialize(); }));
+
+    (void)RunBootStage(BootStage::Hardware, [] {
+        (void)HardwareManager::getInstance();
+        return ESP_OK;
+    });
+    (void)RunBootStage(BootStage::Controller, [] {
+        (void)Controller::getInstance();
+        return ESP_OK;
+    });
+    ESP_ERROR_CHECK(RunBootStage(BootStage::ProfileEngine, [] { return ProfileEngine::getInstance().Initialize(); }));
+    (void)RunBootStage(BootStage::DataManager, [] {
+        (void)DataManager::getInstance();
+        return ESP_OK;
+    });
+
+#if CONFIG_CONTROL_MATH_BENCHMARK
+    (void)RunBootStage(BootStage::ControlBenchmark, [] {
+        RunControlMathBenchmark();
+        return ESP_OK;
+    });
+#else
+    timeline.SkipStage(BootStage::ControlBenchmark);
+#endif
 
-    TimeManager& timeManager = TimeManager::getInstance();
-    ESP_ERROR_CHECK(timeManager.Initialize());
+    ESP_ERROR_CHECK(RunBootStage(BootStage::ControllerTask, [] { return StartControllerTask(); }));
+    timeline.MarkControlReady();
 
-    (void)HardwareManager::getInstance();
-    (void)Controller::getInstance();
-    ESP_ERROR_CHECK(ProfileEngine::getInstance().Initialize());
-    (void)DataManager::getInstance();
+    ESP_ERROR_CHECK(StartNetworkStartupTask());
 
-    ESP_ERROR_CHECK(StartControllerTask());
-    ESP_ERROR_CHECK(WebServerManager::getInstance().Initialize());
+    // Baseline for the run-time counters so the first diagnostics read has a CPU% window.
+    (void)SystemProfiler::getInstance().Capture();
 
-    ESP_LOGI(TAG, "Application startup complete");
+    const BootTimelineSnapshot snapshot = timeline.GetSnapshot();
+    ESP_LOGI(TAG, "Control path up in %.1f ms; network bring-up continues in the background",
+             static_cast<double>(snapshot.controlReadyUs - snapshot.appStartUs) / 1000.0);
 }